@@ -1,13 +1,17 @@
 /*
- * COCHE ESCLAVO - Simplificado
- * 
+ * COCHE ESCLAVO
+ *
  * Este coche:
- * - NO necesita sensores conectados (solo motores y luces opcionales)
+ * - NO necesita sensores de luz ni temperatura (motores, HC-SR04 y luces)
  * - Recibe comandos de movimiento del maestro
  * - Recibe datos de sensores del maestro
- * - Ejecuta los movimientos que le ordena el maestro
+ * - Sigue al maestro con su propio HC-SR04, anticipando con sus comandos
+ *   (sin sensor, o con setFusionHueco(false), ejecuta los comandos tal cual)
  * - Muestra datos del maestro en su web
- * 
+ *
+ * Pines, sensores montados y funciones vienen del perfil PerfilEsclavoLolin
+ * (PerfilesCoche.h); para otro montaje, cambiar el perfil.
+ *
  * PASOS DE CONFIGURACIÓN:
  * 1. Conecta solo los motores (y luces si quieres)
  * 2. Sube este código PRIMERO
@@ -16,63 +20,42 @@
  * 5. Anota la IP para acceder a la web
  */
 
-#include "Coche.h"
+#include <PerfilesCoche.h>
 
 // ========== CONFIGURACIÓN WIFI ==========
-const char* WIFI_SSID = "yiyiyi";        
-const char* WIFI_PASSWORD = "xabicrack"; 
+const char* WIFI_SSID = "yiyiyi";
+const char* WIFI_PASSWORD = "xabicrack";
 
 // ========== CONFIGURACIÓN ESP-NOW ==========
-// Esto se puede dejar así, no es necesario cambiarlo
+// Esto se puede dejar así: el esclavo aprende la MAC del maestro al oírlo
 uint8_t MAC_MAESTRO[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
-// ========== PINES LOLIN D1 ESP-WROOM-02 ==========
-#define MOTOR1_A D1  // GPIO5
-#define MOTOR1_B D2  // GPIO4
-#define MOTOR2_A D3  // GPIO0
-#define MOTOR2_B D4  // GPIO2
-// Sensor de seguridad del esclavo
-#define TRIG_PIN D5  // GPIO14 - Sensor ultrasonidos seguridad
-#define ECHO_PIN D6  // GPIO12 - CON DIVISOR DE VOLTAJE
-#define LIGHT_PIN -1 // Sin sensor de luz
-#define LUCES_PIN D8 // GPIO15 - LEDs (opcional)
-
-// Crear objeto Coche ESCLAVO
-Coche miCoche(MOTOR1_A, MOTOR1_B, MOTOR2_A, MOTOR2_B,
-              TRIG_PIN, ECHO_PIN, LIGHT_PIN, LUCES_PIN);
+// Crear objeto Coche ESCLAVO (LOLIN D1 ESP-WROOM-02, HC-SR04 de seguridad + LEDs)
+CochePerfil<PerfilEsclavoLolin> miCoche;
 
 void setup() {
   Serial.begin(115200);
   delay(100);
-  
+
   // Inicializar hardware
   miCoche.inicializar();
-  
-  // Configurar control de distancia: zona muerta 15-20 cm (IGUAL QUE MAESTRO)
-  miCoche.setRangoDistancia(15.0, 20.0);
-  miCoche.setConstanteProporcional(8.0);
-  
+
+  // Seguridad: no avanzar con un obstáculo a menos de 5 cm del propio sensor
+  miCoche.setDistanciaSeguridad(5.0);
+
   // Conectar a WiFi PRIMERO
   miCoche.inicializarWiFi(WIFI_SSID, WIFI_PASSWORD);
-  
-  // Inicializar ESP-NOW como ESCLAVO (mostrará su MAC)
-  miCoche.inicializarESPNowEsclavo(MAC_MAESTRO);
-  
+
+  // Inicializar ESP-NOW (el perfil fija el rol de ESCLAVO; mostrará su MAC)
+  miCoche.inicializarESPNowDual(MAC_MAESTRO);
+
   // Iniciar servidor web
   miCoche.inicializarServidorWeb();
-  
-  delay(1000);
+
+  // Motores, sensor de seguridad, radio, luces y web
+  miCoche.iniciarTareas();
 }
 
 void loop() {
-  // Ejecutar comandos recibidos del maestro
-  miCoche.ejecutarComandoRecibido();
-  
-  // Servidor web
-  miCoche.atenderClientes();
-  
-  // Control de luces según datos del maestro
-  miCoche.controlarLucesAutomaticas();
-  
-  yield();
+  miCoche.ejecutarTareas();  // Sin delay()
 }
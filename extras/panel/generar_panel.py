@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+# Comprime extras/panel/panel.html y lo incrusta en src/PanelWeb.h como un
+# array PROGMEM listo para servir con Content-Encoding: gzip.
+#
+# Uso (desde la raíz de la librería, tras editar panel.html):
+#   python3 extras/panel/generar_panel.py
+#
+# La salida es determinista (gzip sin fecha ni nombre), así que el ETag solo
+# cambia cuando cambia el contenido.
+
+import gzip
+import hashlib
+import io
+import os
+
+RAIZ = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", ".."))
+ENTRADA = os.path.join(RAIZ, "extras", "panel", "panel.html")
+SALIDA = os.path.join(RAIZ, "src", "PanelWeb.h")
+
+
+def comprimir(datos):
+    buffer = io.BytesIO()
+    with gzip.GzipFile(filename="", mode="wb", fileobj=buffer, compresslevel=9, mtime=0) as gz:
+        gz.write(datos)
+    return buffer.getvalue()
+
+
+def main():
+    with open(ENTRADA, "rb") as f:
+        html = f.read()
+    comprimido = comprimir(html)
+    etag = hashlib.sha1(comprimido).hexdigest()[:16]
+
+    lineas = []
+    for i in range(0, len(comprimido), 16):
+        trozo = comprimido[i:i + 16]
+        lineas.append("    " + ", ".join("0x%02x" % b for b in trozo) + ",")
+
+    with open(SALIDA, "w", newline="\n") as f:
+        f.write("#ifndef PANEL_WEB_H\n")
+        f.write("#define PANEL_WEB_H\n\n")
+        f.write("#include <Arduino.h>\n\n")
+        f.write("// Generado por extras/panel/generar_panel.py a partir de extras/panel/panel.html.\n")
+        f.write("// No editar a mano: editar el HTML y volver a ejecutar el script.\n")
+        f.write("// Original: %d bytes, comprimido: %d bytes.\n\n" % (len(html), len(comprimido)))
+        f.write("#define PANEL_ETAG \"\\\"%s\\\"\"\n\n" % etag)
+        f.write("static const size_t PANEL_GZ_LONGITUD = %d;\n\n" % len(comprimido))
+        f.write("static const uint8_t PANEL_GZ[] PROGMEM = {\n")
+        f.write("\n".join(lineas) + "\n")
+        f.write("};\n\n")
+        f.write("#endif\n")
+
+    print("%s: %d -> %d bytes, ETag %s" % (os.path.relpath(SALIDA, RAIZ), len(html), len(comprimido), etag))
+
+
+if __name__ == "__main__":
+    main()
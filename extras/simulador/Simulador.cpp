@@ -0,0 +1,555 @@
+#include "Simulador.h"
+#include <CocheT.h>
+
+Simulador* Simulador::actual = nullptr;
+
+static const uint8_t MAC_TODOS[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+typedef CocheT<RolMaestro> CocheMaestro;
+typedef CocheT<RolEsclavo> CocheEsclavo;
+
+// Constructor: valores medidos a ojo en el coche real
+Simulador::Simulador(uint32_t semilla) {
+    motor.bandaArranque = 140;
+    motor.bandaMovimiento = 90;
+    motor.velocidadMax = 60.0f;
+    motor.constanteTiempo = 0.15f;
+    motor.signoAvance = -1;
+
+    sensor.ruido = 0.3f;
+    sensor.probPerdida = 0.02f;
+    sensor.alcanceMax = 400.0f;
+    sensor.retardoEco = 500;
+
+    radio.latenciaBase = 250;
+    radio.usPorByte = 8;
+    radio.jitterMax = 200;
+    radio.probPerdida = 0.0f;
+    radio.probRafaga = 0.0f;
+    radio.probFinRafaga = 0.3f;
+    radio.perdidaRafaga = 1.0f;
+
+    relojes.derivaMax = 0.0f;
+    relojes.desfaseMax = 0;
+
+    reloj = 0;
+    ordenEventos = 0;
+    canalLibre = 0;
+    nodoActual = 0;
+    estadoAleatorio = semilla != 0 ? semilla : 1;
+    zonaMin = 7.0f;
+    zonaMax = 13.0f;
+    largoCoche = 15.0f;
+    posicionObstaculo = 0;
+    pasoUs = 100;
+}
+
+Simulador::~Simulador() {
+    for (Nodo& nodo : nodos) {
+        if (!nodo.rolFijo) delete nodo.coche;
+        else if (nodo.maestro) delete static_cast<CocheMaestro*>(nodo.coche);
+        else delete static_cast<CocheEsclavo*>(nodo.coche);
+    }
+    if (actual == this) actual = nullptr;
+}
+
+// ========== ALEATORIOS (xorshift32: igual en cualquier plataforma) ==========
+
+uint32_t Simulador::aleatorio() {
+    uint32_t x = estadoAleatorio;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    estadoAleatorio = x;
+    return x;
+}
+
+// Uniforme en [0, 1)
+float Simulador::uniforme() {
+    return (aleatorio() >> 8) * (1.0f / 16777216.0f);
+}
+
+// Normal estándar por Box-Muller
+float Simulador::gaussiana() {
+    float u1 = uniforme();
+    float u2 = uniforme();
+    if (u1 < 1e-7f) u1 = 1e-7f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+// ========== FLOTA ==========
+
+int Simulador::agregarCoche(float posicion, bool maestro, bool rolFijo) {
+    Nodo nodo;
+    memset(nodo.nivel, 0, sizeof(nodo.nivel));
+    memset(nodo.pwm, 0, sizeof(nodo.pwm));
+    memset(nodo.isr, 0, sizeof(nodo.isr));
+    memset(nodo.contextoIsr, 0, sizeof(nodo.contextoIsr));
+    nodo.recepcion = nullptr;
+    nodo.envio = nullptr;
+    nodo.contextoRadio = nullptr;
+
+    // MAC administrada localmente: 02:00:00:00:00:<n>
+    uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, (uint8_t)(nodos.size() + 1)};
+    memcpy(nodo.mac, mac, 6);
+    nodo.maestro = maestro;
+    nodo.posicion = posicion;
+    nodo.velocidad = 0;
+    memset(&nodo.resumen, 0, sizeof(nodo.resumen));
+    nodo.resumen.distanciaMinima = 1e9f;
+    nodo.sumaError = 0;
+    nodo.muestras = 0;
+    nodo.muestrasFuera = 0;
+    nodo.enContacto = false;
+    nodo.enRafaga = false;
+    nodo.deriva = 0;
+    nodo.desfase = 0;
+    nodo.esperaPaso = 0;
+    nodo.rolFijo = rolFijo;
+    if (!rolFijo) {
+        nodo.coche = new Coche(PIN_M1A, PIN_M1B, PIN_M2A, PIN_M2B,
+                               PIN_TRIG, PIN_ECHO, PIN_TEMP, PIN_LUZ, PIN_LUCES);
+    } else if (maestro) {
+        nodo.coche = new CocheMaestro(PIN_M1A, PIN_M1B, PIN_M2A, PIN_M2B,
+                                      PIN_TRIG, PIN_ECHO, PIN_TEMP, PIN_LUZ, PIN_LUCES);
+    } else {
+        nodo.coche = new CocheEsclavo(PIN_M1A, PIN_M1B, PIN_M2A, PIN_M2B,
+                                      PIN_TRIG, PIN_ECHO, PIN_TEMP, PIN_LUZ, PIN_LUCES);
+    }
+    nodos.push_back(nodo);
+    return nodos.size() - 1;
+}
+
+void Simulador::setZonaObjetivo(float minima, float maxima) {
+    zonaMin = minima;
+    zonaMax = maxima;
+}
+
+void Simulador::setLargoCoche(float cm) {
+    largoCoche = cm;
+}
+
+// Inicializar cada coche como lo haría su setup()
+void Simulador::iniciar() {
+    actual = this;
+
+    // Relojes de cada coche (sin aleatorios si no hay deriva ni desfase: mismas
+    // ejecuciones que antes con la misma semilla)
+    for (Nodo& nodo : nodos) {
+        if (relojes.derivaMax > 0) nodo.deriva = (uniforme() * 2.0f - 1.0f) * relojes.derivaMax;
+        if (relojes.desfaseMax > 0) nodo.desfase = aleatorio() % relojes.desfaseMax;
+    }
+
+    int maestro = 0;
+    for (size_t i = 0; i < nodos.size(); i++) {
+        if (nodos[i].maestro) maestro = i;
+    }
+
+    for (size_t i = 0; i < nodos.size(); i++) {
+        nodoActual = i;
+        Nodo& nodo = nodos[i];
+        nodo.nivel[PIN_LUZ] = HIGH;  // De día
+        nodo.coche->inicializar();
+        nodo.coche->setRangoDistancia(zonaMin, zonaMax);
+
+        // El maestro conoce a todos; cada esclavo, al maestro
+        int otro = nodo.maestro ? (i + 1) % nodos.size() : maestro;
+        nodo.coche->inicializarESPNowDual(nodos[otro].mac, nodo.maestro);
+        if (nodo.maestro) {
+            for (size_t j = 0; j < nodos.size(); j++) {
+                if (j != i) nodo.coche->agregarPar(nodos[j].mac);
+            }
+        }
+        if (!nodo.rolFijo) nodo.coche->iniciarTareas();
+        else if (nodo.maestro) static_cast<CocheMaestro*>(nodo.coche)->iniciarTareas();
+        else static_cast<CocheEsclavo*>(nodo.coche)->iniciarTareas();
+    }
+}
+
+Coche& Simulador::coche(int indice) {
+    return *nodos[indice].coche;
+}
+
+float Simulador::posicion(int indice) {
+    return nodos[indice].posicion;
+}
+
+float Simulador::velocidad(int indice) {
+    return nodos[indice].velocidad;
+}
+
+int Simulador::cantidad() {
+    return nodos.size();
+}
+
+unsigned long long Simulador::tiempoUs() {
+    return reloj;
+}
+
+// Reloj del coche: desfase + tiempo real con su deriva
+unsigned long Simulador::relojCoche(int indice) {
+    const Nodo& nodo = nodos[indice];
+    return nodo.desfase + reloj + (long long)llround(reloj * (nodo.deriva * 1e-6));
+}
+
+float Simulador::derivaCoche(int indice) {
+    return nodos[indice].deriva;
+}
+
+const std::vector<unsigned long long>& Simulador::arranques(int indice) {
+    return nodos[indice].arranques;
+}
+
+// PWM medio de las dos ruedas con signo (lo que ve el modelo 1-D)
+int Simulador::pwmMedio(int indice) {
+    Nodo& nodo = nodos[indice];
+    int izq = nodo.pwm[PIN_M1A] - nodo.pwm[PIN_M1B];
+    int der = nodo.pwm[PIN_M2A] - nodo.pwm[PIN_M2B];
+    return (izq + der) / 2;
+}
+
+// Hueco real entre el frontal del coche y lo que tiene delante
+float Simulador::distanciaReal(int indice) {
+    float delante = indice == 0 ? posicionObstaculo : nodos[indice - 1].posicion - largoCoche;
+    return delante - nodos[indice].posicion;
+}
+
+Simulador::Resumen Simulador::resumen(int indice) {
+    Nodo& nodo = nodos[indice];
+    Resumen r = nodo.resumen;
+    r.errorMedio = nodo.muestras > 0 ? nodo.sumaError / nodo.muestras : 0;
+    r.fueraDeZona = nodo.muestras > 0 ? (float)nodo.muestrasFuera / nodo.muestras : 0;
+    return r;
+}
+
+void Simulador::seleccionar(int indice) {
+    actual = this;
+    nodoActual = indice;
+}
+
+// ========== BUCLE PRINCIPAL ==========
+
+// Avanzar a pasos fijos: física, eventos vencidos y una pasada de loop() por coche
+void Simulador::avanzar(unsigned long duracionUs, float (*obstaculo)(float segundos)) {
+    actual = this;
+    unsigned long long fin = reloj + duracionUs;
+    while (reloj < fin) {
+        unsigned long long siguiente = reloj + pasoUs;
+        posicionObstaculo = obstaculo(siguiente / 1000000.0f);
+        integrar(pasoUs / 1000000.0f);
+        procesarEventos(siguiente);
+        reloj = siguiente;
+
+        for (size_t i = 0; i < nodos.size(); i++) {
+            nodoActual = i;
+            nodos[i].esperaPaso = 0;
+            nodos[i].coche->ejecutarTareas();
+            if (nodos[i].esperaPaso > nodos[i].resumen.esperaMaxima) {
+                nodos[i].resumen.esperaMaxima = nodos[i].esperaPaso;
+            }
+        }
+        actualizarEstadisticas();
+    }
+}
+
+// Entregar por orden los eventos hasta el instante indicado, cada uno en su
+// propio instante (las ISR y callbacks ven el micros() del evento)
+void Simulador::procesarEventos(unsigned long long hasta) {
+    while (!eventos.empty() && eventos.top().tiempo <= hasta) {
+        Evento evento = eventos.top();
+        eventos.pop();
+        reloj = evento.tiempo;
+        nodoActual = evento.nodo;
+        Nodo& nodo = nodos[evento.nodo];
+
+        switch (evento.tipo) {
+            case FLANCO_ECO:
+                nodo.nivel[PIN_ECHO] = evento.nivel;
+                if (nodo.isr[PIN_ECHO]) nodo.isr[PIN_ECHO](nodo.contextoIsr[PIN_ECHO]);
+                break;
+            case RECEPCION:
+                nodo.resumen.tramasRecibidas++;
+                if (nodo.recepcion) {
+                    nodo.recepcion(nodo.contextoRadio, evento.mac, evento.datos, evento.longitud);
+                }
+                break;
+            case RESULTADO_ENVIO:
+                if (nodo.envio) nodo.envio(nodo.contextoRadio, evento.mac, evento.exitoso);
+                break;
+        }
+    }
+}
+
+// Modelo cinemático: motor de primer orden con zona muerta y choques sin rebote
+void Simulador::integrar(float dt) {
+    for (size_t i = 0; i < nodos.size(); i++) {
+        Nodo& nodo = nodos[i];
+        int pwm = pwmMedio(i);
+        int magnitud = pwm < 0 ? -pwm : pwm;
+        bool parado = fabsf(nodo.velocidad) < 0.5f;
+        int banda = parado ? motor.bandaArranque : motor.bandaMovimiento;
+
+        float objetivo = 0;
+        if (magnitud >= banda) {
+            float fraccion = (float)(magnitud - motor.bandaMovimiento) / (255 - motor.bandaMovimiento);
+            objetivo = motor.signoAvance * (pwm < 0 ? -1 : 1) * fraccion * motor.velocidadMax;
+        }
+        nodo.velocidad += (objetivo - nodo.velocidad) * dt / motor.constanteTiempo;
+        if (parado && objetivo == 0) nodo.velocidad = 0;
+        nodo.posicion += nodo.velocidad * dt;
+
+        // No atravesar lo que hay delante
+        float hueco = distanciaReal(i);
+        if (hueco < 0) {
+            nodo.posicion += hueco;
+            float delante = i == 0 ? 0 : nodos[i - 1].velocidad;
+            if (nodo.velocidad > delante) nodo.velocidad = delante;
+            if (!nodo.enContacto) nodo.resumen.choques++;
+            nodo.enContacto = true;
+        } else if (hueco > 0.5f) {
+            nodo.enContacto = false;
+        }
+    }
+}
+
+void Simulador::actualizarEstadisticas() {
+    for (size_t i = 0; i < nodos.size(); i++) {
+        Nodo& nodo = nodos[i];
+        float hueco = distanciaReal(i);
+        if (hueco < nodo.resumen.distanciaMinima) nodo.resumen.distanciaMinima = hueco;
+
+        float error = 0;
+        if (hueco < zonaMin) error = zonaMin - hueco;
+        if (hueco > zonaMax) error = hueco - zonaMax;
+        nodo.sumaError += error;
+        nodo.muestras++;
+        if (error > 0) nodo.muestrasFuera++;
+    }
+}
+
+void Simulador::programar(Evento& evento) {
+    evento.orden = ordenEventos++;
+    eventos.push(evento);
+}
+
+// Flanco de bajada del TRIG: programar el eco (o ninguno si se pierde)
+void Simulador::disparoSensor(int indice) {
+    float distancia = distanciaReal(indice) + sensor.ruido * gaussiana();
+    if (uniforme() < sensor.probPerdida || distancia > sensor.alcanceMax) {
+        nodos[indice].resumen.ecosPerdidos++;
+        return;
+    }
+    if (distancia < 0.5f) distancia = 0.5f;
+
+    Evento evento;
+    evento.tipo = FLANCO_ECO;
+    evento.nodo = indice;
+    evento.tiempo = reloj + sensor.retardoEco;
+    evento.nivel = HIGH;
+    programar(evento);
+    evento.tiempo += (unsigned long long)(distancia * 2.0f / 0.034f);
+    evento.nivel = LOW;
+    programar(evento);
+}
+
+// ========== HAL SIMULADA ==========
+
+unsigned long Simulador::micros() {
+    return relojCoche(nodoActual);
+}
+
+void Simulador::modoPin(int pin, uint8_t modo) {
+}
+
+void Simulador::escribirDigital(int pin, uint8_t nivel) {
+    if (pin < 0 || pin >= NUM_PINES) return;
+    Nodo& nodo = nodos[nodoActual];
+    if (pin == PIN_TRIG && nodo.nivel[pin] == HIGH && nivel == LOW) {
+        disparoSensor(nodoActual);
+    }
+    nodo.nivel[pin] = nivel;
+}
+
+int Simulador::leerDigital(int pin) {
+    if (pin < 0 || pin >= NUM_PINES) return LOW;
+    return nodos[nodoActual].nivel[pin];
+}
+
+// LM35 a unos 25 °C: 250 mV sobre 5 V y 10 bits
+int Simulador::leerAnalogico(int pin) {
+    return 51;
+}
+
+void Simulador::escribirPWM(int pin, int valor) {
+    if (pin < 0 || pin >= NUM_PINES) return;
+    bool parado = pwmMedio(nodoActual) == 0;
+    nodos[nodoActual].pwm[pin] = valor;
+    if (parado && pwmMedio(nodoActual) != 0) nodos[nodoActual].arranques.push_back(reloj);
+}
+
+void Simulador::esperar(unsigned long us) {
+    if (nodoActual < (int)nodos.size()) nodos[nodoActual].esperaPaso += us;
+}
+
+void Simulador::adjuntarInterrupcion(int pin, FuncionInterrupcionHal funcion, void* contexto) {
+    if (pin < 0 || pin >= NUM_PINES) return;
+    nodos[nodoActual].isr[pin] = funcion;
+    nodos[nodoActual].contextoIsr[pin] = contexto;
+}
+
+int Simulador::iniciarESPNow(FuncionRecepcionHal recepcion, FuncionEnvioHal envio, void* contexto) {
+    Nodo& nodo = nodos[nodoActual];
+    nodo.recepcion = recepcion;
+    nodo.envio = envio;
+    nodo.contextoRadio = contexto;
+    return 0;
+}
+
+int Simulador::agregarPar(const uint8_t* mac) {
+    Nodo& nodo = nodos[nodoActual];
+    for (const std::vector<uint8_t>& par : nodo.pares) {
+        if (memcmp(par.data(), mac, 6) == 0) return 0;
+    }
+    nodo.pares.push_back(std::vector<uint8_t>(mac, mac + 6));
+    return 0;
+}
+
+int Simulador::buscarNodo(const uint8_t* mac) {
+    for (size_t i = 0; i < nodos.size(); i++) {
+        if (memcmp(nodos[i].mac, mac, 6) == 0) return i;
+    }
+    return -1;
+}
+
+// ¿Se pierde la trama que llega a este nodo? Sin ráfagas configuradas no se
+// gasta ningún aleatorio extra (mismas ejecuciones que antes con la misma semilla)
+bool Simulador::perdida(Nodo& nodo) {
+    if (nodo.enRafaga) {
+        if (uniforme() < radio.probFinRafaga) nodo.enRafaga = false;
+    } else if (radio.probRafaga > 0 && uniforme() < radio.probRafaga) {
+        nodo.enRafaga = true;
+        nodo.resumen.rafagas++;
+    }
+    return uniforme() < (nodo.enRafaga ? radio.perdidaRafaga : radio.probPerdida);
+}
+
+// Transmitir una trama: ocupa el canal su tiempo de aire; después llega a su
+// destino (o a todos, si es difusión) salvo pérdida, y el emisor recibe el
+// resultado. En unicast el éxito depende del ACK; en difusión siempre es éxito.
+int Simulador::enviar(const uint8_t* mac, const uint8_t* datos, int longitud) {
+    if (longitud <= 0 || longitud > TAM_MAX_TRAMA) return -1;
+    Nodo& emisor = nodos[nodoActual];
+    bool difusion = memcmp(mac, MAC_TODOS, 6) == 0;
+
+    bool esPar = false;
+    for (const std::vector<uint8_t>& par : emisor.pares) {
+        if (memcmp(par.data(), mac, 6) == 0) esPar = true;
+    }
+    if (!esPar) return -1;  // Como el SDK: hay que añadir el par antes
+    emisor.resumen.tramasEnviadas++;
+
+    unsigned long long inicio = reloj > canalLibre ? reloj : canalLibre;
+    unsigned long aire = radio.latenciaBase + radio.usPorByte * longitud;
+    if (radio.jitterMax > 0) aire += aleatorio() % (radio.jitterMax + 1);
+    unsigned long long llegada = inicio + aire;
+    canalLibre = llegada;
+
+    Evento evento;
+    evento.tipo = RECEPCION;
+    evento.origen = nodoActual;
+    evento.tiempo = llegada;
+    memcpy(evento.mac, emisor.mac, 6);
+    memcpy(evento.datos, datos, longitud);
+    evento.longitud = longitud;
+
+    bool entregada = false;
+    for (size_t i = 0; i < nodos.size(); i++) {
+        if ((int)i == nodoActual) continue;
+        if (!difusion && memcmp(nodos[i].mac, mac, 6) != 0) continue;
+        if (perdida(nodos[i])) {
+            nodos[i].resumen.tramasPerdidas++;
+            continue;
+        }
+        evento.nodo = i;
+        programar(evento);
+        entregada = true;
+    }
+
+    Evento resultado;
+    resultado.tipo = RESULTADO_ENVIO;
+    resultado.nodo = nodoActual;
+    resultado.tiempo = llegada + 50;
+    memcpy(resultado.mac, mac, 6);
+    resultado.exitoso = difusion || entregada;
+    resultado.longitud = 0;
+    programar(resultado);
+    return 0;
+}
+
+void Simulador::obtenerMAC(uint8_t* mac) {
+    memcpy(mac, nodos[nodoActual].mac, 6);
+}
+
+// Implementación de Hal.h para COCHE_HOST: todo va al simulador en curso
+
+unsigned long halMicros() {
+    return Simulador::actual->micros();
+}
+
+unsigned long halMillis() {
+    return Simulador::actual->micros() / 1000;
+}
+
+// Las esperas no avanzan el reloj (el código de los coches corre en tiempo
+// cero), pero se apuntan: es lo que esa pasada de loop() bloquearía en el coche
+void halEsperar(unsigned long ms) {
+    Simulador::actual->esperar(ms * 1000UL);
+}
+
+void halEsperarUs(unsigned int us) {
+    Simulador::actual->esperar(us);
+}
+
+void halModoPin(int pin, uint8_t modo) {
+    Simulador::actual->modoPin(pin, modo);
+}
+
+void halEscribirDigital(int pin, uint8_t nivel) {
+    Simulador::actual->escribirDigital(pin, nivel);
+}
+
+int halLeerDigital(int pin) {
+    return Simulador::actual->leerDigital(pin);
+}
+
+int halLeerAnalogico(int pin) {
+    return Simulador::actual->leerAnalogico(pin);
+}
+
+void halEscribirPWM(int pin, int valor) {
+    Simulador::actual->escribirPWM(pin, valor);
+}
+
+void halAdjuntarInterrupcion(int pin, FuncionInterrupcionHal funcion, void* contexto, int modo) {
+    Simulador::actual->adjuntarInterrupcion(pin, funcion, contexto);
+}
+
+int halIniciarESPNow(FuncionRecepcionHal recepcion, FuncionEnvioHal envio, void* contexto) {
+    return Simulador::actual->iniciarESPNow(recepcion, envio, contexto);
+}
+
+int halAgregarParESPNow(const uint8_t* mac) {
+    return Simulador::actual->agregarPar(mac);
+}
+
+int halEnviarESPNow(uint8_t* mac, uint8_t* datos, int longitud) {
+    return Simulador::actual->enviar(mac, datos, longitud);
+}
+
+void halObtenerMAC(uint8_t* mac) {
+    Simulador::actual->obtenerMAC(mac);
+}
+
+uint32_t halHeapLibre() {
+    return 40000;
+}
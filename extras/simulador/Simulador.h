@@ -0,0 +1,208 @@
+#ifndef SIMULADOR_H
+#define SIMULADOR_H
+
+#include <Arduino.h>
+#include <Hal.h>
+#include <vector>
+#include <queue>
+
+class Coche;
+
+// Simulador determinista de una flota de coches en una recta (1-D).
+// Cada coche ejecuta la librería sin cambios sobre la HAL simulada (Hal.h con
+// COCHE_HOST): pines y PWM por coche, HC-SR04 con ruido y ecos perdidos que
+// llega por la interrupción del ECHO, un bus ESP-NOW en proceso con tiempo
+// de aire, canal compartido y pérdidas, y un reloj por coche con su deriva.
+// El tiempo avanza a pasos fijos y el código de los coches corre en tiempo
+// cero dentro de cada paso; con la misma semilla, dos ejecuciones dan
+// exactamente el mismo resultado.
+class Simulador {
+public:
+    // Motores de corriente continua con zona muerta (la fricción estática es
+    // mayor que la dinámica: hace falta más PWM para arrancar que para seguir)
+    struct ModeloMotor {
+        int bandaArranque;     // PWM mínimo para arrancar desde parado
+        int bandaMovimiento;   // PWM mínimo para seguir moviéndose
+        float velocidadMax;    // cm/s con PWM 255
+        float constanteTiempo; // s, respuesta de primer orden
+        int signoAvance;       // -1: PWM negativo acerca el coche al de delante
+    };
+
+    // HC-SR04: ruido gaussiano en la distancia y ecos que no vuelven
+    struct ModeloSensor {
+        float ruido;           // cm (desviación típica)
+        float probPerdida;     // 0..1 por disparo
+        float alcanceMax;      // cm; más lejos no hay eco
+        unsigned long retardoEco;  // us entre el disparo y el inicio del eco
+    };
+
+    // Radio: canal único compartido, tiempo de aire por byte y pérdidas.
+    // Las pérdidas a ráfagas siguen el modelo de Gilbert-Elliott: la recepción
+    // de cada coche pasa al estado malo con probRafaga por trama y vuelve al
+    // bueno con probFinRafaga; en el malo se pierde con perdidaRafaga.
+    struct ModeloRadio {
+        unsigned long latenciaBase;  // us por trama (preámbulo, cabeceras, ACK)
+        unsigned long usPorByte;     // us por byte de carga
+        unsigned long jitterMax;     // us, uniforme
+        float probPerdida;           // 0..1 por trama y destino (estado bueno)
+        float probRafaga;            // 0..1 bueno → malo (0 = sin ráfagas)
+        float probFinRafaga;         // 0..1 malo → bueno
+        float perdidaRafaga;         // 0..1 por trama en el estado malo
+    };
+
+    // Relojes: cada coche cuenta su micros() con la deriva de su cristal y
+    // desde su propio instante de arranque. Deriva uniforme en ±derivaMax y
+    // desfase en [0, desfaseMax); con los dos a 0 todos marcan el tiempo real
+    struct ModeloReloj {
+        float derivaMax;             // ppm
+        unsigned long desfaseMax;    // us
+    };
+
+    // Estadísticas por coche al terminar
+    struct Resumen {
+        float distanciaMinima;
+        float errorMedio;          // cm fuera de la zona objetivo (media)
+        float fueraDeZona;         // Fracción del tiempo fuera de la zona
+        unsigned long choques;
+        unsigned long tramasEnviadas;
+        unsigned long tramasRecibidas;
+        unsigned long tramasPerdidas;
+        unsigned long ecosPerdidos;
+        unsigned long rafagas;     // Entradas en el estado malo de la radio
+        unsigned long esperaMaxima;  // us de esperas activas en una sola pasada de loop()
+    };
+
+    Simulador(uint32_t semilla = 1);
+    ~Simulador();
+
+    ModeloMotor motor;
+    ModeloSensor sensor;
+    ModeloRadio radio;
+    ModeloReloj relojes;
+
+    // Añadir un coche con su posición (cm, frontal) y rol; devuelve su índice.
+    // El coche 0 sigue al obstáculo; cada uno de los demás, al anterior.
+    // rolFijo construye CocheT<RolMaestro> o CocheT<RolEsclavo> en vez de Coche.
+    int agregarCoche(float posicion, bool maestro, bool rolFijo = false);
+    void setZonaObjetivo(float minima, float maxima);  // Para las estadísticas
+    void setLargoCoche(float cm);
+
+    // Inicializar los coches: pines, ESP-NOW entre todos y planificador
+    void iniciar();
+
+    // Avanzar la simulación; obstaculo es la posición del obstáculo en cada instante
+    void avanzar(unsigned long duracionUs, float (*obstaculo)(float segundos));
+
+    Coche& coche(int indice);
+    float posicion(int indice);
+    float velocidad(int indice);
+    float distanciaReal(int indice);
+    int pwmMedio(int indice);
+    int cantidad();
+    unsigned long long tiempoUs();
+    unsigned long relojCoche(int indice);  // micros() que ve el coche ahora
+    float derivaCoche(int indice);         // ppm
+    // Instantes (tiempo real, us) en que el coche arrancó desde parado
+    const std::vector<unsigned long long>& arranques(int indice);
+    Resumen resumen(int indice);
+
+    // Hacer que las llamadas a la HAL que vengan fuera de avanzar() actúen
+    // sobre este coche (para ejercitar la librería desde fuera, p. ej. el benchmark)
+    void seleccionar(int indice);
+
+    // Pines con los que se construye cada coche (mismos que en el README)
+    static const int PIN_M1A = 5, PIN_M1B = 4, PIN_M2A = 0, PIN_M2B = 2;
+    static const int PIN_TRIG = 14, PIN_ECHO = 12, PIN_TEMP = 17, PIN_LUZ = 13, PIN_LUCES = 15;
+
+    // Interfaz de la HAL simulada (Hal.h): actúan sobre el coche en curso
+    static Simulador* actual;
+    unsigned long micros();
+    void modoPin(int pin, uint8_t modo);
+    void escribirDigital(int pin, uint8_t nivel);
+    int leerDigital(int pin);
+    int leerAnalogico(int pin);
+    void escribirPWM(int pin, int valor);
+    void esperar(unsigned long us);
+    void adjuntarInterrupcion(int pin, FuncionInterrupcionHal funcion, void* contexto);
+    int iniciarESPNow(FuncionRecepcionHal recepcion, FuncionEnvioHal envio, void* contexto);
+    int agregarPar(const uint8_t* mac);
+    int enviar(const uint8_t* mac, const uint8_t* datos, int longitud);
+    void obtenerMAC(uint8_t* mac);
+
+private:
+    static const int NUM_PINES = 32;
+    static const int TAM_MAX_TRAMA = 250;
+
+    struct Nodo {
+        Coche* coche;
+        bool maestro;
+        bool rolFijo;
+        uint8_t mac[6];
+        int nivel[NUM_PINES];
+        int pwm[NUM_PINES];
+        FuncionInterrupcionHal isr[NUM_PINES];
+        void* contextoIsr[NUM_PINES];
+        FuncionRecepcionHal recepcion;
+        FuncionEnvioHal envio;
+        void* contextoRadio;
+        std::vector<std::vector<uint8_t>> pares;
+
+        float posicion;   // cm (frontal)
+        float velocidad;  // cm/s
+        Resumen resumen;
+        double sumaError;
+        unsigned long long muestras;
+        unsigned long long muestrasFuera;
+        bool enContacto;
+        bool enRafaga;    // Estado malo de Gilbert-Elliott en su recepción
+        float deriva;     // ppm de su reloj
+        unsigned long desfase;  // us de su reloj al empezar
+        std::vector<unsigned long long> arranques;
+        unsigned long esperaPaso;  // us de esperas activas en la pasada en curso
+    };
+
+    enum TipoEvento : uint8_t { FLANCO_ECO, RECEPCION, RESULTADO_ENVIO };
+
+    struct Evento {
+        unsigned long long tiempo;
+        unsigned long long orden;  // Desempate estable entre eventos simultáneos
+        TipoEvento tipo;
+        int nodo;
+        int origen;
+        uint8_t nivel;
+        bool exitoso;
+        uint8_t mac[6];
+        uint8_t longitud;
+        uint8_t datos[TAM_MAX_TRAMA];
+    };
+    struct PosteriorA {
+        bool operator()(const Evento& a, const Evento& b) const {
+            return a.tiempo != b.tiempo ? a.tiempo > b.tiempo : a.orden > b.orden;
+        }
+    };
+
+    std::vector<Nodo> nodos;
+    std::priority_queue<Evento, std::vector<Evento>, PosteriorA> eventos;
+    unsigned long long reloj;
+    unsigned long long ordenEventos;
+    unsigned long long canalLibre;  // Fin de la última trama en el aire
+    int nodoActual;
+    uint32_t estadoAleatorio;
+    float zonaMin, zonaMax;
+    float largoCoche;
+    float posicionObstaculo;
+    unsigned long pasoUs;
+
+    uint32_t aleatorio();
+    float uniforme();
+    float gaussiana();
+    void programar(Evento& evento);
+    bool perdida(Nodo& nodo);
+    void disparoSensor(int indice);
+    void procesarEventos(unsigned long long hasta);
+    void integrar(float dt);
+    void actualizarEstadisticas();
+    int buscarNodo(const uint8_t* mac);
+};
+
+#endif
@@ -0,0 +1,759 @@
+// Micro-benchmarks de los caminos calientes de la librería, en Linux sobre la
+// HAL simulada. Al estilo de Google Benchmark: cada prueba se repite hasta
+// durar un tiempo mínimo y se informa de ns/op, ciclos/op (TSC, en x86),
+// reservas de memoria/op,
+// bytes reservados/op y el pico de memoria viva. Las operaciones que en el
+// coche llevan tiempo real (medir con el HC-SR04, arrancar un motor) informan
+// además del tiempo simulado que tardan, las que recorren un buffer, de su
+// caudal en MB/s, y las peticiones web, del tiempo hasta el primer byte.
+//
+//   ./benchmark [--filtro texto] [--tiempo-min S] [--json fichero]
+//
+// El JSON sigue el formato de Google Benchmark (name, iterations, real_time,
+// time_unit) más los contadores propios, para poder comparar versiones con
+// las mismas herramientas.
+
+#include "Simulador.h"
+#include <Coche.h>
+#include <PanelWeb.h>
+#include <chrono>
+#include <malloc.h>
+#include <new>
+#include <vector>
+
+// ========== CONTEO DE MEMORIA DINÁMICA ==========
+
+static unsigned long long reservas = 0;
+static unsigned long long bytesReservados = 0;
+static size_t bytesVivos = 0;  // Lo que ocupan los bloques sin liberar, según malloc
+static size_t picoVivos = 0;
+
+void* operator new(size_t tam) {
+    reservas++;
+    bytesReservados += tam;
+    void* p = malloc(tam ? tam : 1);
+    if (!p) throw std::bad_alloc();
+    bytesVivos += malloc_usable_size(p);
+    if (bytesVivos > picoVivos) picoVivos = bytesVivos;
+    return p;
+}
+
+void* operator new[](size_t tam) {
+    return operator new(tam);
+}
+
+static void liberar(void* p) {
+    if (p) bytesVivos -= malloc_usable_size(p);
+    free(p);
+}
+
+void operator delete(void* p) noexcept { liberar(p); }
+void operator delete[](void* p) noexcept { liberar(p); }
+void operator delete(void* p, size_t) noexcept { liberar(p); }
+void operator delete[](void* p, size_t) noexcept { liberar(p); }
+
+// Ciclos del contador de tiempo del procesador (TSC); -1 donde no hay
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline long long leerCiclos() { return (long long)__rdtsc(); }
+#else
+static inline long long leerCiclos() { return -1; }
+#endif
+
+// Impedir que el compilador descarte un resultado que nadie usa
+template <typename T>
+static inline void noDescartar(const T& valor) {
+    asm volatile("" : : "g"(&valor) : "memory");
+}
+
+// ========== ARNÉS ==========
+
+// Lo que recibe cada prueba: cuántas veces repetir y dónde sumar el tiempo simulado
+struct Ronda {
+    unsigned long long iteraciones;
+    double usSimulados;  // Suma de toda la ronda; < 0 si la prueba no lo usa
+    double bytes;        // Bytes procesados en toda la ronda; < 0 si no lo usa
+    double nsPrimerByte; // Suma del tiempo hasta el primer byte; < 0 si no lo usa
+    void simulado(double us) {
+        if (usSimulados < 0) usSimulados = 0;
+        usSimulados += us;
+    }
+    void procesados(double n) {
+        if (bytes < 0) bytes = 0;
+        bytes += n;
+    }
+    void primerByte(double ns) {
+        if (nsPrimerByte < 0) nsPrimerByte = 0;
+        nsPrimerByte += ns;
+    }
+};
+
+typedef void (*FuncionBenchmark)(Ronda& ronda);
+
+struct Benchmark {
+    const char* nombre;
+    FuncionBenchmark funcion;
+};
+
+struct Resultado {
+    const char* nombre;
+    unsigned long long iteraciones;
+    double nsPorOp;
+    double ciclosPorOp;       // < 0 si no hay TSC
+    double reservasPorOp;
+    double bytesPorOp;
+    double usSimuladosPorOp;  // < 0 si no aplica
+    double bytesPorSegundo;   // < 0 si no aplica
+    double nsPrimerBytePorOp; // < 0 si no aplica
+    size_t picoHeap;          // Memoria viva máxima por encima de la del inicio
+};
+
+// Repetir con cada vez más iteraciones hasta superar el tiempo mínimo
+static Resultado ejecutar(const Benchmark& b, double tiempoMin) {
+    unsigned long long iteraciones = 1;
+    while (true) {
+        Ronda ronda = {iteraciones, -1.0, -1.0, -1.0};
+        unsigned long long reservasAntes = reservas;
+        size_t vivosAntes = bytesVivos;
+        picoVivos = bytesVivos;
+        unsigned long long bytesAntes = bytesReservados;
+        auto inicio = std::chrono::steady_clock::now();
+        long long ciclosAntes = leerCiclos();
+        b.funcion(ronda);
+        long long ciclos = leerCiclos() - ciclosAntes;
+        double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+        if (segundos >= tiempoMin || iteraciones >= 1000000000ULL) {
+            Resultado r;
+            r.nombre = b.nombre;
+            r.iteraciones = iteraciones;
+            r.nsPorOp = segundos * 1e9 / iteraciones;
+            r.ciclosPorOp = ciclosAntes >= 0 ? (double)ciclos / iteraciones : -1.0;
+            r.reservasPorOp = (double)(reservas - reservasAntes) / iteraciones;
+            r.bytesPorOp = (double)(bytesReservados - bytesAntes) / iteraciones;
+            r.usSimuladosPorOp = ronda.usSimulados >= 0 ? ronda.usSimulados / iteraciones : -1.0;
+            r.bytesPorSegundo = ronda.bytes >= 0 ? ronda.bytes / segundos : -1.0;
+            r.nsPrimerBytePorOp = ronda.nsPrimerByte >= 0 ? ronda.nsPrimerByte / iteraciones : -1.0;
+            r.picoHeap = picoVivos - vivosAntes;
+            return r;
+        }
+
+        // Estimar las iteraciones que faltan, con margen y sin saltos enormes
+        double factor = segundos > 0 ? tiempoMin * 1.4 / segundos : 10.0;
+        if (factor > 10.0) factor = 10.0;
+        if (factor < 2.0) factor = 2.0;
+        iteraciones = (unsigned long long)(iteraciones * factor);
+    }
+}
+
+// ========== ESCENARIO ==========
+
+// Obstáculo quieto 40 cm por delante del maestro
+static float obstaculoFijo(float t) {
+    return 70.0f;
+}
+
+// Flota de dos coches ya en marcha: el maestro lleva 3 s siguiendo al obstáculo
+static Simulador* flota = nullptr;
+
+static Simulador& obtenerFlota() {
+    if (flota == nullptr) {
+        flota = new Simulador(1);
+        flota->agregarCoche(30.0f, true);
+        flota->agregarCoche(5.0f, false);
+        flota->iniciar();
+        flota->avanzar(3000000, obstaculoFijo);
+    }
+    return *flota;
+}
+
+// ========== TELEMETRÍA ==========
+
+static void bmDatosJSONString(Ronda& ronda) {
+    Simulador& sim = obtenerFlota();
+    sim.seleccionar(0);
+    Coche& coche = sim.coche(0);
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        String json = coche.obtenerDatosJSON();
+        noDescartar(json);
+    }
+}
+
+static void bmDatosJSONBuffer(Ronda& ronda) {
+    Simulador& sim = obtenerFlota();
+    sim.seleccionar(0);
+    Coche& coche = sim.coche(0);
+    static char buffer[TELEMETRIA_TAM_MAX];
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        size_t n = coche.escribirDatosJSON(buffer, sizeof(buffer));
+        ronda.procesados(n);
+        noDescartar(n);
+    }
+}
+
+// El documento más largo posible: flota completa y todos los números al
+// máximo ancho (el caso de TELEMETRIA_TAM_MAX)
+static void bmPeorCasoJSON(Ronda& ronda) {
+    static InstantaneaTelemetria t;
+    memset(&t, 0, sizeof(t));
+    t.distancia = t.varianzaDistancia = t.velocidadDistancia = t.temperatura = -1e9f;
+    t.tasaExito = t.errorExtrapolacion = t.huecoFusion = t.derivaReloj = t.errorReloj = -1e9f;
+    t.luz = -128;
+    t.origenDatos = ORIGEN_SIN_DATOS;
+    t.movimiento = MOV_RETROCEDIENDO;
+    t.mensajesEnviados = t.mensajesRecibidos = t.mensajesFallidos = t.reintentos = 0xFFFFFFFFUL;
+    t.timeoutsACK = t.comandosSobrescritos = t.desbordesBuzon = 0xFFFFFFFFUL;
+    t.silenciosMando = t.paradasPorSilencio = t.comandosTarde = 0xFFFFFFFFUL;
+    t.desfaseReloj = INT32_MIN;
+    t.numPares = MAX_PARES;
+    for (int i = 0; i < MAX_PARES; i++) {
+        InstantaneaPar& p = t.pares[i];
+        p.datosValidos = true;
+        p.luz = -128;
+        p.temperatura = -1e9f;
+        p.vistoHace = p.recibidos = p.perdidos = p.duplicados = p.reordenados = 0xFFFFFFFFUL;
+    }
+    static char buffer[TELEMETRIA_TAM_MAX];
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        size_t n = escribirTelemetriaJSON(t, buffer, sizeof(buffer));
+        ronda.procesados(n);
+        noDescartar(n);
+    }
+}
+
+// Delta de /eventos con un solo campo cambiado (el caso típico)
+static void bmEventosDelta(Ronda& ronda) {
+    Simulador& sim = obtenerFlota();
+    sim.seleccionar(0);
+    static InstantaneaTelemetria anterior, actual;
+    sim.coche(0).tomarInstantanea(anterior);
+    actual = anterior;
+    static char buffer[TELEMETRIA_TAM_MAX];
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        actual.distancia = anterior.distancia + 1.0f + (i & 7);
+        size_t n = escribirTelemetriaDeltaJSON(actual, anterior, buffer, sizeof(buffer));
+        noDescartar(n);
+    }
+}
+
+// ========== PROTOCOLO ==========
+
+static void bmSellarComando(Ronda& ronda) {
+    TramaComando trama;
+    memset(&trama, 0, sizeof(trama));
+    trama.velocidadIzq = -180;
+    trama.velocidadDer = -180;
+    trama.movimiento = MOV_AVANZANDO;
+    trama.banderas = BANDERA_SENSORES | BANDERA_LUZ;
+    trama.temperatura = aCentesimas(24.5f);
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        sellarTrama(trama, (uint16_t)i, (uint32_t)i);
+        noDescartar(trama);
+    }
+}
+
+static void bmVerComando(Ronda& ronda) {
+    TramaComando trama;
+    memset(&trama, 0, sizeof(trama));
+    sellarTrama(trama, 1, 1000);
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        const TramaComando* vista = verTrama<TramaComando>((const uint8_t*)&trama, sizeof(trama));
+        noDescartar(vista);
+    }
+}
+
+static void bmSellarRespuesta(Ronda& ronda) {
+    TramaRespuesta trama;
+    memset(&trama, 0, sizeof(trama));
+    trama.origen = ROL_ESCLAVO;
+    trama.banderas = BANDERA_SENSORES;
+    trama.temperatura = aCentesimas(24.5f);
+    trama.marcaEco = 123456;
+    trama.retenidoUs = 250;
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        sellarTrama(trama, (uint16_t)i, (uint32_t)i);
+        noDescartar(trama);
+    }
+}
+
+static void bmVerRespuesta(Ronda& ronda) {
+    TramaRespuesta trama;
+    memset(&trama, 0, sizeof(trama));
+    sellarTrama(trama, 1, 1000);
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        const TramaRespuesta* vista = verTrama<TramaRespuesta>((const uint8_t*)&trama, sizeof(trama));
+        noDescartar(vista);
+    }
+}
+
+// Sellar y ver de nuevo cada tipo de trama, como hacen emisor y receptor;
+// el caudal cuenta los bytes de las cuatro tramas
+static void bmIdaYVuelta(Ronda& ronda) {
+    TramaComando comando;
+    TramaControl control;
+    TramaRespuesta respuesta;
+    TramaSincronia sincronia;
+    memset(&comando, 0, sizeof(comando));
+    memset(&control, 0, sizeof(control));
+    memset(&respuesta, 0, sizeof(respuesta));
+    memset(&sincronia, 0, sizeof(sincronia));
+    comando.velocidadIzq = -180;
+    control.codigo = CTRL_CAMBIAR_MODO;
+    respuesta.marcaEco = 123456;
+    sincronia.recepcionEco = 654321;
+    int validas = 0;
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        sellarTrama(comando, (uint16_t)i, (uint32_t)i);
+        sellarTrama(control, (uint16_t)i, (uint32_t)i);
+        sellarTrama(respuesta, (uint16_t)i, (uint32_t)i);
+        sellarTrama(sincronia, (uint16_t)i, (uint32_t)i);
+        validas += verTrama<TramaComando>((const uint8_t*)&comando, sizeof(comando)) != nullptr;
+        validas += verTrama<TramaControl>((const uint8_t*)&control, sizeof(control)) != nullptr;
+        validas += verTrama<TramaRespuesta>((const uint8_t*)&respuesta, sizeof(respuesta)) != nullptr;
+        validas += verTrama<TramaSincronia>((const uint8_t*)&sincronia, sizeof(sincronia)) != nullptr;
+    }
+    noDescartar(validas);
+    ronda.procesados((double)ronda.iteraciones *
+                     (sizeof(comando) + sizeof(control) + sizeof(respuesta) + sizeof(sincronia)));
+}
+
+// El mensaje de texto que se mandaban los ejemplos maestro/esclavo antes del
+// protocolo binario: snprintf en el emisor y sscanf sobre una copia de 200
+// bytes en el callback de recepción
+static void bmMensajeTexto(Ronda& ronda) {
+    static const float distancias[4] = {12.3f, 45.6f, 78.9f, 101.2f};
+    int luz = 0;
+    float dist = 0;
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        char mensaje[200];
+        int n = snprintf(mensaje, sizeof(mensaje), "luz=%d,dist=%.1f", (int)(i & 1), distancias[i & 3]);
+        char recibido[200];
+        memcpy(recibido, mensaje, n);
+        recibido[n] = '\0';
+        if (sscanf(recibido, "luz=%d,dist=%f", &luz, &dist) != 2) luz = -1;
+        noDescartar(dist);
+        ronda.procesados(n);
+    }
+    noDescartar(luz);
+}
+
+// Comparación histórica: el mensaje binario de 4 bytes que usaron después
+// los ejemplos (versión, banderas y distancia en milímetros). Ya no existe en
+// el árbol; los ejemplos usan la librería y las tramas de Protocolo.h
+struct __attribute__((packed)) MensajeCoche {
+    uint8_t version;
+    uint8_t banderas;
+    uint16_t distanciaMm;
+};
+
+static void bmMensajeBinario(Ronda& ronda) {
+    static const float distancias[4] = {12.3f, 45.6f, 78.9f, 101.2f};
+    int luz = 0;
+    float dist = 0;
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        MensajeCoche mensaje;
+        long mm = (long)(distancias[i & 3] * 10.0f + 0.5f);
+        mensaje.version = 1;
+        mensaje.banderas = (i & 1) ? 0x01 : 0;
+        mensaje.distanciaMm = (uint16_t)(mm > 0xFFFF ? 0xFFFF : mm);
+        noDescartar(mensaje);
+
+        MensajeCoche recibido;
+        memcpy(&recibido, &mensaje, sizeof(recibido));
+        if (recibido.version == 1) {
+            luz = recibido.banderas & 0x01;
+            dist = recibido.distanciaMm / 10.0f;
+        }
+        noDescartar(dist);
+    }
+    noDescartar(luz);
+    ronda.procesados((double)ronda.iteraciones * sizeof(MensajeCoche));
+}
+
+// Comando del maestro en el esclavo: callback de recepción (copia al buzón)
+// y su procesado en loop() hasta aplicar los motores y responder. Cada
+// iteración sella una trama nueva para que no se descarte como duplicada.
+static void bmRecepcionComando(Ronda& ronda) {
+    Simulador& sim = obtenerFlota();
+    sim.seleccionar(1);
+    Coche& esclavo = sim.coche(1);
+    uint8_t macMaestro[6];
+    sim.seleccionar(0);
+    memcpy(macMaestro, sim.coche(0).obtenerMAC(), 6);
+    sim.seleccionar(1);
+
+    static uint16_t secuencia = 30000;
+    TramaComando trama;
+    memset(&trama, 0, sizeof(trama));
+    trama.velocidadIzq = -150;
+    trama.velocidadDer = -150;
+    trama.movimiento = MOV_AVANZANDO;
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        sellarTrama(trama, secuencia++, (uint32_t)i);
+        esclavo.recibirTrama(macMaestro, (const uint8_t*)&trama, sizeof(trama));
+        esclavo.atenderESPNow();
+    }
+}
+
+// ========== CONTROL ==========
+
+// Un paso del PID del maestro fuera de la zona muerta
+static void bmControlarDistancia(Ronda& ronda) {
+    Simulador& sim = obtenerFlota();
+    sim.seleccionar(0);
+    Coche& maestro = sim.coche(0);
+    maestro.setRangoDistancia(60.0f, 70.0f);  // Demasiado cerca: el PID trabaja siempre
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        maestro.controlarDistancia();
+    }
+    maestro.setRangoDistancia(7.0f, 13.0f);
+}
+
+// Un paso del PID en Q16 con error y prealimentación cambiantes; las
+// ganancias ya están en Q16, así que solo hay enteros
+static void bmActualizarPID(Ronda& ronda) {
+    ControladorPID pid;
+    pid.setGanancias(8.0f, 0.5f, 0.2f);
+    pid.setFeedForward(1.0f);
+    static const int32_t errores[8] = {
+        3 * ControladorPID::UNO, -2 * ControladorPID::UNO, ControladorPID::UNO / 2, 12 * ControladorPID::UNO,
+        -ControladorPID::UNO / 3, 7 * ControladorPID::UNO, -9 * ControladorPID::UNO, ControladorPID::UNO / 5,
+    };
+    int32_t suma = 0;
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        suma += pid.actualizar(errores[i & 7], errores[(i + 3) & 7] / 4);
+    }
+    noDescartar(suma);
+}
+
+// Muestras de 40 cm con ruido de ±1 cm cada 5 ms
+static void bmFiltro(Ronda& ronda, FiltroDistancia::Modo modo, uint8_t ventana) {
+    FiltroDistancia filtro;
+    filtro.configurar(modo, ventana);
+    static const float ruido[8] = {0.3f, -0.8f, 0.1f, 1.0f, -0.4f, -1.0f, 0.6f, -0.2f};
+    unsigned long marca = 0;
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        marca += 5000;
+        filtro.agregarMuestra(40.0f + ruido[i & 7], marca);
+    }
+    float d = filtro.obtenerDistancia();
+    noDescartar(d);
+}
+
+static void bmFiltroMediana(Ronda& ronda) {
+    bmFiltro(ronda, FiltroDistancia::MEDIANA, 5);
+}
+
+static void bmFiltroKalman(Ronda& ronda) {
+    bmFiltro(ronda, FiltroDistancia::KALMAN, 5);
+}
+
+// ========== OPERACIONES CON TIEMPO REAL (tiempo simulado) ==========
+
+// Una medición del HC-SR04 a 40 cm, del disparo al final del eco. Sustituye
+// al antiguo leerDistanciaFiable(), que bloqueaba en pulseIn() todo ese tiempo.
+static void bmMedicionHCSR04(Ronda& ronda) {
+    Simulador sim(7);
+    sim.agregarCoche(30.0f, true);  // Solo presta sus pines: no se inicializa
+    sim.seleccionar(0);
+    MedidorDistancia medidor(Simulador::PIN_TRIG, Simulador::PIN_ECHO);
+    medidor.inicializar();
+    medidor.setIntervaloDisparo(0);
+
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        unsigned long long inicio = sim.tiempoUs();
+        sim.seleccionar(0);
+        while (!medidor.actualizar()) {
+            sim.avanzar(50, obstaculoFijo);
+            sim.seleccionar(0);
+        }
+        ronda.simulado(sim.tiempoUs() - inicio);
+    }
+}
+
+// Arranque de una rueda desde parado hasta PWM 180 con el impulso y la rampa
+// por defecto, avanzando el perfil cada 2 ms como la tarea de motores.
+// Sustituye al antiguo delay(100) del impulso de arranque.
+static void bmArranqueMotor(Ronda& ronda) {
+    RampaMotor rampa;
+    unsigned long ahora = 0;
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        rampa.detener();
+        rampa.avanzar(ahora);
+        unsigned long inicio = ahora;
+        rampa.setObjetivo(180);
+        while (rampa.avanzar(ahora) != 180) ahora += 2000;
+        ronda.simulado(ahora - inicio);
+        ahora += 2000;
+    }
+}
+
+// Un milisegundo simulado de la flota completa (física, radio y loop() de cada coche)
+static void bmCicloFlota(Ronda& ronda) {
+    Simulador& sim = obtenerFlota();
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        sim.avanzar(1000, obstaculoFijo);
+    }
+    ronda.simulado(1000.0 * ronda.iteraciones);
+}
+
+// ========== WEB ==========
+
+// El manejador de "/" anterior a la página comprimida en flash: montaba los
+// 7 KB de HTML con unas 120 concatenaciones de String en cada petición. Se
+// conserva aquí tal cual para poder medir el antes y el después.
+static void panelPrevio(ESP8266WebServer& servidor) {
+    String html = "<!DOCTYPE html><html><head>";
+    html += "<meta charset='UTF-8'>";
+    html += "<meta name='viewport' content='width=device-width, initial-scale=1.0'>";
+    html += "<title>Control Coche Robot</title>";
+    html += "<style>";
+    html += "body { font-family: Arial, sans-serif; max-width: 600px; margin: 20px auto; padding: 20px; background: #f0f0f0; }";
+    html += ".card { background: white; border-radius: 10px; padding: 20px; margin: 15px 0; box-shadow: 0 2px 5px rgba(0,0,0,0.1); }";
+    html += "h1 { color: #333; text-align: center; margin-bottom: 5px; }";
+    html += ".sensor { display: flex; justify-content: space-between; align-items: center; margin: 10px 0; padding: 15px; background: #f9f9f9; border-radius: 5px; }";
+    html += ".sensor-label { font-weight: bold; color: #555; }";
+    html += ".sensor-value { font-size: 24px; color: #007bff; }";
+    html += ".unit { font-size: 16px; color: #666; margin-left: 5px; }";
+    html += ".estado { text-align: center; padding: 20px; border-radius: 10px; font-size: 28px; font-weight: bold; margin: 15px 0; transition: all 0.3s; }";
+    html += ".parado { background: #ffc107; color: #000; }";
+    html += ".avanzando { background: #28a745; color: white; }";
+    html += ".retrocediendo { background: #dc3545; color: white; }";
+    html += ".modo { text-align: center; padding: 15px; border-radius: 10px; font-size: 20px; font-weight: bold; margin: 10px 0; }";
+    html += ".maestro { background: #007bff; color: white; }";
+    html += ".esclavo { background: #6c757d; color: white; }";
+    html += ".luces { text-align: center; padding: 15px; border-radius: 10px; font-size: 18px; font-weight: bold; margin: 10px 0; transition: all 0.3s; }";
+    html += ".luces-on { background: #ffd700; color: #000; }";
+    html += ".luces-off { background: #333; color: #999; }";
+    html += ".btn { display: block; width: 100%; padding: 15px; margin: 10px 0; font-size: 18px; font-weight: bold; border: none; border-radius: 5px; cursor: pointer; transition: all 0.3s; }";
+    html += ".btn-maestro { background: #007bff; color: white; }";
+    html += ".btn-maestro:hover { background: #0056b3; }";
+    html += ".btn-esclavo { background: #6c757d; color: white; }";
+    html += ".btn-esclavo:hover { background: #545b62; }";
+    html += ".btn-auto { background: #28a745; color: white; }";
+    html += ".btn-auto:hover { background: #218838; }";
+    html += ".btn-manual { background: #ffc107; color: black; }";
+    html += ".btn-manual:hover { background: #e0a800; }";
+    html += ".btn-luces { background: #ffd700; color: black; }";
+    html += ".btn-luces:hover { background: #ffed4e; }";
+    html += ".modo-control { display: flex; gap: 10px; }";
+    html += ".modo-control .btn { flex: 1; }";
+    html += ".sensores-activos { font-size: 14px; color: #666; margin: 5px 0; }";
+    html += ".sensor-activo { display: inline-block; margin: 5px 8px; padding: 5px 10px; background: #28a745; color: white; border-radius: 15px; font-size: 12px; }";
+    html += ".sensor-inactivo { display: inline-block; margin: 5px 8px; padding: 5px 10px; background: #ccc; color: #666; border-radius: 15px; font-size: 12px; }";
+    html += ".estadistica { display: inline-block; margin: 5px; padding: 8px 12px; background: #007bff; color: white; border-radius: 5px; font-size: 14px; font-weight: bold; }";
+    html += "</style>";
+    html += "<script>";
+    html += "function actualizarDatos() {";
+    html += "  fetch('/datos').then(r => r.json()).then(data => {";
+    html += "    document.getElementById('distancia').innerHTML = data.distancia.toFixed(1) + ' <span class=\"unit\">cm</span>';";
+    html += "    var origenTexto = '';";
+    html += "    if (data.origenDatos === 'LOCAL') { origenTexto = ' 📡'; }";
+    html += "    else if (data.origenDatos === 'REMOTO') { origenTexto = ' 📶'; }";
+    html += "    else { origenTexto = ' ❌'; }";
+    html += "    document.getElementById('temperatura').innerHTML = data.temperatura.toFixed(1) + ' <span class=\"unit\">°C</span>' + origenTexto;";
+    html += "    document.getElementById('luz').innerHTML = (data.luz ? '☀️ Detectada' : '🌙 Oscuro') + origenTexto;";
+    html += "    var estadoDiv = document.getElementById('estado');";
+    html += "    estadoDiv.className = 'card estado ' + data.estado.toLowerCase();";
+    html += "    var icono = data.estado === 'AVANZANDO' ? '⬆️' : (data.estado === 'RETROCEDIENDO' ? '⬇️' : '⏸️');";
+    html += "    estadoDiv.innerHTML = icono + ' ' + data.estado;";
+    html += "    var modoDiv = document.getElementById('modo');";
+    html += "    modoDiv.className = 'card modo ' + (data.modo === 'MAESTRO' ? 'maestro' : 'esclavo');";
+    html += "    modoDiv.innerHTML = (data.modo === 'MAESTRO' ? '👑 ' : '🤖 ') + data.modo;";
+    html += "    var autoDiv = document.getElementById('modoAuto');";
+    html += "    autoDiv.innerHTML = (data.automatico ? '🤖 AUTOMÁTICO' : '🎮 MANUAL');";
+    html += "    if (data.lucesDisponibles) {";
+    html += "      document.getElementById('seccionLuces').style.display = 'block';";
+    html += "      var lucesDiv = document.getElementById('estadoLuces');";
+    html += "      lucesDiv.className = 'card luces ' + (data.lucesEncendidas ? 'luces-on' : 'luces-off');";
+    html += "      lucesDiv.innerHTML = (data.lucesEncendidas ? '💡 LUCES ENCENDIDAS' : '🌑 LUCES APAGADAS');";
+    html += "      document.getElementById('btnLucesAuto').innerHTML = (data.lucesAutomaticas ? '🤖 LUCES AUTO' : '🎮 LUCES MANUAL');";
+    html += "    } else {";
+    html += "      document.getElementById('seccionLuces').style.display = 'none';";
+    html += "    }";
+    html += "    var sensoresHTML = '';";
+    html += "    sensoresHTML += data.sensorUltrasonico ? '<span class=\"sensor-activo\">📏 HC-SR04</span>' : '<span class=\"sensor-inactivo\">📏 HC-SR04</span>';";
+    html += "    sensoresHTML += data.sensorTemperatura ? '<span class=\"sensor-activo\">🌡️ LM35</span>' : '<span class=\"sensor-inactivo\">🌡️ LM35</span>';";
+    html += "    sensoresHTML += data.sensorLuminosidad ? '<span class=\"sensor-activo\">💡 LM393</span>' : '<span class=\"sensor-inactivo\">💡 LM393</span>';";
+    html += "    sensoresHTML += data.sensorLuces ? '<span class=\"sensor-activo\">💡 LED</span>' : '<span class=\"sensor-inactivo\">💡 LED</span>';";
+    html += "    document.getElementById('sensoresActivos').innerHTML = sensoresHTML;";
+    html += "  });";
+    html += "}";
+    html += "function cambiarModo(maestro) {";
+    html += "  fetch('/modo?maestro=' + (maestro ? '1' : '0')).then(() => setTimeout(actualizarDatos, 500));";
+    html += "}";
+    html += "function toggleAutomatico() {";
+    html += "  fetch('/automatico').then(() => setTimeout(actualizarDatos, 500));";
+    html += "}";
+    html += "function toggleLuces() {";
+    html += "  fetch('/luces/toggle').then(() => setTimeout(actualizarDatos, 200));";
+    html += "}";
+    html += "function toggleLucesAuto() {";
+    html += "  fetch('/luces/auto').then(() => setTimeout(actualizarDatos, 200));";
+    html += "}";
+    html += "setInterval(actualizarDatos, 500);";
+    html += "window.onload = actualizarDatos;";
+    html += "</script>";
+    html += "</head><body>";
+    html += "<h1>🚗 Control Coche Robot</h1>";
+    html += "<div class='card modo maestro' id='modo'>👑 MAESTRO</div>";
+    html += "<div class='card'>";
+    html += "<div class='modo-control'>";
+    html += "<button class='btn btn-maestro' onclick='cambiarModo(true)'>👑 Maestro</button>";
+    html += "<button class='btn btn-esclavo' onclick='cambiarModo(false)'>🤖 Esclavo</button>";
+    html += "</div>";
+    html += "<button class='btn btn-auto' id='modoAuto' onclick='toggleAutomatico()'>🤖 AUTOMÁTICO</button>";
+    html += "</div>";
+    html += "<div id='seccionLuces' style='display:none;'>";
+    html += "<div class='card luces luces-off' id='estadoLuces'>🌑 LUCES APAGADAS</div>";
+    html += "<div class='card'>";
+    html += "<button class='btn btn-luces' onclick='toggleLuces()'>💡 ON/OFF Luces</button>";
+    html += "<button class='btn btn-auto' id='btnLucesAuto' onclick='toggleLucesAuto()'>🤖 LUCES AUTO</button>";
+    html += "</div>";
+    html += "</div>";
+    html += "<div class='card estado parado' id='estado'>⏸️ PARADO</div>";
+    html += "<div class='card'>";
+    html += "<div class='sensor'><span class='sensor-label'>📏 Distancia:</span><span class='sensor-value' id='distancia'>-- cm</span></div>";
+    html += "<div class='sensor'><span class='sensor-label'>🌡️ Temperatura:</span><span class='sensor-value' id='temperatura'>-- °C</span></div>";
+    html += "<div class='sensor'><span class='sensor-label'>💡 Luminosidad:</span><span class='sensor-value' id='luz'>--</span></div>";
+    html += "</div>";
+    html += "<div class='card'>";
+    html += "<h3 style='margin-top:0; color:#333;'>🔧 Sensores Activos</h3>";
+    html += "<div class='sensores-activos' id='sensoresActivos'>Cargando...</div>";
+    html += "</div>";
+    html += "</body></html>";
+    servidor.send(200, "text/html", html);
+}
+
+static void bmPanel(Ronda& ronda, ESP8266WebServer& servidor, const char* siNoCoincide) {
+    for (unsigned long long i = 0; i < ronda.iteraciones; i++) {
+        const ESP8266WebServer::Respuesta& r = servidor.peticion("/", siNoCoincide);
+        ronda.primerByte(r.nsPrimerByte);
+        noDescartar(r);
+    }
+}
+
+static void bmPanelStringPrevio(Ronda& ronda) {
+    static ESP8266WebServer* servidor = nullptr;
+    if (servidor == nullptr) {
+        servidor = new ESP8266WebServer(80);
+        servidor->on("/", [] { panelPrevio(*servidor); });
+    }
+    bmPanel(ronda, *servidor, "");
+}
+
+// El servidor de inicializarServidorWeb() en el maestro de la flota
+static ESP8266WebServer& servidorCoche() {
+    static ESP8266WebServer* servidor = nullptr;
+    if (servidor == nullptr) {
+        obtenerFlota().seleccionar(0);
+        obtenerFlota().coche(0).inicializarServidorWeb();
+        servidor = ESP8266WebServer::ultimo();
+    }
+    return *servidor;
+}
+
+static void bmPanelGzip(Ronda& ronda) {
+    bmPanel(ronda, servidorCoche(), "");
+}
+
+// Recarga con la página ya en la caché del navegador
+static void bmPanel304(Ronda& ronda) {
+    bmPanel(ronda, servidorCoche(), PANEL_ETAG);
+}
+
+static const Benchmark BENCHMARKS[] = {
+    {"telemetria/datos_json_string", bmDatosJSONString},
+    {"telemetria/datos_json_buffer", bmDatosJSONBuffer},
+    {"telemetria/peor_caso_json", bmPeorCasoJSON},
+    {"telemetria/eventos_delta", bmEventosDelta},
+    {"protocolo/sellar_comando", bmSellarComando},
+    {"protocolo/ver_comando", bmVerComando},
+    {"protocolo/sellar_respuesta", bmSellarRespuesta},
+    {"protocolo/ver_respuesta", bmVerRespuesta},
+    {"protocolo/ida_y_vuelta_4_tramas", bmIdaYVuelta},
+    {"protocolo/mensaje_texto", bmMensajeTexto},
+    {"protocolo/mensaje_binario", bmMensajeBinario},
+    {"espnow/recepcion_comando", bmRecepcionComando},
+    {"control/controlar_distancia", bmControlarDistancia},
+    {"control/actualizar_pid", bmActualizarPID},
+    {"control/filtro_mediana", bmFiltroMediana},
+    {"control/filtro_kalman", bmFiltroKalman},
+    {"tiempo/medicion_hcsr04", bmMedicionHCSR04},
+    {"tiempo/arranque_motor", bmArranqueMotor},
+    {"tiempo/ciclo_flota_1ms", bmCicloFlota},
+    {"web/panel_string_previo", bmPanelStringPrevio},
+    {"web/panel_gzip", bmPanelGzip},
+    {"web/panel_304", bmPanel304},
+};
+
+// ========== SALIDA ==========
+
+static void escribirJSON(FILE* f, const std::vector<Resultado>& resultados) {
+    fprintf(f, "{\n  \"context\": {\"library\": \"Coche\", \"executable\": \"benchmark\"},\n");
+    fprintf(f, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < resultados.size(); i++) {
+        const Resultado& r = resultados[i];
+        fprintf(f, "    {\"name\": \"%s\", \"run_type\": \"iteration\", \"iterations\": %llu, "
+                   "\"real_time\": %.3f, \"cpu_time\": %.3f, \"time_unit\": \"ns\", "
+                   "\"allocs_per_op\": %.3f, \"bytes_per_op\": %.1f",
+                r.nombre, r.iteraciones, r.nsPorOp, r.nsPorOp, r.reservasPorOp, r.bytesPorOp);
+        if (r.ciclosPorOp >= 0) fprintf(f, ", \"cycles_per_op\": %.1f", r.ciclosPorOp);
+        if (r.usSimuladosPorOp >= 0) fprintf(f, ", \"sim_us_per_op\": %.1f", r.usSimuladosPorOp);
+        if (r.bytesPorSegundo >= 0) fprintf(f, ", \"bytes_per_second\": %.0f", r.bytesPorSegundo);
+        if (r.nsPrimerBytePorOp >= 0) fprintf(f, ", \"ttfb_ns\": %.1f", r.nsPrimerBytePorOp);
+        fprintf(f, ", \"peak_heap_bytes\": %zu", r.picoHeap);
+        fprintf(f, "}%s\n", i + 1 < resultados.size() ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+    const char* filtro = nullptr;
+    const char* rutaJSON = nullptr;
+    double tiempoMin = 0.2;
+
+    for (int i = 1; i < argc; i++) {
+        bool hayValor = i + 1 < argc;
+        if (!strcmp(argv[i], "--filtro") && hayValor) filtro = argv[++i];
+        else if (!strcmp(argv[i], "--tiempo-min") && hayValor) tiempoMin = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--json") && hayValor) rutaJSON = argv[++i];
+        else {
+            fprintf(stderr, "Uso: %s [--filtro texto] [--tiempo-min S] [--json fichero]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("%-32s %14s %12s %12s %10s %10s %14s %10s %12s %10s\n", "Benchmark", "Tiempo(ns/op)", "Ciclos/op",
+           "Iteraciones", "Reservas/op", "Bytes/op", "Simulado(us/op)", "MB/s", "TTFB(ns)", "Pico heap");
+    std::vector<Resultado> resultados;
+    for (const Benchmark& b : BENCHMARKS) {
+        if (filtro && !strstr(b.nombre, filtro)) continue;
+        Resultado r = ejecutar(b, tiempoMin);
+        resultados.push_back(r);
+        printf("%-32s %14.1f ", r.nombre, r.nsPorOp);
+        if (r.ciclosPorOp >= 0) printf("%12.1f ", r.ciclosPorOp);
+        else printf("%12s ", "-");
+        printf("%12llu %10.2f %10.1f ", r.iteraciones, r.reservasPorOp, r.bytesPorOp);
+        if (r.usSimuladosPorOp >= 0) printf("%14.1f ", r.usSimuladosPorOp);
+        else printf("%14s ", "-");
+        if (r.bytesPorSegundo >= 0) printf("%10.1f ", r.bytesPorSegundo / 1e6);
+        else printf("%10s ", "-");
+        if (r.nsPrimerBytePorOp >= 0) printf("%12.1f ", r.nsPrimerBytePorOp);
+        else printf("%12s ", "-");
+        printf("%10zu\n", r.picoHeap);
+        fflush(stdout);
+    }
+
+    if (rutaJSON) {
+        FILE* f = fopen(rutaJSON, "w");
+        if (!f) {
+            perror(rutaJSON);
+            return 1;
+        }
+        escribirJSON(f, resultados);
+        fclose(f);
+    }
+    delete flota;
+    return 0;
+}
@@ -0,0 +1,21 @@
+#include "Arduino.h"
+#include "ESP8266WiFi.h"
+#include <stdarg.h>
+
+HardwareSerial Serial;
+WiFiClass WiFi;
+
+size_t Print::printf(const char* formato, ...) {
+    char texto[256];
+    va_list argumentos;
+    va_start(argumentos, formato);
+    int n = vsnprintf(texto, sizeof(texto), formato, argumentos);
+    va_end(argumentos);
+    if (n < 0) return 0;
+    return write((const uint8_t*)texto, strlen(texto));
+}
+
+size_t HardwareSerial::write(const uint8_t* datos, size_t n) {
+    if (habilitado) fwrite(datos, 1, n, stdout);
+    return n;
+}
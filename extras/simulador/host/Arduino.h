@@ -0,0 +1,117 @@
+#ifndef ARDUINO_HOST_H
+#define ARDUINO_HOST_H
+
+// Lo mínimo del core de Arduino para compilar la librería en Linux
+// (-DCOCHE_HOST). Solo tipos y utilidades: pines, tiempo y radio no están
+// aquí a propósito, la librería los usa a través de Hal.h.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+
+#define ICACHE_RAM_ATTR
+#define IRAM_ATTR
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define PGM_P const char*
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define RISING 1
+#define FALLING 2
+#define CHANGE 3
+
+#ifndef constrain
+#define constrain(valor, bajo, alto) ((valor) < (bajo) ? (bajo) : ((valor) > (alto) ? (alto) : (valor)))
+#endif
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// Cadena de Arduino sobre std::string
+class String {
+public:
+    String() {}
+    String(const char* texto) : s(texto ? texto : "") {}
+    String(const std::string& texto) : s(texto) {}
+    String(char c) : s(1, c) {}
+    String(int v) : s(std::to_string(v)) {}
+    String(unsigned int v) : s(std::to_string(v)) {}
+    String(long v) : s(std::to_string(v)) {}
+    String(unsigned long v) : s(std::to_string(v)) {}
+    String(float v, int decimales = 2) { formatear(v, decimales); }
+    String(double v, int decimales = 2) { formatear(v, decimales); }
+
+    String& operator+=(const String& otra) { s += otra.s; return *this; }
+    String& operator+=(const char* otra) { s += otra; return *this; }
+    String& operator+=(char c) { s += c; return *this; }
+    friend String operator+(const String& a, const String& b) { return String(a.s + b.s); }
+    friend String operator+(const String& a, const char* b) { return String(a.s + b); }
+    friend String operator+(const char* a, const String& b) { return String(a + b.s); }
+    bool operator==(const char* otra) const { return s == otra; }
+    bool operator==(const String& otra) const { return s == otra.s; }
+    bool operator!=(const char* otra) const { return s != otra; }
+    bool operator!=(const String& otra) const { return s != otra.s; }
+
+    const char* c_str() const { return s.c_str(); }
+    unsigned int length() const { return s.size(); }
+    bool reserve(unsigned int n) { s.reserve(n); return true; }
+    int toInt() const { return atoi(s.c_str()); }
+    float toFloat() const { return atof(s.c_str()); }
+
+private:
+    std::string s;
+
+    void formatear(double v, int decimales) {
+        char texto[48];
+        snprintf(texto, sizeof(texto), "%.*f", decimales, v);
+        s = texto;
+    }
+};
+
+class Printable {};
+
+// Salida de texto; en el simulador Serial va a stdout solo si está habilitado
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(const uint8_t* datos, size_t n) = 0;
+    size_t write(uint8_t c) { return write(&c, 1); }
+
+    size_t print(const char* texto) { return write((const uint8_t*)texto, strlen(texto)); }
+    size_t print(const String& texto) { return print(texto.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(int v, int base = 10) { return print(String(v)); }
+    size_t print(unsigned int v, int base = 10) { return print(String(v)); }
+    size_t print(long v, int base = 10) { return print(String(v)); }
+    size_t print(unsigned long v, int base = 10) { return print(String(v)); }
+    size_t print(double v, int decimales = 2) { return print(String(v, decimales)); }
+
+    size_t println() { return print("\n"); }
+    template <typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    size_t println(double v, int decimales) { size_t n = print(v, decimales); return n + println(); }
+
+    size_t printf(const char* formato, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class HardwareSerial : public Print {
+public:
+    bool habilitado = false;
+    void begin(unsigned long) {}
+    int availableForWrite() { return 128; }  // Como el FIFO de la UART
+    size_t write(const uint8_t* datos, size_t n) override;
+    using Print::write;
+};
+extern HardwareSerial Serial;
+
+#endif
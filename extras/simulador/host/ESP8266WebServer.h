@@ -0,0 +1,120 @@
+#ifndef ESP8266WEBSERVER_HOST_H
+#define ESP8266WEBSERVER_HOST_H
+
+// Servidor web para compilar la librería en Linux. No abre ningún socket:
+// las pruebas y los benchmarks le pasan las peticiones con peticion() y
+// leen lo que el manejador entregó a la red. Las que se encolan con
+// encolar() las atiende handleClient() de una en una, como el de verdad.
+
+#include "ESP8266WiFi.h"
+#include <Hal.h>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+
+class ESP8266WebServer {
+public:
+    // Lo que el manejador entregó en la última petición
+    struct Respuesta {
+        int codigo;
+        size_t bytes;         // Cabeceras propias + cuerpo
+        double nsPrimerByte;  // Desde que entra la petición hasta el primer send*; < 0 sin respuesta
+    };
+
+    // Coste modelado de atender una petición en el ESP8266 (aceptar,
+    // leer cabeceras y escribir la respuesta en el socket). handleClient()
+    // lo carga como espera activa de la pasada de loop(); 0 = gratis.
+    unsigned long usPorPeticion = 0;
+    unsigned long usPorByte = 0;
+
+    ESP8266WebServer(int) { creado = this; }
+    ~ESP8266WebServer() { if (creado == this) creado = nullptr; }
+    void on(const char* uri, std::function<void()> manejador) { rutas[uri] = manejador; }
+    void onNotFound(std::function<void()>) {}
+    void begin() {}
+    void handleClient() {
+        if (cola.empty()) return;
+        Pendiente p = cola.front();
+        cola.pop_front();
+        unsigned long espera = halMicros() - p.llegada;
+        if (espera > esperaMaxima) esperaMaxima = espera;
+        atendidas++;
+        peticion(p.uri.c_str(), p.siNoCoincide.c_str());
+        unsigned long coste = usPorPeticion + respuesta.bytes * usPorByte;
+        if (coste > 0) halEsperarUs(coste);
+    }
+    void collectHeaders(const char**, size_t) {}
+
+    void send(int codigo, const char* = nullptr, const String& cuerpo = String("")) {
+        registrar(codigo, cuerpo.length());
+    }
+    void send(int codigo, const char*, const char* cuerpo) { registrar(codigo, strlen(cuerpo)); }
+    void send(int codigo, const char*, const char*, size_t longitud) { registrar(codigo, longitud); }
+    void send_P(int codigo, PGM_P, PGM_P, size_t longitud) { registrar(codigo, longitud); }
+    void sendHeader(const String& nombre, const String& valor, bool = false) {
+        bytesCabeceras += nombre.length() + valor.length() + 4;
+    }
+
+    bool hasArg(const String&) { return false; }
+    String arg(const String&) { return String(); }
+    String header(const String& nombre) {
+        return nombre == "If-None-Match" ? String(siNoCoincide.c_str()) : String();
+    }
+    WiFiClient client() { return WiFiClient(); }
+
+    // Atender una petición GET en el momento. siNoCoincide es la cabecera
+    // If-None-Match del navegador ("" si no la manda).
+    const Respuesta& peticion(const char* uri, const char* cabeceraSiNoCoincide = "") {
+        respuesta.codigo = 404;
+        respuesta.bytes = 0;
+        respuesta.nsPrimerByte = -1.0;
+        bytesCabeceras = 0;
+        siNoCoincide = cabeceraSiNoCoincide;
+        inicio = std::chrono::steady_clock::now();
+        auto ruta = rutas.find(uri);
+        if (ruta != rutas.end()) ruta->second();
+        return respuesta;
+    }
+
+    // Dejar una petición para el siguiente handleClient()
+    void encolar(const char* uri, const char* cabeceraSiNoCoincide = "") {
+        cola.push_back({uri, cabeceraSiNoCoincide, halMicros()});
+    }
+    size_t pendientes() { return cola.size(); }
+    unsigned long obtenerAtendidas() { return atendidas; }
+    unsigned long obtenerEsperaMaxima() { return esperaMaxima; }  // us en cola
+
+    // El último servidor construido (el de inicializarServidorWeb())
+    static ESP8266WebServer* ultimo() { return creado; }
+
+private:
+    void registrar(int codigo, size_t longitud) {
+        if (respuesta.nsPrimerByte < 0) {
+            respuesta.nsPrimerByte = std::chrono::duration<double, std::nano>(
+                std::chrono::steady_clock::now() - inicio).count();
+        }
+        respuesta.codigo = codigo;
+        respuesta.bytes += bytesCabeceras + longitud;
+        bytesCabeceras = 0;
+    }
+
+    struct Pendiente {
+        std::string uri;
+        std::string siNoCoincide;
+        unsigned long llegada;
+    };
+
+    std::map<std::string, std::function<void()>> rutas;
+    std::deque<Pendiente> cola;
+    unsigned long atendidas = 0;
+    unsigned long esperaMaxima = 0;
+    std::string siNoCoincide;
+    std::chrono::steady_clock::time_point inicio;
+    size_t bytesCabeceras = 0;
+    Respuesta respuesta = {404, 0, -1.0};
+    static inline ESP8266WebServer* creado = nullptr;
+};
+
+#endif
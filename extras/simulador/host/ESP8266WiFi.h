@@ -0,0 +1,33 @@
+#ifndef ESP8266WIFI_HOST_H
+#define ESP8266WIFI_HOST_H
+
+// WiFi del ESP8266 en Linux: sin red real. Las peticiones web se inyectan
+// en el servidor simulado (ESP8266WebServer.h).
+
+#include "Arduino.h"
+
+#define WL_CONNECTED 3
+#define WIFI_STA 1
+
+class WiFiClient : public Print {
+public:
+    bool connected() { return false; }
+    void stop() {}
+    void setNoDelay(bool) {}
+    int available() { return 0; }
+    int availableForWrite() { return 0; }
+    size_t write(const uint8_t*, size_t) override { return 0; }
+    using Print::write;
+    operator bool() { return false; }
+};
+
+class WiFiClass {
+public:
+    void mode(int) {}
+    void begin(const char*, const char*) {}
+    int status() { return WL_CONNECTED; }
+    String localIP() { return String("127.0.0.1"); }
+};
+extern WiFiClass WiFi;
+
+#endif
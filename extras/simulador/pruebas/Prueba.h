@@ -0,0 +1,61 @@
+#ifndef PRUEBA_H
+#define PRUEBA_H
+
+#include <cmath>
+#include <cstdio>
+
+// Arnés mínimo de las pruebas en Linux (ctest). Cada comprobación fallida se
+// informa con su fichero y línea y la prueba sigue; el ejecutable devuelve 1
+// si falló alguna.
+
+inline int fallosPrueba = 0;
+
+#define COMPROBAR(condicion)                                                     \
+    do {                                                                         \
+        if (!(condicion)) {                                                      \
+            printf("  %s:%d: falla %s\n", __FILE__, __LINE__, #condicion);       \
+            fallosPrueba++;                                                      \
+        }                                                                        \
+    } while (0)
+
+#define COMPROBAR_IGUAL(valor, esperado)                                         \
+    do {                                                                         \
+        long long v_ = (long long)(valor), e_ = (long long)(esperado);           \
+        if (v_ != e_) {                                                          \
+            printf("  %s:%d: %s = %lld, se esperaba %lld\n", __FILE__, __LINE__, \
+                   #valor, v_, e_);                                              \
+            fallosPrueba++;                                                      \
+        }                                                                        \
+    } while (0)
+
+#define COMPROBAR_CERCA(valor, esperado, tolerancia)                             \
+    do {                                                                         \
+        double v_ = (valor), e_ = (esperado);                                    \
+        if (!(fabs(v_ - e_) <= (tolerancia))) {                                  \
+            printf("  %s:%d: %s = %g, se esperaba %g ± %g\n", __FILE__, __LINE__, \
+                   #valor, v_, e_, (double)(tolerancia));                        \
+            fallosPrueba++;                                                      \
+        }                                                                        \
+    } while (0)
+
+struct CasoPrueba {
+    const char* nombre;
+    void (*funcion)();
+};
+
+// Ejecutar los casos en orden; 0 si todos pasan
+template <size_t N>
+int ejecutarPruebas(const CasoPrueba (&casos)[N]) {
+    int casosFallidos = 0;
+    for (const CasoPrueba& caso : casos) {
+        int antes = fallosPrueba;
+        caso.funcion();
+        bool bien = fallosPrueba == antes;
+        if (!bien) casosFallidos++;
+        printf("[%s] %s\n", bien ? " OK  " : "FALLO", caso.nombre);
+    }
+    printf("%zu casos, %d con fallos\n", N, casosFallidos);
+    return casosFallidos == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+# Genera eco_ruidoso.csv: 20 s de muestras del HC-SR04 cada 60 ms frente al
+# obstáculo del simulador (quieto, se aleja a 10 cm/s, quieto, se acerca a
+# 6 cm/s), con el ruido y los fallos que se ven en el coche real: ruido
+# gaussiano de 1 cm, un 2 % de ecos que no vuelven (sin fila) y un 3 % de
+# ecos múltiples que llegan de 15 a 60 cm más lejos.
+#
+# Uso (desde la raíz de la librería):
+#   python3 extras/simulador/pruebas/datos/generar_eco.py
+#
+# Semilla fija: el fichero solo cambia si cambia este script.
+
+import os
+import random
+
+SALIDA = os.path.join(os.path.dirname(os.path.abspath(__file__)), "eco_ruidoso.csv")
+
+PERIODO_US = 60000
+DURACION_US = 20000000
+RUIDO_CM = 1.0
+PROB_PERDIDA = 0.02
+PROB_MULTIPLE = 0.03
+
+
+# El mismo perfil que perfilObstaculo() en simulador.cpp
+def obstaculo(t):
+    ciclo = t % 20.0
+    if ciclo < 3.0:
+        return 40.0
+    if ciclo < 7.0:
+        return 40.0 + (ciclo - 3.0) * 10.0
+    if ciclo < 10.0:
+        return 80.0
+    if ciclo < 16.0:
+        return 80.0 - (ciclo - 10.0) * 6.0
+    return 44.0 - (ciclo - 16.0)
+
+
+def main():
+    azar = random.Random(2)
+    lineas = ["marca_us,medida_cm,real_cm,multiple"]
+    for marca in range(PERIODO_US, DURACION_US + 1, PERIODO_US):
+        real = obstaculo(marca / 1e6)
+        if azar.random() < PROB_PERDIDA:
+            continue
+        medida = real + azar.gauss(0.0, RUIDO_CM)
+        multiple = azar.random() < PROB_MULTIPLE
+        if multiple:
+            medida += azar.uniform(15.0, 60.0)
+        lineas.append("%d,%.2f,%.2f,%d" % (marca, medida, real, multiple))
+    with open(SALIDA, "w") as f:
+        f.write("\n".join(lineas) + "\n")
+    print("%s: %d muestras" % (SALIDA, len(lineas) - 1))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,155 @@
+// Buzon.h con un productor y un consumidor en hilos de verdad: nada se
+// pierde ni se duplica sin contarlo, el orden se conserva y el consumidor
+// nunca ve un valor a medio escribir.
+
+#include "Prueba.h"
+#include <Buzon.h>
+#include <thread>
+
+// Los lados que esperan ceden la CPU: con un solo núcleo el otro hilo solo
+// avanza cuando este se aparta
+static const uint32_t ELEMENTOS = 300000;
+
+// Ráfagas de 1 a 16 elementos entre cesiones de CPU del productor, como
+// los callbacks que llegan entre dos pasadas de loop()
+static bool finRafaga(uint32_t& estado) {
+    estado = estado * 1103515245u + 12345u;
+    return ((estado >> 16) & 15) == 0;
+}
+
+// Contenido comprobable: todos los campos se derivan del número
+struct Elemento {
+    uint32_t numero;
+    uint32_t cuadrado;
+    uint8_t relleno[24];
+
+    static Elemento de(uint32_t n) {
+        Elemento e;
+        e.numero = n;
+        e.cuadrado = n * n;
+        for (uint8_t i = 0; i < sizeof(e.relleno); i++) e.relleno[i] = (uint8_t)(n + i);
+        return e;
+    }
+
+    bool coherente() const {
+        if (cuadrado != numero * numero) return false;
+        for (uint8_t i = 0; i < sizeof(relleno); i++) {
+            if (relleno[i] != (uint8_t)(numero + i)) return false;
+        }
+        return true;
+    }
+};
+
+// Productor que reintenta si está llena: llegan todos, en orden
+static void colaSinPerdidas() {
+    static ColaSPSC<Elemento, 16> cola;
+    std::thread productor([] {
+        for (uint32_t n = 0; n < ELEMENTOS; n++) {
+            Elemento e = Elemento::de(n);
+            while (!cola.poner(e)) std::this_thread::yield();
+        }
+    });
+
+    uint32_t esperado = 0, incoherentes = 0, desordenados = 0;
+    Elemento e;
+    while (esperado < ELEMENTOS) {
+        if (!cola.sacar(e)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (!e.coherente()) incoherentes++;
+        if (e.numero != esperado) desordenados++;
+        esperado = e.numero + 1;
+    }
+    productor.join();
+    COMPROBAR_IGUAL(incoherentes, 0);
+    COMPROBAR_IGUAL(desordenados, 0);
+    COMPROBAR(!cola.sacar(e));
+}
+
+// Productor que no espera (como el callback de ESP-NOW): lo que no cabe se
+// cuenta como desborde y lo que llega sigue en orden
+static void colaConDesbordes() {
+    static ColaSPSC<Elemento, 8> cola;
+    static std::atomic<bool> terminado(false);
+    std::thread productor([] {
+        uint32_t azar = 1;
+        for (uint32_t n = 0; n < ELEMENTOS; n++) {
+            cola.poner(Elemento::de(n));
+            if (finRafaga(azar)) std::this_thread::yield();
+        }
+        terminado.store(true, std::memory_order_release);
+    });
+
+    uint32_t recibidos = 0, incoherentes = 0, desordenados = 0;
+    long ultimo = -1;
+    Elemento e;
+    while (true) {
+        bool fin = terminado.load(std::memory_order_acquire);
+        bool hay = false;
+        while (cola.sacar(e)) {
+            hay = true;
+            recibidos++;
+            if (!e.coherente()) incoherentes++;
+            if ((long)e.numero <= ultimo) desordenados++;
+            ultimo = e.numero;
+        }
+        if (fin && !hay) break;
+        if (!hay) std::this_thread::yield();
+    }
+    productor.join();
+    printf("  %u recibidos, %lu desbordes\n", recibidos, cola.obtenerDesbordes());
+    COMPROBAR_IGUAL(incoherentes, 0);
+    COMPROBAR_IGUAL(desordenados, 0);
+    COMPROBAR_IGUAL(recibidos + cola.obtenerDesbordes(), ELEMENTOS);
+    COMPROBAR(recibidos > 0 && cola.obtenerDesbordes() > 0);
+}
+
+// Ranura de último valor: cada lectura es coherente y más nueva que la
+// anterior, y leídos + sobrescritos cuadra con lo escrito
+static void ranuraCoherente() {
+    static RanuraUltimoValor<Elemento> ranura;
+    static std::atomic<bool> terminado(false);
+    std::thread productor([] {
+        uint32_t azar = 2;
+        for (uint32_t n = 1; n <= ELEMENTOS; n++) {
+            ranura.escribir(Elemento::de(n));
+            if (finRafaga(azar)) std::this_thread::yield();
+        }
+        terminado.store(true, std::memory_order_release);
+    });
+
+    uint32_t lecturas = 0, incoherentes = 0, repetidas = 0;
+    uint32_t ultimo = 0;
+    Elemento e;
+    while (true) {
+        bool fin = terminado.load(std::memory_order_acquire);
+        if (ranura.leer(e)) {
+            lecturas++;
+            if (!e.coherente()) incoherentes++;
+            if (e.numero <= ultimo) repetidas++;
+            ultimo = e.numero;
+        } else if (fin) {
+            break;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    productor.join();
+    printf("  %u lecturas, %lu sobrescritos\n", lecturas, ranura.obtenerSobrescritos());
+    COMPROBAR_IGUAL(incoherentes, 0);
+    COMPROBAR_IGUAL(repetidas, 0);
+    COMPROBAR_IGUAL(ultimo, ELEMENTOS);
+    COMPROBAR_IGUAL(lecturas + ranura.obtenerSobrescritos(), ELEMENTOS);
+    COMPROBAR(lecturas > 1 && ranura.obtenerSobrescritos() > 0);
+    COMPROBAR(!ranura.leer(e));
+}
+
+int main() {
+    static const CasoPrueba casos[] = {
+        {"buzon/cola_sin_perdidas", colaSinPerdidas},
+        {"buzon/cola_con_desbordes", colaConDesbordes},
+        {"buzon/ranura_coherente", ranuraCoherente},
+    };
+    return ejecutarPruebas(casos);
+}
@@ -0,0 +1,443 @@
+// ColaEnvio frente a un sustituto de esp_now_send/OnDataSent con pérdidas y
+// retardos: reintentos tras ACK negativo, timeouts, ACKs tardíos asignados a
+// su propia trama, callbacks que nunca llegan, huecos reservados a la
+// difusión y sellado al transmitir.
+//
+// Cada envío tiene su propio retardo, así que una trama puede completarse en
+// el aire antes que la anterior, pero el sustituto cumple el contrato del
+// SDK del ESP8266: un callback por cada envío aceptado y en el mismo orden,
+// de modo que un callback lento retiene a los que vienen detrás.
+
+#include "Prueba.h"
+#include <ColaEnvio.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+// Transmisión vista por el sustituto
+struct Transmision {
+    int trama;                // Primer byte útil de la trama (identificador en la prueba)
+    unsigned long envio;      // us
+    unsigned long callback;   // us en que el SDK avisaría; 0 = nunca
+    bool exitoso;
+};
+
+// Sustituto de ESP-NOW: decide el destino de cada envío según la política actual
+struct EspNowSimulado {
+    std::vector<Transmision> transmisiones;
+    size_t siguienteCallback = 0;
+    unsigned long ahora = 0;
+    unsigned long ultimoCallback = 0;
+
+    // Lo que le pasará al próximo envío
+    unsigned long retardo = 2000;
+    bool exitoso = true;
+    bool sinCallback = false;
+
+    // Con azar: probabilidad de ACK negativo y retardo uniforme
+    std::mt19937* azar = nullptr;
+    float probNegativo = 0;
+    unsigned long retardoMin = 0, retardoMax = 0;
+
+    int enviar(uint8_t* mac, uint8_t* datos, int longitud) {
+        Transmision t;
+        t.trama = datos[1];
+        t.envio = ahora;
+        t.exitoso = exitoso;
+        unsigned long espera = retardo;
+        if (azar) {
+            t.exitoso = std::uniform_real_distribution<float>(0, 1)(*azar) >= probNegativo;
+            espera = std::uniform_int_distribution<unsigned long>(retardoMin, retardoMax)(*azar);
+        }
+        // En orden: ningún callback antes que el del envío anterior
+        unsigned long llegada = std::max(ahora + espera, ultimoCallback);
+        t.callback = sinCallback ? 0 : llegada;
+        if (!sinCallback) ultimoCallback = llegada;
+        transmisiones.push_back(t);
+        return 0;
+    }
+
+    // Entregar los callbacks vencidos; devuelve cuántos
+    int entregar(ColaEnvio& cola, std::vector<long>* tiempos = nullptr) {
+        int entregados = 0;
+        while (siguienteCallback < transmisiones.size()) {
+            const Transmision& t = transmisiones[siguienteCallback];
+            if (t.callback == 0) {
+                siguienteCallback++;  // Perdido: el SDK no avisa
+                continue;
+            }
+            if (t.callback > ahora) break;
+            long tiempo = cola.registrarACK(t.exitoso, ahora);
+            if (tiempos) tiempos->push_back(tiempo);
+            COMPROBAR(tiempo < 0 || (unsigned long)tiempo == ahora - t.envio);
+            siguienteCallback++;
+            entregados++;
+        }
+        return entregados;
+    }
+
+    // Transmisiones de una trama
+    int veces(int trama) const {
+        int n = 0;
+        for (const Transmision& t : transmisiones) n += t.trama == trama;
+        return n;
+    }
+};
+
+static EspNowSimulado* espnow = nullptr;
+
+static int enviarSimulado(uint8_t* mac, uint8_t* datos, int longitud) {
+    return espnow->enviar(mac, datos, longitud);
+}
+
+static const uint8_t MAC[6] = {0x24, 0x6F, 0x28, 0x01, 0x02, 0x03};
+
+// Cola por defecto (ventana 2, timeout 50 ms, 2 reintentos) sobre el sustituto
+static void preparar(ColaEnvio& cola, EspNowSimulado& simulado) {
+    espnow = &simulado;
+    cola.setFuncionEnvio(enviarSimulado);
+}
+
+static void encolar(ColaEnvio& cola, int trama, bool reemplazable = false) {
+    uint8_t datos[4] = {1, (uint8_t)trama, 0, 0};
+    COMPROBAR(cola.encolar(MAC, datos, sizeof(datos), reemplazable));
+}
+
+// Avanzar el tiempo en pasos de 1 ms atendiendo la cola como loop()
+static void avanzar(ColaEnvio& cola, EspNowSimulado& simulado, unsigned long us) {
+    unsigned long fin = simulado.ahora + us;
+    while (simulado.ahora < fin) {
+        simulado.ahora += 1000;
+        simulado.entregar(cola);
+        cola.atender(simulado.ahora);
+    }
+}
+
+// ACK negativo: la trama se reintenta y, agotados los reintentos, se descarta
+static void reintentoTrasNegativo() {
+    ColaEnvio cola;
+    EspNowSimulado simulado;
+    preparar(cola, simulado);
+
+    simulado.exitoso = false;
+    encolar(cola, 1);
+    cola.atender(simulado.ahora);
+    avanzar(cola, simulado, 20000);
+    COMPROBAR_IGUAL(simulado.veces(1), 3);  // Original + 2 reintentos
+    COMPROBAR_IGUAL(cola.obtenerReintentos(), 2);
+    COMPROBAR_IGUAL(cola.obtenerFallos(), 3);
+    COMPROBAR_IGUAL(cola.obtenerDescartadas(), 1);
+    COMPROBAR_IGUAL(cola.obtenerEntregadas(), 0);
+    COMPROBAR(cola.hayHueco());
+
+    simulado.exitoso = true;
+    encolar(cola, 2);
+    avanzar(cola, simulado, 20000);
+    COMPROBAR_IGUAL(simulado.veces(2), 1);
+    COMPROBAR_IGUAL(cola.obtenerEntregadas(), 1);
+    COMPROBAR_IGUAL(cola.obtenerEnVuelo(), 0);
+}
+
+// Con dos en vuelo, el ACK tardío de la primera la confirma a ella: la
+// segunda sigue en vuelo esperando el suyo y nada se reintenta de más
+static void ackTardioConfirmaSuTrama() {
+    ColaEnvio cola;
+    EspNowSimulado simulado;
+    preparar(cola, simulado);
+
+    simulado.retardo = 80000;  // Más que el timeout de 50 ms
+    encolar(cola, 1);
+    cola.atender(simulado.ahora);
+    simulado.retardo = 2000;   // Retenido en orden detrás del anterior
+    encolar(cola, 2);
+    cola.atender(simulado.ahora);
+    COMPROBAR_IGUAL(cola.obtenerEnVuelo(), 2);
+
+    // Vencen los dos timeouts: ambas se reintentan
+    avanzar(cola, simulado, 60000);
+    COMPROBAR_IGUAL(cola.obtenerTimeouts(), 2);
+    COMPROBAR_IGUAL(simulado.veces(1), 2);
+    COMPROBAR_IGUAL(simulado.veces(2), 2);
+
+    // A los 80 ms llegan los callbacks de las primeras transmisiones: cada
+    // uno libera su trama, y los de los reintentos ya no cuentan
+    avanzar(cola, simulado, 30000);
+    COMPROBAR_IGUAL(cola.obtenerEntregadas(), 2);
+    COMPROBAR_IGUAL(cola.obtenerACKTardios(), 2);
+    COMPROBAR_IGUAL(cola.obtenerEnVuelo(), 0);
+    avanzar(cola, simulado, 100000);
+    COMPROBAR_IGUAL(cola.obtenerEntregadas(), 2);
+    COMPROBAR_IGUAL(cola.obtenerDescartadas(), 0);
+    COMPROBAR_IGUAL(cola.obtenerFallos(), 0);
+    COMPROBAR_IGUAL(simulado.veces(1), 2);
+    COMPROBAR_IGUAL(simulado.veces(2), 2);
+}
+
+// Un ACK tardío no libera la trama en vuelo que vino detrás
+static void ackTardioNoLiberaOtra() {
+    ColaEnvio cola;
+    EspNowSimulado simulado;
+    preparar(cola, simulado);
+    cola.configurar(2, 50000, 0);  // Sin reintentos: espera el ACK tardío
+
+    simulado.retardo = 70000;
+    encolar(cola, 1);
+    cola.atender(simulado.ahora);
+    avanzar(cola, simulado, 55000);   // La 1 vence y queda esperando su ACK
+    COMPROBAR_IGUAL(cola.obtenerTimeouts(), 1);
+    COMPROBAR_IGUAL(cola.obtenerEnVuelo(), 0);
+
+    simulado.retardo = 1000;
+    encolar(cola, 2);                 // Su callback irá detrás del de la 1
+    avanzar(cola, simulado, 10000);
+    COMPROBAR_IGUAL(cola.obtenerEnVuelo(), 1);
+
+    avanzar(cola, simulado, 6000);    // Llegan los dos, en orden
+    COMPROBAR_IGUAL(cola.obtenerACKTardios(), 1);
+    COMPROBAR_IGUAL(cola.obtenerEntregadas(), 2);
+    COMPROBAR_IGUAL(cola.obtenerDescartadas(), 0);
+    COMPROBAR_IGUAL(cola.obtenerEnVuelo(), 0);
+    COMPROBAR_IGUAL(simulado.veces(1), 1);
+    COMPROBAR_IGUAL(simulado.veces(2), 1);
+}
+
+// Sin callback: tras ESPERA_ACK_TARDIO timeouts se descarta y los callbacks
+// siguientes vuelven a casar con su transmisión
+static void callbackPerdido() {
+    ColaEnvio cola;
+    EspNowSimulado simulado;
+    preparar(cola, simulado);
+    cola.configurar(2, 50000, 0);
+
+    simulado.sinCallback = true;
+    encolar(cola, 1);
+    cola.atender(simulado.ahora);
+    simulado.sinCallback = false;
+    avanzar(cola, simulado, 100000);
+    COMPROBAR_IGUAL(cola.obtenerTimeouts(), 1);
+    COMPROBAR_IGUAL(cola.obtenerDescartadas(), 0);  // Aún puede llegar
+    avanzar(cola, simulado, 150000);
+    COMPROBAR_IGUAL(cola.obtenerDescartadas(), 1);
+
+    encolar(cola, 2);
+    avanzar(cola, simulado, 10000);
+    COMPROBAR_IGUAL(cola.obtenerEntregadas(), 1);
+    COMPROBAR_IGUAL(cola.obtenerACKTardios(), 0);
+    COMPROBAR_IGUAL(cola.obtenerEnVuelo(), 0);
+    for (int i = 0; i < ColaEnvio::CAPACIDAD; i++) encolar(cola, 10 + i);  // Ningún hueco retenido
+}
+
+// Un callback perdido en mitad de tráfico a 50 Hz: la purga por
+// ESPERA_ACK_TARDIO no llega a actuar porque siempre hay callbacks, pero el
+// siguiente ya no se asigna a la transmisión sin callback y los tiempos de
+// ACK vuelven a ser los de cada envío
+static void callbackPerdidoConTrafico() {
+    ColaEnvio cola;
+    EspNowSimulado simulado;
+    preparar(cola, simulado);
+
+    std::vector<long> tiempos;
+    const int TRAMAS = 100;
+    const int PERDIDA = 40;
+    for (int trama = 0; trama < TRAMAS; trama++) {
+        simulado.sinCallback = (trama == PERDIDA);
+        encolar(cola, trama);
+        cola.atender(simulado.ahora);
+        simulado.sinCallback = false;
+        for (int ms = 0; ms < 20; ms++) {
+            simulado.ahora += 1000;
+            simulado.entregar(cola, &tiempos);
+            cola.atender(simulado.ahora);
+        }
+    }
+    avanzar(cola, simulado, 300000);
+
+    COMPROBAR_IGUAL(cola.obtenerCallbacksPerdidos(), 1);
+    COMPROBAR_IGUAL(tiempos.size(), TRAMAS);  // El reintento de la perdida tiene el suyo
+    for (long t : tiempos) COMPROBAR_IGUAL(t, 2000);  // Ninguno cuenta el de otra
+    // La trama sin callback vence y se reintenta; ninguna otra
+    COMPROBAR_IGUAL(cola.obtenerTimeouts(), 1);
+    COMPROBAR_IGUAL(simulado.veces(PERDIDA), 2);
+    COMPROBAR_IGUAL(simulado.veces(PERDIDA + 1), 1);
+    COMPROBAR_IGUAL(cola.obtenerEntregadas(), TRAMAS);
+    COMPROBAR_IGUAL(cola.obtenerACKTardios(), 0);
+    COMPROBAR_IGUAL(cola.obtenerEnVuelo() + cola.obtenerPendientes(), 0);
+}
+
+// La más fresca sustituye a una pendiente; el ACK tardío de la sustituida
+// no confirma a la nueva
+static void ackTardioDeTramaReemplazada() {
+    ColaEnvio cola;
+    EspNowSimulado simulado;
+    preparar(cola, simulado);
+    cola.configurar(1, 50000, 1);
+
+    simulado.retardo = 70000;
+    encolar(cola, 1, true);
+    cola.atender(simulado.ahora);
+    avanzar(cola, simulado, 51000);   // Timeout: reintento en vuelo...
+    COMPROBAR_IGUAL(cola.obtenerTimeouts(), 1);
+    COMPROBAR_IGUAL(simulado.veces(1), 2);
+    avanzar(cola, simulado, 60000);   // ...el ACK tardío de la primera la libera
+    COMPROBAR_IGUAL(cola.obtenerACKTardios(), 1);
+    COMPROBAR_IGUAL(cola.obtenerEntregadas(), 1);
+
+    // Una pendiente sustituida antes de salir: el ACK que llegue es de la nueva
+    simulado.retardo = 1000;
+    encolar(cola, 2, true);
+    encolar(cola, 3, true);
+    COMPROBAR_IGUAL(cola.obtenerReemplazadas(), 1);
+    avanzar(cola, simulado, 200000);
+    COMPROBAR_IGUAL(simulado.veces(2), 0);
+    COMPROBAR_IGUAL(cola.obtenerEntregadas(), 2);
+}
+
+// Con un hueco reservado, dos unicast esperando su ACK no retrasan la
+// difusión: sale en cuanto se encola. Sin reserva espera a un ACK.
+static void reservaDeDifusion() {
+    static const uint8_t GRUPO[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+    uint8_t difusion[4] = {1, 9, 0, 0};
+    for (int reserva = 0; reserva <= 1; reserva++) {
+        ColaEnvio cola;
+        EspNowSimulado simulado;
+        preparar(cola, simulado);
+        cola.reservarDifusion(reserva);
+
+        simulado.retardo = 10000;
+        encolar(cola, 1);
+        encolar(cola, 2);
+        cola.atender(simulado.ahora);
+        COMPROBAR_IGUAL(cola.obtenerEnVuelo(), reserva ? 1 : 2);  // La 2 espera su turno
+        avanzar(cola, simulado, 3000);
+        COMPROBAR(cola.encolar(GRUPO, difusion, sizeof(difusion), true));
+        cola.atender(simulado.ahora);
+        COMPROBAR_IGUAL(simulado.veces(9), reserva ? 1 : 0);
+
+        avanzar(cola, simulado, 40000);
+        COMPROBAR_IGUAL(simulado.veces(9), 1);
+        COMPROBAR_IGUAL(cola.obtenerEntregadas(), 2);
+        COMPROBAR_IGUAL(cola.obtenerDifundidas(), 1);
+    }
+
+    // La reserva nunca deja a las unicast sin ventana
+    ColaEnvio cola;
+    EspNowSimulado simulado;
+    preparar(cola, simulado);
+    cola.configurar(1, 50000, 2);
+    cola.reservarDifusion(3);
+    encolar(cola, 1);
+    cola.atender(simulado.ahora);
+    COMPROBAR_IGUAL(simulado.veces(1), 1);
+}
+
+// El sellado se aplica justo antes de cada transmisión, reintentos incluidos:
+// una trama que esperó en la cola sale con la marca de su salida
+static std::vector<unsigned long> sellados;
+
+static void sellarPrueba(uint8_t* datos, uint8_t longitud, unsigned long ahoraUs) {
+    datos[2] = (uint8_t)(ahoraUs / 1000);
+    sellados.push_back(ahoraUs);
+}
+
+static void selladoAlTransmitir() {
+    ColaEnvio cola;
+    EspNowSimulado simulado;
+    preparar(cola, simulado);
+    cola.configurar(1, 50000, 1);
+    cola.setFuncionSellado(sellarPrueba);
+    sellados.clear();
+
+    simulado.retardo = 5000;
+    encolar(cola, 1);
+    encolar(cola, 2);
+    cola.atender(simulado.ahora);
+    simulado.exitoso = false;    // El primer intento de la 2 falla
+    avanzar(cola, simulado, 5000);
+    simulado.exitoso = true;
+    avanzar(cola, simulado, 20000);
+    COMPROBAR_IGUAL(simulado.veces(2), 2);
+    COMPROBAR_IGUAL(sellados.size(), simulado.transmisiones.size());
+    for (size_t i = 0; i < sellados.size(); i++) {
+        COMPROBAR_IGUAL(sellados[i], simulado.transmisiones[i].envio);
+    }
+    COMPROBAR_IGUAL(sellados[1], 5000);   // La 2 salió tras el ACK de la 1...
+    COMPROBAR_IGUAL(sellados[2], 10000);  // ...y su reintento con marca nueva
+    COMPROBAR_IGUAL(cola.obtenerEntregadas(), 2);
+}
+
+// Tráfico a 50 Hz con pérdidas y retardos al azar. Como los callbacks llegan
+// antes de ESPERA_ACK_TARDIO timeouts, cada trama acaba entregada si alguna
+// de sus transmisiones tuvo ACK positivo y descartada si no; nunca se
+// retransmite una trama ya confirmada y cada tiempo de ACK es el de su envío.
+static void traficoConPerdidasYRetardos() {
+    for (unsigned semilla = 1; semilla <= 20; semilla++) {
+        ColaEnvio cola;
+        EspNowSimulado simulado;
+        std::mt19937 azar(semilla);
+        preparar(cola, simulado);
+        simulado.azar = &azar;
+        simulado.probNegativo = 0.3f;
+        simulado.retardoMin = 500;
+        simulado.retardoMax = 120000;
+
+        const int TRAMAS = 200;
+        int encoladas = 0;
+        std::vector<long> tiempos;
+        while (simulado.ahora < 30000000UL) {
+            simulado.ahora += 1000;
+            simulado.entregar(cola, &tiempos);
+            if (simulado.ahora % 20000 == 0 && encoladas < TRAMAS && cola.hayHueco()) {
+                uint8_t datos[4] = {1, (uint8_t)encoladas, 0, 0};
+                cola.encolar(MAC, datos, sizeof(datos), false);
+                encoladas++;
+            }
+            cola.atender(simulado.ahora);
+        }
+        COMPROBAR_IGUAL(encoladas, TRAMAS);
+
+        int confirmadas = 0;
+        bool repetidaTrasACK = false;
+        for (int trama = 0; trama < TRAMAS; trama++) {
+            // Primer ACK positivo de la trama (0 = ninguno)
+            unsigned long primerACK = 0;
+            for (const Transmision& t : simulado.transmisiones) {
+                if (t.trama == trama && t.exitoso && t.callback > 0 &&
+                    (primerACK == 0 || t.callback < primerACK)) {
+                    primerACK = t.callback;
+                }
+            }
+            for (const Transmision& t : simulado.transmisiones) {
+                if (t.trama == trama && primerACK > 0 && t.envio >= primerACK) repetidaTrasACK = true;
+            }
+            confirmadas += primerACK > 0;
+            COMPROBAR(simulado.veces(trama) <= 3);
+        }
+        COMPROBAR(!repetidaTrasACK);
+        COMPROBAR_IGUAL(cola.obtenerEntregadas(), confirmadas);
+        COMPROBAR_IGUAL(cola.obtenerEntregadas() + cola.obtenerDescartadas(), TRAMAS);
+        COMPROBAR_IGUAL(cola.obtenerTransmisiones(), simulado.transmisiones.size());
+        COMPROBAR_IGUAL(tiempos.size(), simulado.transmisiones.size());
+        for (long t : tiempos) COMPROBAR(t >= 0);
+        COMPROBAR_IGUAL(cola.obtenerEnVuelo() + cola.obtenerPendientes(), 0);
+        if (semilla == 1) {
+            printf("  semilla 1: %lu entregadas, %lu descartadas, %lu reintentos, %lu timeouts, "
+                   "%lu ACKs tardíos\n", cola.obtenerEntregadas(), cola.obtenerDescartadas(),
+                   cola.obtenerReintentos(), cola.obtenerTimeouts(), cola.obtenerACKTardios());
+        }
+    }
+}
+
+int main() {
+    static const CasoPrueba casos[] = {
+        {"cola_envio/reintento_tras_negativo", reintentoTrasNegativo},
+        {"cola_envio/ack_tardio_confirma_su_trama", ackTardioConfirmaSuTrama},
+        {"cola_envio/ack_tardio_no_libera_otra", ackTardioNoLiberaOtra},
+        {"cola_envio/callback_perdido", callbackPerdido},
+        {"cola_envio/callback_perdido_con_trafico", callbackPerdidoConTrafico},
+        {"cola_envio/ack_tardio_de_trama_reemplazada", ackTardioDeTramaReemplazada},
+        {"cola_envio/reserva_de_difusion", reservaDeDifusion},
+        {"cola_envio/sellado_al_transmitir", selladoAlTransmitir},
+        {"cola_envio/trafico_con_perdidas_y_retardos", traficoConPerdidasYRetardos},
+    };
+    return ejecutarPruebas(casos);
+}
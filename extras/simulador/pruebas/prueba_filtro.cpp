@@ -0,0 +1,143 @@
+// FiltroDistancia sobre una traza grabada del HC-SR04 con ruido, ecos perdidos
+// y ecos múltiples (datos/eco_ruidoso.csv, ver generar_eco.py): error frente a
+// la distancia real, rechazo de los ecos múltiples y velocidad estimada.
+
+#include "Prueba.h"
+#include <FiltroDistancia.h>
+#include <vector>
+
+struct Muestra {
+    unsigned long marca;
+    float medida;
+    float real;
+    bool multiple;
+};
+
+static std::vector<Muestra> cargarTraza() {
+    std::vector<Muestra> traza;
+    FILE* f = fopen(DATOS_PRUEBAS "/eco_ruidoso.csv", "r");
+    if (!f) {
+        perror(DATOS_PRUEBAS "/eco_ruidoso.csv");
+        return traza;
+    }
+    char linea[96];
+    fgets(linea, sizeof(linea), f);  // Cabecera
+    Muestra m;
+    int multiple;
+    while (fscanf(f, "%lu,%f,%f,%d", &m.marca, &m.medida, &m.real, &multiple) == 4) {
+        m.multiple = multiple != 0;
+        traza.push_back(m);
+    }
+    fclose(f);
+    return traza;
+}
+
+// Errores frente a la distancia real, saltando las primeras muestras
+struct Errores {
+    double cuadratico;   // cm (raíz del error cuadrático medio)
+    double maximo;       // cm
+    double crudo;        // cm, el de las medidas sin filtrar
+};
+
+static Errores recorrer(FiltroDistancia& filtro, const std::vector<Muestra>& traza,
+                        std::vector<float>* velocidades = nullptr) {
+    Errores e = {0, 0, 0};
+    double suma = 0, sumaCruda = 0;
+    size_t n = 0;
+    for (size_t i = 0; i < traza.size(); i++) {
+        filtro.agregarMuestra(traza[i].medida, traza[i].marca);
+        if (velocidades) velocidades->push_back(filtro.obtenerVelocidad());
+        if (i < 5) continue;
+        double error = filtro.obtenerDistancia() - traza[i].real;
+        double crudo = traza[i].medida - traza[i].real;
+        suma += error * error;
+        sumaCruda += crudo * crudo;
+        if (fabs(error) > e.maximo) e.maximo = fabs(error);
+        n++;
+    }
+    e.cuadratico = sqrt(suma / n);
+    e.crudo = sqrt(sumaCruda / n);
+    return e;
+}
+
+static void trazaCargada() {
+    std::vector<Muestra> traza = cargarTraza();
+    COMPROBAR(traza.size() > 300);
+}
+
+// La mediana de 5 no deja pasar ningún eco múltiple suelto
+static void medianaRechazaEcosMultiples() {
+    std::vector<Muestra> traza = cargarTraza();
+    FiltroDistancia filtro;
+    filtro.configurar(FiltroDistancia::MEDIANA, 5);
+    Errores e = recorrer(filtro, traza);
+    printf("  mediana: error %.2f cm (crudo %.2f), máximo %.2f cm\n", e.cuadratico, e.crudo, e.maximo);
+    COMPROBAR(e.cuadratico < 1.5);
+    COMPROBAR(e.cuadratico < e.crudo / 4);
+    COMPROBAR(e.maximo < 5.0);
+}
+
+// El Kalman descarta los ecos múltiples en la puerta y filtra el ruido
+static void kalmanRechazaEcosMultiples() {
+    std::vector<Muestra> traza = cargarTraza();
+    size_t multiples = 0;
+    for (const Muestra& m : traza) multiples += m.multiple;
+
+    FiltroDistancia filtro;
+    filtro.configurar(FiltroDistancia::KALMAN, 5);
+    Errores e = recorrer(filtro, traza);
+    printf("  kalman: error %.2f cm (crudo %.2f), máximo %.2f cm, rechazos %lu de %zu ecos múltiples\n",
+           e.cuadratico, e.crudo, e.maximo, filtro.obtenerRechazos(), multiples);
+    COMPROBAR(e.cuadratico < 1.0);
+    COMPROBAR(e.maximo < 4.0);
+    COMPROBAR(filtro.obtenerRechazos() >= multiples);
+    COMPROBAR(filtro.obtenerRechazos() <= multiples + 5);
+    COMPROBAR(filtro.obtenerVarianza() < 1.0);  // Por debajo del ruido de una muestra
+}
+
+// Velocidad del Kalman en los tramos del perfil: quieto, se aleja a 10 cm/s,
+// quieto y se acerca a 6 cm/s (se deja 1 s tras cada cambio para converger)
+static void kalmanVelocidad() {
+    std::vector<Muestra> traza = cargarTraza();
+    FiltroDistancia filtro;
+    filtro.configurar(FiltroDistancia::KALMAN, 5);
+    std::vector<float> velocidades;
+    recorrer(filtro, traza, &velocidades);
+
+    struct Tramo { float desde, hasta, velocidad; };
+    static const Tramo TRAMOS[] = {{1, 3, 0}, {4, 7, 10}, {8, 10, 0}, {11, 16, -6}};
+    for (const Tramo& tramo : TRAMOS) {
+        double suma = 0;
+        size_t n = 0;
+        for (size_t i = 0; i < traza.size(); i++) {
+            float t = traza[i].marca / 1e6f;
+            if (t < tramo.desde || t >= tramo.hasta) continue;
+            suma += velocidades[i];
+            n++;
+        }
+        printf("  velocidad media en %.0f-%.0f s: %.2f cm/s (real %.0f)\n", tramo.desde, tramo.hasta,
+               suma / n, tramo.velocidad);
+        COMPROBAR_CERCA(suma / n, tramo.velocidad, 1.5);
+    }
+}
+
+// Tras un hueco de más de 1 s el Kalman vuelve a empezar en la nueva medida
+static void kalmanReiniciaTrasHueco() {
+    FiltroDistancia filtro;
+    filtro.configurar(FiltroDistancia::KALMAN, 5);
+    for (int i = 1; i <= 20; i++) filtro.agregarMuestra(40.0f, i * 60000UL);
+    filtro.agregarMuestra(90.0f, 20 * 60000UL + 1500000UL);
+    COMPROBAR_CERCA(filtro.obtenerDistancia(), 90.0, 0.01);
+    COMPROBAR_CERCA(filtro.obtenerVelocidad(), 0.0, 0.01);
+}
+
+int main() {
+    static const CasoPrueba casos[] = {
+        {"filtro/traza_cargada", trazaCargada},
+        {"filtro/mediana_rechaza_ecos_multiples", medianaRechazaEcosMultiples},
+        {"filtro/kalman_rechaza_ecos_multiples", kalmanRechazaEcosMultiples},
+        {"filtro/kalman_velocidad", kalmanVelocidad},
+        {"filtro/kalman_reinicia_tras_hueco", kalmanReiniciaTrasHueco},
+    };
+    return ejecutarPruebas(casos);
+}
@@ -0,0 +1,107 @@
+// Flota de nueve coches (un maestro y ocho esclavos) en el simulador con
+// pérdidas en la radio: nadie choca, cada esclavo cuenta como perdidos los
+// comandos de difusión que no le llegaron y el maestro no mide ACKs de una
+// difusión que nadie confirma.
+
+#include "Prueba.h"
+#include "Simulador.h"
+#include <Coche.h>
+#include <string>
+
+static const int NUM_COCHES = 9;
+
+static float obstaculoFijo(float t) {
+    return 70.0f;
+}
+
+// Número de muestras ("n") de un histograma en obtenerLatenciaJSON()
+static long muestrasHistograma(Coche& coche, const char* nombre) {
+    std::string json = coche.obtenerLatenciaJSON().c_str();
+    size_t pos = json.find(std::string("\"") + nombre + "\":{\"n\":");
+    if (pos == std::string::npos) return -1;
+    return atol(json.c_str() + pos + strlen(nombre) + 8);
+}
+
+static Simulador* crearFlota(float perdida) {
+    Simulador* sim = new Simulador(3);
+    sim->radio.probPerdida = perdida;
+    sim->setZonaObjetivo(7.0f, 13.0f);
+    for (int i = 0; i < NUM_COCHES; i++) sim->agregarCoche(30.0f - i * 25.0f, i == 0);
+    sim->iniciar();
+    sim->avanzar(20000000, obstaculoFijo);
+    return sim;
+}
+
+static void sinChoques() {
+    Simulador* sim = crearFlota(0.05f);
+    for (int i = 0; i < NUM_COCHES; i++) {
+        Simulador::Resumen r = sim->resumen(i);
+        COMPROBAR_IGUAL(r.choques, 0);
+        COMPROBAR(r.distanciaMinima > 2.0f);
+    }
+    delete sim;
+}
+
+// Cada esclavo oye los comandos de difusión del maestro: lo que el simulador
+// perdió en su recepción es lo que su tabla de pares cuenta como perdido
+static void perdidasPorEsclavo() {
+    Simulador* sim = crearFlota(0.05f);
+    static InstantaneaTelemetria t;
+    for (int i = 1; i < NUM_COCHES; i++) {
+        sim->seleccionar(i);
+        sim->coche(i).tomarInstantanea(t);
+        COMPROBAR_IGUAL(t.numPares, 1);
+        Simulador::Resumen r = sim->resumen(i);
+        const InstantaneaPar& maestro = t.pares[0];
+        COMPROBAR(maestro.perdidos <= r.tramasPerdidas);
+        COMPROBAR(maestro.perdidos + 1 >= r.tramasPerdidas);  // La última perdida aún no se ve
+        COMPROBAR_IGUAL(maestro.recibidos, r.tramasRecibidas);
+        COMPROBAR_IGUAL(maestro.duplicados, 0);
+        COMPROBAR_IGUAL(maestro.reordenados, 0);
+        COMPROBAR(r.tramasPerdidas > 0);
+    }
+
+    // El maestro conoce a los ocho y recibe de todos
+    sim->seleccionar(0);
+    sim->coche(0).tomarInstantanea(t);
+    COMPROBAR_IGUAL(t.numPares, NUM_COCHES - 1);
+    for (int i = 0; i < t.numPares; i++) COMPROBAR(t.pares[i].recibidos > 800);
+    delete sim;
+}
+
+// Los comandos salen por difusión: sin ACK, sin reintentos ni timeouts en el
+// maestro aunque se pierdan. Las respuestas unicast de los esclavos sí se
+// confirman y se reintentan.
+static void difusionSinEstadisticasDeACK() {
+    Simulador* sim = crearFlota(0.05f);
+    static InstantaneaTelemetria t;
+    sim->seleccionar(0);
+    Coche& maestro = sim->coche(0);
+    maestro.tomarInstantanea(t);
+    COMPROBAR(t.mensajesEnviados > 900);
+    COMPROBAR_IGUAL(t.reintentos, 0);
+    COMPROBAR_IGUAL(t.timeoutsACK, 0);
+    COMPROBAR_IGUAL(muestrasHistograma(maestro, "envioACK"), 0);
+    COMPROBAR_CERCA(maestro.obtenerTasaExito(), 100.0, 0.01);
+
+    unsigned long reintentos = 0;
+    for (int i = 1; i < NUM_COCHES; i++) {
+        sim->seleccionar(i);
+        Coche& esclavo = sim->coche(i);
+        esclavo.tomarInstantanea(t);
+        reintentos += t.reintentos;
+        COMPROBAR(muestrasHistograma(esclavo, "envioACK") > 800);
+        COMPROBAR(esclavo.obtenerTasaExito() > 99.0f);  // 5 % por intento, 3 intentos
+    }
+    COMPROBAR(reintentos > 0);
+    delete sim;
+}
+
+int main() {
+    static const CasoPrueba casos[] = {
+        {"flota/sin_choques", sinChoques},
+        {"flota/perdidas_por_esclavo", perdidasPorEsclavo},
+        {"flota/difusion_sin_estadisticas_de_ack", difusionSinEstadisticasDeACK},
+    };
+    return ejecutarPruebas(casos);
+}
@@ -0,0 +1,97 @@
+// MedidorDistancia sobre los pines simulados: distancia medida, ecos que no
+// vuelven y lo que bloquea cada pasada de loop() (esperas activas) con la
+// flota entera en marcha.
+
+#include "Prueba.h"
+#include "Simulador.h"
+#include <Coche.h>
+
+static float obstaculoFijo(float t) {
+    return 70.0f;
+}
+
+// Un medidor suelto con los pines del coche 0 (que no se inicializa)
+static void medir(Simulador& sim, MedidorDistancia& medidor, unsigned long long& duracion) {
+    unsigned long long inicio = sim.tiempoUs();
+    sim.seleccionar(0);
+    while (!medidor.actualizar()) {
+        sim.avanzar(50, obstaculoFijo);
+        sim.seleccionar(0);
+    }
+    duracion = sim.tiempoUs() - inicio;
+}
+
+// A 40 cm con ruido de 0,3 cm: cada muestra, dentro de 5 desviaciones
+static void medicionCorrecta() {
+    Simulador sim(3);
+    sim.sensor.probPerdida = 0;
+    sim.agregarCoche(30.0f, true);
+    sim.avanzar(100, obstaculoFijo);
+    sim.seleccionar(0);
+    MedidorDistancia medidor(Simulador::PIN_TRIG, Simulador::PIN_ECHO);
+    medidor.inicializar();
+    medidor.setIntervaloDisparo(0);
+
+    for (int i = 0; i < 50; i++) {
+        unsigned long long duracion;
+        medir(sim, medidor, duracion);
+        COMPROBAR(medidor.muestraValida());
+        COMPROBAR_CERCA(medidor.obtenerDistancia(), sim.distanciaReal(0), 1.5);
+        COMPROBAR(duracion < 5000);  // Disparo, retardo y eco de ida y vuelta (~2,9 ms)
+    }
+    COMPROBAR_IGUAL(medidor.obtenerMuestrasValidas(), 50);
+    COMPROBAR_IGUAL(medidor.obtenerTimeouts(), 0);
+}
+
+// Sin eco el ciclo termina por timeout, inválido, y el siguiente vuelve a medir
+static void ecoPerdido() {
+    Simulador sim(3);
+    sim.sensor.probPerdida = 1.0f;
+    sim.agregarCoche(30.0f, true);
+    sim.avanzar(100, obstaculoFijo);
+    sim.seleccionar(0);
+    MedidorDistancia medidor(Simulador::PIN_TRIG, Simulador::PIN_ECHO);
+    medidor.inicializar();
+    medidor.setIntervaloDisparo(0);
+
+    for (int i = 0; i < 5; i++) {
+        unsigned long long duracion;
+        medir(sim, medidor, duracion);
+        COMPROBAR(!medidor.muestraValida());
+        COMPROBAR(duracion >= 30000 && duracion <= 31100);  // timeoutEco + margen
+    }
+    COMPROBAR_IGUAL(medidor.obtenerTimeouts(), 5);
+
+    sim.sensor.probPerdida = 0;
+    unsigned long long duracion;
+    medir(sim, medidor, duracion);
+    COMPROBAR(medidor.muestraValida());
+    COMPROBAR_CERCA(medidor.obtenerDistancia(), sim.distanciaReal(0), 1.5);
+}
+
+// Con la flota en marcha ninguna pasada de loop() espera más que el pulso de
+// disparo de 10 us (el antiguo leerDistanciaFiable() llegaba a ~190 ms)
+static void bloqueoMaximo() {
+    Simulador sim(5);
+    sim.sensor.probPerdida = 0.2f;
+    sim.agregarCoche(30.0f, true);
+    sim.agregarCoche(5.0f, false);
+    sim.iniciar();
+    sim.avanzar(5000000, obstaculoFijo);
+
+    for (int i = 0; i < 2; i++) {
+        Simulador::Resumen r = sim.resumen(i);
+        printf("  coche %d: bloqueo máximo por pasada %lu us\n", i, r.esperaMaxima);
+        COMPROBAR(r.esperaMaxima <= 10);
+        COMPROBAR(r.ecosPerdidos > 0);
+    }
+}
+
+int main() {
+    static const CasoPrueba casos[] = {
+        {"medidor/medicion_correcta", medicionCorrecta},
+        {"medidor/eco_perdido", ecoPerdido},
+        {"medidor/bloqueo_maximo", bloqueoMaximo},
+    };
+    return ejecutarPruebas(casos);
+}
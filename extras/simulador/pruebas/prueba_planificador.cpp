@@ -0,0 +1,86 @@
+// Planificador::escribirJSON con cualquier tamaño de buffer: la salida es
+// siempre una lista JSON cerrada con tareas enteras, nunca un objeto cortado.
+
+#include "Prueba.h"
+#include "Simulador.h"
+#include <Planificador.h>
+#include <string>
+
+static void nada(void*) {}
+
+static const char* const NOMBRES[MAX_TAREAS] = {
+    "motores", "control", "sensor", "radio", "luces", "web", "traza", "extra1", "extra2", "extra3",
+};
+
+// agregar() lee el reloj: hace falta un coche simulado en curso
+struct Entorno {
+    Simulador sim;
+    Planificador planificador;
+    Entorno() {
+        sim.agregarCoche(0.0f, true);
+        sim.seleccionar(0);
+        for (int i = 0; i < MAX_TAREAS; i++) {
+            planificador.agregar(NOMBRES[i], nada, nullptr, 1000UL * (i + 1), 0, i);
+        }
+    }
+};
+
+static int contar(const std::string& texto, const char* patron) {
+    int n = 0;
+    for (size_t pos = texto.find(patron); pos != std::string::npos; pos = texto.find(patron, pos + 1)) n++;
+    return n;
+}
+
+static void listaCompleta() {
+    Entorno entorno;
+    static char buffer[4096];
+    size_t n = entorno.planificador.escribirJSON(buffer, sizeof(buffer));
+    COMPROBAR_IGUAL(n, strlen(buffer));
+    std::string json = buffer;
+    COMPROBAR_IGUAL(contar(json, "{\"nombre\":"), MAX_TAREAS);
+    COMPROBAR(json.front() == '[' && json.back() == ']');
+    COMPROBAR(json.find("\"nombre\":\"extra3\",\"periodo\":10000,") != std::string::npos);
+}
+
+// Con cada tamaño posible: "[" + las primeras tareas enteras + "]"
+static void recorteSiempreValido() {
+    Entorno entorno;
+    static char completo[4096];
+    size_t total = entorno.planificador.escribirJSON(completo, sizeof(completo));
+    std::string referencia = completo;
+
+    static char buffer[4096];
+    int tareasAntes = 0;
+    for (size_t tam = 0; tam <= total + 1; tam++) {
+        memset(buffer, 'x', sizeof(buffer));
+        size_t n = entorno.planificador.escribirJSON(buffer, tam);
+        if (tam < 3) {
+            COMPROBAR_IGUAL(n, 0);
+            if (tam > 0) COMPROBAR_IGUAL(buffer[0], '\0');
+            continue;
+        }
+        COMPROBAR(n < tam);
+        COMPROBAR_IGUAL(buffer[n], '\0');
+        COMPROBAR_IGUAL(buffer[tam], 'x');  // Nada fuera del tamaño dado
+        std::string json = buffer;
+        COMPROBAR_IGUAL(json.size(), n);
+        COMPROBAR(json.back() == ']');
+        COMPROBAR_IGUAL(contar(json, "{"), contar(json, "}"));
+
+        // Es el principio de la lista completa, cortado tras un objeto
+        int tareas = contar(json, "{\"nombre\":");
+        COMPROBAR_IGUAL(referencia.compare(0, n - 1, json, 0, n - 1), 0);
+        COMPROBAR(json.size() == 2 || json[n - 2] == '}');
+        COMPROBAR(tareas >= tareasAntes);  // Más sitio nunca da menos tareas
+        tareasAntes = tareas;
+    }
+    COMPROBAR_IGUAL(tareasAntes, MAX_TAREAS);
+}
+
+int main() {
+    static const CasoPrueba casos[] = {
+        {"planificador/lista_completa", listaCompleta},
+        {"planificador/recorte_siempre_valido", recorteSiempreValido},
+    };
+    return ejecutarPruebas(casos);
+}
@@ -0,0 +1,161 @@
+// Protocolo binario de las tramas ESP-NOW: CRC-16/CCITT-FALSE, ida y vuelta
+// de cada tipo de trama (sellar → verTrama) y rechazo de las tramas dañadas.
+
+#include "Prueba.h"
+#include <Protocolo.h>
+
+// Valor de comprobación del catálogo de CRC para "123456789"
+static void crcValorComprobacion() {
+    COMPROBAR_IGUAL(calcularCRC16((const uint8_t*)"123456789", 9), 0x29B1);
+    COMPROBAR_IGUAL(calcularCRC16(nullptr, 0), 0xFFFF);
+}
+
+static void tamanosTramas() {
+    COMPROBAR_IGUAL(sizeof(CabeceraTrama), 8);
+    COMPROBAR_IGUAL(sizeof(TramaComando), 22);
+    COMPROBAR_IGUAL(sizeof(TramaControl), 12);
+    COMPROBAR_IGUAL(sizeof(TramaRespuesta), 22);
+    COMPROBAR_IGUAL(sizeof(TramaSincronia), 18);
+}
+
+// Cabecera común tras sellar y ver
+template <typename T>
+static const T* idaYVuelta(T& trama, uint16_t secuencia, uint32_t marca) {
+    sellarTrama(trama, secuencia, marca);
+    const uint8_t* datos = (const uint8_t*)&trama;
+    COMPROBAR_IGUAL(tipoTrama(datos, sizeof(T)), T::TIPO);
+    const T* vista = verTrama<T>(datos, sizeof(T));
+    COMPROBAR(vista == &trama);  // Sin copia: la vista apunta al buffer recibido
+    if (vista) {
+        COMPROBAR_IGUAL(vista->cabecera.version, PROTOCOLO_VERSION);
+        COMPROBAR_IGUAL(vista->cabecera.secuencia, secuencia);
+        COMPROBAR_IGUAL(vista->cabecera.marcaTiempo, marca);
+    }
+    return vista;
+}
+
+static void idaYVueltaComando() {
+    TramaComando trama;
+    memset(&trama, 0, sizeof(trama));
+    trama.velocidadIzq = -255;
+    trama.velocidadDer = 254;
+    trama.movimiento = MOV_RETROCEDIENDO;
+    trama.banderas = BANDERA_SENSORES | BANDERA_LUZ;
+    trama.temperatura = aCentesimas(-12.34f);
+    trama.aplicarEn = 0xFFFFFFF0UL;
+    const TramaComando* v = idaYVuelta(trama, 0xFFFF, 0xDEADBEEFUL);
+    if (!v) return;
+    COMPROBAR_IGUAL(v->velocidadIzq, -255);
+    COMPROBAR_IGUAL(v->velocidadDer, 254);
+    COMPROBAR_IGUAL(v->movimiento, MOV_RETROCEDIENDO);
+    COMPROBAR_IGUAL(v->banderas, BANDERA_SENSORES | BANDERA_LUZ);
+    COMPROBAR_CERCA(deCentesimas(v->temperatura), -12.34, 0.005);
+    COMPROBAR_IGUAL(v->aplicarEn, 0xFFFFFFF0UL);
+}
+
+static void idaYVueltaControl() {
+    TramaControl trama;
+    memset(&trama, 0, sizeof(trama));
+    trama.codigo = CTRL_CAMBIAR_MODO;
+    trama.argumento = ROL_ESCLAVO;
+    const TramaControl* v = idaYVuelta(trama, 7, 1000);
+    if (!v) return;
+    COMPROBAR_IGUAL(v->codigo, CTRL_CAMBIAR_MODO);
+    COMPROBAR_IGUAL(v->argumento, ROL_ESCLAVO);
+}
+
+static void idaYVueltaRespuesta() {
+    TramaRespuesta trama;
+    memset(&trama, 0, sizeof(trama));
+    trama.origen = ROL_ESCLAVO;
+    trama.banderas = BANDERA_SENSORES | BANDERA_SINCRONIA;
+    trama.temperatura = aCentesimas(24.5f);
+    trama.marcaEco = 123456789UL;
+    trama.retenidoUs = 250;
+    const TramaRespuesta* v = idaYVuelta(trama, 1, 2);
+    if (!v) return;
+    COMPROBAR_IGUAL(v->origen, ROL_ESCLAVO);
+    COMPROBAR_IGUAL(v->banderas, BANDERA_SENSORES | BANDERA_SINCRONIA);
+    COMPROBAR_IGUAL(v->temperatura, 2450);
+    COMPROBAR_IGUAL(v->marcaEco, 123456789UL);
+    COMPROBAR_IGUAL(v->retenidoUs, 250);
+}
+
+static void idaYVueltaSincronia() {
+    TramaSincronia trama;
+    memset(&trama, 0, sizeof(trama));
+    trama.marcaEco = 1000;
+    trama.recepcionEco = 4000000000UL;
+    const TramaSincronia* v = idaYVuelta(trama, 42, 3000);
+    if (!v) return;
+    COMPROBAR_IGUAL(v->marcaEco, 1000);
+    COMPROBAR_IGUAL(v->recepcionEco, 4000000000UL);
+}
+
+// Cualquier bit cambiado en cualquier byte invalida la trama
+static void rechazaBitCambiado() {
+    TramaComando trama;
+    memset(&trama, 0, sizeof(trama));
+    trama.velocidadIzq = 100;
+    sellarTrama(trama, 3, 4);
+    uint8_t* datos = (uint8_t*)&trama;
+    int aceptadas = 0;
+    for (size_t byte = 0; byte < sizeof(trama); byte++) {
+        for (int bit = 0; bit < 8; bit++) {
+            datos[byte] ^= 1 << bit;
+            if (verTrama<TramaComando>(datos, sizeof(trama))) aceptadas++;
+            datos[byte] ^= 1 << bit;
+        }
+    }
+    COMPROBAR_IGUAL(aceptadas, 0);
+    COMPROBAR(verTrama<TramaComando>(datos, sizeof(trama)) != nullptr);
+}
+
+// Tamaño, tipo o versión que no cuadran, aunque el CRC sea correcto
+static void rechazaCabeceraAjena() {
+    TramaControl control;
+    memset(&control, 0, sizeof(control));
+    sellarTrama(control, 1, 1);
+    const uint8_t* datos = (const uint8_t*)&control;
+    COMPROBAR(verTrama<TramaControl>(datos, sizeof(control) - 1) == nullptr);
+    COMPROBAR(verTrama<TramaComando>(datos, sizeof(control)) == nullptr);
+
+    // Misma longitud, otro tipo: respuesta y comando miden 22 bytes
+    TramaRespuesta respuesta;
+    memset(&respuesta, 0, sizeof(respuesta));
+    sellarTrama(respuesta, 1, 1);
+    COMPROBAR(verTrama<TramaComando>((const uint8_t*)&respuesta, sizeof(respuesta)) == nullptr);
+
+    // Otra versión con su CRC recalculado
+    respuesta.cabecera.version = PROTOCOLO_VERSION + 1;
+    respuesta.crc = calcularCRC16((const uint8_t*)&respuesta, sizeof(respuesta) - sizeof(respuesta.crc));
+    COMPROBAR(verTrama<TramaRespuesta>((const uint8_t*)&respuesta, sizeof(respuesta)) == nullptr);
+    COMPROBAR_IGUAL(tipoTrama((const uint8_t*)&respuesta, sizeof(respuesta)), TRAMA_INVALIDA);
+    COMPROBAR_IGUAL(tipoTrama((const uint8_t*)&respuesta, sizeof(CabeceraTrama) - 1), TRAMA_INVALIDA);
+}
+
+static void puntoFijoYCodigos() {
+    COMPROBAR_IGUAL(aCentesimas(0.005f), 1);
+    COMPROBAR_IGUAL(aCentesimas(-0.005f), -1);
+    COMPROBAR_IGUAL(aCentesimas(1000.0f), 32767);
+    COMPROBAR_IGUAL(aCentesimas(-1000.0f), -32768);
+    for (int c = MOV_PARADO; c <= MOV_RETROCEDIENDO; c++) {
+        COMPROBAR_IGUAL(codigoMovimiento(textoMovimiento(c)), c);
+    }
+    COMPROBAR_IGUAL(codigoMovimiento("DESCONOCIDO"), MOV_PARADO);
+}
+
+int main() {
+    static const CasoPrueba casos[] = {
+        {"protocolo/crc_valor_comprobacion", crcValorComprobacion},
+        {"protocolo/tamanos_tramas", tamanosTramas},
+        {"protocolo/ida_y_vuelta_comando", idaYVueltaComando},
+        {"protocolo/ida_y_vuelta_control", idaYVueltaControl},
+        {"protocolo/ida_y_vuelta_respuesta", idaYVueltaRespuesta},
+        {"protocolo/ida_y_vuelta_sincronia", idaYVueltaSincronia},
+        {"protocolo/rechaza_bit_cambiado", rechazaBitCambiado},
+        {"protocolo/rechaza_cabecera_ajena", rechazaCabeceraAjena},
+        {"protocolo/punto_fijo_y_codigos", puntoFijoYCodigos},
+    };
+    return ejecutarPruebas(casos);
+}
@@ -0,0 +1,168 @@
+// RampaMotor: la pendiente nunca cambia más que el tirón por paso, tampoco
+// al llegar al objetivo ni al pasar por cero, y un objetivo cero durante el
+// impulso baja por la rampa en vez de cortar. detener() sigue siendo
+// inmediato.
+
+#include "Prueba.h"
+#include <RampaMotor.h>
+#include <stdlib.h>
+
+static const unsigned long PASO_US = 2000;  // Como la tarea "motores"
+static const int32_t PENDIENTE = 2000;
+static const int32_t TIRON = 20000;
+static const int32_t CAMBIO_MAX = TIRON * (int32_t)PASO_US / 1000000 + 1;  // PWM/s por paso, con redondeo
+
+struct Recorrido {
+    int32_t cambioMaximo;  // PWM/s entre dos pasos
+    int32_t saltoMaximo;   // PWM entre dos pasos, fuera del impulso
+    int16_t salida;
+    unsigned long ahora;
+};
+
+// Avanzar hasta que la salida se quede quieta en el objetivo
+static void recorrer(RampaMotor& rampa, Recorrido& r, unsigned long maxUs = 2000000) {
+    int32_t pendienteAntes = rampa.obtenerPendiente();
+    for (unsigned long fin = r.ahora + maxUs; r.ahora < fin; r.ahora += PASO_US) {
+        bool impulsoAntes = rampa.enImpulso();
+        int16_t salida = rampa.avanzar(r.ahora);
+        int32_t pendiente = rampa.obtenerPendiente();
+        int32_t cambio = abs(pendiente - pendienteAntes);
+        if (cambio > r.cambioMaximo) r.cambioMaximo = cambio;
+        if (!impulsoAntes && !rampa.enImpulso() && abs(salida - r.salida) > r.saltoMaximo) {
+            r.saltoMaximo = abs(salida - r.salida);
+        }
+        pendienteAntes = pendiente;
+        r.salida = salida;
+        if (salida == rampa.obtenerObjetivo() && pendiente == 0 && !rampa.enImpulso()) return;
+    }
+}
+
+// Subir, bajar y cambiar de sentido entre valores arbitrarios
+static void tironAcotadoAlLlegar() {
+    RampaMotor rampa;
+    rampa.configurar(0, 0, PENDIENTE, TIRON);
+    Recorrido r = {0, 0, 0, 0};
+    static const int16_t OBJETIVOS[] = {180, 40, 255, 3, -120, 90, 91, 0, -255, 0};
+    for (int16_t objetivo : OBJETIVOS) {
+        rampa.setObjetivo(objetivo);
+        recorrer(rampa, r);
+        COMPROBAR_IGUAL(r.salida, objetivo);
+        COMPROBAR_IGUAL(rampa.obtenerPendiente(), 0);
+    }
+    printf("  cambio máx %d PWM/s por paso (límite %d)\n", r.cambioMaximo, CAMBIO_MAX);
+    COMPROBAR(r.cambioMaximo <= CAMBIO_MAX);
+    COMPROBAR(r.saltoMaximo <= PENDIENTE * (int32_t)PASO_US / 1000000 + 1);
+}
+
+// Objetivo cambiado a media rampa: la salida vuelve sin saltos de pendiente
+static void tironAcotadoAMediaRampa() {
+    RampaMotor rampa;
+    rampa.configurar(0, 0, PENDIENTE, TIRON);
+    Recorrido r = {0, 0, 0, 0};
+    rampa.setObjetivo(200);
+    recorrer(rampa, r, 60000);
+    COMPROBAR(r.salida > 0 && r.salida < 200);
+    rampa.setObjetivo(-200);
+    recorrer(rampa, r);
+    COMPROBAR_IGUAL(r.salida, -200);
+    COMPROBAR(r.cambioMaximo <= CAMBIO_MAX);
+}
+
+// Pasos irregulares (la tarea se retrasa): el perfil se planifica con el
+// paso que acaba de dar, así que el cambio puede ser el de un paso largo
+// aunque el siguiente sea corto, pero nunca más de dos
+static void tironAcotadoConPasosIrregulares() {
+    RampaMotor rampa;
+    rampa.configurar(0, 0, PENDIENTE, TIRON);
+    uint32_t azar = 7;
+    unsigned long ahora = 0;
+    int32_t pendienteAntes = 0, cambioMaximo = 0;
+    int llegadas = 0, esperadas = 0;
+    for (int i = 0; i < 200; i++) {
+        azar = azar * 1103515245u + 12345u;
+        int16_t objetivo = (int16_t)((azar >> 16) % 511) - 255;
+        rampa.setObjetivo(objetivo);
+        bool aMedias = (i % 3 == 0);  // Uno de cada tres se cambia antes de llegar
+        if (!aMedias) esperadas++;
+        for (int paso = 0; paso < 2000; paso++) {
+            azar = azar * 1103515245u + 12345u;
+            ahora += 1000 + (azar >> 16) % 4000;
+            int16_t salida = rampa.avanzar(ahora);
+            int32_t pendiente = rampa.obtenerPendiente();
+            if (abs(pendiente - pendienteAntes) > cambioMaximo) cambioMaximo = abs(pendiente - pendienteAntes);
+            pendienteAntes = pendiente;
+            if (aMedias && paso == 20) break;
+            if (salida == objetivo && pendiente == 0) {
+                llegadas++;
+                break;
+            }
+        }
+    }
+    printf("  cambio máx %d PWM/s por paso, %d llegadas\n", cambioMaximo, llegadas);
+    COMPROBAR(cambioMaximo <= 2 * TIRON * 5000 / 1000000);
+    COMPROBAR_IGUAL(llegadas, esperadas);
+}
+
+// Cero durante el impulso: termina el impulso y la salida baja por la rampa
+static void ceroDuranteImpulsoBajaConRampa() {
+    RampaMotor rampa;
+    rampa.configurar(210, 100000, PENDIENTE, TIRON);
+    Recorrido r = {0, 0, 0, 0};
+    rampa.setObjetivo(180);
+    r.salida = rampa.avanzar(r.ahora);
+    COMPROBAR(rampa.enImpulso());
+    COMPROBAR_IGUAL(r.salida, 210);
+
+    r.ahora += 20000;
+    rampa.setObjetivo(0);
+    int16_t salida = rampa.avanzar(r.ahora);
+    COMPROBAR(!rampa.enImpulso());
+    COMPROBAR(salida > 200);  // Sin corte a cero
+    r.salida = salida;
+    recorrer(rampa, r);
+    COMPROBAR_IGUAL(r.salida, 0);
+    COMPROBAR(r.saltoMaximo <= PENDIENTE * (int32_t)PASO_US / 1000000 + 1);
+    COMPROBAR(r.cambioMaximo <= CAMBIO_MAX);
+    COMPROBAR_IGUAL(rampa.obtenerImpulsos(), 1);
+}
+
+// Sentido contrario durante el impulso: baja por la rampa, se para en cero
+// y arranca con impulso hacia el otro lado
+static void sentidoContrarioDuranteImpulso() {
+    RampaMotor rampa;
+    rampa.configurar(210, 100000, PENDIENTE, TIRON);
+    Recorrido r = {0, 0, 0, 0};
+    rampa.setObjetivo(180);
+    rampa.avanzar(r.ahora);
+    r.ahora += 20000;
+    rampa.setObjetivo(-150);
+    r.salida = rampa.avanzar(r.ahora);
+    COMPROBAR(r.salida > 200);
+    recorrer(rampa, r);
+    COMPROBAR_IGUAL(r.salida, -150);
+    COMPROBAR_IGUAL(rampa.obtenerImpulsos(), 2);
+}
+
+static void detenerEsInmediato() {
+    RampaMotor rampa;
+    Recorrido r = {0, 0, 0, 0};
+    rampa.setObjetivo(200);
+    recorrer(rampa, r);
+    COMPROBAR_IGUAL(r.salida, 200);
+    rampa.detener();
+    COMPROBAR_IGUAL(rampa.obtenerSalida(), 0);
+    COMPROBAR_IGUAL(rampa.obtenerPendiente(), 0);
+    COMPROBAR_IGUAL(rampa.avanzar(r.ahora + PASO_US), 0);
+}
+
+int main() {
+    static const CasoPrueba casos[] = {
+        {"rampa_motor/tiron_acotado_al_llegar", tironAcotadoAlLlegar},
+        {"rampa_motor/tiron_acotado_a_media_rampa", tironAcotadoAMediaRampa},
+        {"rampa_motor/tiron_acotado_con_pasos_irregulares", tironAcotadoConPasosIrregulares},
+        {"rampa_motor/cero_durante_impulso_baja_con_rampa", ceroDuranteImpulsoBajaConRampa},
+        {"rampa_motor/sentido_contrario_durante_impulso", sentidoContrarioDuranteImpulso},
+        {"rampa_motor/detener_es_inmediato", detenerEsInmediato},
+    };
+    return ejecutarPruebas(casos);
+}
@@ -0,0 +1,161 @@
+// Sincronía de relojes: SincroniaReloj sola, con deriva y RTT con jitter
+// asimétrico, y una flota en el simulador con sincronía cada 500 ms, donde
+// el desfase estimado por cada esclavo tiene que quedar a menos de 1 ms del
+// real sin que las respuestas de sincronía retrasen los comandos.
+
+#include "Prueba.h"
+#include "Simulador.h"
+#include <Coche.h>
+#include <SincroniaReloj.h>
+#include <random>
+
+// Reloj del maestro para un instante propio: deriva en ppm y desfase en us
+struct RelojMaestro {
+    double deriva;
+    double desfase;
+    uint32_t en(double propioUs) const {
+        return (uint32_t)(uint64_t)(propioUs * (1.0 + deriva * 1e-6) + desfase);
+    }
+    long desfaseEn(double propioUs) const {
+        return (long)((int64_t)en(propioUs) - (int64_t)(uint32_t)(uint64_t)propioUs);
+    }
+};
+
+// Intercambio con latencia de ida y vuelta distintas y el maestro tardando
+// en contestar
+static bool intercambio(SincroniaReloj& reloj, const RelojMaestro& maestro, double t1,
+                        std::mt19937& azar, unsigned long jitterUs) {
+    std::uniform_real_distribution<double> jitter(0, jitterUs);
+    double ida = 1500 + jitter(azar);
+    double retenido = 200 + jitter(azar);
+    double vuelta = 1500 + jitter(azar);
+    uint32_t t2 = maestro.en(t1 + ida);
+    uint32_t t3 = maestro.en(t1 + ida + retenido);
+    double t4 = t1 + ida + retenido + vuelta;
+    return reloj.agregarIntercambio((uint32_t)(uint64_t)t1, t2, t3, (uint32_t)(uint64_t)t4);
+}
+
+// Converge con deriva y jitter, y entre intercambios sigue la deriva. Con el
+// jitter de la radio (unos cientos de us) ningún intercambio se rechaza; con
+// uno de 1 ms algunos sí, pero el error sigue muy por debajo
+static void convergeConDerivaYJitter() {
+    const double derivas[3] = {-80.0, 25.0, 95.0};
+    const unsigned long jitters[2] = {300, 1000};
+    for (unsigned long jitter : jitters) {
+        for (double deriva : derivas) {
+            std::mt19937 azar(7);
+            RelojMaestro maestro = {deriva, 123456789.0};
+            SincroniaReloj reloj;
+            double ahora = 1000000;
+            COMPROBAR(!reloj.sincronizado((unsigned long)ahora));
+
+            double errorMax = 0;
+            for (int i = 0; i < 120; i++) {
+                intercambio(reloj, maestro, ahora, azar, jitter);
+                ahora += 500000;
+                if (i < 20) continue;  // Convergencia de la deriva
+                unsigned long propio = (uint32_t)(uint64_t)ahora;
+                double error = fabs((double)(reloj.obtenerDesfase(propio) - maestro.desfaseEn(ahora)));
+                if (error > errorMax) errorMax = error;
+            }
+            unsigned long propio = (uint32_t)(uint64_t)ahora;
+            COMPROBAR(reloj.sincronizado(propio));
+            if (jitter <= 300) {
+                COMPROBAR(errorMax < 100);
+                COMPROBAR_CERCA(reloj.obtenerDeriva(), deriva, 2.0);
+                COMPROBAR_IGUAL(reloj.obtenerRechazos(), 0);
+            } else {
+                COMPROBAR(errorMax < 500);
+                COMPROBAR_CERCA(reloj.obtenerDeriva(), deriva, 10.0);
+            }
+
+            // Sin intercambios durante 5 s: la deriva estimada mantiene el desfase
+            ahora += 5000000;
+            propio = (uint32_t)(uint64_t)ahora;
+            COMPROBAR(reloj.sincronizado(propio));
+            COMPROBAR(fabs((double)(reloj.obtenerDesfase(propio) - maestro.desfaseEn(ahora))) < 600);
+        }
+    }
+}
+
+// Un intercambio con RTT disparado (colas, reintentos) no mueve la estimación
+static void rttAltoNoDesplaza() {
+    std::mt19937 azar(3);
+    RelojMaestro maestro = {40.0, 5000000.0};
+    SincroniaReloj reloj;
+    double ahora = 0;
+    for (int i = 0; i < 40; i++) {
+        intercambio(reloj, maestro, ahora, azar, 500);
+        ahora += 500000;
+    }
+    unsigned long propio = (uint32_t)(uint64_t)ahora;
+    long antes = reloj.obtenerDesfase(propio);
+
+    // Respuesta que esperó 20 ms en la cola del maestro con la marca de
+    // cuando se encoló: su desfase está 10 ms corrido
+    uint32_t t1 = propio;
+    uint32_t t2 = maestro.en(ahora + 1500);
+    uint32_t t3 = t2 + 200;
+    uint32_t t4 = t1 + 1500 + 200 + 20000 + 1500;
+    reloj.agregarIntercambio(t1, t2, t3, t4);
+    COMPROBAR(fabs((double)(reloj.obtenerDesfase(propio) - antes)) < 1000);
+    COMPROBAR(fabs((double)(reloj.obtenerDesfase(propio) - maestro.desfaseEn(ahora))) < 300);
+}
+
+static float obstaculoFijo(float t) {
+    return 70.0f;
+}
+
+// Flota de cuatro coches con relojes que derivan y arrancan desfasados: cada
+// esclavo se sincroniza y, pasado el arranque, su desfase estimado no se
+// aparta más de 1 ms del real. Las respuestas de sincronía no retrasan los
+// comandos de difusión: ningún silencio del mando y una respuesta por comando.
+static void flotaSincronizada() {
+    const int coches = 4;
+    for (uint32_t semilla = 1; semilla <= 3; semilla++) {
+        Simulador sim(semilla);
+        sim.relojes.derivaMax = 40.0f;
+        sim.relojes.desfaseMax = 5000000;
+        sim.setZonaObjetivo(7.0f, 13.0f);
+        for (int i = 0; i < coches; i++) sim.agregarCoche(30.0f - i * 25.0f, i == 0);
+        sim.iniciar();
+        for (int i = 0; i < coches; i++) sim.coche(i).configurarSincronia(500, 30);
+
+        std::vector<double> errorMax(coches, 0);
+        std::vector<int> muestras(coches, 0);
+        for (int paso = 0; paso < 3000; paso++) {
+            sim.avanzar(10000, obstaculoFijo);
+            if (paso < 500) continue;  // 5 s de arranque
+            for (int i = 1; i < coches; i++) {
+                unsigned long propio = sim.relojCoche(i);
+                SincroniaReloj& reloj = sim.coche(i).obtenerReloj();
+                if (!reloj.sincronizado(propio)) continue;
+                long real = (long)(sim.relojCoche(0) - propio);
+                double error = fabs((double)(reloj.obtenerDesfase(propio) - real));
+                if (error > errorMax[i]) errorMax[i] = error;
+                muestras[i]++;
+            }
+        }
+
+        static InstantaneaTelemetria t;
+        for (int i = 1; i < coches; i++) {
+            COMPROBAR(muestras[i] > 2400);  // Sincronizado casi todo el tiempo
+            COMPROBAR(errorMax[i] < 1000);
+            COMPROBAR(sim.coche(i).obtenerReloj().obtenerIntercambios() > 50);
+            sim.seleccionar(i);
+            sim.coche(i).tomarInstantanea(t);
+            COMPROBAR_IGUAL(t.silenciosMando, 0);
+            COMPROBAR_IGUAL(t.comandosTarde, 0);
+            COMPROBAR(sim.resumen(i).tramasEnviadas >= 1499);  // 30 s a 50 Hz
+        }
+    }
+}
+
+int main() {
+    static const CasoPrueba casos[] = {
+        {"sincronia/converge_con_deriva_y_jitter", convergeConDerivaYJitter},
+        {"sincronia/rtt_alto_no_desplaza", rttAltoNoDesplaza},
+        {"sincronia/flota_sincronizada", flotaSincronizada},
+    };
+    return ejecutarPruebas(casos);
+}
@@ -0,0 +1,182 @@
+// TablaPares: contabilidad por número de secuencia (perdidas, duplicadas,
+// desordenadas, vuelta del contador y reinicio del emisor), flujos de
+// difusión y unicast por separado, límite de pares y datos de sensores más
+// recientes.
+
+#include "Prueba.h"
+#include "Simulador.h"
+#include <Protocolo.h>
+#include <TablaPares.h>
+
+static const uint8_t MAC_A[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x01};
+
+// agregar() registra el par en ESP-NOW: hace falta un coche simulado en curso
+struct Entorno {
+    Simulador sim;
+    Entorno() {
+        sim.agregarCoche(0.0f, true);
+        sim.seleccionar(0);
+    }
+};
+
+static void secuenciaEnOrdenYHuecos() {
+    Entorno entorno;
+    TablaPares tabla;
+    COMPROBAR(tabla.registrarRecepcion(MAC_A, 10, 0) != nullptr);
+    COMPROBAR(tabla.registrarRecepcion(MAC_A, 11, 0) != nullptr);
+    COMPROBAR(tabla.registrarRecepcion(MAC_A, 15, 0) != nullptr);  // Faltan 12, 13 y 14
+    InfoPar* par = tabla.obtener(0);
+    COMPROBAR_IGUAL(par->recibidos, 3);
+    COMPROBAR_IGUAL(par->perdidos, 3);
+    COMPROBAR_IGUAL(par->duplicados, 0);
+    COMPROBAR_IGUAL(par->reordenados, 0);
+}
+
+static void duplicadoNoSeReprocesa() {
+    Entorno entorno;
+    TablaPares tabla;
+    tabla.registrarRecepcion(MAC_A, 7, 0);
+    COMPROBAR(tabla.registrarRecepcion(MAC_A, 7, 0) == nullptr);
+    InfoPar* par = tabla.obtener(0);
+    COMPROBAR_IGUAL(par->duplicados, 1);
+    COMPROBAR_IGUAL(par->recibidos, 1);
+}
+
+// Una trama antigua no hace retroceder la secuencia: la siguiente en orden
+// no suma pérdidas falsas
+static void desordenadaNoRetrocede() {
+    Entorno entorno;
+    TablaPares tabla;
+    tabla.registrarRecepcion(MAC_A, 100, 0);
+    tabla.registrarRecepcion(MAC_A, 102, 0);          // 101 cuenta como perdida...
+    COMPROBAR(tabla.registrarRecepcion(MAC_A, 101, 5) == nullptr);  // ...y llega tarde
+    COMPROBAR(tabla.registrarRecepcion(MAC_A, 103, 0) != nullptr);
+    InfoPar* par = tabla.obtener(0);
+    COMPROBAR_IGUAL(par->reordenados, 1);
+    COMPROBAR_IGUAL(par->perdidos, 1);
+    COMPROBAR_IGUAL(par->directo.ultima, 103);
+    COMPROBAR_IGUAL(par->recibidos, 4);
+    COMPROBAR_IGUAL(par->ultimoVisto, 0);  // La 103 llegó después
+
+    // Varias antiguas seguidas dentro de la ventana de reorden
+    for (uint16_t s = 103 - VENTANA_REORDEN; s < 103; s++) {
+        COMPROBAR(tabla.registrarRecepcion(MAC_A, s, 0) == nullptr);
+    }
+    COMPROBAR_IGUAL(par->reordenados, 1 + VENTANA_REORDEN);
+    COMPROBAR(tabla.registrarRecepcion(MAC_A, 104, 0) != nullptr);
+    COMPROBAR_IGUAL(par->perdidos, 1);
+}
+
+static void vueltaDelContador() {
+    Entorno entorno;
+    TablaPares tabla;
+    tabla.registrarRecepcion(MAC_A, 0x7FFE, 0);
+    COMPROBAR(tabla.registrarRecepcion(MAC_A, 0x7FFF, 0) != nullptr);
+    COMPROBAR(tabla.registrarRecepcion(MAC_A, 1, 0) != nullptr);  // Falta el 0
+    COMPROBAR(tabla.registrarRecepcion(MAC_A, 0, 0) == nullptr);  // Desordenada
+    InfoPar* par = tabla.obtener(0);
+    COMPROBAR_IGUAL(par->perdidos, 1);
+    COMPROBAR_IGUAL(par->reordenados, 1);
+    COMPROBAR_IGUAL(par->directo.ultima, 1);
+}
+
+// Muy por detrás de la ventana: el emisor se reinició y se sigue desde ahí
+static void reinicioDelEmisor() {
+    Entorno entorno;
+    TablaPares tabla;
+    tabla.registrarRecepcion(MAC_A, 5000, 0);
+    COMPROBAR(tabla.registrarRecepcion(MAC_A, 0, 0) != nullptr);
+    COMPROBAR(tabla.registrarRecepcion(MAC_A, 1, 0) != nullptr);
+    InfoPar* par = tabla.obtener(0);
+    COMPROBAR_IGUAL(par->directo.ultima, 1);
+    COMPROBAR_IGUAL(par->reordenados, 0);
+    COMPROBAR_IGUAL(par->perdidos, 0);
+}
+
+// El emisor intercala difusión con unicast a otros coches: lo que no va
+// dirigido a nosotros no deja huecos en su flujo directo
+static void flujosSeparados() {
+    Entorno entorno;
+    TablaPares tabla;
+    for (uint16_t i = 0; i < 50; i++) {
+        COMPROBAR(tabla.registrarRecepcion(MAC_A, SECUENCIA_DIFUSION | (2 * i), 0) != nullptr);
+        COMPROBAR(tabla.registrarRecepcion(MAC_A, i, 0) != nullptr);  // Sus otros unicast no llegan aquí
+        COMPROBAR(tabla.registrarRecepcion(MAC_A, SECUENCIA_DIFUSION | (2 * i + 1), 0) != nullptr);
+    }
+    InfoPar* par = tabla.obtener(0);
+    COMPROBAR_IGUAL(par->recibidos, 150);
+    COMPROBAR_IGUAL(par->perdidos, 0);
+    COMPROBAR_IGUAL(par->reordenados, 0);
+    COMPROBAR_IGUAL(par->difusion.ultima, 99);
+    COMPROBAR_IGUAL(par->directo.ultima, 49);
+
+    // Un hueco en la difusión solo cuenta ahí
+    tabla.registrarRecepcion(MAC_A, SECUENCIA_DIFUSION | 102, 0);
+    tabla.registrarRecepcion(MAC_A, 50, 0);
+    COMPROBAR_IGUAL(par->perdidos, 2);
+}
+
+// Al enviar: un contador para la difusión (con el bit) y otro por destino
+static void numeracionPorDestino() {
+    Entorno entorno;
+    TablaPares tabla;
+    uint8_t macB[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x02};
+    COMPROBAR_IGUAL(tabla.siguienteSecuencia(MAC_DIFUSION), SECUENCIA_DIFUSION | 0);
+    COMPROBAR_IGUAL(tabla.siguienteSecuencia(MAC_A), 0);
+    COMPROBAR_IGUAL(tabla.siguienteSecuencia(MAC_DIFUSION), SECUENCIA_DIFUSION | 1);
+    COMPROBAR_IGUAL(tabla.siguienteSecuencia(macB), 0);
+    COMPROBAR_IGUAL(tabla.siguienteSecuencia(MAC_A), 1);
+    COMPROBAR_IGUAL(tabla.cantidad(), 2);  // Los destinos quedan registrados
+
+    // El contador de 15 bits vuelve sin tocar el bit de difusión
+    tabla.obtener(0)->secuenciaTx = SECUENCIA_NUMERO;
+    COMPROBAR_IGUAL(tabla.siguienteSecuencia(MAC_A), SECUENCIA_NUMERO);
+    COMPROBAR_IGUAL(tabla.siguienteSecuencia(MAC_A), 0);
+}
+
+static void limiteDePares() {
+    Entorno entorno;
+    TablaPares tabla;
+    uint8_t mac[6] = {0x24, 0x6F, 0x28, 0x00, 0x01, 0x00};
+    for (int i = 0; i < MAX_PARES; i++) {
+        mac[5] = i;
+        COMPROBAR_IGUAL(tabla.agregar(mac), i);
+    }
+    mac[5] = MAX_PARES;
+    COMPROBAR_IGUAL(tabla.agregar(mac), -1);
+    COMPROBAR(tabla.registrarRecepcion(mac, 1, 0) == nullptr);
+    mac[5] = 3;
+    COMPROBAR_IGUAL(tabla.agregar(mac), 3);  // Ya conocido
+    COMPROBAR_IGUAL(tabla.cantidad(), MAX_PARES);
+
+    TablaPares otra;
+    COMPROBAR_IGUAL(otra.agregar(MAC_DIFUSION), -1);
+}
+
+static void sensoresMasRecientes() {
+    Entorno entorno;
+    TablaPares tabla;
+    uint8_t macB[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x02};
+    InfoPar* a = tabla.registrarRecepcion(MAC_A, 1, 0);
+    InfoPar* b = tabla.registrarRecepcion(macB, 1, 0);
+    COMPROBAR(tabla.masRecienteConSensores(1000, 5000) == nullptr);
+    tabla.actualizarSensores(a, 21.5f, 1, 1000);
+    tabla.actualizarSensores(b, 23.0f, 0, 2000);
+    COMPROBAR(tabla.masRecienteConSensores(3000, 5000) == b);
+    COMPROBAR(tabla.masRecienteConSensores(7500, 5000) == nullptr);  // Caducados
+}
+
+int main() {
+    static const CasoPrueba casos[] = {
+        {"tabla_pares/secuencia_en_orden_y_huecos", secuenciaEnOrdenYHuecos},
+        {"tabla_pares/duplicado_no_se_reprocesa", duplicadoNoSeReprocesa},
+        {"tabla_pares/desordenada_no_retrocede", desordenadaNoRetrocede},
+        {"tabla_pares/vuelta_del_contador", vueltaDelContador},
+        {"tabla_pares/reinicio_del_emisor", reinicioDelEmisor},
+        {"tabla_pares/flujos_separados", flujosSeparados},
+        {"tabla_pares/numeracion_por_destino", numeracionPorDestino},
+        {"tabla_pares/limite_de_pares", limiteDePares},
+        {"tabla_pares/sensores_mas_recientes", sensoresMasRecientes},
+    };
+    return ejecutarPruebas(casos);
+}
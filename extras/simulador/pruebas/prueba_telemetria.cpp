@@ -0,0 +1,119 @@
+// Telemetría JSON: el peor caso ocupa exactamente TELEMETRIA_TAM_MAX, un
+// buffer más corto no se desborda y los números extremos se escriben
+// enteros.
+
+#include "Prueba.h"
+#include <Telemetria.h>
+#include <Protocolo.h>
+#include <string>
+
+// Todos los números al máximo ancho y los textos más largos
+static void llenarPeorCaso(InstantaneaTelemetria& t, uint8_t numPares) {
+    memset(&t, 0, sizeof(t));
+    t.distancia = t.varianzaDistancia = t.velocidadDistancia = t.temperatura = -1e9f;
+    t.luz = -128;
+    t.origenDatos = ORIGEN_SIN_DATOS;
+    t.movimiento = MOV_RETROCEDIENDO;
+    t.esMaestro = false;
+    t.mensajesEnviados = t.mensajesRecibidos = t.mensajesFallidos = t.reintentos = 0xFFFFFFFFUL;
+    t.timeoutsACK = t.comandosSobrescritos = t.desbordesBuzon = 0xFFFFFFFFUL;
+    t.tasaExito = t.errorExtrapolacion = t.huecoFusion = -1e9f;
+    t.silenciosMando = t.paradasPorSilencio = t.comandosTarde = 0xFFFFFFFFUL;
+    t.controlPropio = false;
+    t.relojSincronizado = false;
+    t.desfaseReloj = INT32_MIN;
+    t.derivaReloj = t.errorReloj = -1e9f;
+    t.numPares = numPares;
+    for (int i = 0; i < numPares; i++) {
+        InstantaneaPar& p = t.pares[i];
+        p.rol = ROL_ESCLAVO;
+        p.datosValidos = true;
+        p.luz = -128;
+        p.temperatura = -1e9f;
+        p.vistoHace = p.recibidos = p.perdidos = p.duplicados = p.reordenados = 0xFFFFFFFFUL;
+    }
+}
+
+static char buffer[2 * TELEMETRIA_TAM_MAX];
+
+static size_t escribir(const InstantaneaTelemetria& t) {
+    return escribirTelemetriaJSON(t, buffer, sizeof(buffer));
+}
+
+// Las constantes cuadran con lo que de verdad se escribe: ni sobra ni falta
+static void peorCasoCabeJusto() {
+    static InstantaneaTelemetria t;
+    llenarPeorCaso(t, MAX_PARES);
+    size_t n = escribir(t);
+    COMPROBAR_IGUAL(n + 1, TELEMETRIA_TAM_MAX);
+
+    // Cada par añade TELEMETRIA_TAM_POR_PAR (el primero, sin su coma: ese
+    // byte es el del terminador)
+    llenarPeorCaso(t, 0);
+    size_t sinPares = escribir(t);
+    COMPROBAR_IGUAL(sinPares, TELEMETRIA_TAM_FIJO);
+    llenarPeorCaso(t, 1);
+    COMPROBAR_IGUAL(escribir(t) - sinPares, TELEMETRIA_TAM_POR_PAR - 1);
+    llenarPeorCaso(t, 2);
+    COMPROBAR_IGUAL(escribir(t) - sinPares, 2 * TELEMETRIA_TAM_POR_PAR - 1);
+}
+
+// Ninguna combinación de textos pasa del peor caso
+static void textosNoPasanDelPeorCaso() {
+    static InstantaneaTelemetria t;
+    llenarPeorCaso(t, MAX_PARES);
+    for (int mov = MOV_PARADO; mov <= MOV_RETROCEDIENDO; mov++) {
+        for (int origen = ORIGEN_LOCAL; origen <= ORIGEN_SIN_DATOS; origen++) {
+            for (int maestro = 0; maestro <= 1; maestro++) {
+                t.movimiento = mov;
+                t.origenDatos = origen;
+                t.esMaestro = maestro;
+                size_t n = escribir(t);
+                COMPROBAR(n > 0);
+                COMPROBAR(n + 1 <= TELEMETRIA_TAM_MAX);
+            }
+        }
+    }
+}
+
+// Sin hueco para el terminador no se escribe nada y el buffer queda vacío
+static void bufferCortoNoSeDesborda() {
+    static InstantaneaTelemetria t;
+    llenarPeorCaso(t, MAX_PARES);
+    size_t n = escribirTelemetriaJSON(t, buffer, TELEMETRIA_TAM_MAX);
+    COMPROBAR_IGUAL(n + 1, TELEMETRIA_TAM_MAX);
+
+    memset(buffer, 'x', sizeof(buffer));
+    COMPROBAR_IGUAL(escribirTelemetriaJSON(t, buffer, TELEMETRIA_TAM_MAX - 1), 0);
+    COMPROBAR_IGUAL(buffer[0], '\0');
+    COMPROBAR_IGUAL(buffer[TELEMETRIA_TAM_MAX - 1], 'x');  // Nada más allá del tamaño dado
+    COMPROBAR_IGUAL(escribirTelemetriaJSON(t, buffer, 0), 0);
+}
+
+static void numerosExtremos() {
+    static InstantaneaTelemetria t;
+    llenarPeorCaso(t, 1);
+    COMPROBAR(escribir(t) > 0);
+    std::string json = buffer;
+    COMPROBAR(json.find("\"desfaseReloj\":-2147483648,") != std::string::npos);
+    COMPROBAR(json.find("\"mensajesEnviados\":4294967295,") != std::string::npos);
+    COMPROBAR(json.find("\"luz\":-128,") != std::string::npos);
+    COMPROBAR(json.find("\"distancia\":-9999999.00,") != std::string::npos);
+
+    t.desfaseReloj = INT32_MAX;
+    t.distancia = 1.125f;
+    escribir(t);
+    json = buffer;
+    COMPROBAR(json.find("\"desfaseReloj\":2147483647,") != std::string::npos);
+    COMPROBAR(json.find("\"distancia\":1.13,") != std::string::npos);
+}
+
+int main() {
+    static const CasoPrueba casos[] = {
+        {"telemetria/peor_caso_cabe_justo", peorCasoCabeJusto},
+        {"telemetria/textos_no_pasan_del_peor_caso", textosNoPasanDelPeorCaso},
+        {"telemetria/buffer_corto_no_se_desborda", bufferCortoNoSeDesborda},
+        {"telemetria/numeros_extremos", numerosExtremos},
+    };
+    return ejecutarPruebas(casos);
+}
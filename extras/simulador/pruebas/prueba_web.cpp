@@ -0,0 +1,93 @@
+// Carga de 1, 4 y 8 navegadores sondeando /datos contra el servidor web
+// síncrono: handleClient() atiende una petición por pasada de loop(), así
+// que lo que bloquea una pasada (el jitter que ven las tareas de control) no
+// crece con el número de clientes; los que llegan a la vez solo esperan en
+// la cola, y todos se atienden antes del siguiente sondeo.
+
+#include "Prueba.h"
+#include "Simulador.h"
+#include <Coche.h>
+
+static const unsigned long SONDEO_US = 500000;  // Lo que pide el panel
+static const unsigned long DURACION_US = 10000000;
+
+// Orden de magnitud en un ESP8266 a 80 MHz: aceptar y leer la petición, y
+// escribir la respuesta en el socket
+static const unsigned long US_POR_PETICION = 2000;
+static const unsigned long US_POR_BYTE = 1;
+
+static float obstaculoFijo(float t) {
+    return 70.0f;
+}
+
+struct Carga {
+    unsigned long enviadas;
+    unsigned long atendidas;
+    size_t colaMaxima;
+    unsigned long esperaMaxima;   // us en la cola
+    unsigned long bloqueoMaximo;  // us de una sola pasada de loop()
+    unsigned long choques;
+};
+
+// Todos los clientes piden a la vez (el peor caso para la cola)
+static Carga cargar(int clientes) {
+    Simulador sim(1);
+    sim.agregarCoche(30.0f, true);
+    sim.agregarCoche(5.0f, false);
+    sim.iniciar();
+    sim.seleccionar(0);
+    sim.coche(0).inicializarServidorWeb();
+    ESP8266WebServer& servidor = *ESP8266WebServer::ultimo();
+    servidor.usPorPeticion = US_POR_PETICION;
+    servidor.usPorByte = US_POR_BYTE;
+
+    Carga carga = {0, 0, 0, 0, 0, 0};
+    for (unsigned long t = 0; t < DURACION_US; t += 1000) {
+        if (t % SONDEO_US == 0) {
+            sim.seleccionar(0);
+            for (int c = 0; c < clientes; c++) servidor.encolar("/datos");
+            carga.enviadas += clientes;
+        }
+        if (servidor.pendientes() > carga.colaMaxima) carga.colaMaxima = servidor.pendientes();
+        sim.avanzar(1000, obstaculoFijo);
+    }
+    sim.avanzar(SONDEO_US, obstaculoFijo);  // Vaciar lo último
+
+    carga.atendidas = servidor.obtenerAtendidas();
+    carga.esperaMaxima = servidor.obtenerEsperaMaxima();
+    carga.bloqueoMaximo = sim.resumen(0).esperaMaxima;
+    carga.choques = sim.resumen(0).choques + sim.resumen(1).choques;
+    printf("  %d clientes: %lu/%lu atendidas, cola máx %zu, espera máx %.1f ms, "
+           "bloqueo máx de loop() %lu us\n",
+           clientes, carga.atendidas, carga.enviadas, carga.colaMaxima,
+           carga.esperaMaxima / 1000.0, carga.bloqueoMaximo);
+    return carga;
+}
+
+// Lo más que puede costar una petición a /datos (peor caso del JSON)
+static unsigned long costeMaximo() {
+    return US_POR_PETICION + TELEMETRIA_TAM_MAX * US_POR_BYTE;
+}
+
+static void jitterNoCreceConClientes() {
+    Carga uno = cargar(1);
+    Carga cuatro = cargar(4);
+    Carga ocho = cargar(8);
+    for (const Carga* c : {&uno, &cuatro, &ocho}) {
+        COMPROBAR_IGUAL(c->atendidas, c->enviadas);
+        COMPROBAR(c->bloqueoMaximo <= costeMaximo() + 100);  // Una petición y el disparo del HC-SR04
+        COMPROBAR(c->esperaMaxima < SONDEO_US);
+        COMPROBAR_IGUAL(c->choques, 0);
+    }
+    // Una petición por pasada: más clientes no alargan ninguna pasada
+    COMPROBAR(cuatro.bloqueoMaximo <= uno.bloqueoMaximo + 100);
+    COMPROBAR(ocho.bloqueoMaximo <= uno.bloqueoMaximo + 100);
+    COMPROBAR(ocho.esperaMaxima > cuatro.esperaMaxima);
+}
+
+int main() {
+    static const CasoPrueba casos[] = {
+        {"web/jitter_no_crece_con_clientes", jitterNoCreceConClientes},
+    };
+    return ejecutarPruebas(casos);
+}
@@ -0,0 +1,459 @@
+// Reproducción en Linux de una traza grabada en el coche (Coche::iniciarTraza).
+// Cada evento de entrada se vuelve a meter en la librería por el mismo punto
+// por el que entró (muestra del HC-SR04, paso del PID, trama procesada, ACK,
+// cambio de modo, orden del esclavo sin comandos, paso del control propio del
+// esclavo, órdenes programadas que llegan a su instante) con el reloj puesto
+// en su marca, y las lecturas de luz y
+// temperatura devuelven lo grabado. Las órdenes a los motores que salen se
+// comparan una a una con las de la traza.
+//
+//   ./reproductor traza.bin [--csv fichero] [--verbose]
+//
+// Devuelve 0 si todas las órdenes coinciden bit a bit, 2 si alguna difiere.
+//
+// No se reproducen las llamadas directas del sketch a los motores (modo
+// manual) ni los cambios de configuración posteriores a iniciarTraza().
+
+#include <Coche.h>
+#include <vector>
+
+// Salida en memoria para los volcados de la traza de la reproducción
+class SalidaMemoria : public Print {
+public:
+    std::vector<uint8_t> datos;
+    size_t write(const uint8_t* bytes, size_t n) override {
+        datos.insert(datos.end(), bytes, bytes + n);
+        return n;
+    }
+    using Print::write;
+};
+
+// Orden a los motores con la marca en que se dio
+struct OrdenMotor {
+    uint32_t marca;
+    EventoTrazaMotor motor;
+};
+
+class ReproductorTraza {
+public:
+    static const int PIN_TEMP = 17, PIN_LUZ = 13;
+
+    unsigned long ahora;
+    unsigned long tramasEnviadas;
+
+    ReproductorTraza();
+    ~ReproductorTraza();
+
+    bool cargar(const char* ruta);
+    void ejecutar();
+    int informar(FILE* csv);  // Devuelve el número de órdenes distintas
+
+    // Lecturas de sensores que hace la librería durante la reproducción
+    int leerLuz();
+    int leerTemperatura();
+
+private:
+    std::vector<uint8_t> fichero;
+    std::vector<EventoTraza> eventos;
+    std::vector<bool> consumido;
+    size_t actual;
+    int luz;
+    int temperatura;
+    Coche* coche;
+
+    std::vector<OrdenMotor> original;
+    std::vector<OrdenMotor> reproducido;
+    unsigned long tramasOriginales;
+    unsigned long porTipo[TRAZA_PROGRAMADA + 1];
+    SalidaMemoria salida;
+    size_t leidoSalida;
+
+    bool despachar(const EventoTraza& evento);
+    void aplicarInicio(const EventoTrazaInicio& inicio);
+    void aplicarModo(const EventoTrazaModo& modo);
+    const EventoTraza* siguienteLectura(uint8_t tipo);
+    void recogerSalida();
+};
+
+static ReproductorTraza* reproductor = nullptr;
+
+ReproductorTraza::ReproductorTraza() {
+    ahora = 0;
+    tramasEnviadas = 0;
+    actual = 0;
+    luz = 0;
+    temperatura = 0;
+    tramasOriginales = 0;
+    memset(porTipo, 0, sizeof(porTipo));
+    leidoSalida = 0;
+    // Sin HC-SR04 (las muestras vienen de la traza) y sin pin de luces
+    coche = new Coche(5, 4, 0, 2, -1, -1, PIN_TEMP, PIN_LUZ, -1);
+}
+
+ReproductorTraza::~ReproductorTraza() {
+    delete coche;
+}
+
+bool ReproductorTraza::cargar(const char* ruta) {
+    FILE* f = fopen(ruta, "rb");
+    if (!f) {
+        perror(ruta);
+        return false;
+    }
+    uint8_t bloque[4096];
+    size_t n;
+    while ((n = fread(bloque, 1, sizeof(bloque), f)) > 0) {
+        fichero.insert(fichero.end(), bloque, bloque + n);
+    }
+    fclose(f);
+
+    size_t pos = RegistroTraza::leerCabecera(fichero.data(), fichero.size());
+    if (pos == 0) {
+        fprintf(stderr, "%s: no es una traza del coche\n", ruta);
+        return false;
+    }
+    EventoTraza evento;
+    while (RegistroTraza::leerEvento(fichero.data(), fichero.size(), pos, evento)) {
+        eventos.push_back(evento);
+    }
+    if (pos != fichero.size()) {
+        fprintf(stderr, "Aviso: %zu bytes al final sin un evento completo\n", fichero.size() - pos);
+    }
+    consumido.assign(eventos.size(), false);
+    return true;
+}
+
+// Recorrer la traza en orden con el reloj en la marca de cada evento
+void ReproductorTraza::ejecutar() {
+    coche->traza.iniciar(4096);
+    for (actual = 0; actual < eventos.size(); actual++) {
+        const EventoTraza& evento = eventos[actual];
+        if (evento.tipo <= TRAZA_PROGRAMADA) porTipo[evento.tipo]++;
+        ahora = evento.marca;
+        if (despachar(evento)) recogerSalida();
+    }
+    recogerSalida();
+}
+
+// Meter un evento en la librería; false si es una salida o una lectura
+bool ReproductorTraza::despachar(const EventoTraza& evento) {
+    switch (evento.tipo) {
+        case TRAZA_INICIO: {
+            EventoTrazaInicio inicio;
+            if (evento.longitud != sizeof(inicio)) return false;
+            memcpy(&inicio, evento.datos, sizeof(inicio));
+            aplicarInicio(inicio);
+            return true;
+        }
+        case TRAZA_MODO: {
+            EventoTrazaModo modo;
+            if (evento.longitud != sizeof(modo)) return false;
+            memcpy(&modo, evento.datos, sizeof(modo));
+            aplicarModo(modo);
+            return true;
+        }
+        case TRAZA_DISTANCIA: {
+            EventoTrazaDistancia muestra;
+            if (evento.longitud != sizeof(muestra)) return false;
+            memcpy(&muestra, evento.datos, sizeof(muestra));
+            coche->procesarMuestraDistancia(muestra.valida, muestra.distancia, muestra.marcaMuestra);
+            return true;
+        }
+        case TRAZA_CONTROL:
+            coche->pasoControl(ControladorPID::aQ16(coche->ultimaDistancia),
+                               ControladorPID::aQ16(coche->filtro.obtenerVelocidad()));
+            return true;
+        case TRAZA_MANDO:
+            coche->atenderSilencioMando();
+            return true;
+        case TRAZA_SEGUIMIENTO:
+            coche->pasoSeguimiento(evento.marca);
+            return true;
+        case TRAZA_PROGRAMADA:
+            coche->atenderProgramadas();
+            return true;
+        case TRAZA_RX: {
+            EventoTrazaRX rx;
+            if (evento.longitud < sizeof(rx)) return false;
+            memcpy(&rx, evento.datos, sizeof(rx));
+            coche->procesarTramaRecibida(rx.mac, evento.datos + sizeof(rx), evento.longitud - sizeof(rx),
+                                         rx.marcaRecepcion);
+            return true;
+        }
+        case TRAZA_ACK: {
+            EventoTrazaACK ack;
+            if (evento.longitud != sizeof(ack)) return false;
+            memcpy(&ack, evento.datos, sizeof(ack));
+            coche->registrarACK(ack.exitoso, ack.marcaResultado);
+            return true;
+        }
+
+        // Lecturas no pedidas por la reproducción (p. ej. de la tarea de
+        // radio o de luces, que no se reproducen): solo fijan el valor
+        case TRAZA_LUZ:
+            if (!consumido[actual]) luz = (int8_t)evento.datos[0];
+            consumido[actual] = true;
+            return false;
+        case TRAZA_TEMPERATURA:
+            if (!consumido[actual]) {
+                int16_t valor;
+                memcpy(&valor, evento.datos, sizeof(valor));
+                temperatura = valor;
+            }
+            consumido[actual] = true;
+            return false;
+
+        case TRAZA_TX:
+            tramasOriginales++;
+            return false;
+        case TRAZA_MOTOR: {
+            OrdenMotor orden;
+            orden.marca = evento.marca;
+            memcpy(&orden.motor, evento.datos, sizeof(orden.motor));
+            original.push_back(orden);
+            return false;
+        }
+    }
+    return false;
+}
+
+// Configurar el coche como estaba al empezar la traza
+void ReproductorTraza::aplicarInicio(const EventoTrazaInicio& inicio) {
+    coche->esMaestro = inicio.maestro;
+    coche->modoAutomatico = inicio.automatico;
+    coche->tieneSensoresLocales = inicio.sensoresLocales;
+    coche->espnowInicializado = true;
+    // Con planificador no hay límites de ritmo dentro de las funciones
+    coche->tareaControl = inicio.planificador ? 0 : -1;
+    coche->tareaEnvio = inicio.planificador ? 0 : -1;
+    coche->setRangoDistancia(inicio.distanciaMin, inicio.distanciaMax);
+    coche->setConstanteProporcional(inicio.kp);
+    coche->setConstanteIntegral(inicio.ki);
+    coche->setConstanteDerivativa(inicio.kd);
+    coche->setFeedForward(inicio.kff);
+    coche->setPWMMinimo(inicio.pwmMinimo);
+    coche->setFiltroDistancia((FiltroDistancia::Modo)inicio.modoFiltro, inicio.ventanaFiltro);
+    coche->filtro.reiniciar();
+    coche->pid.reiniciar();
+    coche->mando.configurar(inicio.horizonteMando, inicio.presupuestoMando, inicio.decaimientoMando);
+    coche->fusionActiva = inicio.fusion;
+    coche->fusion.configurar(inicio.gananciaFusion, inicio.bandaFusion, inicio.constanteFusion);
+    coche->periodoSincronia = inicio.periodoSincronia;
+    coche->retardoAplicacion = inicio.retardoAplicacion;
+    coche->olvidarMando();
+}
+
+// Lo mismo que hicieron cambiarModo() o setModoAutomatico(), sin avisar a la flota
+void ReproductorTraza::aplicarModo(const EventoTrazaModo& modo) {
+    if (modo.origen == TRAZA_MODO_AUTOMATICO) {
+        coche->setModoAutomatico(modo.automatico);
+        return;
+    }
+    coche->esMaestro = modo.maestro;
+    if (!coche->esMaestro) {
+        coche->detener();
+        coche->estadoMovimiento = "PARADO";
+    }
+    coche->olvidarMando();
+}
+
+// Lectura hecha al reproducir el evento actual: es la primera de ese tipo que
+// queda por delante antes del siguiente evento de entrada
+const EventoTraza* ReproductorTraza::siguienteLectura(uint8_t tipo) {
+    for (size_t i = actual + 1; i < eventos.size(); i++) {
+        uint8_t t = eventos[i].tipo;
+        if (t == tipo && !consumido[i]) {
+            consumido[i] = true;
+            return &eventos[i];
+        }
+        if (t == TRAZA_DISTANCIA || t == TRAZA_CONTROL || t == TRAZA_RX || t == TRAZA_ACK ||
+            t == TRAZA_MODO || t == TRAZA_MANDO || t == TRAZA_SEGUIMIENTO || t == TRAZA_PROGRAMADA) {
+            break;
+        }
+    }
+    return nullptr;
+}
+
+int ReproductorTraza::leerLuz() {
+    const EventoTraza* lectura = siguienteLectura(TRAZA_LUZ);
+    if (lectura) luz = (int8_t)lectura->datos[0];
+    return luz;
+}
+
+int ReproductorTraza::leerTemperatura() {
+    const EventoTraza* lectura = siguienteLectura(TRAZA_TEMPERATURA);
+    if (lectura) {
+        int16_t valor;
+        memcpy(&valor, lectura->datos, sizeof(valor));
+        temperatura = valor;
+    }
+    return temperatura;
+}
+
+// Sacar las órdenes a los motores que la reproducción acaba de registrar
+void ReproductorTraza::recogerSalida() {
+    coche->traza.volcar(salida);
+    size_t pos = leidoSalida;
+    if (pos == 0) pos = RegistroTraza::leerCabecera(salida.datos.data(), salida.datos.size());
+    EventoTraza evento;
+    while (RegistroTraza::leerEvento(salida.datos.data(), salida.datos.size(), pos, evento)) {
+        if (evento.tipo != TRAZA_MOTOR) continue;
+        OrdenMotor orden;
+        orden.marca = evento.marca;
+        memcpy(&orden.motor, evento.datos, sizeof(orden.motor));
+        reproducido.push_back(orden);
+    }
+    leidoSalida = pos;
+}
+
+int ReproductorTraza::informar(FILE* csv) {
+    static const char* NOMBRES[] = {"", "inicio", "modo", "distancia", "luz", "temperatura",
+                                    "rx", "tx", "ack", "control", "motor", "mando", "seguimiento",
+                                    "programada"};
+    printf("Eventos: %zu", eventos.size());
+    for (int t = 1; t <= TRAZA_PROGRAMADA; t++) printf(", %s %lu", NOMBRES[t], porTipo[t]);
+    printf("\n");
+
+    int distintas = 0;
+    long primera = -1;
+    unsigned long desfaseMax = 0;
+    size_t comunes = original.size() < reproducido.size() ? original.size() : reproducido.size();
+    for (size_t i = 0; i < comunes; i++) {
+        const OrdenMotor& a = original[i];
+        const OrdenMotor& b = reproducido[i];
+        if (memcmp(&a.motor, &b.motor, sizeof(a.motor)) != 0) {
+            distintas++;
+            if (primera < 0) primera = i;
+        }
+        unsigned long desfase = a.marca > b.marca ? a.marca - b.marca : b.marca - a.marca;
+        if (desfase > desfaseMax) desfaseMax = desfase;
+    }
+    distintas += (original.size() > comunes ? original.size() : reproducido.size()) - comunes;
+
+    printf("Órdenes a los motores: %zu grabadas, %zu reproducidas, %d distintas (desfase máximo %lu us)\n",
+           original.size(), reproducido.size(), distintas, desfaseMax);
+    if (primera >= 0) {
+        const OrdenMotor& a = original[primera];
+        const OrdenMotor& b = reproducido[primera];
+        printf("Primera diferencia: orden %ld en t=%.6f s: grabada (%d,%d%s), reproducida (%d,%d%s)\n",
+               primera, a.marca / 1000000.0, a.motor.izquierdo, a.motor.derecho, a.motor.parada ? ",parada" : "",
+               b.motor.izquierdo, b.motor.derecho, b.motor.parada ? ",parada" : "");
+    }
+    printf("Tramas encoladas: %lu grabadas, %lu reproducidas\n", tramasOriginales, tramasEnviadas);
+
+    if (csv) {
+        fprintf(csv, "orden,t,izq,der,parada,t_rep,izq_rep,der_rep,parada_rep\n");
+        size_t total = original.size() > reproducido.size() ? original.size() : reproducido.size();
+        for (size_t i = 0; i < total; i++) {
+            fprintf(csv, "%zu", i);
+            if (i < original.size()) {
+                const OrdenMotor& a = original[i];
+                fprintf(csv, ",%.6f,%d,%d,%d", a.marca / 1000000.0, a.motor.izquierdo, a.motor.derecho, a.motor.parada);
+            } else {
+                fprintf(csv, ",,,,");
+            }
+            if (i < reproducido.size()) {
+                const OrdenMotor& b = reproducido[i];
+                fprintf(csv, ",%.6f,%d,%d,%d\n", b.marca / 1000000.0, b.motor.izquierdo, b.motor.derecho, b.motor.parada);
+            } else {
+                fprintf(csv, ",,,,\n");
+            }
+        }
+    }
+    return distintas;
+}
+
+// ========== HAL DE LA REPRODUCCIÓN ==========
+
+unsigned long halMicros() {
+    return reproductor->ahora;
+}
+
+unsigned long halMillis() {
+    return reproductor->ahora / 1000;
+}
+
+void halEsperar(unsigned long ms) {
+}
+
+void halEsperarUs(unsigned int us) {
+}
+
+void halModoPin(int pin, uint8_t modo) {
+}
+
+void halEscribirDigital(int pin, uint8_t nivel) {
+}
+
+int halLeerDigital(int pin) {
+    return pin == ReproductorTraza::PIN_LUZ ? reproductor->leerLuz() : LOW;
+}
+
+int halLeerAnalogico(int pin) {
+    return pin == ReproductorTraza::PIN_TEMP ? reproductor->leerTemperatura() : 0;
+}
+
+void halEscribirPWM(int pin, int valor) {
+}
+
+void halAdjuntarInterrupcion(int pin, FuncionInterrupcionHal funcion, void* contexto, int modo) {
+}
+
+int halIniciarESPNow(FuncionRecepcionHal recepcion, FuncionEnvioHal envio, void* contexto) {
+    return 0;
+}
+
+int halAgregarParESPNow(const uint8_t* mac) {
+    return 0;
+}
+
+int halEnviarESPNow(uint8_t* mac, uint8_t* datos, int longitud) {
+    reproductor->tramasEnviadas++;
+    return 0;
+}
+
+void halObtenerMAC(uint8_t* mac) {
+    static const uint8_t MAC[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0xFE};
+    memcpy(mac, MAC, 6);
+}
+
+uint32_t halHeapLibre() {
+    return 40000;
+}
+
+int main(int argc, char** argv) {
+    const char* rutaTraza = nullptr;
+    const char* rutaCSV = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        bool hayValor = i + 1 < argc;
+        if (!strcmp(argv[i], "--csv") && hayValor) rutaCSV = argv[++i];
+        else if (!strcmp(argv[i], "--verbose")) Serial.habilitado = true;
+        else if (argv[i][0] != '-' && rutaTraza == nullptr) rutaTraza = argv[i];
+        else {
+            rutaTraza = nullptr;
+            break;
+        }
+    }
+    if (rutaTraza == nullptr) {
+        fprintf(stderr, "Uso: %s traza.bin [--csv fichero] [--verbose]\n", argv[0]);
+        return 1;
+    }
+
+    ReproductorTraza repro;
+    reproductor = &repro;
+    if (!repro.cargar(rutaTraza)) return 1;
+    repro.ejecutar();
+
+    FILE* csv = nullptr;
+    if (rutaCSV) {
+        csv = fopen(rutaCSV, "w");
+        if (!csv) {
+            perror(rutaCSV);
+            return 1;
+        }
+    }
+    int distintas = repro.informar(csv);
+    if (csv) fclose(csv);
+    return distintas == 0 ? 0 : 2;
+}
@@ -0,0 +1,236 @@
+// Simulación de la flota en Linux: un maestro que sigue a un obstáculo y
+// esclavos detrás que reciben sus comandos por ESP-NOW y siguen su propio
+// hueco (o los replican, con --replicar).
+//
+//   ./simulador [--coches N] [--segundos S] [--semilla X] [--perdida P]
+//               [--rafagas ENTRAR SALIR] [--mando HORIZONTE PRESUPUESTO DECAIMIENTO]
+//               [--fusion GANANCIA BANDA CONSTANTE] [--replicar]
+//               [--sincronia PERIODO RETARDO] [--reloj DERIVA DESFASE]
+//               [--csv fichero] [--traza prefijo] [--serial] [--roles-fijos]
+//
+// Imprime un resumen por coche; con --csv guarda la traza cada 10 ms. Con
+// --traza cada coche graba su traza binaria en <prefijo><n>.bin, que se puede
+// pasar al reproductor. --rafagas añade pérdidas a ráfagas (Gilbert-Elliott:
+// probabilidad por trama de entrar y de salir de la ráfaga, que lo pierde
+// todo); --mando configura en ms qué hacen los esclavos sin comandos
+// (configurarPerdidaMando; "--mando 0 0 0" mantiene el último comando);
+// --fusion, el modelo de los motores de su fusión (configurarFusion, ms).
+// --sincronia activa la sincronía de relojes (configurarSincronia, ms) y
+// --reloj da a cada coche una deriva de hasta ±DERIVA ppm y un desfase de
+// hasta DESFASE ms; el resumen compara el desfase estimado con el real.
+
+#include "Simulador.h"
+#include <Coche.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+// Salida de la traza de un coche a un fichero
+class SalidaFichero : public Print {
+public:
+    FILE* f;
+    size_t write(const uint8_t* datos, size_t n) override {
+        return fwrite(datos, 1, n, f);
+    }
+    using Print::write;
+};
+
+// Obstáculo: quieto, se aleja, quieto, se acerca, y vuelta a empezar (20 s)
+static float perfilObstaculo(float t) {
+    float ciclo = fmodf(t, 20.0f);
+    if (ciclo < 3.0f) return 40.0f;
+    if (ciclo < 7.0f) return 40.0f + (ciclo - 3.0f) * 10.0f;   // Se aleja a 10 cm/s
+    if (ciclo < 10.0f) return 80.0f;
+    if (ciclo < 16.0f) return 80.0f - (ciclo - 10.0f) * 6.0f;  // Se acerca a 6 cm/s
+    return 44.0f - (ciclo - 16.0f);
+}
+
+int main(int argc, char** argv) {
+    int numCoches = 2;
+    float segundos = 20.0f;
+    uint32_t semilla = 1;
+    float perdida = 0.0f;
+    const char* rutaCSV = nullptr;
+    const char* prefijoTraza = nullptr;
+    bool rolesFijos = false;
+    float entrarRafaga = 0.0f;
+    float salirRafaga = 0.3f;
+    long mando[3] = {-1, -1, -1};  // Por defecto, lo que traiga la librería
+    float fusion[3] = {-1, -1, -1};
+    bool replicar = false;
+    long sincronia[2] = {0, 0};
+    float reloj[2] = {0, 0};
+
+    for (int i = 1; i < argc; i++) {
+        bool hayValor = i + 1 < argc;
+        if (!strcmp(argv[i], "--coches") && hayValor) numCoches = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--segundos") && hayValor) segundos = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--semilla") && hayValor) semilla = strtoul(argv[++i], nullptr, 10);
+        else if (!strcmp(argv[i], "--perdida") && hayValor) perdida = atof(argv[++i]);
+        else if (!strcmp(argv[i], "--csv") && hayValor) rutaCSV = argv[++i];
+        else if (!strcmp(argv[i], "--traza") && hayValor) prefijoTraza = argv[++i];
+        else if (!strcmp(argv[i], "--serial")) Serial.habilitado = true;
+        else if (!strcmp(argv[i], "--roles-fijos")) rolesFijos = true;
+        else if (!strcmp(argv[i], "--rafagas") && i + 2 < argc) {
+            entrarRafaga = atof(argv[++i]);
+            salirRafaga = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--mando") && i + 3 < argc) {
+            for (int k = 0; k < 3; k++) mando[k] = atol(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--fusion") && i + 3 < argc) {
+            for (int k = 0; k < 3; k++) fusion[k] = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--sincronia") && i + 2 < argc) {
+            for (int k = 0; k < 2; k++) sincronia[k] = atol(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--reloj") && i + 2 < argc) {
+            for (int k = 0; k < 2; k++) reloj[k] = atof(argv[++i]);
+        }
+        else if (!strcmp(argv[i], "--replicar")) replicar = true;
+        else {
+            fprintf(stderr, "Uso: %s [--coches N] [--segundos S] [--semilla X] [--perdida P] [--rafagas ENTRAR SALIR] "
+                            "[--mando HORIZONTE PRESUPUESTO DECAIMIENTO] [--fusion GANANCIA BANDA CONSTANTE] [--replicar] "
+                            "[--sincronia PERIODO RETARDO] [--reloj DERIVA DESFASE] [--csv fichero] [--traza prefijo] [--serial] [--roles-fijos]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (numCoches < 1) numCoches = 1;
+
+    Simulador sim(semilla);
+    sim.radio.probPerdida = perdida;
+    sim.radio.probRafaga = entrarRafaga;
+    sim.radio.probFinRafaga = salirRafaga;
+    sim.relojes.derivaMax = reloj[0];
+    sim.relojes.desfaseMax = (unsigned long)(reloj[1] * 1000.0f);
+    sim.setZonaObjetivo(7.0f, 13.0f);
+    for (int i = 0; i < numCoches; i++) {
+        // Cada coche 10 cm detrás del anterior (más su largo)
+        sim.agregarCoche(30.0f - i * 25.0f, i == 0, rolesFijos);
+    }
+    sim.iniciar();
+    if (mando[0] >= 0) {
+        for (int i = 0; i < numCoches; i++) sim.coche(i).configurarPerdidaMando(mando[0], mando[1], mando[2]);
+    }
+    for (int i = 0; i < numCoches; i++) {
+        if (fusion[0] >= 0) sim.coche(i).configurarFusion(fusion[0], (int16_t)fusion[1], (unsigned long)fusion[2]);
+        if (replicar) sim.coche(i).setFusionHueco(false);
+        if (sincronia[0] > 0) sim.coche(i).configurarSincronia(sincronia[0], sincronia[1]);
+    }
+
+    std::vector<SalidaFichero> trazas;
+    if (prefijoTraza) {
+        trazas.resize(numCoches);
+        for (int i = 0; i < numCoches; i++) {
+            char ruta[256];
+            snprintf(ruta, sizeof(ruta), "%s%d.bin", prefijoTraza, i);
+            trazas[i].f = fopen(ruta, "wb");
+            if (!trazas[i].f) {
+                perror(ruta);
+                return 1;
+            }
+            sim.seleccionar(i);
+            sim.coche(i).iniciarTraza(65536, nullptr);
+        }
+    }
+
+    FILE* csv = nullptr;
+    if (rutaCSV) {
+        csv = fopen(rutaCSV, "w");
+        if (!csv) {
+            perror(rutaCSV);
+            return 1;
+        }
+        fprintf(csv, "t");
+        for (int i = 0; i < numCoches; i++) fprintf(csv, ",pos%d,vel%d,pwm%d,hueco%d", i, i, i, i);
+        fprintf(csv, "\n");
+    }
+
+    // Error de la sincronía de cada esclavo (estimado - real), cada 10 ms
+    // desde que se da por sincronizado
+    std::vector<double> sumaError(numCoches, 0), maxError(numCoches, 0);
+    std::vector<unsigned long> muestrasError(numCoches, 0);
+    std::vector<double> convergencia(numCoches, -1);
+
+    auto inicio = std::chrono::steady_clock::now();
+    unsigned long total = (unsigned long)(segundos * 1000000.0f);
+    for (unsigned long hecho = 0; hecho < total; hecho += 10000) {
+        sim.avanzar(10000, perfilObstaculo);
+        for (size_t i = 0; i < trazas.size(); i++) sim.coche(i).volcarTraza(trazas[i]);
+        for (int i = 1; i < numCoches && sincronia[0] > 0; i++) {
+            unsigned long propio = sim.relojCoche(i);
+            SincroniaReloj& r = sim.coche(i).obtenerReloj();
+            if (!r.sincronizado(propio)) continue;
+            long real = (long)(sim.relojCoche(0) - propio);
+            double error = fabs((double)(r.obtenerDesfase(propio) - real));
+            if (convergencia[i] < 0) convergencia[i] = sim.tiempoUs() / 1000000.0;
+            sumaError[i] += error;
+            if (error > maxError[i]) maxError[i] = error;
+            muestrasError[i]++;
+        }
+        if (csv) {
+            fprintf(csv, "%.3f", sim.tiempoUs() / 1000000.0);
+            for (int i = 0; i < numCoches; i++) {
+                fprintf(csv, ",%.2f,%.2f,%d,%.2f", sim.posicion(i), sim.velocidad(i), sim.pwmMedio(i),
+                        sim.distanciaReal(i));
+            }
+            fprintf(csv, "\n");
+        }
+    }
+    double real = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    if (csv) fclose(csv);
+    for (SalidaFichero& traza : trazas) fclose(traza.f);
+
+    printf("Simulados %.1f s en %.3f s (x%.0f), semilla %u, pérdida %.2f",
+           segundos, real, real > 0 ? segundos / real : 0, semilla, perdida);
+    if (entrarRafaga > 0) printf(", ráfagas %.3f/%.3f", entrarRafaga, salirRafaga);
+    printf("\n");
+    printf("coche  rol      minimo(cm)  error(cm)  fuera(%%)  choques  tx     rx     perdidas  ecosPerdidos\n");
+    for (int i = 0; i < numCoches; i++) {
+        Simulador::Resumen r = sim.resumen(i);
+        printf("%-6d %-8s %-11.2f %-10.2f %-9.1f %-8lu %-6lu %-6lu %-9lu %lu\n",
+               i, i == 0 ? "maestro" : "esclavo", r.distanciaMinima, r.errorMedio, r.fueraDeZona * 100.0f,
+               r.choques, r.tramasEnviadas, r.tramasRecibidas, r.tramasPerdidas, r.ecosPerdidos);
+    }
+
+    // Esclavos: silencios del maestro y lo bien que se siguió su tendencia
+    if (numCoches > 1) {
+        printf("\ncoche  ráfagas  silencios  paradas  errorExtrapolación(PWM)\n");
+        for (int i = 1; i < numCoches; i++) {
+            InstantaneaTelemetria t;
+            sim.seleccionar(i);
+            sim.coche(i).tomarInstantanea(t);
+            printf("%-6d %-8lu %-10lu %-8lu %.1f\n", i, sim.resumen(i).rafagas, t.silenciosMando,
+                   t.paradasPorSilencio, t.errorExtrapolacion);
+        }
+    }
+
+    // Esclavos: sincronía del reloj con el del maestro y mediana del desfase
+    // entre sus arranques desde parado (tiempo real)
+    if (numCoches > 1 && sincronia[0] > 0) {
+        printf("\ncoche  sincronizado(s)  errorMedio(us)  errorMax(us)  deriva(ppm)  estimada(ppm)  tarde  arranques(us)\n");
+        for (int i = 1; i < numCoches; i++) {
+            InstantaneaTelemetria t;
+            sim.seleccionar(i);
+            sim.coche(i).tomarInstantanea(t);
+            float derivaReal = (sim.derivaCoche(0) - sim.derivaCoche(i)) / (1 + sim.derivaCoche(i) * 1e-6f);
+            std::vector<double> arranques;
+            for (unsigned long long maestro : sim.arranques(0)) {
+                for (unsigned long long propio : sim.arranques(i)) {
+                    double diferencia = fabs((double)propio - (double)maestro);
+                    if (diferencia < 20000) {
+                        arranques.push_back(diferencia);
+                        break;
+                    }
+                }
+            }
+            std::sort(arranques.begin(), arranques.end());
+            printf("%-6d %-16.2f %-15.1f %-13.1f %-12.2f %-14.2f %-6lu ", i, convergencia[i],
+                   muestrasError[i] ? sumaError[i] / muestrasError[i] : 0.0, maxError[i], derivaReal,
+                   t.derivaReloj, t.comandosTarde);
+            if (!arranques.empty()) printf("%.0f (%zu)\n", arranques[arranques.size() / 2], arranques.size());
+            else printf("-\n");
+        }
+    }
+    return 0;
+}
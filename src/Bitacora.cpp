@@ -0,0 +1,104 @@
+#include "Bitacora.h"
+#include "Protocolo.h"
+
+// Constructor
+Bitacora::Bitacora() {
+    longitudLinea = 0;
+    escritosLinea = 0;
+    perdidosAvisados = 0;
+}
+
+// Centésimas como "24.5" (una decimal, redondeada como String(valor, 1))
+static int escribirDecimas(char* destino, size_t tam, int16_t centesimas) {
+    int decimas = centesimas >= 0 ? (centesimas + 5) / 10 : (centesimas - 5) / 10;
+    const char* signo = decimas < 0 ? "-" : "";
+    if (decimas < 0) decimas = -decimas;
+    return snprintf(destino, tam, "%s%d.%d", signo, decimas / 10, decimas % 10);
+}
+
+// " T:24.5 L:1", cada parte solo si hay dato
+static int escribirSensores(char* destino, size_t tam, int16_t temperatura, int16_t luz) {
+    int n = 0;
+    if (temperatura != BITACORA_SIN_DATO) {
+        n += snprintf(destino, tam, " T:");
+        n += escribirDecimas(destino + n, tam - n, temperatura);
+    }
+    if (luz != BITACORA_SIN_DATO) n += snprintf(destino + n, tam - n, " L:%d", luz);
+    return n;
+}
+
+static const char* textoRol(int16_t rol) {
+    return rol == ROL_MAESTRO ? "MAESTRO" : "ESCLAVO";
+}
+
+size_t Bitacora::formatear(const RegistroBitacora& r, char* destino, size_t tam) {
+    const int16_t* a = r.args;
+    int n = snprintf(destino, tam, "%lu.%03lus ", (unsigned long)(r.marca / 1000), (unsigned long)(r.marca % 1000));
+
+    switch (r.evento) {
+        case BIT_ENVIO:
+        case BIT_RECEPCION:
+            n += snprintf(destino + n, tam - n, "%s: %s V:%d,%d", r.evento == BIT_ENVIO ? "ENVIO" : "RECEP",
+                          textoMovimiento(a[0]), a[1], a[2]);
+            n += escribirSensores(destino + n, tam - n, a[3], a[4]);
+            break;
+        case BIT_RESPUESTA:
+            n += snprintf(destino + n, tam - n, "RESP:");
+            n += escribirSensores(destino + n, tam - n, a[0], a[1]);
+            break;
+        case BIT_RESPUESTA_RX:
+            n += snprintf(destino + n, tam - n, "RESP_RX: %02X:%02X:%02X:%02X:%02X:%02X",
+                          (uint8_t)(a[0] >> 8), (uint8_t)a[0], (uint8_t)(a[1] >> 8), (uint8_t)a[1],
+                          (uint8_t)(a[2] >> 8), (uint8_t)a[2]);
+            n += escribirSensores(destino + n, tam - n, a[3], a[4]);
+            break;
+        case BIT_MODO:
+            n += snprintf(destino + n, tam - n, "MODO: %s%s → %s", a[2] ? "Remoto: " : "",
+                          textoRol(a[0]), textoRol(a[1]));
+            break;
+        case BIT_TRAMA_INVALIDA:
+            n += snprintf(destino + n, tam - n, "TRAMA_INVALIDA: %d bytes, tipo %d", a[0], a[1]);
+            break;
+        default:
+            n += snprintf(destino + n, tam - n, "EVENTO %u: %d %d %d %d %d", r.evento, a[0], a[1], a[2], a[3], a[4]);
+            break;
+    }
+
+    // snprintf devuelve lo que habría escrito: recortar y dejar sitio al fin de línea
+    if (n > (int)tam - 3) n = tam - 3;
+    destino[n++] = '\r';
+    destino[n++] = '\n';
+    destino[n] = '\0';
+    return n;
+}
+
+void Bitacora::atender(Print& salida, size_t hueco) {
+    while (hueco > 0) {
+        if (longitudLinea == 0) {
+            // Avisar de lo perdido antes del siguiente registro
+            unsigned long perdidos = cola.obtenerDesbordes();
+            if (perdidos != perdidosAvisados) {
+                longitudLinea = snprintf(linea, sizeof(linea), "... %lu registros perdidos\r\n",
+                                         perdidos - perdidosAvisados);
+                perdidosAvisados = perdidos;
+            } else {
+                RegistroBitacora registro;
+                if (!cola.sacar(registro)) return;
+                longitudLinea = formatear(registro, linea, sizeof(linea));
+            }
+            escritosLinea = 0;
+        }
+
+        size_t n = longitudLinea - escritosLinea;
+        if (n > hueco) n = hueco;
+        size_t escritos = salida.write((const uint8_t*)linea + escritosLinea, n);
+        escritosLinea += escritos;
+        hueco -= escritos;
+        if (escritosLinea < longitudLinea) return;  // Salida llena
+        longitudLinea = 0;
+    }
+}
+
+unsigned long Bitacora::obtenerPerdidos() {
+    return cola.obtenerDesbordes();
+}
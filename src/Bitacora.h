@@ -0,0 +1,93 @@
+#ifndef BITACORA_H
+#define BITACORA_H
+
+#include <Arduino.h>
+#include "Hal.h"
+#include "Buzon.h"
+
+// Bitácora diferida para el camino de envío y recepción.
+// Registrar solo copia un registro binario de tamaño fijo (marca, evento y
+// argumentos) a una cola sin bloqueos; el texto se forma y se escribe más
+// tarde, en tiempo libre, y solo lo que cabe en el buffer de la UART, así que
+// registrar nunca espera al Serial. Si la cola se llena, los registros nuevos
+// se pierden y se avisa de cuántos al escribir el siguiente.
+//
+// Los niveles se filtran al compilar con COCHE_NIVEL_BITACORA (p. ej.
+// -DCOCHE_NIVEL_BITACORA=BITACORA_AVISO): con la macro BITACORA() un nivel
+// desactivado no genera código, ni siquiera la evaluación de los argumentos.
+
+#define BITACORA_NADA 0
+#define BITACORA_ERROR 1
+#define BITACORA_AVISO 2
+#define BITACORA_INFO 3
+#define BITACORA_DEPURACION 4
+
+#ifndef COCHE_NIVEL_BITACORA
+#define COCHE_NIVEL_BITACORA BITACORA_INFO
+#endif
+
+#define BITACORA(bitacora, nivel, evento, ...) \
+    do { \
+        if ((nivel) <= COCHE_NIVEL_BITACORA) (bitacora).registrar((nivel), (evento), ##__VA_ARGS__); \
+    } while (0)
+
+// Sin dato en un argumento (temperatura o luz que no se envían)
+#define BITACORA_SIN_DATO INT16_MIN
+
+// Eventos y sus argumentos
+enum EventoBitacora : uint8_t {
+    BIT_ENVIO,            // movimiento, izq, der, temperatura (centésimas), luz
+    BIT_RECEPCION,        // movimiento, izq, der, temperatura (centésimas), luz
+    BIT_RESPUESTA,        // temperatura (centésimas), luz
+    BIT_RESPUESTA_RX,     // MAC en 3 palabras (mac[0]<<8 | mac[1], ...), temperatura (centésimas), luz
+    BIT_MODO,             // rol anterior, rol nuevo, 1 si lo pidió otro coche
+    BIT_TRAMA_INVALIDA    // longitud, primer byte
+};
+
+// Registro binario (16 bytes)
+struct RegistroBitacora {
+    uint32_t marca;       // millis()
+    uint8_t evento;       // EventoBitacora
+    uint8_t nivel;
+    int16_t args[5];
+};
+
+class Bitacora {
+public:
+    static const uint8_t CAPACIDAD = 64;  // Registros (1 KB)
+
+    Bitacora();
+
+    // Copiar un registro a la cola; usar la macro BITACORA() para el filtro
+    void registrar(uint8_t nivel, uint8_t evento, int16_t a = 0, int16_t b = 0,
+                   int16_t c = 0, int16_t d = 0, int16_t e = 0) {
+        RegistroBitacora registro;
+        registro.marca = halMillis();
+        registro.evento = evento;
+        registro.nivel = nivel;
+        registro.args[0] = a;
+        registro.args[1] = b;
+        registro.args[2] = c;
+        registro.args[3] = d;
+        registro.args[4] = e;
+        cola.poner(registro);
+    }
+
+    // Formatear y escribir como mucho "hueco" bytes; una línea que no cabe
+    // entera se termina en la siguiente llamada
+    void atender(Print& salida, size_t hueco);
+
+    // Texto de un registro ("12.345s ENVIO: ..."), terminado en "\r\n"
+    static size_t formatear(const RegistroBitacora& registro, char* destino, size_t tam);
+
+    unsigned long obtenerPerdidos();  // Registros descartados por cola llena
+
+private:
+    ColaSPSC<RegistroBitacora, CAPACIDAD> cola;
+    char linea[96];
+    uint8_t longitudLinea;   // Bytes de la línea formateada (0 = ninguna)
+    uint8_t escritosLinea;   // Cuántos de ellos ya salieron
+    unsigned long perdidosAvisados;
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef BUZON_H
+#define BUZON_H
+
+#include <Arduino.h>
+#include <atomic>
+
+// Primitivas sin bloqueos para pasar datos de un productor (callback de
+// ESP-NOW) a un consumidor (loop). Cada estructura admite exactamente un
+// productor y un consumidor.
+
+// Cola circular de capacidad fija. N debe ser potencia de dos.
+template <typename T, uint8_t N>
+class ColaSPSC {
+public:
+    ColaSPSC() : cabeza(0), cola(0), desbordes(0) {}
+
+    // Productor: false si está llena (el elemento se pierde)
+    bool poner(const T& elemento) {
+        uint8_t c = cabeza.load(std::memory_order_relaxed);
+        if ((uint8_t)(c - cola.load(std::memory_order_acquire)) >= N) {
+            desbordes++;
+            return false;
+        }
+        elementos[c & (N - 1)] = elemento;
+        cabeza.store(c + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor: false si está vacía
+    bool sacar(T& elemento) {
+        uint8_t t = cola.load(std::memory_order_relaxed);
+        if (t == cabeza.load(std::memory_order_acquire)) return false;
+        elemento = elementos[t & (N - 1)];
+        cola.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    unsigned long obtenerDesbordes() { return desbordes; }
+
+private:
+    static_assert((N & (N - 1)) == 0 && N <= 128, "N debe ser potencia de dos <= 128");
+    T elementos[N];
+    std::atomic<uint8_t> cabeza;  // Solo la escribe el productor
+    std::atomic<uint8_t> cola;    // Solo la escribe el consumidor
+    unsigned long desbordes;      // Solo la escribe el productor
+};
+
+// Ranura de último valor (seqlock): el productor nunca espera y siempre
+// sobrescribe; el consumidor obtiene una copia coherente del valor más nuevo.
+template <typename T>
+class RanuraUltimoValor {
+public:
+    RanuraUltimoValor() : secuencia(0), ultimaLeida(0), sobrescritos(0) {}
+
+    // Productor
+    void escribir(const T& nuevo) {
+        uint32_t s = secuencia.load(std::memory_order_relaxed);
+        secuencia.store(s + 1, std::memory_order_relaxed);  // Impar: escritura en curso
+        std::atomic_thread_fence(std::memory_order_release);
+        valor = nuevo;
+        secuencia.store(s + 2, std::memory_order_release);
+    }
+
+    // Consumidor: true si había un valor nuevo desde la última lectura.
+    // Los valores intermedios que no se llegaron a leer se cuentan como sobrescritos.
+    bool leer(T& destino) {
+        uint32_t antes, despues = 0;
+        do {
+            antes = secuencia.load(std::memory_order_acquire);
+            if (antes == ultimaLeida) return false;
+            if (antes & 1) continue;  // Escritura a medias: reintentar
+            destino = valor;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            despues = secuencia.load(std::memory_order_relaxed);
+        } while ((antes & 1) || antes != despues);
+
+        sobrescritos += (antes - ultimaLeida) / 2 - 1;
+        ultimaLeida = antes;
+        return true;
+    }
+
+    unsigned long obtenerSobrescritos() { return sobrescritos; }
+
+private:
+    std::atomic<uint32_t> secuencia;
+    T valor;
+    uint32_t ultimaLeida;        // Solo la usa el consumidor
+    unsigned long sobrescritos;  // Solo la usa el consumidor
+};
+
+#endif
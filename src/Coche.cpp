@@ -1,8 +1,10 @@
 #include "Coche.h"
+#include "PanelWeb.h"
 
 // Constructor
 Coche::Coche(int m1A, int m1B, int m2A, int m2B, 
-             int trig, int echo, int temp, int light, int luces) {
+             int trig, int echo, int temp, int light, int luces)
+    : medidor(trig, echo) {
     motor1A = m1A;
     motor1B = m1B;
     motor2A = m2A;
@@ -15,7 +17,27 @@ Coche::Coche(int m1A, int m1B, int m2A, int m2B,
     distanciaObjetivo = 10.0; // 10 cm por defecto
     distanciaMin = 7.0;  // Límite inferior
     distanciaMax = 13.0; // Límite superior
-    kp = 8.0; // Constante proporcional más suave
+    distanciaMinQ = ControladorPID::aQ16(distanciaMin);
+    distanciaMaxQ = ControladorPID::aQ16(distanciaMax);
+    distanciaSeguridad = 0;
+    movimientoMando = MOV_PARADO;
+    fusionActiva = (trig >= 0);
+    siguiendoHueco = false;
+    periodoSincronia = 0;
+    ultimaSincronia = 0;
+    retardoAplicacion = 0;
+    aplicarEnEnviado = 0;
+    ultimoAplicarEn = 0;
+    numProgramadas = 0;
+    comandosTarde = 0;
+    pid.setGanancias(8.0, 1.0, 0.4);  // Kp como el antiguo control P, con algo de I y D
+    pid.setPeriodo(20000);            // Paso fijo de 20 ms
+    pid.setLimites(-255, 255);
+    pwmMinimo = 120;
+    ultimoControl = 0;
+    pwmAplicadoIzq = 0;
+    pwmAplicadoDer = 0;
+    for (uint8_t i = 0; i < 4; i++) pwmCanal[i] = -1;
     servidor = nullptr;
     ultimaDistancia = 0;
     ultimaTemperatura = 0;
@@ -23,48 +45,55 @@ Coche::Coche(int m1A, int m1B, int m2A, int m2B,
     estadoMovimiento = "PARADO";
     ultimaLecturaDistancia = 0;
     esMaestro = true;  // Por defecto empieza como maestro
+    rolFijo = false;
     ultimaVelocidadIzq = 0;
     ultimaVelocidadDer = 0;
     espnowInicializado = false;
     modoAutomatico = true;
     lucesAutomaticas = true;  // Luces automáticas activadas por defecto
     estadoLuces = false;  // Luces apagadas inicialmente
-    memset(macRemota, 0, 6);
+    memset(macMaestro, 0, 6);
     
     // Inicializar variables de sensores compartidos
-    temperaturaRemota = 0;
-    luminosidadRemota = 0;
-    tieneSensoresLocales = (temp >= 0 && light >= 0);  // Si los pines son válidos
-    datosRemotosValidos = false;
-    ultimosDatosRemotos = 0;
+    tieneSensoresLocales = (light >= 0);  // El LM35 es opcional (temp = -1)
     
     // Inicializar variables de log
-    mensajesEnviados = 0;
     mensajesRecibidos = 0;
-    mensajesFallidos = 0;
-    esperandoACK = false;
+    tramasInvalidas = 0;
     ultimoEnvio = 0;
+    intervaloEnvio = 20;  // 50 Hz por defecto
+    ultimoEvento = 0;
+    ultimoLatido = 0;
+    intervaloEventos = 100;  // 10 eventos/s como máximo
+    memset(&instantaneaPublicada, 0, sizeof(instantaneaPublicada));
+    tareaEnvio = -1;
+    tareaControl = -1;
+    marcaRecepcion = 0;
+    heapMinimoPanel = 0xFFFFFFFF;
+    tramasDemasiadoLargas = 0;
+    marcaComandoRemoto = 0;
+    recepcionComandoRemoto = 0;
+    rutaTraza = nullptr;
 }
 
 // Inicialización de pines
 void Coche::inicializar() {
     // Configurar pines del motor como salidas
-    pinMode(motor1A, OUTPUT);
-    pinMode(motor1B, OUTPUT);
-    pinMode(motor2A, OUTPUT);
-    pinMode(motor2B, OUTPUT);
+    halModoPin(motor1A, OUTPUT);
+    halModoPin(motor1B, OUTPUT);
+    halModoPin(motor2A, OUTPUT);
+    halModoPin(motor2B, OUTPUT);
     
-    // Configurar pines del sensor HC-SR04
-    pinMode(trigPin, OUTPUT);
-    pinMode(echoPin, INPUT);
+    // Configurar sensor HC-SR04 (pines + interrupción del ECHO)
+    medidor.inicializar();
     
     // Configurar pin del sensor de luz como entrada
-    pinMode(lightPin, INPUT);
+    halModoPin(lightPin, INPUT);
     
     // Configurar pin de luces si está definido
     if (pinLuces >= 0) {
-        pinMode(pinLuces, OUTPUT);
-        digitalWrite(pinLuces, LOW);  // Luces apagadas inicialmente
+        halModoPin(pinLuces, OUTPUT);
+        halEscribirDigital(pinLuces, LOW);  // Luces apagadas inicialmente
     }
     
     // El pin analógico del LM35 no necesita configuración
@@ -73,152 +102,261 @@ void Coche::inicializar() {
     detenerMotores();
 }
 
-// Leer distancia del sensor HC-SR04 en cm (con caché)
+// Leer distancia del sensor HC-SR04 en cm (no bloqueante, filtrada)
 float Coche::leerDistancia() {
-    // Solo medir cada 200ms para tener medidas más estables
-    unsigned long ahora = millis();
-    if (ahora - ultimaLecturaDistancia > 200) {
-        ultimaDistancia = leerDistanciaFiable();
-        ultimaLecturaDistancia = ahora;
+    // Avanzar la medición asíncrona
+    if (medidor.actualizar()) {
+        procesarMuestraDistancia(medidor.muestraValida(), medidor.obtenerDistancia(),
+                                 medidor.obtenerMarcaMuestra());
     }
     return ultimaDistancia;
 }
 
-// Leer distancia con múltiples mediciones para mayor fiabilidad (privado)
-float Coche::leerDistanciaFiable() {
-    const int NUM_LECTURAS = 5;
-    float lecturas[NUM_LECTURAS];
-    float suma = 0;
-    int lecturasValidas = 0;
-    
-    // Tomar múltiples mediciones
-    for (int i = 0; i < NUM_LECTURAS; i++) {
-        digitalWrite(trigPin, LOW);
-        delayMicroseconds(2);
-        digitalWrite(trigPin, HIGH);
-        delayMicroseconds(10);
-        digitalWrite(trigPin, LOW);
-        
-        long duracion = pulseIn(echoPin, HIGH, 30000);
-        float distancia = duracion * 0.034 / 2.0;
-        
-        // Filtrar lecturas inválidas (muy cerca o muy lejos)
-        if (distancia > 2 && distancia < 400) {
-            lecturas[lecturasValidas] = distancia;
-            lecturasValidas++;
-        }
-        
-        if (i < NUM_LECTURAS - 1) {
-            delay(10); // Pequeña pausa entre mediciones
-        }
+// Un ciclo del HC-SR04 terminado: cada muestra válida pasa por el filtro
+void Coche::procesarMuestraDistancia(bool valida, float distancia, unsigned long marcaUs) {
+    if (traza.activa()) {
+        EventoTrazaDistancia evento;
+        evento.valida = valida;
+        evento.distancia = distancia;
+        evento.marcaMuestra = marcaUs;
+        traza.registrar(TRAZA_DISTANCIA, halMicros(), &evento, sizeof(evento));
     }
     
-    // Si no hay lecturas válidas, retornar distancia anterior o valor alto
-    if (lecturasValidas == 0) {
-        return (ultimaDistancia > 0) ? ultimaDistancia : 400;
+    if (valida) {
+        filtro.agregarMuestra(distancia, marcaUs);
+        ultimaDistancia = filtro.obtenerDistancia();
+        if (!esMaestro && fusionActiva) fusion.agregarMuestra(distancia, marcaUs);
+    } else if (ultimaDistancia <= 0) {
+        ultimaDistancia = 400;  // Sin eco y sin lectura previa: libre
     }
-    
-    // Calcular promedio de lecturas válidas
-    for (int i = 0; i < lecturasValidas; i++) {
-        suma += lecturas[i];
-    }
-    
-    return suma / lecturasValidas;
+    ultimaLecturaDistancia = halMillis();
 }
 
 // Leer temperatura del sensor LM35 en grados Celsius
 float Coche::leerTemperatura() {
-    int lectura = analogRead(tempPin);
+    int lectura = halLeerAnalogico(tempPin);
+    if (traza.activa()) {
+        int16_t valor = lectura;
+        traza.registrar(TRAZA_TEMPERATURA, halMicros(), &valor, sizeof(valor));
+    }
     // LM35: 10mV/°C, con Vref 5V y ADC de 10 bits (1024)
     // Temperatura = (lectura * 5000mV / 1024) / 10
     float temperatura = (lectura * 5000.0 / 1024.0) / 10.0;
+    ultimaTemperatura = temperatura;  // Para la telemetría
     return temperatura;
 }
 
 // Leer estado del sensor de luz LM393 (digital)
 // Retorna 1 si hay luz, 0 si está oscuro
 int Coche::leerLuz() {
-    return digitalRead(lightPin);
+    ultimaLuz = halLeerDigital(lightPin);  // Para la telemetría
+    if (traza.activa()) {
+        int8_t valor = ultimaLuz;
+        traza.registrar(TRAZA_LUZ, halMicros(), &valor, sizeof(valor));
+    }
+    return ultimaLuz;
+}
+
+// Control PID de distancia con zona muerta
+void Coche::controlarDistancia() {
+    controlarDistancia<RolDinamico>();
 }
 
-// Control proporcional de distancia con zona muerta
+template <class Rol>
 void Coche::controlarDistancia() {
     // Solo controlar distancia si es maestro Y modo automático está activado
-    if (!esMaestro || !modoAutomatico) {
+    // (el esclavo con fusión controla su propio hueco)
+    if (!modoAutomatico) return;
+    if (!actuaComoMaestro<Rol>()) {
+        if (actuaComoEsclavo<Rol>() && fusionActiva) controlarHueco();
         return;
     }
     
     float distanciaActual = leerDistancia();
     
+    // Todavía no ha terminado ninguna medición
+    if (distanciaActual <= 0) return;
+    
+    // El PID supone un periodo fijo: sin planificador, limitar el ritmo aquí
+    unsigned long ahora = halMicros();
+    if (tareaControl < 0 && ahora - ultimoControl < 20000) return;
+    ultimoControl = ahora;
+    
+    traza.registrar(TRAZA_CONTROL, ahora, nullptr, 0);
+    pasoControl(ControladorPID::aQ16(distanciaActual), ControladorPID::aQ16(filtro.obtenerVelocidad()));
+}
+
+// Esclavo: control del propio hueco a ritmo fijo, como el del maestro
+void Coche::controlarHueco() {
+    leerDistancia();
+    
+    unsigned long ahora = halMicros();
+    if (tareaControl < 0 && ahora - ultimoControl < 20000) return;
+    ultimoControl = ahora;
+    
+    traza.registrar(TRAZA_SEGUIMIENTO, ahora, nullptr, 0);
+    pasoSeguimiento(ahora);
+}
+
+// Un paso del esclavo sobre el hueco fusionado. Hasta tener estimación y
+// algún comando del maestro (o si se pierde la estimación), mandan los comandos
+void Coche::pasoSeguimiento(unsigned long ahora) {
+    bool antes = siguiendoHueco;
+    siguiendoHueco = fusion.actualizar(ahora) && fusion.tieneLider();
+    if (siguiendoHueco) {
+        if (!antes) pid.reiniciar();
+        pasoControl(ControladorPID::aQ16(fusion.obtenerDistancia()), ControladorPID::aQ16(fusion.obtenerVelocidad()));
+    } else if (antes) {
+        detenerMotores();  // Hasta el próximo comando
+        estadoMovimiento = "PARADO";
+    }
+}
+
+// Un paso del control con la distancia filtrada y la velocidad del hueco,
+// pasadas a Q16 una sola vez a la salida del filtro: la zona muerta, el
+// error y el PID van en enteros
+void Coche::pasoControl(int32_t distanciaQ, int32_t velocidadHuecoQ) {
     // Zona muerta: si está entre distanciaMin y distanciaMax, no hacer nada
-    if (distanciaActual >= distanciaMin && distanciaActual <= distanciaMax) {
-        detenerMotores();
+    if (distanciaQ >= distanciaMinQ && distanciaQ <= distanciaMaxQ) {
+        ordenControl(0, 0, true);
         estadoMovimiento = "PARADO";
+        pid.reiniciar();  // Sin integral acumulada al salir de la zona
         return;
     }
     
-    // Calcular error respecto al centro de la zona muerta
-    float error;
-    if (distanciaActual < distanciaMin) {
+    // Error respecto al borde más cercano de la zona muerta
+    int32_t errorQ;
+    if (distanciaQ < distanciaMinQ) {
         // Está demasiado cerca, retroceder (velocidad negativa)
-        error = distanciaActual - distanciaMin; // Negativo
+        errorQ = distanciaQ - distanciaMinQ; // Negativo
         estadoMovimiento = "RETROCEDIENDO";
     } else {
         // Está demasiado lejos, avanzar (velocidad positiva)
-        error = distanciaActual - distanciaMax; // Positivo
+        errorQ = distanciaQ - distanciaMaxQ; // Positivo
         estadoMovimiento = "AVANZANDO";
     }
     
-    // Calcular velocidad proporcional al error (control más suave)
-    // INVERTIMOS el signo para corregir la dirección
-    int velocidad = -(int)(kp * error);
+    // La prealimentación usa la velocidad del hueco (si el de delante se
+    // aleja, avanzar más; si se acerca, menos)
+    int velocidad = pid.actualizar(errorQ, velocidadHuecoQ);
     
-    // Limitar velocidad entre -255 y 255
-    if (velocidad > 255) velocidad = 255;
-    if (velocidad < -255) velocidad = -255;
+    // INVERTIMOS el signo para corregir la dirección
+    velocidad = -velocidad;
     
-    // Aplicar velocidad mínima más alta para que los motores se muevan
-    if (velocidad > 0 && velocidad < 120) velocidad = 120;
-    if (velocidad < 0 && velocidad > -120) velocidad = -120;
+    // Aplicar velocidad mínima para que los motores se muevan
+    if (velocidad > 0 && velocidad < pwmMinimo) velocidad = pwmMinimo;
+    if (velocidad < 0 && velocidad > -pwmMinimo) velocidad = -pwmMinimo;
     
     // Mover motores
-    moverMotores(velocidad, velocidad);
+    ordenControl(velocidad, velocidad, false);
+}
+
+// Orden del control: al momento o, en el maestro con órdenes programadas,
+// retardoAplicacion después. Los comandos llevan ya esta orden y su instante
+void Coche::ordenControl(int velocidadIzq, int velocidadDer, bool parada) {
+    if (!esMaestro || retardoAplicacion == 0) {
+        if (parada) detenerMotores();
+        else moverMotores(velocidadIzq, velocidadDer);
+        return;
+    }
+    
+    OrdenProgramada orden;
+    orden.izq = velocidadIzq;
+    orden.der = velocidadDer;
+    orden.movimiento = MOV_PARADO;
+    orden.parada = parada;
+    orden.instante = halMicros() + retardoAplicacion;
+    ultimaVelocidadIzq = velocidadIzq;
+    ultimaVelocidadDer = velocidadDer;
+    aplicarEnEnviado = orden.instante != 0 ? orden.instante : 1;
+    programarOrden(orden);
 }
 
-// Mover motores (privado)
+// Mover motores (privado): fija el objetivo de cada rueda; el impulso de
+// arranque y la rampa los completa atenderMotores() sin bloquear
 void Coche::moverMotores(int velocidadIzq, int velocidadDer) {
-    // Guardar velocidades para ESP-NOW
+    // Guardar velocidades para ESP-NOW (una orden al momento: sin instante)
     ultimaVelocidadIzq = velocidadIzq;
     ultimaVelocidadDer = velocidadDer;
+    aplicarEnEnviado = 0;
+    fijarMotores(velocidadIzq, velocidadDer);
+}
+
+// Objetivo de las ruedas, sin tocar lo que mandan los comandos
+void Coche::fijarMotores(int velocidadIzq, int velocidadDer) {
+    fusion.registrarPropio((velocidadIzq + velocidadDer) / 2, halMicros());
     
-    // Motor izquierdo (motor1)
-    if (velocidadIzq >= 0) {
-        analogWrite(motor1A, velocidadIzq);
-        analogWrite(motor1B, 0);
-    } else {
-        analogWrite(motor1A, 0);
-        analogWrite(motor1B, -velocidadIzq);
+    if (traza.activa()) {
+        EventoTrazaMotor evento = {(int16_t)velocidadIzq, (int16_t)velocidadDer, 0};
+        traza.registrar(TRAZA_MOTOR, halMicros(), &evento, sizeof(evento));
     }
     
-    // Motor derecho (motor2)
-    if (velocidadDer >= 0) {
-        analogWrite(motor2A, velocidadDer);
-        analogWrite(motor2B, 0);
-    } else {
-        analogWrite(motor2A, 0);
-        analogWrite(motor2B, -velocidadDer);
+    rampaIzq.setObjetivo(velocidadIzq);
+    rampaDer.setObjetivo(velocidadDer);
+    avanzarRampas();
+}
+
+// Órdenes programadas que ya tocan, impulso y rampa (tarea "motores")
+void Coche::atenderMotores() {
+    atenderProgramadas();
+    avanzarRampas();
+}
+
+// Avanzar el perfil de cada rueda y escribir solo lo que cambia
+void Coche::avanzarRampas() {
+    unsigned long ahora = halMicros();
+    int16_t izq = rampaIzq.avanzar(ahora);
+    int16_t der = rampaDer.avanzar(ahora);
+    
+    if (izq != pwmAplicadoIzq || der != pwmAplicadoDer) {
+        escribirMotores(izq, der);
+        pwmAplicadoIzq = izq;
+        pwmAplicadoDer = der;
     }
 }
 
-// Detener motores (privado y público)
+// Escribir los cuatro canales de los L9110S como una sola actualización:
+// primero los que se apagan y después los que se encienden, de modo que ningún
+// puente tiene sus dos entradas activas a la vez (el instante en que el motor
+// frena o tira hacia el lado contrario al invertir). Solo se escriben los
+// canales que cambian: cada analogWrite() rehace la tabla de PWM del core.
+void Coche::escribirMotores(int16_t izq, int16_t der) {
+    const int pines[4] = {motor1A, motor1B, motor2A, motor2B};
+    const int16_t valores[4] = {
+        (int16_t)(izq > 0 ? izq : 0), (int16_t)(izq < 0 ? -izq : 0),  // Motor izquierdo (motor1)
+        (int16_t)(der > 0 ? der : 0), (int16_t)(der < 0 ? -der : 0)   // Motor derecho (motor2)
+    };
+    
+    for (uint8_t i = 0; i < 4; i++) {
+        if (valores[i] == 0 && pwmCanal[i] != 0) {
+            halEscribirPWM(pines[i], 0);
+            pwmCanal[i] = 0;
+        }
+    }
+    for (uint8_t i = 0; i < 4; i++) {
+        if (valores[i] != pwmCanal[i]) {
+            halEscribirPWM(pines[i], valores[i]);
+            pwmCanal[i] = valores[i];
+        }
+    }
+}
+
+// Detener motores (privado y público): inmediato, sin rampa
 void Coche::detenerMotores() {
-    analogWrite(motor1A, 0);
-    analogWrite(motor1B, 0);
-    analogWrite(motor2A, 0);
-    analogWrite(motor2B, 0);
+    if (traza.activa()) {
+        EventoTrazaMotor evento = {0, 0, 1};
+        traza.registrar(TRAZA_MOTOR, halMicros(), &evento, sizeof(evento));
+    }
+    fusion.registrarPropio(0, halMicros());
+    rampaIzq.detener();
+    rampaDer.detener();
+    pwmAplicadoIzq = 0;
+    pwmAplicadoDer = 0;
+    escribirMotores(0, 0);
 }
 
 void Coche::detener() {
+    aplicarEnEnviado = 0;
     detenerMotores();
 }
 
@@ -251,12 +389,85 @@ void Coche::setDistanciaObjetivo(float distancia) {
 void Coche::setRangoDistancia(float minDist, float maxDist) {
     distanciaMin = minDist;
     distanciaMax = maxDist;
+    distanciaMinQ = ControladorPID::aQ16(minDist);
+    distanciaMaxQ = ControladorPID::aQ16(maxDist);
     distanciaObjetivo = (minDist + maxDist) / 2.0;
 }
 
+// Configurar la distancia a la que el esclavo deja de obedecer "avanzar"
+void Coche::setDistanciaSeguridad(float distancia) {
+    distanciaSeguridad = distancia;
+}
+
+// Configurar qué hace el esclavo cuando dejan de llegar comandos
+void Coche::configurarPerdidaMando(unsigned long horizonteMs, unsigned long presupuestoMs,
+                                   unsigned long decaimientoMs) {
+    mando.configurar(horizonteMs * 1000UL, presupuestoMs * 1000UL, decaimientoMs * 1000UL);
+}
+
+// Activar el control propio del esclavo sobre el hueco fusionado
+void Coche::setFusionHueco(bool activa) {
+    fusionActiva = activa;
+    olvidarMando();
+}
+
+// Configurar el modelo de los motores de la fusión
+void Coche::configurarFusion(float cmsPorPWM, int16_t pwmBanda, unsigned long constanteMs) {
+    fusion.configurar(cmsPorPWM, pwmBanda, constanteMs * 1000UL);
+}
+
+// Configurar la sincronía de reloj y el retardo de las órdenes programadas
+void Coche::configurarSincronia(unsigned long periodoMs, unsigned long retardoMs) {
+    periodoSincronia = periodoMs * 1000UL;
+    retardoAplicacion = retardoMs * 1000UL;
+    olvidarMando();
+}
+
 // Configurar constante proporcional
 void Coche::setConstanteProporcional(float kp_value) {
-    kp = kp_value;
+    pid.setKp(kp_value);
+}
+
+// Configurar constante integral (1/s)
+void Coche::setConstanteIntegral(float ki_value) {
+    pid.setKi(ki_value);
+}
+
+// Configurar constante derivativa (s)
+void Coche::setConstanteDerivativa(float kd_value) {
+    pid.setKd(kd_value);
+}
+
+// Configurar prealimentación de la velocidad del obstáculo
+void Coche::setFeedForward(float kff_value) {
+    pid.setFeedForward(kff_value);
+}
+
+// Configurar PWM mínimo de arranque de los motores
+void Coche::setPWMMinimo(int16_t pwm) {
+    pwmMinimo = pwm;
+}
+
+// Configurar impulso de arranque y límites de pendiente/tirón de los motores
+void Coche::configurarMotores(int16_t pwmImpulso, unsigned long impulsoMs,
+                              uint16_t pendienteMax, uint32_t tironMax) {
+    rampaIzq.configurar(pwmImpulso, impulsoMs * 1000UL, pendienteMax, tironMax);
+    rampaDer.configurar(pwmImpulso, impulsoMs * 1000UL, pendienteMax, tironMax);
+}
+
+// Configurar filtro de distancia (mediana o Kalman) y su ventana
+void Coche::setFiltroDistancia(FiltroDistancia::Modo modo, uint8_t ventana) {
+    filtro.configurar(modo, ventana);
+}
+
+// Varianza de la distancia estimada
+float Coche::obtenerVarianzaDistancia() {
+    return filtro.obtenerVarianza();
+}
+
+// Velocidad con la que cambia la distancia (positiva = se aleja)
+float Coche::obtenerVelocidadDistancia() {
+    return filtro.obtenerVelocidad();
 }
 
 // Obtener estado de movimiento actual
@@ -271,7 +482,7 @@ void Coche::inicializarWiFi(const char* ssid, const char* password) {
     
     int intentos = 0;
     while (WiFi.status() != WL_CONNECTED && intentos < 20) {
-        delay(500);
+        halEsperar(500);
         Serial.print(".");
         intentos++;
     }
@@ -285,145 +496,199 @@ void Coche::inicializarWiFi(const char* ssid, const char* password) {
     }
 }
 
+// Aplicar una orden que cambia el estado (siempre desde loop())
+const char* Coche::aplicarOrdenWeb(uint8_t orden) {
+    switch (orden) {
+        case ORDEN_MODO_MAESTRO:
+        case ORDEN_MODO_ESCLAVO:
+            if (rolFijo) return "Rol fijo";
+            cambiarModo(orden == ORDEN_MODO_MAESTRO);
+            return "Modo cambiado";
+        case ORDEN_ALTERNAR_AUTOMATICO:
+            modoAutomatico = !modoAutomatico;
+            if (!modoAutomatico) {
+                detener();  // Detener al cambiar a manual
+            }
+            return modoAutomatico ? "Automático" : "Manual";
+        case ORDEN_ALTERNAR_LUCES:
+            toggleLuces();
+            return estadoLuces ? "Luces encendidas" : "Luces apagadas";
+        case ORDEN_ALTERNAR_LUCES_AUTO:
+            lucesAutomaticas = !lucesAutomaticas;
+            if (!lucesAutomaticas) {
+                apagarLuces();  // Apagar al desactivar automático
+            }
+            return lucesAutomaticas ? "Luces automáticas" : "Luces manuales";
+        case ORDEN_REINICIAR_LATENCIAS:
+            reiniciarLatencias();
+            return "Latencias reiniciadas";
+        case ORDEN_REINICIAR_TAREAS:
+            planificador.reiniciarEstadisticas();
+            return "Estadísticas de tareas reiniciadas";
+    }
+    return "Orden desconocida";
+}
+
+#ifdef COCHE_SERVIDOR_ASINCRONO
+
+// Inicializar servidor web asíncrono (ESPAsyncWebServer). Los manejadores
+// corren en la pila TCP, fuera de loop(), y las órdenes que cambian el estado
+// se encolan para que atenderClientes() las aplique en loop().
+//
+// /, /datos, /latencia y /tareas sí tocan lo mismo que loop() (el buffer y
+// la instantánea de telemetría, los histogramas) sin copia ni cerrojo. Es
+// seguro porque en el ESP8266 la pila TCP corre en el contexto del sistema,
+// que es cooperativo: solo entra cuando loop() vuelve o llama a yield() o
+// delay(), nunca a mitad de una función. Ninguna tarea cede la CPU con esos
+// datos a medias; una que lo haga tendría que pasarlos por un Buzon. Servir
+// una copia a través de RanuraUltimoValor costaría dos buffers más de 4,7 KB
+// (la ranura y el del manejador) para proteger algo que no puede ocurrir.
+void Coche::inicializarServidorWeb() {
+    servidor = new AsyncWebServer(80);
+    
+    // Encolar una orden y contestar sin esperar a que se aplique
+    auto encolarOrden = [this](AsyncWebServerRequest* peticion, uint8_t orden) {
+        if (ordenesWeb.poner(orden)) {
+            peticion->send(202, "text/plain", "Orden aceptada");
+        } else {
+            peticion->send(503, "text/plain", "Demasiadas órdenes pendientes");
+        }
+    };
+    
+    // Ruta raíz - página comprimida desde flash, 304 si el navegador ya la tiene
+    servidor->on("/", HTTP_GET, [this](AsyncWebServerRequest* peticion) {
+        unsigned long inicio = halMicros();
+        AsyncWebServerResponse* respuesta;
+        if (peticion->hasHeader("If-None-Match") && peticion->getHeader("If-None-Match")->value() == PANEL_ETAG) {
+            respuesta = peticion->beginResponse(304);
+        } else {
+            respuesta = peticion->beginResponse_P(200, "text/html", PANEL_GZ, PANEL_GZ_LONGITUD);
+            respuesta->addHeader("Content-Encoding", "gzip");
+        }
+        respuesta->addHeader("ETag", PANEL_ETAG);
+        respuesta->addHeader("Cache-Control", "no-cache");
+        registrarPanel(inicio);
+        peticion->send(respuesta);
+    });
+    
+    // Ruta para obtener datos en JSON (la librería copia el cuerpo)
+    servidor->on("/datos", HTTP_GET, [this](AsyncWebServerRequest* peticion) {
+        escribirDatosJSON(bufferTelemetria, sizeof(bufferTelemetria));
+        peticion->send(200, "application/json", bufferTelemetria);
+    });
+    
+    // Ruta con percentiles de latencia (?reiniciar=1 los vacía)
+    servidor->on("/latencia", HTTP_GET, [this](AsyncWebServerRequest* peticion) {
+        if (peticion->hasParam("reiniciar")) {
+            ordenesWeb.poner(ORDEN_REINICIAR_LATENCIAS);
+        }
+        peticion->send(200, "application/json", obtenerLatenciaJSON());
+    });
+    
+    // Ruta con periodo, ejecución y retrasos de cada tarea (?reiniciar=1 los vacía)
+    servidor->on("/tareas", HTTP_GET, [this](AsyncWebServerRequest* peticion) {
+        if (peticion->hasParam("reiniciar")) {
+            ordenesWeb.poner(ORDEN_REINICIAR_TAREAS);
+        }
+        planificador.escribirJSON(bufferTelemetria, sizeof(bufferTelemetria));
+        peticion->send(200, "application/json", bufferTelemetria);
+    });
+    
+    // Ruta para cambiar modo maestro/esclavo
+    servidor->on("/modo", HTTP_GET, [encolarOrden](AsyncWebServerRequest* peticion) {
+        if (peticion->hasParam("maestro")) {
+            bool nuevoModo = (peticion->getParam("maestro")->value() == "1");
+            encolarOrden(peticion, nuevoModo ? ORDEN_MODO_MAESTRO : ORDEN_MODO_ESCLAVO);
+        } else {
+            peticion->send(400, "text/plain", "Parámetro incorrecto");
+        }
+    });
+    
+    servidor->on("/automatico", HTTP_GET, [encolarOrden](AsyncWebServerRequest* peticion) {
+        encolarOrden(peticion, ORDEN_ALTERNAR_AUTOMATICO);
+    });
+    
+    servidor->on("/luces/toggle", HTTP_GET, [encolarOrden](AsyncWebServerRequest* peticion) {
+        encolarOrden(peticion, ORDEN_ALTERNAR_LUCES);
+    });
+    
+    servidor->on("/luces/auto", HTTP_GET, [encolarOrden](AsyncWebServerRequest* peticion) {
+        encolarOrden(peticion, ORDEN_ALTERNAR_LUCES_AUTO);
+    });
+    
+    // Descarga de la traza binaria tal como está en LittleFS
+    servidor->on("/traza", HTTP_GET, [this](AsyncWebServerRequest* peticion) {
+        if (rutaTraza == nullptr) {
+            peticion->send(404, "text/plain", "Traza no activa");
+            return;
+        }
+        peticion->send(LittleFS, rutaTraza, "application/octet-stream", true);
+    });
+    
+    // Flujo de telemetría (/eventos)
+    eventos.adjuntar(*servidor);
+    
+    servidor->begin();
+    Serial.println("Servidor web asíncrono iniciado en el puerto 80");
+}
+
+#else
+
 // Inicializar servidor web
 void Coche::inicializarServidorWeb() {
     servidor = new ESP8266WebServer(80);
     
-    // Ruta raíz - página HTML con controles de modo y luces
+    // El navegador revalida la página con If-None-Match
+    static const char* cabecerasPanel[] = {"If-None-Match"};
+    servidor->collectHeaders(cabecerasPanel, 1);
+    
+    // Ruta raíz - página HTML con controles de modo y luces, servida tal cual
+    // desde flash ya comprimida (ver extras/panel/generar_panel.py)
     servidor->on("/", [this]() {
-        String html = "<!DOCTYPE html><html><head>";
-        html += "<meta charset='UTF-8'>";
-        html += "<meta name='viewport' content='width=device-width, initial-scale=1.0'>";
-        html += "<title>Control Coche Robot</title>";
-        html += "<style>";
-        html += "body { font-family: Arial, sans-serif; max-width: 600px; margin: 20px auto; padding: 20px; background: #f0f0f0; }";
-        html += ".card { background: white; border-radius: 10px; padding: 20px; margin: 15px 0; box-shadow: 0 2px 5px rgba(0,0,0,0.1); }";
-        html += "h1 { color: #333; text-align: center; margin-bottom: 5px; }";
-        html += ".sensor { display: flex; justify-content: space-between; align-items: center; margin: 10px 0; padding: 15px; background: #f9f9f9; border-radius: 5px; }";
-        html += ".sensor-label { font-weight: bold; color: #555; }";
-        html += ".sensor-value { font-size: 24px; color: #007bff; }";
-        html += ".unit { font-size: 16px; color: #666; margin-left: 5px; }";
-        html += ".estado { text-align: center; padding: 20px; border-radius: 10px; font-size: 28px; font-weight: bold; margin: 15px 0; transition: all 0.3s; }";
-        html += ".parado { background: #ffc107; color: #000; }";
-        html += ".avanzando { background: #28a745; color: white; }";
-        html += ".retrocediendo { background: #dc3545; color: white; }";
-        html += ".modo { text-align: center; padding: 15px; border-radius: 10px; font-size: 20px; font-weight: bold; margin: 10px 0; }";
-        html += ".maestro { background: #007bff; color: white; }";
-        html += ".esclavo { background: #6c757d; color: white; }";
-        html += ".luces { text-align: center; padding: 15px; border-radius: 10px; font-size: 18px; font-weight: bold; margin: 10px 0; transition: all 0.3s; }";
-        html += ".luces-on { background: #ffd700; color: #000; }";
-        html += ".luces-off { background: #333; color: #999; }";
-        html += ".btn { display: block; width: 100%; padding: 15px; margin: 10px 0; font-size: 18px; font-weight: bold; border: none; border-radius: 5px; cursor: pointer; transition: all 0.3s; }";
-        html += ".btn-maestro { background: #007bff; color: white; }";
-        html += ".btn-maestro:hover { background: #0056b3; }";
-        html += ".btn-esclavo { background: #6c757d; color: white; }";
-        html += ".btn-esclavo:hover { background: #545b62; }";
-        html += ".btn-auto { background: #28a745; color: white; }";
-        html += ".btn-auto:hover { background: #218838; }";
-        html += ".btn-manual { background: #ffc107; color: black; }";
-        html += ".btn-manual:hover { background: #e0a800; }";
-        html += ".btn-luces { background: #ffd700; color: black; }";
-        html += ".btn-luces:hover { background: #ffed4e; }";
-        html += ".modo-control { display: flex; gap: 10px; }";
-        html += ".modo-control .btn { flex: 1; }";
-        html += ".sensores-activos { font-size: 14px; color: #666; margin: 5px 0; }";
-        html += ".sensor-activo { display: inline-block; margin: 5px 8px; padding: 5px 10px; background: #28a745; color: white; border-radius: 15px; font-size: 12px; }";
-        html += ".sensor-inactivo { display: inline-block; margin: 5px 8px; padding: 5px 10px; background: #ccc; color: #666; border-radius: 15px; font-size: 12px; }";
-        html += ".estadistica { display: inline-block; margin: 5px; padding: 8px 12px; background: #007bff; color: white; border-radius: 5px; font-size: 14px; font-weight: bold; }";
-        html += "</style>";
-        html += "<script>";
-        html += "function actualizarDatos() {";
-        html += "  fetch('/datos').then(r => r.json()).then(data => {";
-        html += "    document.getElementById('distancia').innerHTML = data.distancia.toFixed(1) + ' <span class=\"unit\">cm</span>';";
-        html += "    var origenTexto = '';";
-        html += "    if (data.origenDatos === 'LOCAL') { origenTexto = ' 📡'; }";
-        html += "    else if (data.origenDatos === 'REMOTO') { origenTexto = ' 📶'; }";
-        html += "    else { origenTexto = ' ❌'; }";
-        html += "    document.getElementById('temperatura').innerHTML = data.temperatura.toFixed(1) + ' <span class=\"unit\">°C</span>' + origenTexto;";
-        html += "    document.getElementById('luz').innerHTML = (data.luz ? '☀️ Detectada' : '🌙 Oscuro') + origenTexto;";
-        html += "    var estadoDiv = document.getElementById('estado');";
-        html += "    estadoDiv.className = 'card estado ' + data.estado.toLowerCase();";
-        html += "    var icono = data.estado === 'AVANZANDO' ? '⬆️' : (data.estado === 'RETROCEDIENDO' ? '⬇️' : '⏸️');";
-        html += "    estadoDiv.innerHTML = icono + ' ' + data.estado;";
-        html += "    var modoDiv = document.getElementById('modo');";
-        html += "    modoDiv.className = 'card modo ' + (data.modo === 'MAESTRO' ? 'maestro' : 'esclavo');";
-        html += "    modoDiv.innerHTML = (data.modo === 'MAESTRO' ? '👑 ' : '🤖 ') + data.modo;";
-        html += "    var autoDiv = document.getElementById('modoAuto');";
-        html += "    autoDiv.innerHTML = (data.automatico ? '🤖 AUTOMÁTICO' : '🎮 MANUAL');";
-        html += "    if (data.lucesDisponibles) {";
-        html += "      document.getElementById('seccionLuces').style.display = 'block';";
-        html += "      var lucesDiv = document.getElementById('estadoLuces');";
-        html += "      lucesDiv.className = 'card luces ' + (data.lucesEncendidas ? 'luces-on' : 'luces-off');";
-        html += "      lucesDiv.innerHTML = (data.lucesEncendidas ? '💡 LUCES ENCENDIDAS' : '🌑 LUCES APAGADAS');";
-        html += "      document.getElementById('btnLucesAuto').innerHTML = (data.lucesAutomaticas ? '🤖 LUCES AUTO' : '🎮 LUCES MANUAL');";
-        html += "    } else {";
-        html += "      document.getElementById('seccionLuces').style.display = 'none';";
-        html += "    }";
-        html += "    var sensoresHTML = '';";
-        html += "    sensoresHTML += data.sensorUltrasonico ? '<span class=\"sensor-activo\">📏 HC-SR04</span>' : '<span class=\"sensor-inactivo\">📏 HC-SR04</span>';";
-        html += "    sensoresHTML += data.sensorTemperatura ? '<span class=\"sensor-activo\">🌡️ LM35</span>' : '<span class=\"sensor-inactivo\">🌡️ LM35</span>';";
-        html += "    sensoresHTML += data.sensorLuminosidad ? '<span class=\"sensor-activo\">💡 LM393</span>' : '<span class=\"sensor-inactivo\">💡 LM393</span>';";
-        html += "    sensoresHTML += data.sensorLuces ? '<span class=\"sensor-activo\">💡 LED</span>' : '<span class=\"sensor-inactivo\">💡 LED</span>';";
-        html += "    document.getElementById('sensoresActivos').innerHTML = sensoresHTML;";
-        html += "  });";
-        html += "}";
-        html += "function cambiarModo(maestro) {";
-        html += "  fetch('/modo?maestro=' + (maestro ? '1' : '0')).then(() => setTimeout(actualizarDatos, 500));";
-        html += "}";
-        html += "function toggleAutomatico() {";
-        html += "  fetch('/automatico').then(() => setTimeout(actualizarDatos, 500));";
-        html += "}";
-        html += "function toggleLuces() {";
-        html += "  fetch('/luces/toggle').then(() => setTimeout(actualizarDatos, 200));";
-        html += "}";
-        html += "function toggleLucesAuto() {";
-        html += "  fetch('/luces/auto').then(() => setTimeout(actualizarDatos, 200));";
-        html += "}";
-        html += "setInterval(actualizarDatos, 500);";
-        html += "window.onload = actualizarDatos;";
-        html += "</script>";
-        html += "</head><body>";
-        html += "<h1>🚗 Control Coche Robot</h1>";
-        html += "<div class='card modo maestro' id='modo'>👑 MAESTRO</div>";
-        html += "<div class='card'>";
-        html += "<div class='modo-control'>";
-        html += "<button class='btn btn-maestro' onclick='cambiarModo(true)'>👑 Maestro</button>";
-        html += "<button class='btn btn-esclavo' onclick='cambiarModo(false)'>🤖 Esclavo</button>";
-        html += "</div>";
-        html += "<button class='btn btn-auto' id='modoAuto' onclick='toggleAutomatico()'>🤖 AUTOMÁTICO</button>";
-        html += "</div>";
-        html += "<div id='seccionLuces' style='display:none;'>";
-        html += "<div class='card luces luces-off' id='estadoLuces'>🌑 LUCES APAGADAS</div>";
-        html += "<div class='card'>";
-        html += "<button class='btn btn-luces' onclick='toggleLuces()'>💡 ON/OFF Luces</button>";
-        html += "<button class='btn btn-auto' id='btnLucesAuto' onclick='toggleLucesAuto()'>🤖 LUCES AUTO</button>";
-        html += "</div>";
-        html += "</div>";
-        html += "<div class='card estado parado' id='estado'>⏸️ PARADO</div>";
-        html += "<div class='card'>";
-        html += "<div class='sensor'><span class='sensor-label'>📏 Distancia:</span><span class='sensor-value' id='distancia'>-- cm</span></div>";
-        html += "<div class='sensor'><span class='sensor-label'>🌡️ Temperatura:</span><span class='sensor-value' id='temperatura'>-- °C</span></div>";
-        html += "<div class='sensor'><span class='sensor-label'>💡 Luminosidad:</span><span class='sensor-value' id='luz'>--</span></div>";
-        html += "</div>";
-        html += "<div class='card'>";
-        html += "<h3 style='margin-top:0; color:#333;'>🔧 Sensores Activos</h3>";
-        html += "<div class='sensores-activos' id='sensoresActivos'>Cargando...</div>";
-        html += "</div>";
-        html += "</body></html>";
-        servidor->send(200, "text/html", html);
+        unsigned long inicio = halMicros();
+        bool vigente = servidor->header("If-None-Match") == PANEL_ETAG;
+        servidor->sendHeader("ETag", PANEL_ETAG);
+        servidor->sendHeader("Cache-Control", "no-cache");  // Revalidar siempre: 304 si no cambió
+        if (!vigente) {
+            servidor->sendHeader("Content-Encoding", "gzip");
+        }
+        registrarPanel(inicio);
+        if (vigente) {
+            servidor->send(304);
+        } else {
+            servidor->send_P(200, PSTR("text/html"), (PGM_P)PANEL_GZ, PANEL_GZ_LONGITUD);
+        }
     });
     
     // Ruta para obtener datos en JSON
     servidor->on("/datos", [this]() {
-        servidor->send(200, "application/json", obtenerDatosJSON());
+        size_t longitud = escribirDatosJSON(bufferTelemetria, sizeof(bufferTelemetria));
+        servidor->send(200, "application/json", bufferTelemetria, longitud);
+    });
+    
+    // Ruta con percentiles de latencia (?reiniciar=1 los vacía)
+    servidor->on("/latencia", [this]() {
+        String json = obtenerLatenciaJSON();
+        if (servidor->hasArg("reiniciar")) {
+            aplicarOrdenWeb(ORDEN_REINICIAR_LATENCIAS);
+        }
+        servidor->send(200, "application/json", json);
+    });
+    
+    // Ruta con periodo, ejecución y retrasos de cada tarea (?reiniciar=1 los vacía)
+    servidor->on("/tareas", [this]() {
+        size_t longitud = planificador.escribirJSON(bufferTelemetria, sizeof(bufferTelemetria));
+        if (servidor->hasArg("reiniciar")) {
+            aplicarOrdenWeb(ORDEN_REINICIAR_TAREAS);
+        }
+        servidor->send(200, "application/json", bufferTelemetria, longitud);
     });
     
     // Ruta para cambiar modo maestro/esclavo
     servidor->on("/modo", [this]() {
         if (servidor->hasArg("maestro")) {
             bool nuevoModo = (servidor->arg("maestro") == "1");
-            cambiarModo(nuevoModo);
-            servidor->send(200, "text/plain", "Modo cambiado");
+            servidor->send(200, "text/plain", aplicarOrdenWeb(nuevoModo ? ORDEN_MODO_MAESTRO : ORDEN_MODO_ESCLAVO));
         } else {
             servidor->send(400, "text/plain", "Parámetro incorrecto");
         }
@@ -431,175 +696,397 @@ void Coche::inicializarServidorWeb() {
     
     // Ruta para toggle modo automático/manual
     servidor->on("/automatico", [this]() {
-        modoAutomatico = !modoAutomatico;
-        if (!modoAutomatico) {
-            detener();  // Detener al cambiar a manual
-        }
-        servidor->send(200, "text/plain", modoAutomatico ? "Automático" : "Manual");
+        servidor->send(200, "text/plain", aplicarOrdenWeb(ORDEN_ALTERNAR_AUTOMATICO));
     });
     
     // Ruta para toggle luces ON/OFF
     servidor->on("/luces/toggle", [this]() {
-        toggleLuces();
-        servidor->send(200, "text/plain", estadoLuces ? "Luces encendidas" : "Luces apagadas");
+        servidor->send(200, "text/plain", aplicarOrdenWeb(ORDEN_ALTERNAR_LUCES));
     });
     
     // Ruta para toggle modo automático de luces
     servidor->on("/luces/auto", [this]() {
-        lucesAutomaticas = !lucesAutomaticas;
-        if (!lucesAutomaticas) {
-            apagarLuces();  // Apagar al desactivar automático
+        servidor->send(200, "text/plain", aplicarOrdenWeb(ORDEN_ALTERNAR_LUCES_AUTO));
+    });
+    
+#ifndef COCHE_HOST
+    // Descarga de la traza binaria (se vuelca lo pendiente antes)
+    servidor->on("/traza", [this]() {
+        if (rutaTraza == nullptr) {
+            servidor->send(404, "text/plain", "Traza no activa");
+            return;
+        }
+        guardarTraza();
+        File fichero = LittleFS.open(rutaTraza, "r");
+        servidor->streamFile(fichero, "application/octet-stream");
+        fichero.close();
+    });
+#endif
+    
+    // Flujo de telemetría: estado completo al conectar y luego solo cambios
+    servidor->on("/eventos", [this]() {
+        WiFiClient cliente = servidor->client();
+        if (!eventos.agregar(cliente)) {
+            servidor->send(503, "text/plain", "Demasiados oyentes");
         }
-        servidor->send(200, "text/plain", lucesAutomaticas ? "Luces automáticas" : "Luces manuales");
     });
     
     servidor->begin();
     Serial.println("Servidor web iniciado en el puerto 80");
 }
 
+#endif
+
+// Justo antes de que salga el primer byte de la página: tiempo desde que
+// entró la petición y heap libre cuando el manejador retiene más memoria
+void Coche::registrarPanel(unsigned long inicio) {
+    histPanel.registrar(halMicros() - inicio);
+    uint32_t heapLibre = halHeapLibre();
+    if (heapLibre < heapMinimoPanel) heapMinimoPanel = heapLibre;
+}
+
 // Atender peticiones de clientes
 void Coche::atenderClientes() {
     if (servidor) {
+#ifdef COCHE_SERVIDOR_ASINCRONO
+        // Las peticiones ya se atendieron en la pila TCP; aquí solo sus órdenes
+        uint8_t orden;
+        while (ordenesWeb.sacar(orden)) {
+            aplicarOrdenWeb(orden);
+        }
+#else
         servidor->handleClient();
+#endif
+        atenderEventos();
     }
 }
 
-// Obtener datos de sensores en formato JSON
-String Coche::obtenerDatosJSON() {
-    // Actualizar lecturas usando los métodos que manejan sensores compartidos
-    ultimaDistancia = leerDistancia();
-    float tempActual = obtenerTemperaturaActual();
-    int luzActual = obtenerLuminosidadActual();
-    String origenDatos = obtenerOrigenDatos();
+// Publicar cambios a los navegadores suscritos. Se serializa una sola vez
+// por evento, haya uno o varios oyentes.
+void Coche::atenderEventos() {
+    unsigned long ahora = halMillis();
+    if (ahora - ultimoEvento < intervaloEventos) return;
+    if (eventos.cantidad() == 0) return;
+    ultimoEvento = ahora;
+    
+    tomarInstantanea(instantanea);
+    
+    // Oyentes nuevos o que perdieron un evento: estado completo
+    if (eventos.faltaCompleto()) {
+        size_t longitud = escribirTelemetriaJSON(instantanea, bufferTelemetria, sizeof(bufferTelemetria));
+        eventos.publicar(bufferTelemetria, longitud, true);
+    }
     
-    String json = "{";
-    json += "\"distancia\":" + String(ultimaDistancia, 2) + ",";
-    json += "\"temperatura\":" + String(tempActual, 2) + ",";
-    json += "\"luz\":" + String(luzActual) + ",";
-    json += "\"estado\":\"" + estadoMovimiento + "\",";
-    json += "\"modo\":\"" + obtenerModoTexto() + "\",";
-    json += "\"automatico\":" + String(modoAutomatico ? "true" : "false") + ",";
-    json += "\"lucesDisponibles\":" + String(pinLuces >= 0 ? "true" : "false") + ",";
-    json += "\"lucesEncendidas\":" + String(estadoLuces ? "true" : "false") + ",";
-    json += "\"lucesAutomaticas\":" + String(lucesAutomaticas ? "true" : "false") + ",";
-    json += "\"tieneSensores\":" + String(tieneSensoresLocales ? "true" : "false") + ",";
-    json += "\"origenDatos\":\"" + origenDatos + "\",";
-    
-    // Información de sensores activos
-    json += "\"sensorUltrasonico\":" + String(trigPin >= 0 && echoPin >= 0 ? "true" : "false") + ",";
-    json += "\"sensorTemperatura\":" + String(tempPin >= 0 ? "true" : "false") + ",";
-    json += "\"sensorLuminosidad\":" + String(lightPin >= 0 ? "true" : "false") + ",";
-    json += "\"sensorLuces\":" + String(pinLuces >= 0 ? "true" : "false") + ",";
-    
-    // Estadísticas ESP-NOW
-    json += "\"mensajesEnviados\":" + String(mensajesEnviados) + ",";
-    json += "\"mensajesRecibidos\":" + String(mensajesRecibidos) + ",";
-    json += "\"mensajesFallidos\":" + String(mensajesFallidos) + ",";
-    json += "\"tasaExito\":" + String(obtenerTasaExito(), 1);
+    // El resto: solo lo que cambió desde el último evento
+    size_t longitud = escribirTelemetriaDeltaJSON(instantanea, instantaneaPublicada,
+                                                 bufferTelemetria, sizeof(bufferTelemetria));
+    if (longitud > TELEMETRIA_DELTA_VACIO) {
+        eventos.publicar(bufferTelemetria, longitud, false);
+        ultimoLatido = ahora;
+    } else if (ahora - ultimoLatido > 15000) {
+        eventos.latido();
+        ultimoLatido = ahora;
+    }
+    instantaneaPublicada = instantanea;
+}
+
+// Fijar el intervalo mínimo entre eventos (ms)
+void Coche::setIntervaloEventos(unsigned long ms) {
+    intervaloEventos = ms;
+}
+
+// Navegadores suscritos a /eventos
+uint8_t Coche::obtenerOyentes() {
+    return eventos.cantidad();
+}
+
+// Copiar el estado publicado sin leer sensores: distancia, temperatura y
+// luz son las últimas lecturas hechas por el control y los envíos
+void Coche::tomarInstantanea(InstantaneaTelemetria& t) {
+    unsigned long ahora = halMillis();
+    InfoPar* remoto = tieneSensoresLocales ? nullptr : pares.masRecienteConSensores(ahora, 5000);
+    
+    t.distancia = ultimaDistancia;
+    t.varianzaDistancia = filtro.obtenerVarianza();
+    t.velocidadDistancia = filtro.obtenerVelocidad();
+    if (tieneSensoresLocales) {
+        t.temperatura = tempPin >= 0 ? ultimaTemperatura : -999;
+        t.luz = ultimaLuz;
+        t.origenDatos = ORIGEN_LOCAL;
+    } else if (remoto != nullptr) {
+        t.temperatura = remoto->temperatura;
+        t.luz = remoto->luminosidad;
+        t.origenDatos = ORIGEN_REMOTO;
+    } else {
+        t.temperatura = -999;
+        t.luz = -1;
+        t.origenDatos = ORIGEN_SIN_DATOS;
+    }
     
-    json += "}";
-    return json;
+    t.movimiento = codigoMovimiento(estadoMovimiento.c_str());
+    t.esMaestro = esMaestro;
+    t.automatico = modoAutomatico;
+    t.lucesDisponibles = pinLuces >= 0;
+    t.lucesEncendidas = estadoLuces;
+    t.lucesAutomaticas = lucesAutomaticas;
+    t.tieneSensores = tieneSensoresLocales;
+    
+    t.sensorUltrasonico = trigPin >= 0 && echoPin >= 0;
+    t.sensorTemperatura = tempPin >= 0;
+    t.sensorLuminosidad = lightPin >= 0;
+    t.sensorLuces = pinLuces >= 0;
+    
+    t.mensajesEnviados = obtenerMensajesEnviados();
+    t.mensajesRecibidos = mensajesRecibidos;
+    t.mensajesFallidos = obtenerMensajesFallidos();
+    t.reintentos = colaEnvio.obtenerReintentos();
+    t.timeoutsACK = colaEnvio.obtenerTimeouts();
+    t.comandosSobrescritos = obtenerComandosSobrescritos();
+    t.desbordesBuzon = obtenerDesbordesBuzon();
+    t.tasaExito = obtenerTasaExito();
+    t.silenciosMando = mando.obtenerSilencios();
+    t.paradasPorSilencio = mando.obtenerParadas();
+    t.errorExtrapolacion = mando.obtenerErrorMedio();
+    t.controlPropio = siguiendoHueco;
+    t.huecoFusion = siguiendoHueco ? fusion.obtenerDistancia() : 0;
+    unsigned long ahoraUs = halMicros();
+    t.relojSincronizado = reloj.sincronizado(ahoraUs);
+    t.desfaseReloj = reloj.obtenerDesfase(ahoraUs);
+    t.derivaReloj = reloj.obtenerDeriva();
+    t.errorReloj = reloj.obtenerError(ahoraUs);
+    t.comandosTarde = comandosTarde;
+    
+    t.numPares = pares.cantidad();
+    for (uint8_t i = 0; i < t.numPares; i++) {
+        InfoPar* par = pares.obtener(i);
+        InstantaneaPar& destino = t.pares[i];
+        memcpy(destino.mac, par->mac, 6);
+        destino.rol = par->rol;
+        destino.datosValidos = par->datosValidos;
+        destino.luz = par->luminosidad;
+        destino.temperatura = par->temperatura;
+        destino.vistoHace = ahora - par->ultimoVisto;
+        destino.recibidos = par->recibidos;
+        destino.perdidos = par->perdidos;
+        destino.duplicados = par->duplicados;
+        destino.reordenados = par->reordenados;
+    }
+}
+
+// Escribir los datos en JSON en un buffer del llamante (sin memoria dinámica)
+size_t Coche::escribirDatosJSON(char* destino, size_t tam) {
+    tomarInstantanea(instantanea);
+    return escribirTelemetriaJSON(instantanea, destino, tam);
+}
+
+// Obtener datos de sensores en formato JSON (copia en String por compatibilidad)
+String Coche::obtenerDatosJSON() {
+    escribirDatosJSON(bufferTelemetria, sizeof(bufferTelemetria));
+    return String(bufferTelemetria);
 }
 
 // ========== FUNCIONES ESP-NOW ==========
 
-// Variable global para instancia del coche (necesaria para callbacks)
-static Coche* instanciaCocheGlobal = nullptr;
+// Callback cuando se envía un mensaje ESP-NOW (datos); el contexto es el coche
+static void OnDataSent(void* contexto, const uint8_t* mac_addr, bool exitoso) {
+    static_cast<Coche*>(contexto)->recibirACK(exitoso);
+}
 
-// Callback cuando se envía un mensaje ESP-NOW (datos)
-void OnDataSent(uint8_t *mac_addr, uint8_t sendStatus) {
-    if (instanciaCocheGlobal != nullptr) {
-        bool exitoso = (sendStatus == 0);
-        instanciaCocheGlobal->registrarACK(exitoso);
-        
-        if (exitoso) {
-            // Serial.println("✓ ACK: Mensaje entregado");
-        } else {
-            Serial.println("✗ FALLO: Mensaje no entregado");
-        }
+// Rehacer la marca de salida de una trama justo antes de transmitirla: la
+// sincronía (t3) y la respuesta (t1 de una petición de sincronía, y lo
+// retenido desde el comando) no pueden contar la espera en la cola
+static void sellarAlTransmitir(uint8_t* datos, uint8_t longitud, unsigned long ahoraUs) {
+    uint8_t tipo = tipoTrama(datos, longitud);
+    if (tipo == TRAMA_SINCRONIA && longitud == sizeof(TramaSincronia)) {
+        TramaSincronia* sincronia = reinterpret_cast<TramaSincronia*>(datos);
+        sellarTrama(*sincronia, sincronia->cabecera.secuencia, ahoraUs);
+    } else if (tipo == TRAMA_RESPUESTA && longitud == sizeof(TramaRespuesta)) {
+        TramaRespuesta* respuesta = reinterpret_cast<TramaRespuesta*>(datos);
+        respuesta->retenidoUs += (uint32_t)ahoraUs - respuesta->cabecera.marcaTiempo;
+        sellarTrama(*respuesta, respuesta->cabecera.secuencia, ahoraUs);
     }
 }
 
+// Temperatura de una trama recibida; -999 si el emisor no tiene LM35
+static float temperaturaRecibida(uint8_t banderas, int16_t centesimas) {
+    return (banderas & BANDERA_SIN_TEMPERATURA) ? -999 : deCentesimas(centesimas);
+}
+
+// Argumentos de sensores para la bitácora según las banderas de la trama
+static int16_t temperaturaBitacora(uint8_t banderas, int16_t centesimas) {
+    if (!(banderas & BANDERA_SENSORES) || (banderas & BANDERA_SIN_TEMPERATURA)) return BITACORA_SIN_DATO;
+    return centesimas;
+}
+
+static int16_t luzBitacora(uint8_t banderas) {
+    if (!(banderas & BANDERA_SENSORES)) return BITACORA_SIN_DATO;
+    return (banderas & BANDERA_LUZ) ? 1 : 0;
+}
+
 // Callback cuando se recibe un mensaje ESP-NOW
-void OnDataRecv(uint8_t *mac_addr, uint8_t *incomingData, uint8_t len) {
-    if (instanciaCocheGlobal != nullptr) {
-        // Verificar tipo de mensaje según tamaño
-        if (len == sizeof(struct_mensaje)) {
-            struct_mensaje mensaje;
-            memcpy(&mensaje, incomingData, sizeof(mensaje));
-            instanciaCocheGlobal->procesarComandoRecibido(&mensaje);
-        } else if (len == sizeof(struct_control)) {
-            struct_control control;
-            memcpy(&control, incomingData, sizeof(control));
-            instanciaCocheGlobal->procesarControlRecibido(&control);
-        } else if (len == sizeof(struct_respuesta)) {
-            struct_respuesta respuesta;
-            memcpy(&respuesta, incomingData, sizeof(respuesta));
-            instanciaCocheGlobal->procesarRespuestaSensores(&respuesta);
-        }
+static void OnDataRecv(void* contexto, const uint8_t* mac_addr, const uint8_t* incomingData, uint8_t len) {
+    static_cast<Coche*>(contexto)->recibirTrama(mac_addr, incomingData, len);
+}
+
+// Contexto del callback: copiar la trama al buzón y volver enseguida
+void Coche::recibirTrama(const uint8_t* mac, const uint8_t* datos, uint8_t longitud) {
+    if (longitud == 0 || longitud > ColaEnvio::TAM_MAX_TRAMA) {
+        tramasDemasiadoLargas++;
+        return;
+    }
+    
+    TramaRecibida trama;
+    memcpy(trama.mac, mac, 6);
+    memcpy(trama.datos, datos, longitud);
+    trama.longitud = longitud;
+    trama.marcaUs = halMicros();
+    
+    // Los comandos solo interesan en su versión más nueva; el resto, todos
+    if (datos[0] == TRAMA_COMANDO) {
+        buzonComando.escribir(trama);
+    } else {
+        buzonTramas.poner(trama);
+    }
+}
+
+// Contexto del callback: apuntar el resultado de envío
+void Coche::recibirACK(bool exitoso) {
+    ResultadoACK resultado;
+    resultado.exitoso = exitoso;
+    resultado.marcaUs = halMicros();
+    buzonACK.poner(resultado);
+}
+
+// Despachar una trama recibida según su tipo (vista directa, sin copia)
+void Coche::procesarTramaRecibida(const uint8_t* mac, const uint8_t* datos, uint8_t longitud, unsigned long marcaUs) {
+    procesarTramaRecibida<RolDinamico, ConSensores>(mac, datos, longitud, marcaUs);
+}
+
+// Las tramas que el rol no usa se validan y se cuentan igual, pero con rol
+// fijo su tratamiento no se compila
+template <class Rol, class Sensores>
+void Coche::procesarTramaRecibida(const uint8_t* mac, const uint8_t* datos, uint8_t longitud, unsigned long marcaUs) {
+    marcaRecepcion = marcaUs;
+    
+    if (traza.activa()) {
+        EventoTrazaRX evento;
+        evento.marcaRecepcion = marcaUs;
+        memcpy(evento.mac, mac, 6);
+        traza.registrar(TRAZA_RX, halMicros(), &evento, sizeof(evento), datos, longitud);
+    }
+    
+    const TramaComando* comando = nullptr;
+    const TramaControl* control = nullptr;
+    const TramaRespuesta* respuesta = nullptr;
+    const TramaSincronia* sincronia = nullptr;
+    const CabeceraTrama* cabecera = nullptr;
+    
+    switch (tipoTrama(datos, longitud)) {
+        case TRAMA_COMANDO:
+            comando = verTrama<TramaComando>(datos, longitud);
+            if (comando) cabecera = &comando->cabecera;
+            break;
+        case TRAMA_CONTROL:
+            control = verTrama<TramaControl>(datos, longitud);
+            if (control) cabecera = &control->cabecera;
+            break;
+        case TRAMA_RESPUESTA:
+            respuesta = verTrama<TramaRespuesta>(datos, longitud);
+            if (respuesta) cabecera = &respuesta->cabecera;
+            break;
+        case TRAMA_SINCRONIA:
+            sincronia = verTrama<TramaSincronia>(datos, longitud);
+            if (sincronia) cabecera = &sincronia->cabecera;
+            break;
+    }
+    if (cabecera == nullptr) {
+        tramasInvalidas++;
+        BITACORA(bitacora, BITACORA_DEPURACION, BIT_TRAMA_INVALIDA, longitud, longitud > 0 ? datos[0] : -1);
+        return;
+    }
+    
+    // Estadísticas por par; los duplicados (reintentos) y las desordenadas no se reprocesan
+    InfoPar* origen = pares.registrarRecepcion(mac, cabecera->secuencia, halMillis());
+    if (origen == nullptr) return;
+    
+    if (comando) {
+        if (Rol::ESCLAVO) procesarComandoRecibido<Rol, Sensores>(origen, comando);
+    } else if (control) {
+        if (!Rol::FIJO) procesarControlRecibido(origen, control);
+    } else if (sincronia) {
+        if (Rol::ESCLAVO) procesarSincronia<Rol>(origen, sincronia);
+    } else {
+        if (Rol::MAESTRO) procesarRespuestaSensores<Rol>(origen, respuesta);
     }
 }
 
 // Inicializar ESP-NOW en modo dual (puede ser maestro o esclavo)
 void Coche::inicializarESPNowDual(uint8_t macOtroCoche[6], bool empezarComoMaestro) {
-    instanciaCocheGlobal = this;
     esMaestro = empezarComoMaestro;
-    memcpy(macRemota, macOtroCoche, 6);
-    
-    // Configurar WiFi en modo estación
-    WiFi.mode(WIFI_STA);
     
-    // Inicializar ESP-NOW
-    if (esp_now_init() != 0) {
+    // WiFi en modo estación, ESP-NOW con rol COMBO y callbacks hacia este coche
+    if (halIniciarESPNow(OnDataRecv, OnDataSent, this) != 0) {
         Serial.println("Error inicializando ESP-NOW");
         espnowInicializado = false;
         return;
     }
     
     espnowInicializado = true;
+    colaEnvio.setFuncionSellado(sellarAlTransmitir);
+    colaEnvio.reservarDifusion(esMaestro ? 1 : 0);  // El comando periódico no espera a un ACK
     Serial.println("ESP-NOW inicializado en modo DUAL");
+    char miMAC[18];
+    formatearMAC(obtenerMAC(), miMAC);
     Serial.print("Mi MAC: ");
-    Serial.println(WiFi.macAddress());
+    Serial.println(miMAC);
     Serial.print("Modo inicial: ");
     Serial.println(esMaestro ? "MAESTRO" : "ESCLAVO");
     
-    // Configurar rol inicial
-    esp_now_set_self_role(esMaestro ? ESP_NOW_ROLE_COMBO : ESP_NOW_ROLE_COMBO);
-    
-    // Registrar callbacks
-    esp_now_register_send_cb(OnDataSent);
-    esp_now_register_recv_cb(OnDataRecv);
+    // Los comandos salen por difusión: una sola trama para toda la flota
+    halAgregarParESPNow(MAC_DIFUSION);
     
-    // Agregar peer (otro coche)
-    esp_now_add_peer(macRemota, ESP_NOW_ROLE_COMBO, 1, NULL, 0);
-    
-    Serial.print("MAC del otro coche: ");
-    for (int i = 0; i < 6; i++) {
-        Serial.printf("%02X", macRemota[i]);
-        if (i < 5) Serial.print(":");
+    // Agregar peer (otro coche); el resto se añade con agregarPar() o al oírlos
+    if (agregarPar(macOtroCoche)) {
+        char texto[18];
+        formatearMAC(macOtroCoche, texto);
+        Serial.print("MAC del otro coche: ");
+        Serial.println(texto);
     }
-    Serial.println();
+}
+
+// Añadir un coche a la flota
+bool Coche::agregarPar(const uint8_t mac[6]) {
+    if (!espnowInicializado) return false;
+    return pares.agregar(mac) >= 0;
+}
+
+// Número de coches conocidos
+uint8_t Coche::obtenerNumeroPares() {
+    return pares.cantidad();
 }
 
 // Cambiar modo maestro/esclavo dinámicamente
 void Coche::cambiarModo(bool nuevoModoMaestro) {
     if (!espnowInicializado) return;
     
-    String modoAnterior = esMaestro ? "MAESTRO" : "ESCLAVO";
+    uint8_t rolAnterior = esMaestro ? ROL_MAESTRO : ROL_ESCLAVO;
     esMaestro = nuevoModoMaestro;
-    String modoNuevo = esMaestro ? "MAESTRO" : "ESCLAVO";
+    colaEnvio.reservarDifusion(esMaestro ? 1 : 0);
     
-    Serial.print("Cambiando a modo: ");
-    Serial.println(modoNuevo);
+    if (traza.activa()) {
+        EventoTrazaModo evento = {TRAZA_MODO_ROL, esMaestro, modoAutomatico};
+        traza.registrar(TRAZA_MODO, halMicros(), &evento, sizeof(evento));
+    }
     
-    // Registrar cambio de modo en el log
-    agregarLog("MODO", modoAnterior + " → " + modoNuevo);
+    // Registrar cambio de modo en la bitácora
+    BITACORA(bitacora, BITACORA_INFO, BIT_MODO, rolAnterior, esMaestro ? ROL_MAESTRO : ROL_ESCLAVO, 0);
     
     // Si cambio a esclavo, detener motores
     if (!esMaestro) {
         detener();
         estadoMovimiento = "PARADO";
     }
+    olvidarMando();  // Comandos de otra época
     
     // Notificar al otro coche que cambie al modo contrario
     enviarCambioModo(nuevoModoMaestro);
@@ -609,105 +1096,245 @@ void Coche::cambiarModo(bool nuevoModoMaestro) {
 void Coche::enviarCambioModo(bool yoSoyMaestro) {
     if (!espnowInicializado) return;
     
-    struct_control control;
-    strcpy(control.tipoComando, "CAMBIAR_MODO");
-    strcpy(control.nuevoModo, yoSoyMaestro ? "ESCLAVO" : "MAESTRO");
+    TramaControl control;
+    control.codigo = CTRL_CAMBIAR_MODO;
+    control.argumento = yoSoyMaestro ? ROL_ESCLAVO : ROL_MAESTRO;
+    
+    // Si paso a maestro, toda la flota pasa a esclavo (difusión). Si dejo de
+    // serlo, el primer par de la tabla toma el relevo.
+    const uint8_t* destino = MAC_DIFUSION;
+    if (!yoSoyMaestro) {
+        InfoPar* relevo = pares.obtener(0);
+        if (relevo == nullptr) return;
+        destino = relevo->mac;
+    }
+    sellarTrama(control, pares.siguienteSecuencia(destino), halMicros());
     
-    esp_now_send(macRemota, (uint8_t*)&control, sizeof(control));
+    // No reemplazable: cada cambio de modo debe llegar
+    encolarTrama(destino, (uint8_t*)&control, sizeof(control), false);
+    colaEnvio.atender(halMicros());
     
     Serial.println("Comando de cambio de modo enviado");
 }
 
 // Procesar comando de control recibido
-void Coche::procesarControlRecibido(struct_control* datos) {
-    if (strcmp(datos->tipoComando, "CAMBIAR_MODO") == 0) {
-        bool nuevoModo = (strcmp(datos->nuevoModo, "MAESTRO") == 0);
-        
-        Serial.print("Recibido cambio de modo a: ");
-        Serial.println(nuevoModo ? "MAESTRO" : "ESCLAVO");
+void Coche::procesarControlRecibido(InfoPar* origen, const TramaControl* datos) {
+    if (datos->codigo == CTRL_CAMBIAR_MODO) {
+        uint8_t rolAnterior = esMaestro ? ROL_MAESTRO : ROL_ESCLAVO;
+        esMaestro = (datos->argumento == ROL_MAESTRO);
+        colaEnvio.reservarDifusion(esMaestro ? 1 : 0);
         
-        String modoAnterior = esMaestro ? "MAESTRO" : "ESCLAVO";
-        esMaestro = nuevoModo;
-        String modoNuevo = esMaestro ? "MAESTRO" : "ESCLAVO";
-        
-        // Registrar cambio en el log
-        agregarLog("MODO", "Remoto: " + modoAnterior + " → " + modoNuevo);
+        // Registrar cambio en la bitácora
+        BITACORA(bitacora, BITACORA_INFO, BIT_MODO, rolAnterior, datos->argumento, 1);
         
         // Si cambio a esclavo, detener
         if (!esMaestro) {
             detener();
             estadoMovimiento = "PARADO";
         }
+        olvidarMando();
     }
 }
 
 // Enviar comando ESP-NOW (solo maestro)
 void Coche::enviarComandoESPNow() {
-    if (!esMaestro || !espnowInicializado) return;
+    enviarComandoESPNow<RolDinamico, ConSensores>();
+}
+
+template <class Rol, class Sensores>
+void Coche::enviarComandoESPNow() {
+    // Dar servicio a la cola en ambos roles (reintentos, timeouts, respuestas)
+    atenderESPNow<Rol, Sensores>();
+    
+    if (actuaComoEsclavo<Rol>() && !siguiendoHueco) atenderSilencioMando();
+    if (!actuaComoMaestro<Rol>() || !espnowInicializado) return;
     
-    // Control de flujo: No enviar si está esperando ACK o no ha pasado 100ms
+    // Control de flujo: hueco en la cola e intervalo mínimo entre comandos
     if (!puedeEnviar()) return;
     
-    struct_mensaje mensaje;
+    TramaComando mensaje;
     mensaje.velocidadIzq = ultimaVelocidadIzq;
     mensaje.velocidadDer = ultimaVelocidadDer;
-    strcpy(mensaje.comando, estadoMovimiento.c_str());
+    mensaje.movimiento = codigoMovimiento(estadoMovimiento.c_str());
     
     // Añadir datos de sensores si tenemos sensores locales
-    mensaje.tieneSensores = tieneSensoresLocales;
-    if (tieneSensoresLocales) {
-        mensaje.temperatura = leerTemperatura();
-        mensaje.luminosidad = leerLuz();
-    } else {
-        // Si no tenemos sensores, enviar valores inválidos
-        mensaje.temperatura = -999;
-        mensaje.luminosidad = -1;
+    mensaje.banderas = 0;
+    mensaje.temperatura = 0;
+    if (sensoresLocales<Sensores>()) {
+        mensaje.banderas |= BANDERA_SENSORES;
+        if (leerLuz()) mensaje.banderas |= BANDERA_LUZ;
+        if (temperaturaLocal<Sensores>()) {
+            mensaje.temperatura = aCentesimas(leerTemperatura());
+        } else {
+            mensaje.banderas |= BANDERA_SIN_TEMPERATURA;
+        }
     }
+    mensaje.aplicarEn = aplicarEnEnviado;
+    sellarTrama(mensaje, pares.siguienteSecuencia(MAC_DIFUSION), halMicros());
     
-    // Marcar que estamos esperando ACK
-    esperandoACK = true;
-    ultimoEnvio = millis();
-    
-    // Enviar mensaje
-    esp_now_send(macRemota, (uint8_t*)&mensaje, sizeof(mensaje));
+    // Encolar (sustituye al comando pendiente si aún no salió) y transmitir
+    ultimoEnvio = halMillis();
+    encolarTrama(MAC_DIFUSION, (uint8_t*)&mensaje, sizeof(mensaje), true);
+    colaEnvio.atender(halMicros());
     
-    // Registrar en el log
-    mensajesEnviados++;
-    String detalle = estadoMovimiento + " V:" + String(ultimaVelocidadIzq) + "," + String(ultimaVelocidadDer);
-    if (tieneSensoresLocales) {
-        detalle += " T:" + String(mensaje.temperatura, 1) + " L:" + String(mensaje.luminosidad);
-    }
-    agregarLog("ENVIO", detalle);
+    // Registrar en la bitácora (se escribe más tarde, en tiempo libre)
+    BITACORA(bitacora, BITACORA_INFO, BIT_ENVIO, mensaje.movimiento, ultimaVelocidadIzq, ultimaVelocidadDer,
+             temperaturaBitacora(mensaje.banderas, mensaje.temperatura), luzBitacora(mensaje.banderas));
 }
 
 // Procesar comando recibido (solo esclavo)
-void Coche::procesarComandoRecibido(struct_mensaje* datos) {
-    if (esMaestro) return; // Solo el esclavo procesa comandos de movimiento
-    
-    // Aplicar las velocidades recibidas directamente
-    moverMotores(datos->velocidadIzq, datos->velocidadDer);
+void Coche::procesarComandoRecibido(InfoPar* origen, const TramaComando* datos) {
+    procesarComandoRecibido<RolDinamico, ConSensores>(origen, datos);
+}
+
+template <class Rol, class Sensores>
+void Coche::procesarComandoRecibido(InfoPar* origen, const TramaComando* datos) {
+    if (!actuaComoEsclavo<Rol>()) return; // Solo el esclavo procesa comandos de movimiento
+    
+    // Las respuestas van al maestro que nos está mandando
+    origen->rol = ROL_MAESTRO;
+    memcpy(macMaestro, origen->mac, 6);
+    
+    // Con el reloj sincronizado, un comando con instante espera a que el
+    // maestro lo aplique (los repetidos ya están programados). Si no, con el
+    // control propio solo alimenta la fusión y sin él se aplica directamente.
+    // Se guarda para seguir su tendencia si dejan de llegar
+    if (datos->aplicarEn != 0 && reloj.sincronizado(marcaRecepcion)) {
+        if (datos->aplicarEn != ultimoAplicarEn) {
+            ultimoAplicarEn = datos->aplicarEn;
+            OrdenProgramada orden;
+            orden.izq = datos->velocidadIzq;
+            orden.der = datos->velocidadDer;
+            orden.movimiento = datos->movimiento;
+            orden.parada = false;
+            orden.instante = reloj.aLocal(datos->aplicarEn);
+            programarOrden(orden);
+        }
+    } else {
+        fusion.registrarLider((datos->velocidadIzq + datos->velocidadDer) / 2, marcaRecepcion);
+        if (!siguiendoHueco) {
+            aplicarMando(datos->velocidadIzq, datos->velocidadDer, datos->movimiento);
+            histAplicacion.registrar(halMicros() - marcaRecepcion);
+        }
+    }
+    unsigned long silencio = mando.registrar(datos->velocidadIzq, datos->velocidadDer, marcaRecepcion);
+    if (silencio > 0) histSilencio.registrar(silencio);
+    movimientoMando = datos->movimiento;
     
-    // Actualizar estado
-    estadoMovimiento = String(datos->comando);
+    // Guardar la marca para devolverla como eco en la respuesta
+    marcaComandoRemoto = datos->cabecera.marcaTiempo;
+    recepcionComandoRemoto = marcaRecepcion;
     
     // Almacenar datos de sensores recibidos si el otro coche tiene sensores
-    if (datos->tieneSensores) {
-        temperaturaRemota = datos->temperatura;
-        luminosidadRemota = datos->luminosidad;
-        datosRemotosValidos = true;
-        ultimosDatosRemotos = millis();
+    if (datos->banderas & BANDERA_SENSORES) {
+        pares.actualizarSensores(origen, temperaturaRecibida(datos->banderas, datos->temperatura),
+                                 (datos->banderas & BANDERA_LUZ) ? 1 : 0, halMillis());
     }
     
-    // Registrar en el log
+    // Registrar en la bitácora
     mensajesRecibidos++;
-    String detalle = String(datos->comando) + " V:" + String(datos->velocidadIzq) + "," + String(datos->velocidadDer);
-    if (datos->tieneSensores) {
-        detalle += " T:" + String(datos->temperatura, 1) + " L:" + String(datos->luminosidad);
-    }
-    agregarLog("RECEP", detalle);
+    BITACORA(bitacora, BITACORA_INFO, BIT_RECEPCION, datos->movimiento, datos->velocidadIzq, datos->velocidadDer,
+             temperaturaBitacora(datos->banderas, datos->temperatura), luzBitacora(datos->banderas));
     
     // COMUNICACIÓN BIDIRECCIONAL: El esclavo responde con sus sensores
-    enviarRespuestaSensores();
+    enviarRespuestaSensores<Rol, Sensores>();
+}
+
+// Esclavo: aplicar una orden de movimiento, salvo avanzar con un obstáculo
+// delante del propio HC-SR04
+void Coche::aplicarMando(int velocidadIzq, int velocidadDer, uint8_t movimiento) {
+    bool bloqueado = movimiento == MOV_AVANZANDO && distanciaSeguridad > 0 &&
+                     ultimaDistancia > 0 && ultimaDistancia < distanciaSeguridad;
+    if (bloqueado) {
+        detenerMotores();
+    } else {
+        moverMotores(velocidadIzq, velocidadDer);
+    }
+    estadoMovimiento = bloqueado ? "PARADO" : textoMovimiento(movimiento);
+}
+
+// Esclavo: mientras el maestro calla, seguir su tendencia y después parar
+// poco a poco (la rampa de los motores suaviza cada paso)
+void Coche::atenderSilencioMando() {
+    int16_t izq, der;
+    unsigned long ahora = halMicros();
+    if (!mando.calcular(ahora, izq, der)) return;
+    traza.registrar(TRAZA_MANDO, ahora, nullptr, 0);
+    aplicarMando(izq, der, izq == 0 && der == 0 ? (uint8_t)MOV_PARADO : movimientoMando);
+}
+
+// Olvidar al maestro (cambio de rol o de configuración): su historial de
+// comandos, la fusión, su reloj y las órdenes en espera, y devolver el mando
+// a los comandos
+void Coche::olvidarMando() {
+    mando.olvidar();
+    fusion.reiniciar();
+    siguiendoHueco = false;
+    reloj.reiniciar();
+    ultimaSincronia = 0;
+    aplicarEnEnviado = 0;
+    ultimoAplicarEn = 0;
+    numProgramadas = 0;
+}
+
+// Poner una orden en espera, por instante. Si ya pasó, se aplica ahora (un
+// comando que llegó tarde); sin sitio, se aplica la más antigua
+void Coche::programarOrden(const OrdenProgramada& orden) {
+    if ((long)(orden.instante - halMicros()) <= 0) {
+        if (!esMaestro) comandosTarde++;
+        aplicarProgramada(orden);
+        return;
+    }
+    if (numProgramadas == ORDENES_PROGRAMADAS) {
+        OrdenProgramada antigua = programadas[0];
+        numProgramadas--;
+        memmove(programadas, programadas + 1, numProgramadas * sizeof(OrdenProgramada));
+        aplicarProgramada(antigua);
+    }
+    uint8_t i = numProgramadas;
+    while (i > 0 && (long)(programadas[i - 1].instante - orden.instante) > 0) {
+        programadas[i] = programadas[i - 1];
+        i--;
+    }
+    programadas[i] = orden;
+    numProgramadas++;
+}
+
+// Aplicar las órdenes cuyo instante ya llegó, en orden
+void Coche::atenderProgramadas() {
+    if (numProgramadas == 0) return;
+    unsigned long ahora = halMicros();
+    if ((long)(ahora - programadas[0].instante) < 0) return;
+    
+    traza.registrar(TRAZA_PROGRAMADA, ahora, nullptr, 0);
+    while (numProgramadas > 0 && (long)(ahora - programadas[0].instante) >= 0) {
+        OrdenProgramada orden = programadas[0];
+        numProgramadas--;
+        memmove(programadas, programadas + 1, numProgramadas * sizeof(OrdenProgramada));
+        aplicarProgramada(orden);
+    }
+}
+
+// El maestro aplica su propia orden; el esclavo, el comando (o, con el
+// control propio, se lo da a la fusión: es cuando el maestro cambia de marcha)
+void Coche::aplicarProgramada(const OrdenProgramada& orden) {
+    if (esMaestro) {
+        if (orden.parada) detenerMotores();
+        else fijarMotores(orden.izq, orden.der);
+        return;
+    }
+    fusion.registrarLider((orden.izq + orden.der) / 2, halMicros());
+    if (!siguiendoHueco) aplicarMando(orden.izq, orden.der, orden.movimiento);
+}
+
+// Esclavo: pedir sincronía en esta respuesta, en todas hasta tener el reloj
+// y después cada periodoSincronia
+bool Coche::tocaSincronia() {
+    if (periodoSincronia == 0) return false;
+    unsigned long ahora = halMicros();
+    if (reloj.sincronizado(ahora) && ahora - ultimaSincronia < periodoSincronia) return false;
+    ultimaSincronia = ahora;
+    return true;
 }
 
 // Obtener modo actual
@@ -723,8 +1350,14 @@ String Coche::obtenerModoTexto() {
 // Configurar modo automático/manual
 void Coche::setModoAutomatico(bool automatico) {
     modoAutomatico = automatico;
+    if (traza.activa()) {
+        EventoTrazaModo evento = {TRAZA_MODO_AUTOMATICO, esMaestro, modoAutomatico};
+        traza.registrar(TRAZA_MODO, halMicros(), &evento, sizeof(evento));
+    }
     if (!automatico) {
         detener();
+        siguiendoHueco = false;
+        numProgramadas = 0;
     }
 }
 
@@ -736,7 +1369,7 @@ bool Coche::obtenerModoAutomatico() {
 // Obtener dirección MAC
 uint8_t* Coche::obtenerMAC() {
     static uint8_t mac[6];
-    WiFi.macAddress(mac);
+    halObtenerMAC(mac);
     return mac;
 }
 
@@ -765,7 +1398,7 @@ void Coche::controlarLucesAutomaticas() {
 // Encender luces
 void Coche::encenderLuces() {
     if (pinLuces >= 0) {
-        digitalWrite(pinLuces, HIGH);
+        halEscribirDigital(pinLuces, HIGH);
         estadoLuces = true;
     }
 }
@@ -773,7 +1406,7 @@ void Coche::encenderLuces() {
 // Apagar luces
 void Coche::apagarLuces() {
     if (pinLuces >= 0) {
-        digitalWrite(pinLuces, LOW);
+        halEscribirDigital(pinLuces, LOW);
         estadoLuces = false;
     }
 }
@@ -813,28 +1446,27 @@ bool Coche::tieneSensores() {
     return tieneSensoresLocales;
 }
 
-// Obtener temperatura actual (local si está disponible, sino remota)
+// Obtener temperatura actual (local si está disponible, sino la remota más reciente)
 float Coche::obtenerTemperaturaActual() {
-    if (tieneSensoresLocales) {
+    if (tieneSensoresLocales && tempPin >= 0) {
         return leerTemperatura();
-    } else if (datosRemotosValidos) {
-        // Verificar que los datos remotos no sean muy antiguos (>5 segundos)
-        if (millis() - ultimosDatosRemotos < 5000) {
-            return temperaturaRemota;
-        }
+    }
+    // Descartar datos remotos muy antiguos (>5 segundos)
+    InfoPar* par = pares.masRecienteConSensores(halMillis(), 5000);
+    if (par != nullptr) {
+        return par->temperatura;
     }
     return -999; // Valor inválido
 }
 
-// Obtener luminosidad actual (local si está disponible, sino remota)
+// Obtener luminosidad actual (local si está disponible, sino la remota más reciente)
 int Coche::obtenerLuminosidadActual() {
     if (tieneSensoresLocales) {
         return leerLuz();
-    } else if (datosRemotosValidos) {
-        // Verificar que los datos remotos no sean muy antiguos (>5 segundos)
-        if (millis() - ultimosDatosRemotos < 5000) {
-            return luminosidadRemota;
-        }
+    }
+    InfoPar* par = pares.masRecienteConSensores(halMillis(), 5000);
+    if (par != nullptr) {
+        return par->luminosidad;
     }
     return -1; // Valor inválido
 }
@@ -843,7 +1475,7 @@ int Coche::obtenerLuminosidadActual() {
 String Coche::obtenerOrigenDatos() {
     if (tieneSensoresLocales) {
         return "LOCAL";
-    } else if (datosRemotosValidos && (millis() - ultimosDatosRemotos < 5000)) {
+    } else if (pares.masRecienteConSensores(halMillis(), 5000) != nullptr) {
         return "REMOTO";
     }
     return "SIN_DATOS";
@@ -851,9 +1483,19 @@ String Coche::obtenerOrigenDatos() {
 
 // ========== FUNCIONES DE LOG ==========
 
-// Agregar entrada al log (solo Serial para depuración)
+// Escribir la bitácora pendiente sin esperar: solo lo que cabe en la UART
+void Coche::atenderBitacora() {
+    bitacora.atender(Serial, Serial.availableForWrite());
+}
+
+Bitacora& Coche::obtenerBitacora() {
+    return bitacora;
+}
+
+// Agregar entrada al log directamente al Serial (bloquea si la UART está
+// llena: la librería usa la bitácora; esto queda para los sketches)
 void Coche::agregarLog(String tipo, String detalle) {
-    unsigned long ahora = millis();
+    unsigned long ahora = halMillis();
     float timestamp = (float)ahora / 1000.0;
     Serial.print(timestamp, 3);
     Serial.print("s ");
@@ -862,9 +1504,9 @@ void Coche::agregarLog(String tipo, String detalle) {
     Serial.println(detalle);
 }
 
-// Obtener contador de mensajes enviados
+// Obtener contador de mensajes enviados (transmisiones por radio)
 unsigned long Coche::obtenerMensajesEnviados() {
-    return mensajesEnviados;
+    return colaEnvio.obtenerTransmisiones();
 }
 
 // Obtener contador de mensajes recibidos
@@ -872,78 +1514,416 @@ unsigned long Coche::obtenerMensajesRecibidos() {
     return mensajesRecibidos;
 }
 
-// Obtener contador de mensajes fallidos
+// Obtener contador de mensajes fallidos (abandonados tras los reintentos)
 unsigned long Coche::obtenerMensajesFallidos() {
-    return mensajesFallidos;
+    return colaEnvio.obtenerDescartadas();
+}
+
+// Obtener contador de tramas descartadas por formato o CRC
+unsigned long Coche::obtenerTramasInvalidas() {
+    return tramasInvalidas;
+}
+
+// Obtener número de retransmisiones
+unsigned long Coche::obtenerReintentos() {
+    return colaEnvio.obtenerReintentos();
+}
+
+// Obtener número de ACKs que no llegaron a tiempo
+unsigned long Coche::obtenerTimeoutsACK() {
+    return colaEnvio.obtenerTimeouts();
+}
+
+// Obtener comandos que llegaron y fueron sustituidos por otro más nuevo
+unsigned long Coche::obtenerComandosSobrescritos() {
+    return buzonComando.obtenerSobrescritos();
+}
+
+// Obtener tramas o ACKs perdidos por buzón lleno o trama demasiado larga
+unsigned long Coche::obtenerDesbordesBuzon() {
+    return buzonTramas.obtenerDesbordes() + buzonACK.obtenerDesbordes() + tramasDemasiadoLargas;
 }
 
 // Obtener tasa de éxito de mensajes (%)
 float Coche::obtenerTasaExito() {
-    unsigned long total = mensajesEnviados + mensajesFallidos;
+    unsigned long entregadas = colaEnvio.obtenerEntregadas();
+    unsigned long total = entregadas + colaEnvio.obtenerDescartadas();
     if (total == 0) return 100.0;
-    return (float)mensajesEnviados / total * 100.0;
+    return (float)entregadas / total * 100.0;
 }
 
-// Verificar si puede enviar mensaje (ACK recibido + throttling 100ms)
+// Verificar si puede enviar mensaje (hueco en la cola + intervalo mínimo)
 bool Coche::puedeEnviar() {
-    // No puede enviar si está esperando ACK
-    if (esperandoACK) return false;
+    // No puede enviar si la cola está llena
+    if (!colaEnvio.hayHueco()) return false;
     
-    // No puede enviar si no han pasado 100ms desde el último envío (throttling)
-    if (millis() - ultimoEnvio < 100) return false;
+    // Respetar el intervalo mínimo entre comandos (con planificador ya lo
+    // marca el periodo de la tarea de radio)
+    if (tareaEnvio < 0 && halMillis() - ultimoEnvio < intervaloEnvio) return false;
     
     return true;
 }
 
-// Registrar ACK de envío
-void Coche::registrarACK(bool exitoso) {
-    esperandoACK = false;  // Liberar bloqueo
+// Encolar una trama para enviar, dejándola en la traza
+bool Coche::encolarTrama(const uint8_t* mac, const uint8_t* datos, uint8_t longitud, bool reemplazable) {
+    traza.registrar(TRAZA_TX, halMicros(), mac, 6, datos, longitud);
+    return colaEnvio.encolar(mac, datos, longitud, reemplazable);
+}
+
+// Registrar ACK de envío (callback de ESP-NOW)
+void Coche::registrarACK(bool exitoso, unsigned long marcaUs) {
+    if (traza.activa()) {
+        EventoTrazaACK evento;
+        evento.exitoso = exitoso;
+        evento.marcaResultado = marcaUs;
+        traza.registrar(TRAZA_ACK, halMicros(), &evento, sizeof(evento));
+    }
+    long tiempoACK = colaEnvio.registrarACK(exitoso, marcaUs);
+    if (tiempoACK >= 0) {
+        histACK.registrar(tiempoACK);
+    }
+}
+
+// Percentiles de latencia en JSON (us)
+String Coche::obtenerLatenciaJSON() {
+    char resumen[96];
+    String json = "{";
+    histRTT.escribirResumen(resumen, sizeof(resumen));
+    json += "\"rtt\":" + String(resumen) + ",";
+    histUnaVia.escribirResumen(resumen, sizeof(resumen));
+    json += "\"unaVia\":" + String(resumen) + ",";
+    histACK.escribirResumen(resumen, sizeof(resumen));
+    json += "\"envioACK\":" + String(resumen) + ",";
+    histAplicacion.escribirResumen(resumen, sizeof(resumen));
+    json += "\"comandoMotor\":" + String(resumen) + ",";
+    histSilencio.escribirResumen(resumen, sizeof(resumen));
+    json += "\"silencioMando\":" + String(resumen) + ",";
+    histPanel.escribirResumen(resumen, sizeof(resumen));
+    json += "\"panel\":" + String(resumen) + ",";
+    json += "\"heapMinimoPanel\":" + String(heapMinimoPanel);
+    json += "}";
+    return json;
+}
+
+// Vaciar los histogramas de latencia
+void Coche::reiniciarLatencias() {
+    histRTT.reiniciar();
+    histUnaVia.reiniciar();
+    histACK.reiniciar();
+    histAplicacion.reiniciar();
+    histSilencio.reiniciar();
+    histPanel.reiniciar();
+    heapMinimoPanel = 0xFFFFFFFF;
+}
+
+// Vaciar los buzones de los callbacks, transmitir y detectar ACKs perdidos
+void Coche::atenderESPNow() {
+    atenderESPNow<RolDinamico, ConSensores>();
+}
+
+template <class Rol, class Sensores>
+void Coche::atenderESPNow() {
+    if (!espnowInicializado) return;
     
-    if (exitoso) {
-        // ACK exitoso, no hacer nada adicional
-    } else {
-        mensajesFallidos++;
-        agregarLog("ERROR", "Envío fallido");
+    // Resultados de envío primero, para liberar la ventana
+    ResultadoACK resultado;
+    while (buzonACK.sacar(resultado)) {
+        registrarACK(resultado.exitoso, resultado.marcaUs);
+    }
+    
+    // Control y respuestas en orden de llegada, luego el comando más nuevo
+    TramaRecibida trama;
+    while (buzonTramas.sacar(trama)) {
+        procesarTramaRecibida<Rol, Sensores>(trama.mac, trama.datos, trama.longitud, trama.marcaUs);
+    }
+    if (buzonComando.leer(trama)) {
+        procesarTramaRecibida<Rol, Sensores>(trama.mac, trama.datos, trama.longitud, trama.marcaUs);
+    }
+    
+    colaEnvio.atender(halMicros());
+}
+
+// Configurar ventana de envío, timeout de ACK y reintentos
+void Coche::configurarEnvio(uint8_t ventana, unsigned long timeoutMs, uint8_t reintentos) {
+    colaEnvio.configurar(ventana, timeoutMs * 1000UL, reintentos);
+}
+
+// Configurar intervalo mínimo entre comandos
+void Coche::setIntervaloEnvio(unsigned long ms) {
+    intervaloEnvio = ms;
+    if (tareaEnvio >= 0) {
+        planificador.setPeriodo(tareaEnvio, ms > 0 ? ms * 1000UL : 1000UL);
     }
 }
 
 // Esclavo envía respuesta con sus datos de sensores
 void Coche::enviarRespuestaSensores() {
-    if (esMaestro || !espnowInicializado) return;  // Solo el esclavo envía respuestas
-    if (!tieneSensoresLocales) return;  // Solo si tiene sensores
+    enviarRespuestaSensores<RolDinamico, ConSensores>();
+}
+
+template <class Rol, class Sensores>
+void Coche::enviarRespuestaSensores() {
+    if (!actuaComoEsclavo<Rol>() || !espnowInicializado) return;  // Solo el esclavo envía respuestas
+    // Se responde aunque no haya sensores: el eco sirve para medir el RTT
     
-    // Control de flujo: No enviar si está esperando ACK o no ha pasado 100ms
+    // Control de flujo: hueco en la cola e intervalo mínimo
     if (!puedeEnviar()) return;
     
-    struct_respuesta respuesta;
-    respuesta.temperatura = leerTemperatura();
-    respuesta.luminosidad = leerLuz();
-    respuesta.tieneSensores = true;
-    strcpy(respuesta.origen, "ESCLAVO");
-    
-    // Marcar que estamos esperando ACK
-    esperandoACK = true;
-    ultimoEnvio = millis();
+    TramaRespuesta respuesta;
+    respuesta.origen = ROL_ESCLAVO;
+    respuesta.banderas = 0;
+    respuesta.temperatura = 0;
+    if (sensoresLocales<Sensores>()) {
+        respuesta.banderas = BANDERA_SENSORES;
+        if (leerLuz()) respuesta.banderas |= BANDERA_LUZ;
+        if (temperaturaLocal<Sensores>()) {
+            respuesta.temperatura = aCentesimas(leerTemperatura());
+        } else {
+            respuesta.banderas |= BANDERA_SIN_TEMPERATURA;
+        }
+    }
+    if (tocaSincronia()) respuesta.banderas |= BANDERA_SINCRONIA;
+    unsigned long ahora = halMicros();
+    respuesta.marcaEco = marcaComandoRemoto;
+    respuesta.retenidoUs = ahora - recepcionComandoRemoto;
+    sellarTrama(respuesta, pares.siguienteSecuencia(macMaestro), ahora);
     
-    esp_now_send(macRemota, (uint8_t*)&respuesta, sizeof(respuesta));
+    ultimoEnvio = halMillis();
+    encolarTrama(macMaestro, (uint8_t*)&respuesta, sizeof(respuesta), true);
+    colaEnvio.atender(halMicros());
     
     // Registrar envío de sensores
-    String detalle = "T:" + String(respuesta.temperatura, 1) + " L:" + String(respuesta.luminosidad);
-    agregarLog("RESP", detalle);
+    BITACORA(bitacora, BITACORA_INFO, BIT_RESPUESTA, temperaturaBitacora(respuesta.banderas, respuesta.temperatura),
+             luzBitacora(respuesta.banderas));
 }
 
 // Maestro procesa respuesta de sensores del esclavo
-void Coche::procesarRespuestaSensores(struct_respuesta* datos) {
-    if (!esMaestro) return;  // Solo el maestro procesa respuestas
-    
-    if (datos->tieneSensores) {
-        temperaturaRemota = datos->temperatura;
-        luminosidadRemota = datos->luminosidad;
-        datosRemotosValidos = true;
-        ultimosDatosRemotos = millis();
+void Coche::procesarRespuestaSensores(InfoPar* origen, const TramaRespuesta* datos) {
+    procesarRespuestaSensores<RolDinamico>(origen, datos);
+}
+
+template <class Rol>
+void Coche::procesarRespuestaSensores(InfoPar* origen, const TramaRespuesta* datos) {
+    if (!actuaComoMaestro<Rol>()) return;  // Solo el maestro procesa respuestas
+    
+    origen->rol = datos->origen;
+    
+    // RTT con el eco de nuestra marca; descontando lo que el esclavo tardó
+    // en contestar queda el tiempo de ida y vuelta por radio
+    if (datos->marcaEco != 0) {
+        unsigned long rtt = marcaRecepcion - datos->marcaEco;
+        histRTT.registrar(rtt);
+        if (rtt >= datos->retenidoUs) {
+            histUnaVia.registrar((rtt - datos->retenidoUs) / 2);
+        }
+    }
+    
+    // Sincronía pedida: la respuesta es la petición (sale en cuanto llega el
+    // comando, con el canal libre) y se contesta con sus marcas
+    if ((datos->banderas & BANDERA_SINCRONIA) && colaEnvio.hayHueco()) {
+        TramaSincronia sincronia;
+        sincronia.marcaEco = datos->cabecera.marcaTiempo;
+        sincronia.recepcionEco = marcaRecepcion;
+        sellarTrama(sincronia, pares.siguienteSecuencia(origen->mac), halMicros());
+        encolarTrama(origen->mac, (uint8_t*)&sincronia, sizeof(sincronia), true);
+        colaEnvio.atender(halMicros());
+    }
+    
+    if (datos->banderas & BANDERA_SENSORES) {
+        pares.actualizarSensores(origen, temperaturaRecibida(datos->banderas, datos->temperatura),
+                                 (datos->banderas & BANDERA_LUZ) ? 1 : 0, halMillis());
         
         // Registrar recepción
-        String detalle = String(datos->origen) + " T:" + String(datos->temperatura, 1) + " L:" + String(datos->luminosidad);
-        agregarLog("RESP_RX", detalle);
+        const uint8_t* mac = origen->mac;
+        BITACORA(bitacora, BITACORA_INFO, BIT_RESPUESTA_RX, (mac[0] << 8) | mac[1], (mac[2] << 8) | mac[3],
+                 (mac[4] << 8) | mac[5], temperaturaBitacora(datos->banderas, datos->temperatura),
+                 luzBitacora(datos->banderas));
     }
-}
\ No newline at end of file
+}
+
+// Esclavo: sincronía del maestro al que sigue, intercambio completo
+void Coche::procesarSincronia(InfoPar* origen, const TramaSincronia* datos) {
+    procesarSincronia<RolDinamico>(origen, datos);
+}
+
+template <class Rol>
+void Coche::procesarSincronia(InfoPar* origen, const TramaSincronia* datos) {
+    if (!actuaComoEsclavo<Rol>() || memcmp(origen->mac, macMaestro, 6) != 0) return;
+    reloj.agregarIntercambio(datos->marcaEco, datos->recepcionEco, datos->cabecera.marcaTiempo, marcaRecepcion);
+}
+
+SincroniaReloj& Coche::obtenerReloj() {
+    return reloj;
+}
+
+// ========== PLANIFICADOR ==========
+
+// Registrar las tareas del coche. Periodos en us; motores y control tienen
+// los plazos más cortos para que ganen en EDF cuando coinciden con las demás.
+void Coche::iniciarTareas() {
+    iniciarTareas<RolDinamico, ConSensores, ConWeb>();
+}
+
+template <class Rol, class Sensores, class Web>
+void Coche::iniciarTareas() {
+    if (planificador.cantidad() > 0) return;
+    
+    // Etapa de salida de los motores: tramos cortos de impulso y rampa
+    planificador.agregar("motores", [](void* c) { static_cast<Coche*>(c)->atenderMotores(); },
+                         this, 2000, 1000, 5);
+    // Muestreo del HC-SR04 (máquina de estados no bloqueante); un esclavo
+    // fijo solo lo necesita para la web, la distancia de seguridad o la fusión
+    if (Rol::MAESTRO || Web::WEB || distanciaSeguridad > 0 || fusionActiva) {
+        planificador.agregar("sensores", [](void* c) { static_cast<Coche*>(c)->leerDistancia(); },
+                             this, 5000, 2000, 3);
+    }
+    // Control de distancia a ritmo fijo (en el esclavo, del hueco fusionado)
+    if (Rol::MAESTRO || fusionActiva) {
+        tareaControl = planificador.agregar("control",
+                                            [](void* c) { static_cast<Coche*>(c)->controlarDistancia<Rol>(); },
+                                            this, 20000, 5000, 4);
+    }
+    // Radio: buzones, cola de envío y comando/respuesta
+    tareaEnvio = planificador.agregar("radio",
+                                      [](void* c) { static_cast<Coche*>(c)->enviarComandoESPNow<Rol, Sensores>(); },
+                                      this, intervaloEnvio > 0 ? intervaloEnvio * 1000UL : 1000UL, 5000, 2);
+    // Luces automáticas
+    planificador.agregar("luces", [](void* c) { static_cast<Coche*>(c)->controlarLucesAutomaticas(); },
+                         this, 100000, 0, 1);
+    // Servidor web: lo menos urgente
+    if (Web::WEB) {
+        planificador.agregar("web", [](void* c) { static_cast<Coche*>(c)->atenderClientes(); },
+                             this, 10000, 0, 0);
+    }
+    // Volcado de la traza a LittleFS (no hace nada si no está activa)
+    planificador.agregar("traza", [](void* c) { static_cast<Coche*>(c)->guardarTraza(); },
+                         this, 500000, 0, 0);
+}
+
+// Ejecutar las tareas que toquen (llamar en cada loop(), sin delay()); si no
+// tocaba ninguna, el tiempo libre se usa para escribir la bitácora
+void Coche::ejecutarTareas() {
+    if (planificador.atender() == 0) {
+        atenderBitacora();
+    }
+}
+
+// Acceso al planificador para añadir tareas propias
+Planificador& Coche::obtenerPlanificador() {
+    return planificador;
+}
+
+// Estadísticas de las tareas en JSON, escritas en el buffer de telemetría y
+// no en la pila: MAX_TAREAS con todos los contadores al máximo ocupan unos
+// 2,2 KB y el buffer tiene 4,7 KB
+String Coche::obtenerTareasJSON() {
+    planificador.escribirJSON(bufferTelemetria, sizeof(bufferTelemetria));
+    return String(bufferTelemetria);
+}
+
+// ========== TRAZA ==========
+
+// Reservar el anillo, truncar el fichero y registrar la configuración actual
+bool Coche::iniciarTraza(size_t bytesRAM, const char* ruta) {
+    if (!traza.iniciar(bytesRAM)) {
+        Serial.println("Sin memoria para la traza");
+        return false;
+    }
+    rutaTraza = nullptr;
+    
+    // Filtro, PID y mando desde cero, para que la reproducción parta del mismo estado
+    filtro.reiniciar();
+    pid.reiniciar();
+    olvidarMando();
+#ifndef COCHE_HOST
+    if (ruta != nullptr) {
+        if (!LittleFS.begin()) {
+            Serial.println("Error montando LittleFS: traza solo en RAM");
+        } else {
+            if (ficheroTraza) ficheroTraza.close();
+            ficheroTraza = LittleFS.open(ruta, "w");
+            if (ficheroTraza) rutaTraza = ruta;
+        }
+    }
+#endif
+    registrarInicioTraza();
+    return true;
+}
+
+// Lo que el reproductor necesita para arrancar igual que este coche
+void Coche::registrarInicioTraza() {
+    EventoTrazaInicio inicio;
+    inicio.maestro = esMaestro;
+    inicio.automatico = modoAutomatico;
+    inicio.sensoresLocales = tieneSensoresLocales;
+    inicio.planificador = tareaControl >= 0;
+    inicio.distanciaMin = distanciaMin;
+    inicio.distanciaMax = distanciaMax;
+    inicio.kp = pid.obtenerKp();
+    inicio.ki = pid.obtenerKi();
+    inicio.kd = pid.obtenerKd();
+    inicio.kff = pid.obtenerFeedForward();
+    inicio.pwmMinimo = pwmMinimo;
+    inicio.modoFiltro = filtro.obtenerModo();
+    inicio.ventanaFiltro = filtro.obtenerVentana();
+    inicio.horizonteMando = mando.obtenerHorizonte();
+    inicio.presupuestoMando = mando.obtenerPresupuesto();
+    inicio.decaimientoMando = mando.obtenerDecaimiento();
+    inicio.fusion = fusionActiva;
+    inicio.gananciaFusion = fusion.obtenerGanancia();
+    inicio.bandaFusion = fusion.obtenerBanda();
+    inicio.constanteFusion = fusion.obtenerConstante();
+    inicio.periodoSincronia = periodoSincronia;
+    inicio.retardoAplicacion = retardoAplicacion;
+    traza.registrar(TRAZA_INICIO, halMicros(), &inicio, sizeof(inicio));
+}
+
+// Dejar de registrar y volcar lo que quede
+void Coche::detenerTraza() {
+    traza.detener();
+    guardarTraza();
+#ifndef COCHE_HOST
+    if (ficheroTraza) ficheroTraza.close();
+#endif
+}
+
+// Volcar lo pendiente al fichero (tarea "traza", cada 500 ms)
+void Coche::guardarTraza() {
+#ifndef COCHE_HOST
+    if (!ficheroTraza || traza.pendientes() == 0) return;
+    traza.volcar(ficheroTraza);
+    ficheroTraza.flush();
+#endif
+}
+
+size_t Coche::volcarTraza(Print& destino) {
+    return traza.volcar(destino);
+}
+
+RegistroTraza& Coche::obtenerTraza() {
+    return traza;
+}
+
+// ========== VARIANTES DE ROL ==========
+
+// Instancias que usa CocheT (CocheT.h); el enlazador quita las que el sketch
+// no llama. Coche es la variante <RolDinamico, ConSensores, ConWeb>.
+template void Coche::controlarDistancia<RolDinamico>();
+template void Coche::controlarDistancia<RolMaestro>();
+template void Coche::controlarDistancia<RolEsclavo>();
+
+#define COCHE_INSTANCIAR_VARIANTE(Rol, Sensores) \
+    template void Coche::enviarComandoESPNow<Rol, Sensores>(); \
+    template void Coche::atenderESPNow<Rol, Sensores>(); \
+    template void Coche::iniciarTareas<Rol, Sensores, ConWeb>(); \
+    template void Coche::iniciarTareas<Rol, Sensores, SinWeb>();
+
+COCHE_INSTANCIAR_VARIANTE(RolDinamico, ConSensores)
+COCHE_INSTANCIAR_VARIANTE(RolDinamico, SoloLuz)
+COCHE_INSTANCIAR_VARIANTE(RolDinamico, SinSensores)
+COCHE_INSTANCIAR_VARIANTE(RolMaestro, ConSensores)
+COCHE_INSTANCIAR_VARIANTE(RolMaestro, SoloLuz)
+COCHE_INSTANCIAR_VARIANTE(RolMaestro, SinSensores)
+COCHE_INSTANCIAR_VARIANTE(RolEsclavo, ConSensores)
+COCHE_INSTANCIAR_VARIANTE(RolEsclavo, SoloLuz)
+COCHE_INSTANCIAR_VARIANTE(RolEsclavo, SinSensores)
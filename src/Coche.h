@@ -3,32 +3,82 @@
 
 #include <Arduino.h>
 #include <ESP8266WiFi.h>
+#ifdef COCHE_SERVIDOR_ASINCRONO
+#include <ESPAsyncWebServer.h>
+#else
 #include <ESP8266WebServer.h>
-#include <espnow.h>
+#endif
+#ifndef COCHE_HOST
+#include <LittleFS.h>
+#endif
+#include "Hal.h"
+#include "MedidorDistancia.h"
+#include "FiltroDistancia.h"
+#include "Protocolo.h"
+#include "ColaEnvio.h"
+#include "TablaPares.h"
+#include "Histograma.h"
+#include "Buzon.h"
+#include "Telemetria.h"
+#include "EmisorEventos.h"
+#include "Planificador.h"
+#include "ControladorPID.h"
+#include "RampaMotor.h"
+#include "ExtrapoladorMando.h"
+#include "FusionHueco.h"
+#include "SincroniaReloj.h"
+#include "RegistroTraza.h"
+#include "Bitacora.h"
 
-// Estructura de datos para enviar comandos por ESP-NOW
-typedef struct struct_mensaje {
-    int velocidadIzq;  // Velocidad motor izquierdo (-255 a 255)
-    int velocidadDer;  // Velocidad motor derecho (-255 a 255)
-    char comando[20];  // Comando: "AVANZAR", "RETROCEDER", "DETENER", etc.
-    float temperatura; // Temperatura del sensor LM35 (grados Celsius)
-    int luminosidad;   // Luminosidad del sensor LM393 (0=oscuro, 1=claro)
-    bool tieneSensores; // true si este coche tiene sensores físicos conectados
-} struct_mensaje;
+// Copia de una trama tal como llegó al callback de recepción
+struct TramaRecibida {
+    uint8_t mac[6];
+    uint8_t longitud;
+    uint8_t datos[ColaEnvio::TAM_MAX_TRAMA];
+    unsigned long marcaUs;  // micros() en el callback
+};
+
+// Orden a los motores que espera a su instante (reloj propio)
+struct OrdenProgramada {
+    int16_t izq;
+    int16_t der;
+    uint8_t movimiento;   // CodigoMovimiento (comando del maestro)
+    bool parada;          // Maestro: detener sin rampa
+    unsigned long instante;
+};
+
+// Órdenes programadas en espera: con el retardo por debajo del periodo del
+// control basta con dos; el resto cubre retardos más largos
+#define ORDENES_PROGRAMADAS 4
+
+// Órdenes que cambian el estado desde la web
+enum OrdenWeb : uint8_t {
+    ORDEN_MODO_MAESTRO,
+    ORDEN_MODO_ESCLAVO,
+    ORDEN_ALTERNAR_AUTOMATICO,
+    ORDEN_ALTERNAR_LUCES,
+    ORDEN_ALTERNAR_LUCES_AUTO,
+    ORDEN_REINICIAR_LATENCIAS,
+    ORDEN_REINICIAR_TAREAS
+};
 
-// Estructura para comandos de control (cambio de modo)
-typedef struct struct_control {
-    char tipoComando[20];  // "CAMBIAR_MODO"
-    char nuevoModo[20];    // "MAESTRO" o "ESCLAVO"
-} struct_control;
+// Resultado de envío tal como llegó al callback de envío
+struct ResultadoACK {
+    bool exitoso;
+    unsigned long marcaUs;
+};
 
-// Estructura para respuesta con datos de sensores (comunicación bidireccional)
-typedef struct struct_respuesta {
-    float temperatura;     // Temperatura del sensor LM35
-    int luminosidad;       // Luminosidad del sensor LM393
-    bool tieneSensores;    // true si tiene sensores físicos
-    char origen[20];       // "MAESTRO" o "ESCLAVO" para identificar quién envía
-} struct_respuesta;
+// Políticas de CocheT (ver CocheT.h). El rol dice qué caminos se compilan:
+// MAESTRO = control de distancia y envío de comandos, ESCLAVO = aplicar
+// comandos y responder; FIJO = no cambia en marcha (sin comprobar esMaestro).
+struct RolDinamico { static const bool FIJO = false; static const bool MAESTRO = true;  static const bool ESCLAVO = true; };
+struct RolMaestro  { static const bool FIJO = true;  static const bool MAESTRO = true;  static const bool ESCLAVO = false; };
+struct RolEsclavo  { static const bool FIJO = true;  static const bool MAESTRO = false; static const bool ESCLAVO = true; };
+struct ConSensores { static const bool SENSORES = true;  static const bool TEMPERATURA = true; };   // LM393 y LM35
+struct SoloLuz     { static const bool SENSORES = true;  static const bool TEMPERATURA = false; };  // Solo LM393
+struct SinSensores { static const bool SENSORES = false; static const bool TEMPERATURA = false; };
+struct ConWeb { static const bool WEB = true; };             // Tarea del servidor web
+struct SinWeb { static const bool WEB = false; };
 
 class Coche {
 private:
@@ -41,6 +91,8 @@ private:
     // Pines del sensor HC-SR04
     int trigPin;
     int echoPin;
+    MedidorDistancia medidor;  // Medición asíncrona por interrupción
+    FiltroDistancia filtro;    // Mediana/Kalman sobre cada muestra nueva
     
     // Pin del sensor LM35 (temperatura)
     int tempPin;
@@ -55,10 +107,40 @@ private:
     float distanciaObjetivo;
     float distanciaMin;  // Límite inferior zona muerta
     float distanciaMax;  // Límite superior zona muerta
-    float kp; // Constante proporcional para control
+    int32_t distanciaMinQ, distanciaMaxQ;  // La zona muerta en Q16, para el lazo
+    float distanciaSeguridad;  // Esclavo: no avanzar más cerca de esto (0 = sin límite)
+    ExtrapoladorMando mando;   // Esclavo: qué aplicar mientras no llegan comandos
+    uint8_t movimientoMando;   // CodigoMovimiento del último comando recibido
+    FusionHueco fusion;        // Esclavo: hueco propio fusionado con los comandos del maestro
+    bool fusionActiva;         // Esclavo con HC-SR04: control propio sobre la fusión
+    bool siguiendoHueco;       // El control propio manda (si no, se aplican los comandos)
+    SincroniaReloj reloj;      // Esclavo: reloj del maestro, base de tiempo común
+    unsigned long periodoSincronia;   // us entre intercambios de sincronía (0 = sin sincronía)
+    unsigned long ultimaSincronia;    // micros() de la última petición (en una respuesta)
+    unsigned long retardoAplicacion;  // us: el maestro aplica sus órdenes este tiempo después (0 = al momento)
+    uint32_t aplicarEnEnviado;        // Maestro: instante de la orden que llevan los comandos (0 = inmediata)
+    uint32_t ultimoAplicarEn;         // Esclavo: instante del último comando programado (repetidos)
+    OrdenProgramada programadas[ORDENES_PROGRAMADAS];  // Por instante
+    uint8_t numProgramadas;
+    unsigned long comandosTarde;        // Esclavo: llegaron pasado su instante
+    ControladorPID pid;      // PID en punto fijo sobre el error a la zona muerta
+    int16_t pwmMinimo;       // PWM por debajo del cual los motores no arrancan
+    unsigned long ultimoControl;  // micros() del último paso del PID
+    
+    // Etapa de salida de los motores: impulso de arranque y rampa por rueda
+    RampaMotor rampaIzq;
+    RampaMotor rampaDer;
+    int16_t pwmAplicadoIzq;  // Último PWM con signo aplicado a cada rueda
+    int16_t pwmAplicadoDer;
+    int16_t pwmCanal[4];     // Último valor escrito en cada pin (1A, 1B, 2A, 2B); -1 = desconocido
     
-    // Servidor web
+    // Servidor web (síncrono por defecto; asíncrono con COCHE_SERVIDOR_ASINCRONO)
+#ifdef COCHE_SERVIDOR_ASINCRONO
+    AsyncWebServer* servidor;
+    ColaSPSC<uint8_t, 8> ordenesWeb;  // Órdenes de los manejadores asíncronos, aplicadas en loop()
+#else
     ESP8266WebServer* servidor;
+#endif
     
     // Variables para datos de sensores
     float ultimaDistancia;
@@ -67,16 +149,14 @@ private:
     String estadoMovimiento;  // "PARADO", "AVANZANDO", "RETROCEDIENDO"
     unsigned long ultimaLecturaDistancia;
     
-    // Variables para sensores compartidos
-    float temperaturaRemota;  // Temperatura recibida del otro coche
-    int luminosidadRemota;    // Luminosidad recibida del otro coche
-    bool tieneSensoresLocales; // true si este coche tiene sensores conectados
-    bool datosRemotos Validos; // true si hemos recibido datos del otro coche
-    unsigned long ultimosDatosRemotos; // timestamp de última recepción
+    // Variables para sensores compartidos (los datos remotos viven en la tabla de pares)
+    bool tieneSensoresLocales; // true si este coche tiene LM393 (el LM35 es opcional)
     
     // Variables para ESP-NOW
     bool esMaestro;  // true = maestro, false = esclavo
-    uint8_t macRemota[6];  // MAC del dispositivo remoto
+    bool rolFijo;    // CocheT con RolMaestro/RolEsclavo: no se acepta cambiarModo
+    TablaPares pares;  // Coches de la flota con estadísticas y sensores por par
+    uint8_t macMaestro[6];  // MAC del último maestro oído (destino de las respuestas)
     int ultimaVelocidadIzq;
     int ultimaVelocidadDer;
     bool espnowInicializado;
@@ -85,16 +165,99 @@ private:
     bool estadoLuces;  // true = luces encendidas, false = apagadas
     
     // Variables para log de mensajes
-    unsigned long mensajesEnviados;  // Contador de mensajes enviados
     unsigned long mensajesRecibidos;  // Contador de mensajes recibidos
-    unsigned long mensajesFallidos;  // Contador de mensajes fallidos
-    bool esperandoACK;  // true si está esperando confirmación
-    unsigned long ultimoEnvio;  // Timestamp del último envío (throttling 100ms)
+    unsigned long tramasInvalidas;  // Tramas descartadas (tamaño, versión o CRC)
+    ColaEnvio colaEnvio;  // Ventana deslizante con reintentos y timeouts de ACK
+    unsigned long ultimoEnvio;  // Timestamp del último comando encolado
+    unsigned long intervaloEnvio;  // ms mínimos entre comandos (0 = lo que dé la radio)
+    
+    // Buzones callback → loop: el callback solo copia, loop() procesa
+    RanuraUltimoValor<TramaRecibida> buzonComando;  // El comando más nuevo gana
+    ColaSPSC<TramaRecibida, 8> buzonTramas;         // Control y respuestas, en orden
+    ColaSPSC<ResultadoACK, 8> buzonACK;             // Resultados de envío
+    unsigned long tramasDemasiadoLargas;
+    
+    // Instrumentación de latencia (us)
+    Histograma histRTT;         // Comando → respuesta con su eco (maestro)
+    Histograma histUnaVia;      // (RTT - retención en el esclavo) / 2
+    Histograma histACK;         // Transmisión → callback de envío
+    Histograma histAplicacion;  // Recepción del comando → motores aplicados (esclavo)
+    Histograma histSilencio;    // Silencios del maestro, al terminar (esclavo)
+    Histograma histPanel;       // Tiempo hasta el primer byte de la página principal
+    uint32_t heapMinimoPanel;   // Heap libre más bajo justo antes de enviarla
+    
+    // Telemetría sin memoria dinámica: instantánea y buffer del peor caso
+    InstantaneaTelemetria instantanea;
+    char bufferTelemetria[TELEMETRIA_TAM_MAX];
+    
+    // Telemetría empujada por Server-Sent Events (/eventos)
+    EmisorEventos eventos;
+    InstantaneaTelemetria instantaneaPublicada;  // Lo último que tienen los oyentes sincronizados
+    unsigned long ultimoEvento;
+    unsigned long ultimoLatido;
+    unsigned long intervaloEventos;  // ms mínimos entre eventos
+    
+    void atenderEventos();
+    void registrarPanel(unsigned long inicio);
+    
+    // Planificador de las tareas periódicas del coche
+    Planificador planificador;
+    int tareaEnvio;  // Id de la tarea de radio, -1 si loop() llama a mano
+    int tareaControl;  // Id de la tarea de control, -1 si loop() llama a mano
+    const char* aplicarOrdenWeb(uint8_t orden);  // Devuelve el texto de respuesta
+    unsigned long marcaRecepcion;        // micros() de la trama en proceso
+    unsigned long marcaComandoRemoto;    // marcaTiempo del último comando recibido
+    unsigned long recepcionComandoRemoto; // micros() en que se recibió
+    
+    // Bitácora de envíos, recepciones y cambios de modo, escrita en tiempo libre
+    Bitacora bitacora;
+    
+    // Traza binaria para reproducir en Linux (extras/simulador/reproductor)
+    RegistroTraza traza;
+    const char* rutaTraza;  // Fichero en LittleFS, nullptr si solo RAM
+#ifndef COCHE_HOST
+    File ficheroTraza;
+#endif
+    void registrarInicioTraza();
+    bool encolarTrama(const uint8_t* mac, const uint8_t* datos, uint8_t longitud, bool reemplazable);
+    friend class ReproductorTraza;  // Inyecta los eventos grabados
+    
+    // Caminos por rol: Coche usa <RolDinamico, ConSensores, ConWeb> y CocheT
+    // sus políticas; instanciados en Coche.cpp
+    template <class, class, class> friend class CocheT;
+    template <class Rol> bool actuaComoMaestro() { if (Rol::FIJO) return Rol::MAESTRO; return esMaestro; }
+    template <class Rol> bool actuaComoEsclavo() { if (Rol::FIJO) return Rol::ESCLAVO; return !esMaestro; }
+    template <class Sensores> bool sensoresLocales() { return Sensores::SENSORES && tieneSensoresLocales; }
+    template <class Sensores> bool temperaturaLocal() { return Sensores::TEMPERATURA && tieneSensoresLocales && tempPin >= 0; }
+    template <class Rol> void controlarDistancia();
+    template <class Rol, class Sensores> void enviarComandoESPNow();
+    template <class Rol, class Sensores> void atenderESPNow();
+    template <class Rol, class Sensores> void procesarTramaRecibida(const uint8_t* mac, const uint8_t* datos,
+                                                                   uint8_t longitud, unsigned long marcaUs);
+    template <class Rol, class Sensores> void procesarComandoRecibido(InfoPar* origen, const TramaComando* datos);
+    template <class Rol, class Sensores> void enviarRespuestaSensores();
+    template <class Rol> void procesarRespuestaSensores(InfoPar* origen, const TramaRespuesta* datos);
+    template <class Rol> void procesarSincronia(InfoPar* origen, const TramaSincronia* datos);
+    template <class Rol, class Sensores, class Web> void iniciarTareas();
     
     // Funciones privadas
     void moverMotores(int velocidadIzq, int velocidadDer);
-    float leerDistanciaFiable();
+    void fijarMotores(int velocidadIzq, int velocidadDer);
+    void avanzarRampas();
     void detenerMotores();
+    void ordenControl(int velocidadIzq, int velocidadDer, bool parada);
+    void programarOrden(const OrdenProgramada& orden);
+    void atenderProgramadas();
+    void aplicarProgramada(const OrdenProgramada& orden);
+    bool tocaSincronia();
+    void escribirMotores(int16_t izq, int16_t der);
+    void aplicarMando(int velocidadIzq, int velocidadDer, uint8_t movimiento);
+    void atenderSilencioMando();
+    void olvidarMando();
+    void procesarMuestraDistancia(bool valida, float distancia, unsigned long marcaUs);
+    void pasoControl(int32_t distanciaQ, int32_t velocidadHuecoQ);
+    void controlarHueco();
+    void pasoSeguimiento(unsigned long ahora);
     
 public:
     // Constructor
@@ -111,6 +274,7 @@ public:
     void girarIzquierda(int velocidad);
     void girarDerecha(int velocidad);
     void detener();
+    void atenderMotores();  // Avanzar impulso/rampa y escribir PWM (cada pocos ms)
     
     // Sensores
     float leerDistancia();
@@ -121,23 +285,88 @@ public:
     // Configuración
     void setDistanciaObjetivo(float distancia);
     void setRangoDistancia(float minDist, float maxDist);
+    void setDistanciaSeguridad(float distancia);  // Esclavo, con su propio HC-SR04 (0 = desactivada)
+    // Esclavo sin comandos del maestro (ver ExtrapoladorMando.h): tendencia
+    // durante horizonteMs (0 por defecto: el último comando), decaimiento a
+    // cero en decaimientoMs pasado presupuestoMs de silencio (por defecto 300
+    // y 500; presupuestoMs = 0 mantiene el último comando indefinidamente)
+    void configurarPerdidaMando(unsigned long horizonteMs, unsigned long presupuestoMs, unsigned long decaimientoMs);
+    // Esclavo con HC-SR04 (activado por defecto si tiene TRIG): controla su
+    // propio hueco con el PID y la zona muerta del maestro, a su ritmo, sobre
+    // la fusión de su sensor con los comandos del maestro (ver FusionHueco.h).
+    // Desactivado, o sin ecos durante 1 s, aplica los comandos tal cual.
+    // Llamar antes de iniciarTareas()
+    void setFusionHueco(bool activa);
+    // Modelo de los motores para la fusión: cm/s por PWM por encima de
+    // pwmBanda y constante de tiempo (por defecto 0.36, 90 y 150 ms;
+    // cmsPorPWM = 0 deja solo el sensor)
+    void configurarFusion(float cmsPorPWM, int16_t pwmBanda, unsigned long constanteMs);
+    // Reloj común y órdenes a la vez (ver SincroniaReloj.h): el esclavo
+    // sincroniza su reloj con el del maestro cada periodoMs (0 = desactivado,
+    // por defecto) y el maestro aplica cada orden del control retardoMs
+    // después de darla y manda ese instante en los comandos; el esclavo
+    // sincronizado los aplica en el mismo instante. retardoMs debe cubrir el
+    // intervalo de envío y la latencia (p. ej. 30 ms con el intervalo de
+    // 20 ms): lo que llega tarde se aplica al llegar. Igual en todos los coches
+    void configurarSincronia(unsigned long periodoMs, unsigned long retardoMs);
     void setConstanteProporcional(float kp_value);
+    void setConstanteIntegral(float ki_value);    // 1/s
+    void setConstanteDerivativa(float kd_value);  // s
+    void setFeedForward(float kff_value);         // PWM por cm/s de velocidad del obstáculo
+    void setPWMMinimo(int16_t pwm);
+    // Impulso de arranque (PWM y ms), pendiente máxima (PWM/s) y tirón máximo
+    // (PWM/s²); 0 desactiva cada límite
+    void configurarMotores(int16_t pwmImpulso, unsigned long impulsoMs,
+                           uint16_t pendienteMax, uint32_t tironMax);
+    void setFiltroDistancia(FiltroDistancia::Modo modo, uint8_t ventana = 5);
+    float obtenerVarianzaDistancia();  // cm²
+    float obtenerVelocidadDistancia(); // cm/s
     
     // WiFi y servidor web
     void inicializarWiFi(const char* ssid, const char* password);
     void inicializarServidorWeb();
-    void atenderClientes();
+    void atenderClientes();  // Peticiones HTTP y eventos a los navegadores
+    void setIntervaloEventos(unsigned long ms);  // Ritmo máximo de /eventos
+    uint8_t obtenerOyentes();  // Navegadores suscritos a /eventos
     String obtenerDatosJSON();
+    void tomarInstantanea(InstantaneaTelemetria& destino);  // Solo valores ya leídos
+    size_t escribirDatosJSON(char* destino, size_t tam);    // 0 si no cabe
     
     // ESP-NOW
     void inicializarESPNowDual(uint8_t macOtroCoche[6], bool empezarComoMaestro = true);
+    bool agregarPar(const uint8_t mac[6]);  // Añadir otro coche a la flota
+    uint8_t obtenerNumeroPares();
     void cambiarModo(bool nuevoModoMaestro);
     void enviarComandoESPNow();
-    void procesarComandoRecibido(struct_mensaje* datos);
-    void procesarControlRecibido(struct_control* datos);
+    void recibirTrama(const uint8_t* mac, const uint8_t* datos, uint8_t longitud);  // Callback: solo copia
+    void recibirACK(bool exitoso);  // Callback: solo copia
+    void procesarTramaRecibida(const uint8_t* mac, const uint8_t* datos, uint8_t longitud, unsigned long marcaUs);
+    void procesarComandoRecibido(InfoPar* origen, const TramaComando* datos);
+    void procesarControlRecibido(InfoPar* origen, const TramaControl* datos);
     void enviarRespuestaSensores();  // Esclavo envía sus sensores al maestro
-    void procesarRespuestaSensores(struct_respuesta* datos);  // Maestro recibe datos del esclavo
-    void registrarACK(bool exitoso);  // Registrar resultado de envío
+    void procesarRespuestaSensores(InfoPar* origen, const TramaRespuesta* datos);  // Maestro recibe datos del esclavo
+    void procesarSincronia(InfoPar* origen, const TramaSincronia* datos);  // Esclavo recibe la sincronía del maestro
+    SincroniaReloj& obtenerReloj();
+    void registrarACK(bool exitoso, unsigned long marcaUs);  // Registrar resultado de envío
+    void atenderESPNow();  // Vaciar buzones, transmitir cola y vigilar ACKs (cada loop, ambos roles)
+    void configurarEnvio(uint8_t ventana, unsigned long timeoutMs, uint8_t reintentos);
+    void setIntervaloEnvio(unsigned long ms);
+    
+    // Planificador: registra motores, sensores, control, radio, web y luces con su
+    // periodo; después loop() solo tiene que llamar a ejecutarTareas()
+    void iniciarTareas();
+    void ejecutarTareas();
+    Planificador& obtenerPlanificador();  // Para añadir tareas propias
+    String obtenerTareasJSON();
+    
+    // Traza binaria: sensores, tramas, ACKs y órdenes a los motores en un
+    // anillo en RAM que la tarea "traza" vuelca a LittleFS (ruta = nullptr:
+    // solo RAM, volcar a mano con volcarTraza). /traza descarga el fichero.
+    bool iniciarTraza(size_t bytesRAM = 4096, const char* ruta = "/traza.bin");
+    void detenerTraza();
+    void guardarTraza();                   // Volcar lo pendiente al fichero
+    size_t volcarTraza(Print& destino);    // Volcar lo pendiente a cualquier salida
+    RegistroTraza& obtenerTraza();
     void enviarCambioModo(bool nuevoModoMaestro);
     bool obtenerModo();
     String obtenerModoTexto();
@@ -160,13 +389,25 @@ public:
     int obtenerLuminosidadActual();   // Devuelve luz local o remota
     String obtenerOrigenDatos();      // "LOCAL", "REMOTO" o "SIN_DATOS"
     
+    // Bitácora diferida (ver Bitacora.h): ejecutarTareas() la escribe sola
+    // cuando no toca ninguna tarea; sin planificador, llamar a atenderBitacora()
+    void atenderBitacora();
+    Bitacora& obtenerBitacora();
+    
     // Estadísticas ESP-NOW
-    void agregarLog(String tipo, String detalle);  // Solo para Serial
+    void agregarLog(String tipo, String detalle);  // Directo al Serial, para sketches
     unsigned long obtenerMensajesEnviados();
     unsigned long obtenerMensajesRecibidos();
     unsigned long obtenerMensajesFallidos();
-    float obtenerTasaExito();  // Porcentaje de mensajes exitosos
-    bool puedeEnviar();  // Verifica si puede enviar (ACK + throttling)
+    unsigned long obtenerTramasInvalidas();
+    unsigned long obtenerReintentos();
+    unsigned long obtenerTimeoutsACK();
+    unsigned long obtenerComandosSobrescritos();  // Comandos sustituidos antes de procesarse
+    unsigned long obtenerDesbordesBuzon();        // Tramas/ACKs perdidos por buzón lleno
+    float obtenerTasaExito();  // Porcentaje de mensajes unicast con ACK (la difusión no tiene)
+    String obtenerLatenciaJSON();  // p50/p95/p99 de cada histograma (us)
+    void reiniciarLatencias();
+    bool puedeEnviar();  // Verifica si puede enviar (hueco en cola + intervalo)
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef COCHE_T_H
+#define COCHE_T_H
+
+#include "Coche.h"
+
+// Coche con el rol, los sensores y la web fijados al compilar.
+// Coche comprueba esMaestro en cada paso del control y de la radio; con
+// CocheT<RolMaestro> o CocheT<RolEsclavo> esas comprobaciones desaparecen y
+// el camino del otro rol no llega a enlazarse (el maestro no aplica comandos
+// ni responde; el esclavo no envía comandos y solo registra la tarea de
+// control si sigue su propio hueco).
+// SoloLuz quita la lectura del LM35 y SinSensores también la del LM393; SinWeb
+// la tarea "web": si el sketch no llama a inicializarServidorWeb(), el
+// servidor y el panel tampoco se enlazan. Con rol fijo no se cambia de modo:
+// cambiarModo() no compila y las órdenes de la web y de otros coches se
+// ignoran. Coche se comporta como CocheT<RolDinamico, ConSensores, ConWeb>.
+//
+//   CocheT<RolEsclavo, SinSensores, SinWeb> miCoche(D1, D2, D3, D4, D5, D6, -1, -1);
+template <class Rol, class Sensores = ConSensores, class Web = ConWeb>
+class CocheT : public Coche {
+public:
+    CocheT(int m1A, int m1B, int m2A, int m2B,
+           int trig, int echo, int temp, int light, int luces = -1)
+        : Coche(m1A, m1B, m2A, m2B, trig, echo, temp, light, luces) {
+        rolFijo = Rol::FIJO;
+        if (!Sensores::TEMPERATURA) tempPin = -1;
+        if (!Sensores::SENSORES) {
+            lightPin = -1;
+            tieneSensoresLocales = false;
+        }
+    }
+
+    // Con rol fijo se empieza (y se sigue) en ese rol
+    void inicializarESPNowDual(uint8_t macOtroCoche[6], bool empezarComoMaestro = Rol::MAESTRO) {
+        if (Rol::FIJO) empezarComoMaestro = Rol::MAESTRO;
+        Coche::inicializarESPNowDual(macOtroCoche, empezarComoMaestro);
+    }
+
+    void iniciarTareas() { Coche::iniciarTareas<Rol, Sensores, Web>(); }
+    void controlarDistancia() { Coche::controlarDistancia<Rol>(); }
+    void enviarComandoESPNow() { Coche::enviarComandoESPNow<Rol, Sensores>(); }
+    void atenderESPNow() { Coche::atenderESPNow<Rol, Sensores>(); }
+
+    void cambiarModo(bool nuevoModoMaestro) {
+        static_assert(!Rol::FIJO, "cambiarModo() necesita RolDinamico");
+        Coche::cambiarModo(nuevoModoMaestro);
+    }
+    void enviarCambioModo(bool nuevoModoMaestro) {
+        static_assert(!Rol::FIJO, "enviarCambioModo() necesita RolDinamico");
+        Coche::enviarCambioModo(nuevoModoMaestro);
+    }
+
+    void inicializarServidorWeb() {
+        static_assert(Web::WEB, "inicializarServidorWeb() necesita ConWeb");
+        Coche::inicializarServidorWeb();
+    }
+    void atenderClientes() {
+        static_assert(Web::WEB, "atenderClientes() necesita ConWeb");
+        Coche::atenderClientes();
+    }
+};
+
+#endif
@@ -0,0 +1,346 @@
+#include "ColaEnvio.h"
+#include "Hal.h"
+
+// Constructor
+ColaEnvio::ColaEnvio() {
+    for (uint8_t i = 0; i < CAPACIDAD; i++) {
+        huecos[i].estado = LIBRE;
+    }
+    contadorOrden = 0;
+    contadorTramas = 0;
+    primerEnvio = 0;
+    numEnvios = 0;
+    tiempoTipico = 0;
+    variacionTiempo = 0;
+    ventana = 2;           // Dos tramas en vuelo por defecto
+    reservaDifusion = 0;
+    timeoutUs = 50000;     // 50ms: el ACK de ESP-NOW llega en pocos ms
+    maxReintentos = 2;
+    funcionEnvio = halEnviarESPNow;
+    funcionSellado = nullptr;
+
+    transmisiones = 0;
+    entregadas = 0;
+    difundidas = 0;
+    reintentos = 0;
+    timeouts = 0;
+    ackTardios = 0;
+    fallos = 0;
+    descartadas = 0;
+    reemplazadas = 0;
+    rechazadas = 0;
+    callbacksPerdidos = 0;
+}
+
+// Configurar ventana, timeout de ACK y número de reintentos
+void ColaEnvio::configurar(uint8_t nuevaVentana, unsigned long nuevoTimeoutUs, uint8_t nuevosReintentos) {
+    if (nuevaVentana < 1) nuevaVentana = 1;
+    if (nuevaVentana > CAPACIDAD) nuevaVentana = CAPACIDAD;
+    ventana = nuevaVentana;
+    timeoutUs = nuevoTimeoutUs;
+    maxReintentos = nuevosReintentos;
+}
+
+// Cambiar la función de transmisión
+void ColaEnvio::setFuncionEnvio(FuncionEnvio funcion) {
+    funcionEnvio = funcion;
+}
+
+// Cambiar el retoque de las tramas al transmitirlas
+void ColaEnvio::setFuncionSellado(FuncionSellado funcion) {
+    funcionSellado = funcion;
+}
+
+// Reservar huecos de la ventana para la difusión
+void ColaEnvio::reservarDifusion(uint8_t huecos) {
+    reservaDifusion = huecos;
+}
+
+// Añadir trama a la cola
+bool ColaEnvio::encolar(const uint8_t* mac, const uint8_t* datos, uint8_t longitud, bool reemplazable) {
+    if (longitud == 0 || longitud > TAM_MAX_TRAMA) {
+        rechazadas++;
+        return false;
+    }
+
+    // La más fresca gana: sobrescribir la pendiente del mismo tipo y destino
+    if (reemplazable) {
+        for (uint8_t i = 0; i < CAPACIDAD; i++) {
+            Hueco& hueco = huecos[i];
+            if (hueco.estado == PENDIENTE && hueco.reemplazable &&
+                hueco.datos[0] == datos[0] && memcmp(hueco.mac, mac, 6) == 0) {
+                memcpy(hueco.datos, datos, longitud);
+                hueco.longitud = longitud;
+                hueco.reintentos = 0;
+                hueco.trama = ++contadorTramas;  // Un ACK tardío de la anterior no la confirma
+                reemplazadas++;
+                return true;
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < CAPACIDAD; i++) {
+        Hueco& hueco = huecos[i];
+        if (hueco.estado == LIBRE) {
+            memcpy(hueco.mac, mac, 6);
+            memcpy(hueco.datos, datos, longitud);
+            hueco.longitud = longitud;
+            hueco.reemplazable = reemplazable;
+            hueco.difusion = (mac[0] & 0x01) != 0;  // Bit de grupo de la MAC
+            hueco.reintentos = 0;
+            hueco.orden = ++contadorOrden;
+            hueco.trama = ++contadorTramas;
+            hueco.estado = PENDIENTE;
+            return true;
+        }
+    }
+
+    rechazadas++;
+    return false;
+}
+
+// Índice del hueco más antiguo en el estado dado (solo de difusión si se
+// pide), o -1
+int ColaEnvio::buscarMasAntiguo(uint8_t estado, bool soloDifusion) {
+    int encontrado = -1;
+    for (uint8_t i = 0; i < CAPACIDAD; i++) {
+        if (huecos[i].estado != estado) continue;
+        if (soloDifusion && !huecos[i].difusion) continue;
+        if (encontrado < 0 || (long)(huecos[i].orden - huecos[encontrado].orden) < 0) {
+            encontrado = i;
+        }
+    }
+    return encontrado;
+}
+
+// Número de huecos en el estado dado
+uint8_t ColaEnvio::contar(uint8_t estado) {
+    uint8_t total = 0;
+    for (uint8_t i = 0; i < CAPACIDAD; i++) {
+        if (huecos[i].estado == estado) total++;
+    }
+    return total;
+}
+
+// Tramas unicast en vuelo (las que cuentan contra la reserva de difusión)
+uint8_t ColaEnvio::contarUnicastEnVuelo() {
+    uint8_t total = 0;
+    for (uint8_t i = 0; i < CAPACIDAD; i++) {
+        if (huecos[i].estado == EN_VUELO && !huecos[i].difusion) total++;
+    }
+    return total;
+}
+
+// Volver a poner en cola una trama fallida o abandonarla. Con esperarACK
+// (timeout) el callback de la última transmisión aún puede llegar.
+void ColaEnvio::reintentarOdescartar(Hueco& hueco, bool esperarACK) {
+    // Si ya hay otra más fresca del mismo tipo, reintentar esta no tiene sentido
+    if (hueco.reemplazable) {
+        for (uint8_t i = 0; i < CAPACIDAD; i++) {
+            Hueco& otro = huecos[i];
+            if (&otro != &hueco && otro.estado == PENDIENTE && otro.reemplazable &&
+                otro.datos[0] == hueco.datos[0] && memcmp(otro.mac, hueco.mac, 6) == 0) {
+                hueco.estado = LIBRE;
+                reemplazadas++;
+                return;
+            }
+        }
+    }
+
+    if (hueco.reintentos < maxReintentos) {
+        hueco.reintentos++;
+        hueco.estado = PENDIENTE;  // Conserva su orden: sale antes que las llegadas después
+        reintentos++;
+    } else if (esperarACK) {
+        hueco.estado = ACK_TARDIO;
+    } else {
+        hueco.estado = LIBRE;
+        if (!hueco.difusion) descartadas++;
+    }
+}
+
+// Transmitir lo que quepa en la ventana y vigilar ACKs perdidos
+void ColaEnvio::atender(unsigned long ahoraUs) {
+    unsigned long esperaMaxima = timeoutUs * ESPERA_ACK_TARDIO;
+
+    // ACKs que no llegan a tiempo, y los que ya no van a llegar
+    for (uint8_t i = 0; i < CAPACIDAD; i++) {
+        Hueco& hueco = huecos[i];
+        if (hueco.estado == EN_VUELO && ahoraUs - hueco.marcaEnvio > timeoutUs) {
+            if (hueco.difusion) {
+                hueco.estado = ACK_TARDIO;  // Sin reintento: solo falta que salga
+                continue;
+            }
+            timeouts++;
+            reintentarOdescartar(hueco, true);
+        } else if (hueco.estado == ACK_TARDIO && ahoraUs - hueco.marcaEnvio > esperaMaxima) {
+            hueco.estado = LIBRE;
+            if (!hueco.difusion) descartadas++;
+        }
+    }
+    while (numEnvios > 0 && ahoraUs - envios[primerEnvio].marca > esperaMaxima) {
+        sacarEnvio();
+        callbacksPerdidos++;
+    }
+
+    // Llenar la ventana con las pendientes más antiguas; las unicast no
+    // pasan de los huecos que no están reservados a la difusión
+    uint8_t maxUnicast = reservaDifusion < ventana ? ventana - reservaDifusion : 1;
+    while (contar(EN_VUELO) < ventana && numEnvios < MAX_ENVIOS) {
+        int indice = buscarMasAntiguo(PENDIENTE, contarUnicastEnVuelo() >= maxUnicast);
+        if (indice < 0) break;
+
+        Hueco& hueco = huecos[indice];
+        if (funcionSellado != nullptr) funcionSellado(hueco.datos, hueco.longitud, ahoraUs);
+        if (funcionEnvio(hueco.mac, hueco.datos, hueco.longitud) != 0) {
+            fallos++;
+            reintentarOdescartar(hueco, false);
+            continue;
+        }
+        transmisiones++;
+        hueco.estado = EN_VUELO;
+        hueco.marcaEnvio = ahoraUs;
+
+        Envio& envio = envios[(primerEnvio + numEnvios) % MAX_ENVIOS];
+        envio.hueco = indice;
+        envio.intento = hueco.reintentos;
+        envio.trama = hueco.trama;
+        envio.difusion = hueco.difusion;
+        envio.marca = ahoraUs;
+        numEnvios++;
+    }
+}
+
+// Quitar la transmisión más antigua de las que esperan callback
+void ColaEnvio::sacarEnvio() {
+    primerEnvio = (primerEnvio + 1) % MAX_ENVIOS;
+    numEnvios--;
+}
+
+// Resultado de la transmisión más antigua que espera su callback
+long ColaEnvio::registrarACK(bool exitoso, unsigned long ahoraUs) {
+    if (numEnvios == 0) return -1;  // Su transmisión ya se dio por perdida
+
+    // Resincronizar tras un callback perdido: demasiado tarde para la más
+    // antigua y a tiempo para la siguiente. Su trama sigue en vuelo y su
+    // timeout decide si se reintenta.
+    if (tiempoTipico > 0) {
+        unsigned long tarde = tiempoTipico + RESINCRONIZAR * variacionTiempo;
+        unsigned long normal = tiempoTipico + variacionTiempo;
+        while (numEnvios > 1 && ahoraUs - envios[primerEnvio].marca > tarde &&
+               ahoraUs - envios[(primerEnvio + 1) % MAX_ENVIOS].marca <= normal) {
+            sacarEnvio();
+            callbacksPerdidos++;
+        }
+    }
+
+    Envio envio = envios[primerEnvio];
+    sacarEnvio();
+    long tiempoACK = ahoraUs - envio.marca;
+
+    // Tiempo típico de callback y su desviación (medias móviles)
+    if (tiempoTipico == 0) {
+        tiempoTipico = tiempoACK;
+        variacionTiempo = tiempoACK / 2;
+    } else {
+        long diferencia = tiempoACK - (long)tiempoTipico;
+        variacionTiempo += ((diferencia < 0 ? -diferencia : diferencia) - (long)variacionTiempo) / 4;
+        tiempoTipico += diferencia / 8;
+    }
+
+    Hueco& hueco = huecos[envio.hueco];
+    bool suya = hueco.estado != LIBRE && hueco.trama == envio.trama;
+
+    // Difusión: salió (o no) y nadie confirma nada
+    if (envio.difusion) {
+        if (suya) {
+            hueco.estado = LIBRE;
+            difundidas++;
+        }
+        return -1;
+    }
+
+    // La trama ya se resolvió (otro ACK, descarte) o se sustituyó por otra
+    if (!suya) {
+        if (!exitoso) fallos++;
+        return tiempoACK;
+    }
+
+    bool ultima = hueco.reintentos == envio.intento;  // Su transmisión más reciente
+    bool actual = hueco.estado == EN_VUELO && ultima;
+    if (exitoso) {
+        // Tardío o no, la trama llegó: no hace falta el reintento
+        if (!actual) ackTardios++;
+        hueco.estado = LIBRE;
+        entregadas++;
+    } else {
+        fallos++;
+        if (actual) {
+            reintentarOdescartar(hueco, false);
+        } else if (hueco.estado == ACK_TARDIO && ultima) {
+            hueco.estado = LIBRE;
+            descartadas++;
+        }
+        // Si ya se está reintentando por timeout, el reintento sigue su curso
+    }
+    return tiempoACK;
+}
+
+// ¿Se puede encolar una trama nueva?
+bool ColaEnvio::hayHueco() {
+    return contar(LIBRE) > 0;
+}
+
+// Tramas en vuelo
+uint8_t ColaEnvio::obtenerEnVuelo() {
+    return contar(EN_VUELO);
+}
+
+// Tramas esperando a ser transmitidas
+uint8_t ColaEnvio::obtenerPendientes() {
+    return contar(PENDIENTE);
+}
+
+unsigned long ColaEnvio::obtenerTransmisiones() {
+    return transmisiones;
+}
+
+unsigned long ColaEnvio::obtenerEntregadas() {
+    return entregadas;
+}
+
+unsigned long ColaEnvio::obtenerDifundidas() {
+    return difundidas;
+}
+
+unsigned long ColaEnvio::obtenerReintentos() {
+    return reintentos;
+}
+
+unsigned long ColaEnvio::obtenerTimeouts() {
+    return timeouts;
+}
+
+unsigned long ColaEnvio::obtenerACKTardios() {
+    return ackTardios;
+}
+
+unsigned long ColaEnvio::obtenerFallos() {
+    return fallos;
+}
+
+unsigned long ColaEnvio::obtenerDescartadas() {
+    return descartadas;
+}
+
+unsigned long ColaEnvio::obtenerReemplazadas() {
+    return reemplazadas;
+}
+
+unsigned long ColaEnvio::obtenerRechazadas() {
+    return rechazadas;
+}
+
+unsigned long ColaEnvio::obtenerCallbacksPerdidos() {
+    return callbacksPerdidos;
+}
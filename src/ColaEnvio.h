@@ -0,0 +1,155 @@
+#ifndef COLA_ENVIO_H
+#define COLA_ENVIO_H
+
+#include <Arduino.h>
+
+// Cola de envío ESP-NOW con ventana deslizante.
+// Permite varias tramas en vuelo a la vez, reintenta las que fallan o cuyo
+// ACK no llega a tiempo y, para las tramas reemplazables, la más reciente
+// sustituye a la pendiente del mismo tipo (la más fresca gana).
+//
+// El SDK del ESP8266 entrega un callback de envío por cada esp_now_send
+// aceptado y en el mismo orden, sin decir de qué trama es. La cola guarda
+// las transmisiones en ese orden y cada callback se asigna a la más antigua
+// que espera el suyo, aunque su trama ya haya vencido el timeout y esté
+// pendiente de reintento: un ACK tardío confirma su propia trama y no la
+// siguiente en vuelo. Si una transmisión lleva ESPERA_ACK_TARDIO timeouts
+// sin callback se da por perdido.
+//
+// Un callback que se pierde con tráfico continuo no llega a esperar tanto:
+// el de la transmisión siguiente se le asignaría a ella, y así a todas las
+// demás. Por eso, si el callback llega mucho después de lo habitual para la
+// más antigua (el tiempo típico más RESINCRONIZAR desviaciones, medidos con
+// los callbacks, como el RTO de TCP) y en su tiempo normal para la siguiente,
+// el de la más antigua se da por perdido y se casa con la siguiente. Si se
+// equivoca (un callback muy lento de verdad), su trama solo se reintenta de
+// más y el desfase se corrige en cuanto no queda nada esperando callback.
+//
+// Las tramas de difusión (dirección de grupo) no tienen ACK de ningún
+// destino: su callback solo dice que la trama salió. Solo se reintentan si
+// esp_now_send falla en local, y no cuentan como entregadas ni descartadas
+// ni en el tiempo de ACK; ocupan la ventana hasta su callback y se cuentan
+// como difundidas. Con reservarDifusion() las unicast dejan libres esos
+// huecos de la ventana, para que un unicast esperando su ACK no retrase la
+// difusión periódica.
+//
+// Una trama puede esperar en la cola bastante después de sellarse. Si lleva
+// una marca que debe ser la de salida, la función de sellado la rehace
+// justo antes de cada transmisión.
+class ColaEnvio {
+public:
+    static const uint8_t CAPACIDAD = 8;        // Tramas pendientes + en vuelo
+    static const uint8_t TAM_MAX_TRAMA = 32;   // Bytes por trama
+    static const uint8_t MAX_ENVIOS = 16;      // Transmisiones esperando su callback
+    static const uint8_t ESPERA_ACK_TARDIO = 4;  // Timeouts que se espera un callback
+    static const uint8_t RESINCRONIZAR = 8;      // Desviaciones sobre el tiempo típico de callback
+
+    // Función de transmisión (halEnviarESPNow o un sustituto para pruebas)
+    typedef int (*FuncionEnvio)(uint8_t* mac, uint8_t* datos, int longitud);
+
+    // Retoque de la trama al transmitirla (marca de tiempo y CRC)
+    typedef void (*FuncionSellado)(uint8_t* datos, uint8_t longitud, unsigned long ahoraUs);
+
+    ColaEnvio();
+
+    // Configuración
+    void configurar(uint8_t ventana, unsigned long timeoutUs, uint8_t maxReintentos);
+    void setFuncionEnvio(FuncionEnvio funcion);
+    void setFuncionSellado(FuncionSellado funcion);  // nullptr = sin retoque
+
+    // Huecos de la ventana que las unicast dejan para la difusión (como
+    // mucho ventana - 1)
+    void reservarDifusion(uint8_t huecos);
+
+    // Añadir trama. Si es reemplazable y ya hay una pendiente del mismo tipo
+    // (primer byte) hacia el mismo destino, se sobrescribe en su sitio.
+    bool encolar(const uint8_t* mac, const uint8_t* datos, uint8_t longitud, bool reemplazable);
+
+    // Transmitir pendientes mientras quepan en la ventana y vigilar timeouts
+    void atender(unsigned long ahoraUs);
+
+    // Resultado de envío (desde el callback de ESP-NOW) de la transmisión más
+    // antigua sin callback. Devuelve los us desde esa transmisión, o -1 si no
+    // quedaba ninguna o era de difusión (no hay ACK que medir).
+    long registrarACK(bool exitoso, unsigned long ahoraUs);
+
+    // Estado
+    bool hayHueco();
+    uint8_t obtenerEnVuelo();
+    uint8_t obtenerPendientes();
+
+    // Estadísticas
+    unsigned long obtenerTransmisiones();  // Llamadas a la función de envío
+    unsigned long obtenerEntregadas();     // Tramas unicast con ACK positivo
+    unsigned long obtenerDifundidas();     // Tramas de difusión que salieron
+    unsigned long obtenerReintentos();     // Retransmisiones
+    unsigned long obtenerTimeouts();       // ACKs que no llegaron a tiempo
+    unsigned long obtenerACKTardios();     // ACKs positivos llegados tras su timeout
+    unsigned long obtenerFallos();         // ACKs negativos
+    unsigned long obtenerDescartadas();    // Tramas abandonadas tras los reintentos
+    unsigned long obtenerReemplazadas();   // Tramas sustituidas por otra más fresca
+    unsigned long obtenerRechazadas();     // Tramas no admitidas por cola llena
+    unsigned long obtenerCallbacksPerdidos();  // Transmisiones sin callback
+
+private:
+    // ACK_TARDIO: agotó los reintentos por timeout pero su último callback
+    // aún puede llegar; sigue ocupando el hueco hasta entonces
+    enum EstadoHueco : uint8_t { LIBRE, PENDIENTE, EN_VUELO, ACK_TARDIO };
+
+    struct Hueco {
+        uint8_t estado;
+        uint8_t mac[6];
+        uint8_t datos[TAM_MAX_TRAMA];
+        uint8_t longitud;
+        bool reemplazable;
+        bool difusion;             // Dirección de grupo: sin ACK del destino
+        uint8_t reintentos;
+        unsigned long orden;       // Orden de llegada a la cola
+        unsigned long trama;       // Identificador del contenido (cambia al reemplazarlo)
+        unsigned long marcaEnvio;  // micros() de la última transmisión
+    };
+
+    // Transmisión esperando su callback
+    struct Envio {
+        uint8_t hueco;
+        uint8_t intento;           // reintentos del hueco al transmitir
+        bool difusion;
+        unsigned long trama;
+        unsigned long marca;       // micros() de la transmisión
+    };
+
+    Hueco huecos[CAPACIDAD];
+    unsigned long contadorOrden;
+    unsigned long contadorTramas;
+    Envio envios[MAX_ENVIOS];      // Cola circular en orden de transmisión
+    uint8_t primerEnvio;
+    uint8_t numEnvios;
+    unsigned long tiempoTipico;    // us de callback con una sola transmisión esperando (media móvil)
+    unsigned long variacionTiempo; // Su desviación media, como el RTO de TCP
+    uint8_t ventana;
+    uint8_t reservaDifusion;
+    unsigned long timeoutUs;
+    uint8_t maxReintentos;
+    FuncionEnvio funcionEnvio;
+    FuncionSellado funcionSellado;
+
+    unsigned long transmisiones;
+    unsigned long entregadas;
+    unsigned long difundidas;
+    unsigned long reintentos;
+    unsigned long timeouts;
+    unsigned long ackTardios;
+    unsigned long fallos;
+    unsigned long descartadas;
+    unsigned long reemplazadas;
+    unsigned long rechazadas;
+    unsigned long callbacksPerdidos;
+
+    int buscarMasAntiguo(uint8_t estado, bool soloDifusion = false);
+    uint8_t contar(uint8_t estado);
+    uint8_t contarUnicastEnVuelo();
+    void reintentarOdescartar(Hueco& hueco, bool esperarACK);
+    void sacarEnvio();
+};
+
+#endif
@@ -0,0 +1,157 @@
+#include "ControladorPID.h"
+
+// Constructor
+ControladorPID::ControladorPID() {
+    kp = 8.0;
+    ki = 0.0;
+    kd = 0.0;
+    kff = 0.0;
+    alfa = 0.2;          // Derivada bastante filtrada: el HC-SR04 es ruidoso
+    periodoUs = 20000;   // 50 Hz
+    minimoQ = -255 * UNO;
+    maximoQ = 255 * UNO;
+    recalcular();
+    reiniciar();
+}
+
+// Convertir a Q16 con redondeo y saturación
+int32_t ControladorPID::aQ16(float valor) {
+    float escalado = valor * UNO;
+    if (escalado > 2147483000.0f) return INT32_MAX;
+    if (escalado < -2147483000.0f) return INT32_MIN;
+    return (int32_t)(escalado < 0 ? escalado - 0.5f : escalado + 0.5f);
+}
+
+// Recortar un valor intermedio de 64 bits
+int32_t ControladorPID::saturar(int64_t valor, int32_t minimo, int32_t maximo) {
+    if (valor > maximo) return maximo;
+    if (valor < minimo) return minimo;
+    return (int32_t)valor;
+}
+
+// Pasar ganancias y periodo a Q16
+void ControladorPID::recalcular() {
+    float periodoS = periodoUs / 1000000.0f;
+    kpQ = aQ16(kp);
+    kiTsQ = aQ16(ki * periodoS);
+    kdTsQ = aQ16(kd / periodoS);
+    kffQ = aQ16(kff);
+    alfaQ = aQ16(alfa);
+}
+
+void ControladorPID::setGanancias(float nuevaKp, float nuevaKi, float nuevaKd) {
+    kp = nuevaKp;
+    ki = nuevaKi;
+    kd = nuevaKd;
+    recalcular();
+}
+
+void ControladorPID::setKp(float nuevaKp) {
+    kp = nuevaKp;
+    recalcular();
+}
+
+void ControladorPID::setKi(float nuevaKi) {
+    ki = nuevaKi;
+    if (ki == 0) integralQ = 0;
+    recalcular();
+}
+
+void ControladorPID::setKd(float nuevaKd) {
+    kd = nuevaKd;
+    recalcular();
+}
+
+void ControladorPID::setFeedForward(float nuevaKff) {
+    kff = nuevaKff;
+    recalcular();
+}
+
+void ControladorPID::setFiltroDerivada(float nuevoAlfa) {
+    if (nuevoAlfa < 0.01f) nuevoAlfa = 0.01f;
+    if (nuevoAlfa > 1.0f) nuevoAlfa = 1.0f;
+    alfa = nuevoAlfa;
+    recalcular();
+}
+
+void ControladorPID::setPeriodo(unsigned long nuevoPeriodoUs) {
+    if (nuevoPeriodoUs == 0) return;
+    periodoUs = nuevoPeriodoUs;
+    recalcular();
+}
+
+void ControladorPID::setLimites(int16_t minimo, int16_t maximo) {
+    if (minimo > maximo) return;
+    minimoQ = (int32_t)minimo * UNO;
+    maximoQ = (int32_t)maximo * UNO;
+    integralQ = saturar(integralQ, minimoQ, maximoQ);
+}
+
+// Olvidar el estado dinámico
+void ControladorPID::reiniciar() {
+    integralQ = 0;
+    derivadaQ = 0;
+    errorAnteriorQ = 0;
+    hayAnterior = false;
+}
+
+// Un paso del lazo a periodo fijo
+int16_t ControladorPID::actualizar(int32_t errorQ16, int32_t referenciaFFQ16) {
+    // Proporcional
+    int64_t proporcional = ((int64_t)kpQ * errorQ16) >> 16;
+
+    // Derivada del error, filtrada: d += alfa * (bruta - d)
+    if (hayAnterior) {
+        int64_t bruta = ((int64_t)kdTsQ * ((int64_t)errorQ16 - errorAnteriorQ)) >> 16;
+        int64_t paso = ((int64_t)alfaQ * (bruta - derivadaQ)) >> 16;
+        derivadaQ = saturar(derivadaQ + paso, INT32_MIN / 2, INT32_MAX / 2);
+    }
+    errorAnteriorQ = errorQ16;
+    hayAnterior = true;
+
+    // Prealimentación
+    int64_t prealimentacion = ((int64_t)kffQ * referenciaFFQ16) >> 16;
+
+    // Integral candidata
+    int64_t incremento = ((int64_t)kiTsQ * errorQ16) >> 16;
+    int32_t integralNueva = saturar((int64_t)integralQ + incremento, minimoQ, maximoQ);
+
+    int64_t salida = proporcional + integralNueva + (int64_t)derivadaQ + prealimentacion;
+
+    // Anti-windup: si satura y el error empuja hacia ese mismo lado, no integrar
+    bool saturaArriba = salida > maximoQ && errorQ16 > 0 && incremento > 0;
+    bool saturaAbajo = salida < minimoQ && errorQ16 < 0 && incremento < 0;
+    if (!(saturaArriba || saturaAbajo)) {
+        integralQ = integralNueva;
+    }
+
+    salida = proporcional + integralQ + (int64_t)derivadaQ + prealimentacion;
+    int32_t saturada = saturar(salida, minimoQ, maximoQ);
+
+    // Redondear al entero más cercano
+    return (int16_t)((saturada + (saturada >= 0 ? UNO / 2 : -(UNO / 2))) / UNO);
+}
+
+int32_t ControladorPID::obtenerIntegral() {
+    return integralQ;
+}
+
+int32_t ControladorPID::obtenerDerivada() {
+    return derivadaQ;
+}
+
+float ControladorPID::obtenerKp() {
+    return kp;
+}
+
+float ControladorPID::obtenerKi() {
+    return ki;
+}
+
+float ControladorPID::obtenerKd() {
+    return kd;
+}
+
+float ControladorPID::obtenerFeedForward() {
+    return kff;
+}
@@ -0,0 +1,64 @@
+#ifndef CONTROLADOR_PID_H
+#define CONTROLADOR_PID_H
+
+#include <Arduino.h>
+
+// Controlador PID en punto fijo Q16.16 (el ESP8266 no tiene FPU).
+// Las ganancias se convierten a Q16 una sola vez en los setters, junto con el
+// periodo de muestreo, de modo que actualizar() solo usa enteros.
+//  - Integral con anti-windup: no se integra mientras la salida está saturada
+//    en el mismo sentido que el error, y el acumulador se limita a la salida.
+//  - Derivada del error filtrada con un paso bajo de primer orden.
+//  - Término de prealimentación (feed-forward) sumado a la salida.
+class ControladorPID {
+public:
+    static const int32_t UNO = 65536;  // 1.0 en Q16
+
+    ControladorPID();
+
+    // Configuración (float solo aquí, fuera del lazo)
+    void setGanancias(float kp, float ki, float kd);
+    void setKp(float kp);
+    void setKi(float ki);  // Por segundo
+    void setKd(float kd);  // Segundos
+    void setFeedForward(float kff);
+    void setFiltroDerivada(float alfa);  // 0..1: peso de la muestra nueva
+    void setPeriodo(unsigned long periodoUs);
+    void setLimites(int16_t minimo, int16_t maximo);
+
+    // Olvidar integral y derivada (p. ej. al entrar en la zona muerta)
+    void reiniciar();
+
+    // Un paso del lazo. error y referenciaFF en Q16; devuelve la salida
+    // saturada a los límites.
+    int16_t actualizar(int32_t errorQ16, int32_t referenciaFFQ16 = 0);
+
+    // Estado (Q16) para depuración
+    int32_t obtenerIntegral();
+    int32_t obtenerDerivada();
+
+    float obtenerKp();
+    float obtenerKi();
+    float obtenerKd();
+    float obtenerFeedForward();
+
+    static int32_t aQ16(float valor);
+
+private:
+    float kp, ki, kd, kff, alfa;
+    unsigned long periodoUs;
+
+    // Ganancias efectivas en Q16 (ki y kd ya multiplicadas/divididas por el periodo)
+    int32_t kpQ, kiTsQ, kdTsQ, kffQ, alfaQ;
+    int32_t minimoQ, maximoQ;
+
+    int32_t integralQ;
+    int32_t derivadaQ;
+    int32_t errorAnteriorQ;
+    bool hayAnterior;
+
+    void recalcular();
+    static int32_t saturar(int64_t valor, int32_t minimo, int32_t maximo);
+};
+
+#endif
@@ -0,0 +1,183 @@
+#include "EmisorEventos.h"
+
+#ifdef COCHE_SERVIDOR_ASINCRONO
+
+// Constructor
+EmisorEventos::EmisorEventos() : fuente("/eventos") {
+    for (uint8_t i = 0; i < MAX_OYENTES; i++) {
+        clientes[i] = nullptr;
+        sincronizados[i] = false;
+    }
+    eventosEnviados = 0;
+    eventosSaltados = 0;
+}
+
+// Registrar el manejador; cada conexión nueva pide un estado completo. Sin
+// hueco se cierra, como el 503 del servidor síncrono.
+void EmisorEventos::adjuntar(AsyncWebServer& servidor) {
+    fuente.onConnect([this](AsyncEventSourceClient* cliente) {
+        for (uint8_t i = 0; i < MAX_OYENTES; i++) {
+            if (clientes[i] == nullptr) {
+                sincronizados[i] = false;
+                clientes[i] = cliente;
+                return;
+            }
+        }
+        cliente->close();
+    });
+    fuente.onDisconnect([this](AsyncEventSourceClient* cliente) {
+        for (uint8_t i = 0; i < MAX_OYENTES; i++) {
+            if (clientes[i] == cliente) clientes[i] = nullptr;
+        }
+    });
+    servidor.addHandler(&fuente);
+}
+
+// Oyentes conectados
+uint8_t EmisorEventos::cantidad() {
+    return fuente.count();
+}
+
+// ¿Algún oyente pendiente del estado completo?
+bool EmisorEventos::faltaCompleto() {
+    for (uint8_t i = 0; i < MAX_OYENTES; i++) {
+        if (clientes[i] != nullptr && !sincronizados[i]) return true;
+    }
+    return false;
+}
+
+// Encolar el evento en cada oyente que corresponda. Con la cola llena la
+// librería lo tiraría sin avisar: se salta aquí, se cuenta y el oyente
+// recibirá el estado completo más adelante.
+void EmisorEventos::publicar(const char* datos, size_t longitud, bool completo) {
+    for (uint8_t i = 0; i < MAX_OYENTES; i++) {
+        AsyncEventSourceClient* cliente = clientes[i];
+        if (cliente == nullptr || !cliente->connected() || sincronizados[i] == completo) continue;
+        if (cliente->packetsWaiting() >= MAX_EVENTOS_EN_COLA) {
+            sincronizados[i] = false;
+            eventosSaltados++;
+            continue;
+        }
+        cliente->send(datos);
+        eventosEnviados++;
+        if (completo) sincronizados[i] = true;
+    }
+}
+
+// Latido: un comentario, que el navegador descarta sin generar evento
+void EmisorEventos::latido() {
+    for (uint8_t i = 0; i < MAX_OYENTES; i++) {
+        if (clientes[i] != nullptr && clientes[i]->connected()) {
+            clientes[i]->write(":\n\n", 3);
+        }
+    }
+}
+
+#else
+
+// Constructor
+EmisorEventos::EmisorEventos() {
+    for (uint8_t i = 0; i < MAX_OYENTES; i++) {
+        oyentes[i].activo = false;
+        oyentes[i].sincronizado = false;
+    }
+    eventosEnviados = 0;
+    eventosSaltados = 0;
+}
+
+// Enviar la cabecera del flujo y guardar la conexión
+bool EmisorEventos::agregar(WiFiClient& cliente) {
+    cantidad();  // Liberar huecos de conexiones cerradas
+    for (uint8_t i = 0; i < MAX_OYENTES; i++) {
+        Oyente& oyente = oyentes[i];
+        if (oyente.activo) continue;
+
+        cliente.setNoDelay(true);  // Eventos pequeños: no esperar a Nagle
+        cliente.print(F("HTTP/1.1 200 OK\r\n"
+                        "Content-Type: text/event-stream\r\n"
+                        "Cache-Control: no-cache\r\n"
+                        "Connection: keep-alive\r\n"
+                        "\r\n"
+                        "retry: 2000\n\n"));
+        oyente.cliente = cliente;
+        oyente.activo = true;
+        oyente.sincronizado = false;
+        return true;
+    }
+    return false;
+}
+
+// ¿Cabe otro oyente?
+bool EmisorEventos::hayHueco() {
+    return cantidad() < MAX_OYENTES;
+}
+
+// Oyentes conectados
+uint8_t EmisorEventos::cantidad() {
+    uint8_t total = 0;
+    for (uint8_t i = 0; i < MAX_OYENTES; i++) {
+        Oyente& oyente = oyentes[i];
+        if (!oyente.activo) continue;
+        if (!oyente.cliente.connected()) {
+            oyente.cliente.stop();
+            oyente.activo = false;
+            continue;
+        }
+        total++;
+    }
+    return total;
+}
+
+// ¿Algún oyente pendiente del estado completo?
+bool EmisorEventos::faltaCompleto() {
+    for (uint8_t i = 0; i < MAX_OYENTES; i++) {
+        if (oyentes[i].activo && !oyentes[i].sincronizado) return true;
+    }
+    return false;
+}
+
+// Escribir "data: ...\n\n" solo si cabe entero en el socket; si no, el
+// oyente pierde la sincronía y recibirá el estado completo más adelante
+bool EmisorEventos::escribirEvento(Oyente& oyente, const char* datos, size_t longitud) {
+    if ((size_t)oyente.cliente.availableForWrite() < longitud + 8) {
+        oyente.sincronizado = false;
+        eventosSaltados++;
+        return false;
+    }
+    oyente.cliente.write((const uint8_t*)"data: ", 6);
+    oyente.cliente.write((const uint8_t*)datos, longitud);
+    oyente.cliente.write((const uint8_t*)"\n\n", 2);
+    eventosEnviados++;
+    return true;
+}
+
+// Enviar un evento a los oyentes que corresponda
+void EmisorEventos::publicar(const char* datos, size_t longitud, bool completo) {
+    for (uint8_t i = 0; i < MAX_OYENTES; i++) {
+        Oyente& oyente = oyentes[i];
+        if (!oyente.activo || oyente.sincronizado == completo) continue;
+        if (escribirEvento(oyente, datos, longitud) && completo) {
+            oyente.sincronizado = true;
+        }
+    }
+}
+
+// Latido para todos los oyentes
+void EmisorEventos::latido() {
+    for (uint8_t i = 0; i < MAX_OYENTES; i++) {
+        Oyente& oyente = oyentes[i];
+        if (oyente.activo && oyente.cliente.availableForWrite() >= 3) {
+            oyente.cliente.write((const uint8_t*)":\n\n", 3);
+        }
+    }
+}
+
+#endif
+
+unsigned long EmisorEventos::obtenerEventosEnviados() {
+    return eventosEnviados;
+}
+
+unsigned long EmisorEventos::obtenerEventosSaltados() {
+    return eventosSaltados;
+}
@@ -0,0 +1,79 @@
+#ifndef EMISOR_EVENTOS_H
+#define EMISOR_EVENTOS_H
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#ifdef COCHE_SERVIDOR_ASINCRONO
+#include <ESPAsyncWebServer.h>
+#include <atomic>
+#endif
+
+#define MAX_OYENTES 4
+#ifdef COCHE_SERVIDOR_ASINCRONO
+// Eventos en la cola de un cliente asíncrono a partir de los que se le salta
+// (por debajo del límite de la librería, que los descartaría sin avisar)
+#define MAX_EVENTOS_EN_COLA 8
+#endif
+
+// Canal Server-Sent Events (text/event-stream) hacia varios navegadores.
+// El llamante serializa una vez y el mismo buffer se escribe en todas las
+// conexiones, así que cada oyente extra solo cuesta una copia al socket.
+// Un oyente nuevo, o uno que no pudo recibir un evento por tener el socket
+// lleno, queda marcado para recibir el estado completo en el siguiente.
+//
+// Con COCHE_SERVIDOR_ASINCRONO las conexiones las gestiona AsyncEventSource,
+// que encola por cliente. Los oyentes se apuntan al conectar y se borran al
+// desconectar (onConnect/onDisconnect, en la pila TCP) y cada evento se
+// encola cliente a cliente: uno con MAX_EVENTOS_EN_COLA esperando se salta y
+// pierde la sincronía, igual que con el socket lleno. La pila TCP del ESP8266
+// no interrumpe a loop(), así que la lista no cambia mientras se recorre.
+class EmisorEventos {
+public:
+    EmisorEventos();
+
+#ifdef COCHE_SERVIDOR_ASINCRONO
+    // Registrar /eventos en el servidor asíncrono
+    void adjuntar(AsyncWebServer& servidor);
+#else
+    // Responder a la petición y quedarse con la conexión. false si no hay hueco.
+    bool agregar(WiFiClient& cliente);
+    bool hayHueco();
+#endif
+
+    // Oyentes conectados (descarta los que se han ido)
+    uint8_t cantidad();
+
+    // ¿Hay algún oyente que necesite el estado completo?
+    bool faltaCompleto();
+
+    // Enviar un evento. Con completo=true solo va a los que lo necesitan y
+    // quedan sincronizados; si no, solo a los ya sincronizados.
+    void publicar(const char* datos, size_t longitud, bool completo);
+
+    // Comentario vacío para mantener viva la conexión y detectar caídas
+    void latido();
+
+    unsigned long obtenerEventosEnviados();  // Escrituras de evento a sockets
+    unsigned long obtenerEventosSaltados();  // Eventos no enviados por socket o cola llenos
+
+private:
+#ifdef COCHE_SERVIDOR_ASINCRONO
+    AsyncEventSource fuente;
+    AsyncEventSourceClient* clientes[MAX_OYENTES];
+    std::atomic<bool> sincronizados[MAX_OYENTES];  // onConnect (pila TCP) lo baja, loop() lo sube
+#else
+    struct Oyente {
+        WiFiClient cliente;
+        bool activo;
+        bool sincronizado;  // Ha recibido un estado completo y todos los deltas posteriores
+    };
+
+    Oyente oyentes[MAX_OYENTES];
+
+    bool escribirEvento(Oyente& oyente, const char* datos, size_t longitud);
+#endif
+    unsigned long eventosEnviados;
+    unsigned long eventosSaltados;
+};
+
+#endif
@@ -0,0 +1,200 @@
+#include "ExtrapoladorMando.h"
+
+// Periodo supuesto hasta tener dos comandos (intervalo de envío por defecto)
+#define MANDO_PERIODO_INICIAL_US 20000UL
+
+// Constructor. Sin horizonte por defecto: los comandos del control de
+// distancia van a saltos (zona muerta y PWM mínimo) y en el simulador mantener
+// el último se equivoca menos que seguir la tendencia
+ExtrapoladorMando::ExtrapoladorMando() {
+    configurar(0, 300000, 500000);
+    periodoUs = MANDO_PERIODO_INICIAL_US;
+    silencios = 0;
+    paradas = 0;
+    muestrasError = 0;
+    sumaError = 0;
+    errorMaximo = 0;
+    olvidar();
+}
+
+// Configurar horizonte, presupuesto de pérdida y decaimiento
+void ExtrapoladorMando::configurar(unsigned long horizonte, unsigned long presupuesto, unsigned long decaimiento) {
+    horizonteUs = horizonte;
+    presupuestoUs = presupuesto;
+    decaimientoUs = decaimiento;
+}
+
+unsigned long ExtrapoladorMando::obtenerHorizonte() {
+    return horizonteUs;
+}
+
+unsigned long ExtrapoladorMando::obtenerPresupuesto() {
+    return presupuestoUs;
+}
+
+unsigned long ExtrapoladorMando::obtenerDecaimiento() {
+    return decaimientoUs;
+}
+
+// Descartar historial y tendencia
+void ExtrapoladorMando::olvidar() {
+    cabeza = 0;
+    cantidad = 0;
+    pendienteIzqQ8 = 0;
+    pendienteDerQ8 = 0;
+    estado = SIN_MANDO;
+    entregadaIzq = 0;
+    entregadaDer = 0;
+}
+
+const ExtrapoladorMando::Muestra& ExtrapoladorMando::ultima() {
+    return historial[(cabeza + HISTORIAL - 1) % HISTORIAL];
+}
+
+// Registrar un comando recibido y cerrar el silencio anterior, si lo hubo
+unsigned long ExtrapoladorMando::registrar(int16_t izq, int16_t der, unsigned long ahoraUs) {
+    unsigned long silencio = 0;
+    if (cantidad > 0) {
+        unsigned long transcurrido = ahoraUs - ultima().marca;
+        if (transcurrido > periodoUs + periodoUs / 2) {
+            silencio = transcurrido;
+            silencios++;
+
+            // Error de lo extrapolado frente a lo que llega (el decaimiento
+            // no es una predicción: no cuenta)
+            if (presupuestoUs == 0 || transcurrido <= presupuestoUs) {
+                int16_t previstaIzq, previstaDer;
+                orden(transcurrido, previstaIzq, previstaDer);
+                int16_t error = (abs(previstaIzq - izq) + abs(previstaDer - der)) / 2;
+                muestrasError++;
+                sumaError += error;
+                if (error > errorMaximo) errorMaximo = error;
+            }
+
+            // La tendencia de antes del silencio ya no vale; el periodo sí
+            cantidad = 0;
+            pendienteIzqQ8 = 0;
+            pendienteDerQ8 = 0;
+        }
+    }
+
+    historial[cabeza].izq = izq;
+    historial[cabeza].der = der;
+    historial[cabeza].marca = ahoraUs;
+    cabeza = (cabeza + 1) % HISTORIAL;
+    if (cantidad < HISTORIAL) cantidad++;
+    estimar();
+
+    estado = SIGUIENDO;
+    entregadaIzq = izq;
+    entregadaDer = der;
+    return silencio;
+}
+
+// Periodo medio y recta de cada rueda por mínimos cuadrados (tiempo en ms
+// relativo al último comando)
+void ExtrapoladorMando::estimar() {
+    if (cantidad < 2) return;
+
+    const Muestra& u = ultima();
+    uint8_t primera = (cabeza + HISTORIAL - cantidad) % HISTORIAL;
+    periodoUs = (u.marca - historial[primera].marca) / (cantidad - 1);
+
+    int64_t st = 0, stt = 0, sIzq = 0, sDer = 0, stIzq = 0, stDer = 0;
+    for (uint8_t k = 0; k < cantidad; k++) {
+        const Muestra& m = historial[(primera + k) % HISTORIAL];
+        int64_t t = -(int64_t)((u.marca - m.marca) / 1000);
+        st += t;
+        stt += t * t;
+        sIzq += m.izq;
+        sDer += m.der;
+        stIzq += t * m.izq;
+        stDer += t * m.der;
+    }
+    int64_t n = cantidad;
+    int64_t denominador = n * stt - st * st;
+    if (denominador == 0) {  // Todos en el mismo ms
+        pendienteIzqQ8 = 0;
+        pendienteDerQ8 = 0;
+        return;
+    }
+    pendienteIzqQ8 = (int32_t)((n * stIzq - st * sIzq) * 256 / denominador);
+    pendienteDerQ8 = (int32_t)((n * stDer - st * sDer) * 256 / denominador);
+}
+
+// Avanzar un valor con su pendiente, sin cruzar el cero
+int16_t ExtrapoladorMando::seguir(int16_t valor, int32_t pendienteQ8, unsigned long ms) {
+    int32_t v = valor + pendienteQ8 * (int32_t)ms / 256;
+    if ((valor > 0 && v < 0) || (valor < 0 && v > 0)) v = 0;
+    return constrain(v, -255, 255);
+}
+
+// Orden tras silencioUs sin comandos: tendencia hasta el horizonte (y nunca
+// más allá del presupuesto) y decaimiento lineal a cero después
+void ExtrapoladorMando::orden(unsigned long silencioUs, int16_t& izq, int16_t& der) {
+    const Muestra& m = ultima();
+    if (presupuestoUs == 0) {
+        izq = m.izq;
+        der = m.der;
+        return;
+    }
+
+    unsigned long tendenciaUs = silencioUs;
+    if (tendenciaUs > horizonteUs) tendenciaUs = horizonteUs;
+    if (tendenciaUs > presupuestoUs) tendenciaUs = presupuestoUs;
+    izq = seguir(m.izq, pendienteIzqQ8, tendenciaUs / 1000);
+    der = seguir(m.der, pendienteDerQ8, tendenciaUs / 1000);
+
+    if (silencioUs <= presupuestoUs) return;
+    unsigned long pasadoMs = (silencioUs - presupuestoUs) / 1000;
+    unsigned long decaimientoMs = decaimientoUs / 1000;
+    if (pasadoMs >= decaimientoMs) {
+        izq = 0;
+        der = 0;
+        return;
+    }
+    int32_t restanteMs = decaimientoMs - pasadoMs;
+    izq = (int32_t)izq * restanteMs / (int32_t)decaimientoMs;
+    der = (int32_t)der * restanteMs / (int32_t)decaimientoMs;
+}
+
+// Orden a aplicar mientras dura el silencio
+bool ExtrapoladorMando::calcular(unsigned long ahoraUs, int16_t& izq, int16_t& der) {
+    if (cantidad == 0 || presupuestoUs == 0) return false;
+
+    unsigned long silencio = ahoraUs - ultima().marca;
+    if (silencio <= periodoUs + periodoUs / 2) return false;  // A su ritmo
+
+    uint8_t nuevo;
+    if (silencio <= presupuestoUs) nuevo = EXTRAPOLANDO;
+    else if (silencio < presupuestoUs + decaimientoUs) nuevo = DECAYENDO;
+    else nuevo = PARADO;
+    if (nuevo == PARADO && estado != PARADO) paradas++;
+    estado = nuevo;
+
+    orden(silencio, izq, der);
+    if (izq == entregadaIzq && der == entregadaDer) return false;
+    entregadaIzq = izq;
+    entregadaDer = der;
+    return true;
+}
+
+ExtrapoladorMando::Estado ExtrapoladorMando::obtenerEstado() {
+    return (Estado)estado;
+}
+
+unsigned long ExtrapoladorMando::obtenerSilencios() {
+    return silencios;
+}
+
+unsigned long ExtrapoladorMando::obtenerParadas() {
+    return paradas;
+}
+
+float ExtrapoladorMando::obtenerErrorMedio() {
+    return muestrasError > 0 ? (float)sumaError / muestrasError : 0;
+}
+
+int16_t ExtrapoladorMando::obtenerErrorMaximo() {
+    return errorMaximo;
+}
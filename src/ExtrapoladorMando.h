@@ -0,0 +1,88 @@
+#ifndef EXTRAPOLADOR_MANDO_H
+#define EXTRAPOLADOR_MANDO_H
+
+#include <Arduino.h>
+
+// Mando del esclavo mientras no llegan comandos del maestro.
+// Guarda los últimos comandos recibidos con su marca local. Si se retrasan más
+// de lo habitual (1,5 veces el periodo medio del historial), sigue la tendencia
+// de cada rueda (recta por mínimos cuadrados) durante un horizonte corto y la
+// mantiene; pasado el presupuesto de pérdida, la orden decae linealmente hasta
+// cero. La extrapolación no cruza el cero: un cambio de sentido no se adivina.
+// Cuando el mando vuelve se mide el error de lo extrapolado frente a lo recibido.
+class ExtrapoladorMando {
+public:
+    static const uint8_t HISTORIAL = 8;  // Comandos para estimar periodo y tendencia
+
+    enum Estado : uint8_t {
+        SIN_MANDO,     // Nada recibido (o olvidado tras un cambio de rol)
+        SIGUIENDO,     // Comandos al ritmo habitual
+        EXTRAPOLANDO,  // Silencio: tendencia durante el horizonte, luego se mantiene
+        DECAYENDO,     // Presupuesto agotado: bajando hacia cero
+        PARADO         // Decaimiento terminado
+    };
+
+    ExtrapoladorMando();
+
+    // horizonteUs: tiempo que se sigue la tendencia; presupuestoUs: silencio
+    // tras el que se empieza a decaer; decaimientoUs: de ahí a cero.
+    // presupuestoUs = 0 desactiva (se mantiene el último comando)
+    void configurar(unsigned long horizonteUs, unsigned long presupuestoUs, unsigned long decaimientoUs);
+    unsigned long obtenerHorizonte();
+    unsigned long obtenerPresupuesto();
+    unsigned long obtenerDecaimiento();
+
+    // Registrar un comando recibido. Devuelve la duración del silencio que
+    // cierra (us), o 0 si llegó a su ritmo.
+    unsigned long registrar(int16_t izq, int16_t der, unsigned long ahoraUs);
+
+    // Orden para ahoraUs. Devuelve true si hay que aplicarla (cambió respecto
+    // a la última entregada o al último comando recibido).
+    bool calcular(unsigned long ahoraUs, int16_t& izq, int16_t& der);
+
+    // Descartar el historial (cambio de rol)
+    void olvidar();
+
+    Estado obtenerEstado();
+
+    // Estadísticas
+    unsigned long obtenerSilencios();  // Silencios ya terminados, por encima del ritmo habitual
+    unsigned long obtenerParadas();    // Silencios que acabaron en parada
+    float obtenerErrorMedio();         // PWM, previsto frente a recibido al volver (antes del presupuesto)
+    int16_t obtenerErrorMaximo();
+
+private:
+    struct Muestra {
+        int16_t izq;
+        int16_t der;
+        unsigned long marca;
+    };
+
+    unsigned long horizonteUs;
+    unsigned long presupuestoUs;
+    unsigned long decaimientoUs;
+
+    Muestra historial[HISTORIAL];
+    uint8_t cabeza;     // Próxima posición a escribir
+    uint8_t cantidad;
+    unsigned long periodoUs;  // Periodo medio del historial
+    int32_t pendienteIzqQ8;   // PWM·256 por ms
+    int32_t pendienteDerQ8;
+
+    uint8_t estado;
+    int16_t entregadaIzq;     // Última orden entregada por calcular()
+    int16_t entregadaDer;
+
+    unsigned long silencios;
+    unsigned long paradas;
+    unsigned long muestrasError;
+    unsigned long sumaError;
+    int16_t errorMaximo;
+
+    const Muestra& ultima();
+    void estimar();
+    void orden(unsigned long silencioUs, int16_t& izq, int16_t& der);
+    static int16_t seguir(int16_t valor, int32_t pendienteQ8, unsigned long ms);
+};
+
+#endif
@@ -0,0 +1,221 @@
+#include "FiltroDistancia.h"
+
+// Más de este tiempo sin muestras invalida la predicción del Kalman
+static const float HUECO_MAXIMO_S = 1.0;
+
+// Rechazos consecutivos tras los que se asume un cambio real de escena
+static const uint8_t RECHAZOS_PARA_REINICIAR = 3;
+
+// Constructor
+FiltroDistancia::FiltroDistancia() {
+    modo = KALMAN;
+    ventana = 5;
+    ruidoMedida = 1.0;     // ~1cm de desviación típica del HC-SR04
+    ruidoProceso = 400.0;  // Aceleraciones de ~20cm/s²
+    rechazos = 0;
+    reiniciar();
+}
+
+// Configurar modo y tamaño de ventana
+void FiltroDistancia::configurar(Modo nuevoModo, uint8_t nuevaVentana) {
+    if (nuevaVentana < 1) nuevaVentana = 1;
+    if (nuevaVentana > VENTANA_MAX) nuevaVentana = VENTANA_MAX;
+    modo = nuevoModo;
+    ventana = nuevaVentana;
+    reiniciar();
+}
+
+// Configurar varianzas de medida y de proceso del Kalman
+void FiltroDistancia::setRuidoKalman(float medida, float proceso) {
+    ruidoMedida = medida;
+    ruidoProceso = proceso;
+}
+
+// Vaciar el buffer y olvidar la estimación
+void FiltroDistancia::reiniciar() {
+    indice = 0;
+    cantidad = 0;
+    distancia = 0;
+    varianza = 0;
+    velocidad = 0;
+    marca = 0;
+    hayEstimacion = false;
+    p00 = p01 = p11 = 0;
+    rechazosSeguidos = 0;
+}
+
+// Incorporar una nueva muestra válida
+void FiltroDistancia::agregarMuestra(float medida, unsigned long marcaUs) {
+    // Guardar en el buffer circular
+    muestras[indice] = medida;
+    marcas[indice] = marcaUs;
+    indice = (indice + 1) % ventana;
+    if (cantidad < ventana) cantidad++;
+
+    if (modo == MEDIANA) {
+        marca = marcaUs;
+        actualizarMediana();
+    } else {
+        actualizarKalman(medida, marcaUs);
+    }
+}
+
+// Mediana de un array pequeño (lo ordena por inserción)
+static float medianaOrdenando(float* valores, uint8_t n) {
+    for (uint8_t i = 1; i < n; i++) {
+        float valor = valores[i];
+        int j = i - 1;
+        while (j >= 0 && valores[j] > valor) {
+            valores[j + 1] = valores[j];
+            j--;
+        }
+        valores[j + 1] = valor;
+    }
+
+    if (n % 2 == 1) return valores[n / 2];
+    return (valores[n / 2 - 1] + valores[n / 2]) / 2.0;
+}
+
+// Mediana de las muestras de la ventana
+float FiltroDistancia::medianaVentana() {
+    float copia[VENTANA_MAX];
+    memcpy(copia, muestras, cantidad * sizeof(float));
+    return medianaOrdenando(copia, cantidad);
+}
+
+// Mediana móvil: estimación, varianza robusta (MAD) y pendiente por mínimos cuadrados
+void FiltroDistancia::actualizarMediana() {
+    distancia = medianaVentana();
+    hayEstimacion = true;
+
+    if (cantidad < 3) {
+        varianza = ruidoMedida;
+        velocidad = 0;
+        return;
+    }
+
+    // Desviación absoluta mediana, escalada para equivaler a sigma gaussiana
+    float desviaciones[VENTANA_MAX];
+    for (uint8_t i = 0; i < cantidad; i++) {
+        desviaciones[i] = fabs(muestras[i] - distancia);
+    }
+    float mad = medianaOrdenando(desviaciones, cantidad);
+    float sigma = 1.4826 * mad;
+    varianza = sigma * sigma;
+    if (varianza < ruidoMedida / cantidad) varianza = ruidoMedida / cantidad;
+
+    // Pendiente distancia/tiempo relativa a la muestra más reciente
+    float mediaT = 0, mediaX = 0;
+    float tiempos[VENTANA_MAX];
+    for (uint8_t i = 0; i < cantidad; i++) {
+        tiempos[i] = (long)(marcas[i] - marca) / 1000000.0;
+        mediaT += tiempos[i];
+        mediaX += muestras[i];
+    }
+    mediaT /= cantidad;
+    mediaX /= cantidad;
+
+    float num = 0, den = 0;
+    for (uint8_t i = 0; i < cantidad; i++) {
+        float dt = tiempos[i] - mediaT;
+        num += dt * (muestras[i] - mediaX);
+        den += dt * dt;
+    }
+    velocidad = (den > 0) ? num / den : 0;
+}
+
+// Arrancar el Kalman en una medida (velocidad desconocida)
+void FiltroDistancia::iniciarKalman(float medida) {
+    distancia = medida;
+    velocidad = 0;
+    p00 = ruidoMedida;
+    p01 = 0;
+    p11 = 400.0;  // Incertidumbre inicial de ~20cm/s
+    varianza = p00;
+    rechazosSeguidos = 0;
+    hayEstimacion = true;
+}
+
+// Kalman 1-D de velocidad constante con rechazo de outliers a 3 sigma
+void FiltroDistancia::actualizarKalman(float medida, unsigned long marcaUs) {
+    float dt = (marcaUs - marca) / 1000000.0;
+
+    if (!hayEstimacion || dt > HUECO_MAXIMO_S) {
+        iniciarKalman(medida);
+        marca = marcaUs;
+        return;
+    }
+    marca = marcaUs;
+
+    // Predicción con ruido de aceleración blanca
+    float dt2 = dt * dt;
+    distancia += velocidad * dt;
+    p00 += 2 * dt * p01 + dt2 * p11 + ruidoProceso * dt2 * dt2 / 4.0;
+    p01 += dt * p11 + ruidoProceso * dt2 * dt / 2.0;
+    p11 += ruidoProceso * dt2;
+
+    // Innovación y puerta de validación
+    float innovacion = medida - distancia;
+    float s = p00 + ruidoMedida;
+    if (innovacion * innovacion > 9.0 * s) {
+        rechazos++;
+        rechazosSeguidos++;
+        if (rechazosSeguidos >= RECHAZOS_PARA_REINICIAR) {
+            // Varias medidas coherentes fuera de la puerta: la escena cambió
+            iniciarKalman(medianaVentana());
+        }
+        varianza = p00;
+        return;
+    }
+    rechazosSeguidos = 0;
+
+    // Corrección
+    float k0 = p00 / s;
+    float k1 = p01 / s;
+    distancia += k0 * innovacion;
+    velocidad += k1 * innovacion;
+    p11 -= k1 * p01;
+    p01 -= k0 * p01;
+    p00 -= k0 * p00;
+    varianza = p00;
+}
+
+// ¿Hay ya alguna estimación?
+bool FiltroDistancia::tieneEstimacion() {
+    return hayEstimacion;
+}
+
+// Distancia estimada (cm)
+float FiltroDistancia::obtenerDistancia() {
+    return distancia;
+}
+
+// Varianza de la estimación (cm²)
+float FiltroDistancia::obtenerVarianza() {
+    return varianza;
+}
+
+// Velocidad estimada del hueco (cm/s)
+float FiltroDistancia::obtenerVelocidad() {
+    return velocidad;
+}
+
+// Marca de tiempo de la última muestra incorporada
+unsigned long FiltroDistancia::obtenerMarca() {
+    return marca;
+}
+
+// Muestras rechazadas por la puerta del Kalman
+unsigned long FiltroDistancia::obtenerRechazos() {
+    return rechazos;
+}
+
+// Modo actual
+FiltroDistancia::Modo FiltroDistancia::obtenerModo() {
+    return modo;
+}
+
+// Tamaño de ventana actual
+uint8_t FiltroDistancia::obtenerVentana() {
+    return ventana;
+}
@@ -0,0 +1,70 @@
+#ifndef FILTRO_DISTANCIA_H
+#define FILTRO_DISTANCIA_H
+
+#include <Arduino.h>
+
+// Filtro de distancia que se actualiza con cada muestra del HC-SR04.
+// Guarda las últimas muestras en un buffer circular y mantiene una
+// estimación siempre al día con su varianza y velocidad, ya sea con una
+// mediana móvil o con un Kalman 1-D de velocidad constante.
+class FiltroDistancia {
+public:
+    enum Modo : uint8_t {
+        MEDIANA,  // Mediana de la ventana (robusta a ecos espurios)
+        KALMAN    // Kalman posición/velocidad con rechazo de outliers
+    };
+
+    static const uint8_t VENTANA_MAX = 15;
+
+    FiltroDistancia();
+
+    // Configuración
+    void configurar(Modo modo, uint8_t ventana);
+    void setRuidoKalman(float ruidoMedida, float ruidoProceso);  // cm², (cm/s²)²
+    void reiniciar();
+
+    // Incorporar una muestra válida (cm) tomada en marcaUs (micros)
+    void agregarMuestra(float distancia, unsigned long marcaUs);
+
+    // Estimación actual
+    bool tieneEstimacion();
+    float obtenerDistancia();  // cm
+    float obtenerVarianza();   // cm²
+    float obtenerVelocidad();  // cm/s (positiva = el hueco crece)
+    unsigned long obtenerMarca();  // micros de la última muestra
+    unsigned long obtenerRechazos();  // Muestras descartadas por el Kalman
+
+    Modo obtenerModo();
+    uint8_t obtenerVentana();
+
+private:
+    Modo modo;
+    uint8_t ventana;
+
+    // Buffer circular de muestras
+    float muestras[VENTANA_MAX];
+    unsigned long marcas[VENTANA_MAX];
+    uint8_t indice;
+    uint8_t cantidad;
+
+    // Estimación publicada
+    float distancia;
+    float varianza;
+    float velocidad;
+    unsigned long marca;
+    bool hayEstimacion;
+
+    // Estado del Kalman: covarianza P = [p00 p01; p01 p11]
+    float p00, p01, p11;
+    float ruidoMedida;
+    float ruidoProceso;
+    uint8_t rechazosSeguidos;
+    unsigned long rechazos;
+
+    void actualizarMediana();
+    void actualizarKalman(float medida, unsigned long marcaUs);
+    void iniciarKalman(float medida);
+    float medianaVentana();
+};
+
+#endif
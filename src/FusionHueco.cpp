@@ -0,0 +1,205 @@
+#include "FusionHueco.h"
+
+// Varianza de medida del HC-SR04 (cm²) y de proceso (aceleración, (cm/s²)²),
+// las mismas que en FiltroDistancia
+static const float RUIDO_MEDIDA = 1.0;
+static const float RUIDO_PROCESO = 400.0;
+
+// Más de este tiempo sin muestras aceptadas invalida la estimación
+static const unsigned long HUECO_MAXIMO_US = 1000000;
+
+// Rechazos consecutivos tras los que se asume un cambio real de escena
+static const uint8_t RECHAZOS_PARA_REINICIAR = 3;
+
+// Constructor. Modelo por defecto: el del simulador (60 cm/s a PWM 255,
+// zona muerta de 90 y 150 ms de respuesta), medido a ojo en el coche real
+FusionHueco::FusionHueco() {
+    configurar(0.36, 90, 150000);
+    rechazos = 0;
+    reiniciar();
+}
+
+// Configurar el modelo de los motores
+void FusionHueco::configurar(float ganancia, int16_t banda, unsigned long constante) {
+    if (constante < 1000) constante = 1000;
+    cmsPorPWM = ganancia;
+    pwmBanda = banda;
+    constanteUs = constante;
+    aceleracionMax = cmsPorPWM * (255 - pwmBanda) / (constanteUs / 1000000.0);
+}
+
+float FusionHueco::obtenerGanancia() {
+    return cmsPorPWM;
+}
+
+int16_t FusionHueco::obtenerBanda() {
+    return pwmBanda;
+}
+
+unsigned long FusionHueco::obtenerConstante() {
+    return constanteUs;
+}
+
+// Olvidar todo (cambio de rol o de modo)
+void FusionHueco::reiniciar() {
+    distancia = 0;
+    velocidad = 0;
+    p00 = p01 = p11 = 0;
+    marca = 0;
+    marcaMuestra = 0;
+    hayEstimacion = false;
+    rechazosSeguidos = 0;
+    pwmPropio = 0;
+    velocidadPropia = 0;
+    olvidarLider();
+}
+
+// Olvidar el comando del maestro
+void FusionHueco::olvidarLider() {
+    hayLider = false;
+    pwmLider = 0;
+    marcaLider = 0;
+    velocidadLider = 0;
+}
+
+// Velocidad en régimen para un PWM, positiva hacia delante (como en
+// pasoControl, el PWM negativo acerca el coche al de delante)
+float FusionHueco::velocidadModelo(int16_t pwm) {
+    int16_t magnitud = pwm < 0 ? -pwm : pwm;
+    if (magnitud <= pwmBanda) return 0;
+    float v = (magnitud - pwmBanda) * cmsPorPWM;
+    return pwm < 0 ? v : -v;
+}
+
+// Aceleración del maestro que su último comando ya no explica (cm/s²):
+// nada con el comando recién llegado, toda la de los motores cuando tiene
+// una constante de tiempo de edad (o si no hay comando)
+float FusionHueco::aceleracionDesconocida(unsigned long ahoraUs) {
+    if (!hayLider) return aceleracionMax;
+    float edad = (float)(ahoraUs - marcaLider) / constanteUs;
+    return edad < 1 ? aceleracionMax * edad : aceleracionMax;
+}
+
+// Llevar el modelo de los motores y el Kalman hasta hastaUs
+void FusionHueco::predecir(unsigned long hastaUs) {
+    float dt = (hastaUs - marca) / 1000000.0;
+    marca = hastaUs;
+
+    // Respuesta de primer orden de cada coche a su último PWM
+    float relativaAntes = velocidadLider - velocidadPropia;
+    float alfa = dt * 1000000.0 / constanteUs;
+    if (alfa > 1) alfa = 1;
+    velocidadLider += (velocidadModelo(pwmLider) - velocidadLider) * alfa;
+    velocidadPropia += (velocidadModelo(pwmPropio) - velocidadPropia) * alfa;
+
+    if (!hayEstimacion) return;
+
+    // Predicción: el cambio de velocidad relativa lo pone el modelo (entrada
+    // conocida); el ruido de aceleración, lo que el modelo no sabe
+    float dt2 = dt * dt;
+    distancia += velocidad * dt;
+    velocidad += velocidadLider - velocidadPropia - relativaAntes;
+    float desconocida = aceleracionDesconocida(hastaUs);
+    float ruido = RUIDO_PROCESO + desconocida * desconocida;
+    p00 += 2 * dt * p01 + dt2 * p11 + ruido * dt2 * dt2 / 4.0;
+    p01 += dt * p11 + ruido * dt2 * dt / 2.0;
+    p11 += ruido * dt2;
+}
+
+// Arrancar en una medida; la velocidad, la que dé el modelo
+void FusionHueco::iniciar(float medida, unsigned long marcaUs) {
+    distancia = medida;
+    velocidad = hayLider ? velocidadLider - velocidadPropia : 0;
+    p00 = RUIDO_MEDIDA;
+    p01 = 0;
+    p11 = 400.0;  // Incertidumbre inicial de ~20cm/s
+    marcaMuestra = marcaUs;
+    rechazosSeguidos = 0;
+    hayEstimacion = true;
+}
+
+// Corregir el hueco con una muestra del HC-SR04 propio
+void FusionHueco::agregarMuestra(float medida, unsigned long marcaUs) {
+    // La muestra puede ser algo anterior a la estimación (el control ya
+    // predijo más allá): se lleva a la marca de la estimación
+    long adelanto = (long)(marcaUs - marca);
+    if (adelanto > 0) predecir(marcaUs);
+
+    if (!hayEstimacion || marcaUs - marcaMuestra > HUECO_MAXIMO_US) {
+        iniciar(medida, marcaUs);
+        return;
+    }
+    if (adelanto < 0) medida += velocidad * (-adelanto) / 1000000.0;
+
+    // Innovación y puerta de validación
+    float innovacion = medida - distancia;
+    float s = p00 + RUIDO_MEDIDA;
+    if (innovacion * innovacion > 9.0 * s) {
+        rechazos++;
+        rechazosSeguidos++;
+        if (rechazosSeguidos >= RECHAZOS_PARA_REINICIAR) iniciar(medida, marcaUs);
+        return;
+    }
+    rechazosSeguidos = 0;
+    marcaMuestra = marcaUs;
+
+    // Corrección
+    float k0 = p00 / s;
+    float k1 = p01 / s;
+    distancia += k0 * innovacion;
+    velocidad += k1 * innovacion;
+    p11 -= k1 * p01;
+    p01 -= k0 * p01;
+    p00 -= k0 * p00;
+}
+
+// Nuevo comando del maestro
+void FusionHueco::registrarLider(int16_t pwm, unsigned long marcaUs) {
+    if ((long)(marcaUs - marca) > 0) predecir(marcaUs);
+    if (!hayLider) velocidadLider = velocidadModelo(pwm);  // Se supone en régimen
+    pwmLider = pwm;
+    marcaLider = marcaUs;
+    hayLider = true;
+}
+
+// Nueva orden a los motores propios
+void FusionHueco::registrarPropio(int16_t pwm, unsigned long marcaUs) {
+    if ((long)(marcaUs - marca) > 0) predecir(marcaUs);
+    pwmPropio = pwm;
+}
+
+// Paso del control: estimación llevada hasta ahoraUs
+bool FusionHueco::actualizar(unsigned long ahoraUs) {
+    if ((long)(ahoraUs - marca) > 0) predecir(ahoraUs);
+    if (!hayEstimacion) return false;
+    if (ahoraUs - marcaMuestra > HUECO_MAXIMO_US) {
+        hayEstimacion = false;
+        return false;
+    }
+    return true;
+}
+
+bool FusionHueco::tieneLider() {
+    return hayLider;
+}
+
+float FusionHueco::obtenerDistancia() {
+    return distancia;
+}
+
+float FusionHueco::obtenerVelocidad() {
+    return velocidad;
+}
+
+float FusionHueco::obtenerVarianza() {
+    return p00;
+}
+
+float FusionHueco::obtenerConfianzaLider(unsigned long ahoraUs) {
+    if (aceleracionMax <= 0) return 0;
+    return 1 - aceleracionDesconocida(ahoraUs) / aceleracionMax;
+}
+
+unsigned long FusionHueco::obtenerRechazos() {
+    return rechazos;
+}
@@ -0,0 +1,78 @@
+#ifndef FUSION_HUECO_H
+#define FUSION_HUECO_H
+
+#include <Arduino.h>
+
+// Hueco del esclavo al coche de delante, fusionando su propio HC-SR04 con los
+// comandos del maestro.
+// Kalman 1-D de posición/velocidad que se predice al ritmo del control. Un
+// modelo de los motores (iguales en los dos coches: zona muerta, ganancia y
+// respuesta de primer orden) convierte el comando del maestro y la orden
+// propia en el cambio de velocidad relativa de cada predicción, antes de que
+// el sensor lo vea; las muestras del HC-SR04 corrigen hueco y velocidad. El
+// ruido de proceso crece con la edad del comando (el maestro puede haber
+// acelerado desde entonces), así que un comando viejo cede el peso al sensor.
+class FusionHueco {
+public:
+    FusionHueco();
+
+    // Modelo de los motores: cm/s por PWM por encima de pwmBanda y constante
+    // de tiempo de la respuesta
+    void configurar(float cmsPorPWM, int16_t pwmBanda, unsigned long constanteUs);
+    float obtenerGanancia();
+    int16_t obtenerBanda();
+    unsigned long obtenerConstante();
+
+    // Olvidar estimación, comando del maestro y órdenes propias
+    void reiniciar();
+    void olvidarLider();
+
+    // Muestra válida del HC-SR04 propio (cm) tomada en marcaUs
+    void agregarMuestra(float distancia, unsigned long marcaUs);
+    // PWM medio del último comando del maestro y de la última orden propia
+    void registrarLider(int16_t pwm, unsigned long marcaUs);
+    void registrarPropio(int16_t pwm, unsigned long marcaUs);
+
+    // Predecir hasta ahoraUs. Devuelve false si no hay estimación (nunca
+    // hubo eco o hace demasiado del último)
+    bool actualizar(unsigned long ahoraUs);
+
+    bool tieneLider();
+    float obtenerDistancia();  // cm
+    float obtenerVelocidad();  // cm/s (positiva = el hueco crece)
+    float obtenerVarianza();   // cm²
+    float obtenerConfianzaLider(unsigned long ahoraUs);  // 1 = comando recién llegado, 0 = ya no explica nada
+    unsigned long obtenerRechazos();  // Muestras fuera de la puerta de validación
+
+private:
+    // Modelo de los motores
+    float cmsPorPWM;
+    int16_t pwmBanda;
+    unsigned long constanteUs;
+    float aceleracionMax;  // cm/s² (velocidad máxima / constante de tiempo)
+
+    // Estado del Kalman: hueco, velocidad relativa y covarianza
+    float distancia;
+    float velocidad;
+    float p00, p01, p11;
+    unsigned long marca;          // micros() de la estimación
+    unsigned long marcaMuestra;   // micros() de la última muestra aceptada
+    bool hayEstimacion;
+    uint8_t rechazosSeguidos;
+    unsigned long rechazos;
+
+    // Comandos y velocidad que da el modelo para cada coche
+    bool hayLider;
+    int16_t pwmLider;
+    unsigned long marcaLider;
+    float velocidadLider;  // cm/s
+    int16_t pwmPropio;
+    float velocidadPropia;
+
+    float velocidadModelo(int16_t pwm);
+    float aceleracionDesconocida(unsigned long ahoraUs);
+    void predecir(unsigned long hastaUs);
+    void iniciar(float medida, unsigned long marcaUs);
+};
+
+#endif
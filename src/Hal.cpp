@@ -0,0 +1,33 @@
+#include "Hal.h"
+
+#ifndef COCHE_HOST
+
+// El SDK no pasa contexto a los callbacks: se guarda aquí
+static FuncionRecepcionHal funcionRecepcion = nullptr;
+static FuncionEnvioHal funcionEnvio = nullptr;
+static void* contextoESPNow = nullptr;
+
+static void alEnviar(uint8_t* mac, uint8_t estado) {
+    if (funcionEnvio != nullptr) funcionEnvio(contextoESPNow, mac, estado == 0);
+}
+
+static void alRecibir(uint8_t* mac, uint8_t* datos, uint8_t longitud) {
+    if (funcionRecepcion != nullptr) funcionRecepcion(contextoESPNow, mac, datos, longitud);
+}
+
+// Inicializar ESP-NOW en modo estación con rol COMBO (emisor y receptor)
+int halIniciarESPNow(FuncionRecepcionHal recepcion, FuncionEnvioHal envio, void* contexto) {
+    WiFi.mode(WIFI_STA);
+    if (esp_now_init() != 0) return -1;
+
+    funcionRecepcion = recepcion;
+    funcionEnvio = envio;
+    contextoESPNow = contexto;
+
+    esp_now_set_self_role(ESP_NOW_ROLE_COMBO);
+    esp_now_register_send_cb(alEnviar);
+    esp_now_register_recv_cb(alRecibir);
+    return 0;
+}
+
+#endif
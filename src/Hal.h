@@ -0,0 +1,114 @@
+#ifndef HAL_H
+#define HAL_H
+
+#include <Arduino.h>
+
+// Capa de abstracción del hardware: tiempo, pines, interrupciones y ESP-NOW.
+// La librería no llama directamente al core del ESP8266 para nada de esto.
+// En el coche son funciones inline sobre Arduino/ESP8266 (sin coste); compilando
+// con COCHE_HOST las implementa el simulador de extras/simulador, que ejecuta
+// varios coches en un mismo proceso de Linux.
+
+// Callbacks de ESP-NOW con contexto (el del ESP8266 no lo tiene)
+typedef void (*FuncionRecepcionHal)(void* contexto, const uint8_t* mac, const uint8_t* datos, uint8_t longitud);
+typedef void (*FuncionEnvioHal)(void* contexto, const uint8_t* mac, bool exitoso);
+typedef void (*FuncionInterrupcionHal)(void* contexto);
+
+#ifdef COCHE_HOST
+
+// Tiempo
+unsigned long halMicros();
+unsigned long halMillis();
+void halEsperar(unsigned long ms);
+void halEsperarUs(unsigned int us);
+
+// Pines
+void halModoPin(int pin, uint8_t modo);
+void halEscribirDigital(int pin, uint8_t nivel);
+int halLeerDigital(int pin);
+int halLeerAnalogico(int pin);
+void halEscribirPWM(int pin, int valor);
+void halAdjuntarInterrupcion(int pin, FuncionInterrupcionHal funcion, void* contexto, int modo);
+
+// ESP-NOW (0 = éxito, como en el SDK)
+int halIniciarESPNow(FuncionRecepcionHal recepcion, FuncionEnvioHal envio, void* contexto);
+int halAgregarParESPNow(const uint8_t* mac);
+int halEnviarESPNow(uint8_t* mac, uint8_t* datos, int longitud);
+void halObtenerMAC(uint8_t* mac);
+
+// Sistema
+uint32_t halHeapLibre();
+
+#else
+
+#include <ESP8266WiFi.h>
+#include <espnow.h>
+
+inline unsigned long halMicros() { return micros(); }
+inline unsigned long halMillis() { return millis(); }
+inline void halEsperar(unsigned long ms) { delay(ms); }
+inline void halEsperarUs(unsigned int us) { delayMicroseconds(us); }
+
+inline void halModoPin(int pin, uint8_t modo) { pinMode(pin, modo); }
+inline void halEscribirDigital(int pin, uint8_t nivel) { digitalWrite(pin, nivel); }
+inline int halLeerDigital(int pin) { return digitalRead(pin); }
+inline int halLeerAnalogico(int pin) { return analogRead(pin); }
+inline void halEscribirPWM(int pin, int valor) { analogWrite(pin, valor); }
+inline void halAdjuntarInterrupcion(int pin, FuncionInterrupcionHal funcion, void* contexto, int modo) {
+    attachInterruptArg(digitalPinToInterrupt(pin), funcion, contexto, modo);
+}
+
+// Registra los callbacks (una sola instancia por placa) y entra en modo COMBO
+int halIniciarESPNow(FuncionRecepcionHal recepcion, FuncionEnvioHal envio, void* contexto);
+
+inline int halAgregarParESPNow(const uint8_t* mac) {
+    if (esp_now_is_peer_exist((uint8_t*)mac)) return 0;
+    return esp_now_add_peer((uint8_t*)mac, ESP_NOW_ROLE_COMBO, 1, NULL, 0);
+}
+inline int halEnviarESPNow(uint8_t* mac, uint8_t* datos, int longitud) {
+    return esp_now_send(mac, datos, longitud);
+}
+inline void halObtenerMAC(uint8_t* mac) { WiFi.macAddress(mac); }
+
+inline uint32_t halHeapLibre() { return ESP.getFreeHeap(); }
+
+#endif
+
+// Salida digital sin PWM que se conmuta en cada ciclo (disparo del HC-SR04).
+// En el coche escribe la máscara del pin directamente en GPOS/GPOC (GP16O para
+// el GPIO16): digitalWrite() busca el pin en tablas y para una posible onda
+// PWM en cada llamada. La máscara se calcula una vez en configurar(); con pin
+// -1 no hace nada.
+class SalidaDigital {
+public:
+    SalidaDigital() : pin(-1), mascara(0) {}
+
+    // Deja el pin como salida a nivel bajo
+    void configurar(int p) {
+        pin = p;
+        mascara = (p >= 0 && p < 16) ? (1UL << p) : 0;
+        if (pin < 0) return;
+        halModoPin(pin, OUTPUT);
+        bajo();
+    }
+
+#ifdef COCHE_HOST
+    void alto() { if (pin >= 0) halEscribirDigital(pin, HIGH); }
+    void bajo() { if (pin >= 0) halEscribirDigital(pin, LOW); }
+#else
+    inline void alto() {
+        if (mascara) GPOS = mascara;
+        else if (pin == 16) GP16O |= 1;
+    }
+    inline void bajo() {
+        if (mascara) GPOC = mascara;
+        else if (pin == 16) GP16O &= ~1;
+    }
+#endif
+
+private:
+    int pin;
+    uint32_t mascara;
+};
+
+#endif
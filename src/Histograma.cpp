@@ -0,0 +1,95 @@
+#include "Histograma.h"
+
+// Constructor
+Histograma::Histograma() {
+    reiniciar();
+}
+
+// Vaciar el histograma
+void Histograma::reiniciar() {
+    memset(cubetas, 0, sizeof(cubetas));
+    muestras = 0;
+    minimo = 0;
+    maximo = 0;
+    suma = 0;
+}
+
+// Cubeta de un valor: los 4 primeros valores tienen cubeta propia; a partir
+// de ahí, exponente (bit más alto) y los 2 bits siguientes como mantisa
+uint8_t Histograma::indiceCubeta(unsigned long valor) {
+    if (valor < SUBCUBETAS) return valor;
+
+    uint8_t exponente = 31 - __builtin_clz((uint32_t)valor);
+    uint8_t mantisa = (valor >> (exponente - 2)) & (SUBCUBETAS - 1);
+    unsigned int indice = SUBCUBETAS * (exponente - 1) + mantisa;
+    return (indice < NUM_CUBETAS) ? indice : NUM_CUBETAS - 1;
+}
+
+// Valor inferior de una cubeta
+unsigned long Histograma::inicioCubeta(uint8_t indice) {
+    if (indice < SUBCUBETAS) return indice;
+    uint8_t exponente = indice / SUBCUBETAS + 1;
+    uint8_t mantisa = indice % SUBCUBETAS;
+    return (unsigned long)(SUBCUBETAS + mantisa) << (exponente - 2);
+}
+
+// Anchura de una cubeta
+unsigned long Histograma::anchoCubeta(uint8_t indice) {
+    if (indice < SUBCUBETAS) return 1;
+    return 1UL << (indice / SUBCUBETAS - 1);
+}
+
+// Registrar una muestra
+void Histograma::registrar(unsigned long valorUs) {
+    cubetas[indiceCubeta(valorUs)]++;
+    if (muestras == 0 || valorUs < minimo) minimo = valorUs;
+    if (valorUs > maximo) maximo = valorUs;
+    suma += valorUs;
+    muestras++;
+}
+
+unsigned long Histograma::obtenerMuestras() {
+    return muestras;
+}
+
+unsigned long Histograma::obtenerMinimo() {
+    return minimo;
+}
+
+unsigned long Histograma::obtenerMaximo() {
+    return maximo;
+}
+
+unsigned long Histograma::obtenerMedia() {
+    if (muestras == 0) return 0;
+    return (unsigned long)(suma / muestras);
+}
+
+// Percentil aproximado
+unsigned long Histograma::percentil(uint8_t p) {
+    if (muestras == 0) return 0;
+    if (p >= 100) return maximo;
+
+    // Rango de la muestra buscada (redondeo hacia arriba)
+    unsigned long objetivo = ((uint64_t)muestras * p + 99) / 100;
+    if (objetivo == 0) objetivo = 1;
+
+    unsigned long acumulado = 0;
+    for (uint8_t i = 0; i < NUM_CUBETAS; i++) {
+        acumulado += cubetas[i];
+        if (acumulado >= objetivo) {
+            unsigned long valor = inicioCubeta(i) + anchoCubeta(i) / 2;
+            // No salirse del rango realmente observado
+            if (valor > maximo) valor = maximo;
+            if (valor < minimo) valor = minimo;
+            return valor;
+        }
+    }
+    return maximo;
+}
+
+// Resumen en JSON
+int Histograma::escribirResumen(char* destino, size_t tam) {
+    return snprintf(destino, tam, "{\"n\":%lu,\"p50\":%lu,\"p95\":%lu,\"p99\":%lu,\"max\":%lu}",
+                    muestras, percentil(50), percentil(95), percentil(99), maximo);
+}
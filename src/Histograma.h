@@ -0,0 +1,42 @@
+#ifndef HISTOGRAMA_H
+#define HISTOGRAMA_H
+
+#include <Arduino.h>
+
+// Histograma de latencias en microsegundos con cubetas logarítmicas fijas.
+// Cada potencia de dos se divide en 4 cubetas (error relativo < 25%), desde
+// 1us hasta ~16s, sin memoria dinámica y con registro en tiempo constante.
+class Histograma {
+public:
+    static const uint8_t SUBCUBETAS = 4;     // Cubetas por potencia de dos
+    static const uint8_t NUM_CUBETAS = 96;   // Cubre hasta 2^24 us
+
+    Histograma();
+
+    void registrar(unsigned long valorUs);
+    void reiniciar();
+
+    unsigned long obtenerMuestras();
+    unsigned long obtenerMinimo();
+    unsigned long obtenerMaximo();
+    unsigned long obtenerMedia();
+
+    // Percentil aproximado (0-100): punto medio de la cubeta que lo contiene
+    unsigned long percentil(uint8_t p);
+
+    // Escribir {"n":..,"p50":..,"p95":..,"p99":..,"max":..}; devuelve bytes escritos
+    int escribirResumen(char* destino, size_t tam);
+
+private:
+    uint32_t cubetas[NUM_CUBETAS];
+    unsigned long muestras;
+    unsigned long minimo;
+    unsigned long maximo;
+    uint64_t suma;
+
+    static uint8_t indiceCubeta(unsigned long valor);
+    static unsigned long inicioCubeta(uint8_t indice);
+    static unsigned long anchoCubeta(uint8_t indice);
+};
+
+#endif
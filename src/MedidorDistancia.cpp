@@ -0,0 +1,136 @@
+#include "MedidorDistancia.h"
+#include "Hal.h"
+
+// Margen para el retardo entre el disparo y el inicio del eco (~500us en el HC-SR04)
+static const unsigned long MARGEN_INICIO_ECO = 1000;
+
+// Constructor
+MedidorDistancia::MedidorDistancia(int trig, int echo) {
+    trigPin = trig;
+    echoPin = echo;
+    estado = REPOSO;
+    inicioEco = 0;
+    finEco = 0;
+    ultimoDisparo = 0;
+    intervaloDisparo = 60000;  // 60ms, mínimo recomendado por el fabricante
+    timeoutEco = 30000;        // Igual que el antiguo pulseIn(..., 30000)
+    ultimaDistancia = 0;
+    ultimaValida = false;
+    marcaMuestra = 0;
+    muestrasValidas = 0;
+    timeouts = 0;
+}
+
+// Configurar pines e interrupción del ECHO
+void MedidorDistancia::inicializar() {
+    if (trigPin < 0 || echoPin < 0) return;
+
+    disparo.configurar(trigPin);
+    halModoPin(echoPin, INPUT);
+
+    // La ISR recibe el puntero a esta instancia, así pueden coexistir varios sensores
+    halAdjuntarInterrupcion(echoPin, isrEco, this, CHANGE);
+}
+
+// ISR del pin ECHO: solo guarda la marca de tiempo del flanco
+void IRAM_ATTR MedidorDistancia::isrEco(void* arg) {
+    MedidorDistancia* medidor = static_cast<MedidorDistancia*>(arg);
+    medidor->registrarFlanco(halLeerDigital(medidor->echoPin) == HIGH, halMicros());
+}
+
+// Registrar un flanco del ECHO (se ejecuta en contexto de interrupción)
+void IRAM_ATTR MedidorDistancia::registrarFlanco(bool nivel, unsigned long marca) {
+    if (nivel && estado == ESPERANDO_SUBIDA) {
+        inicioEco = marca;
+        estado = ESPERANDO_BAJADA;
+    } else if (!nivel && estado == ESPERANDO_BAJADA) {
+        finEco = marca;
+        estado = COMPLETA;
+    }
+}
+
+// Enviar pulso de disparo de 10us (única espera activa, acotada)
+void MedidorDistancia::disparar(unsigned long ahora) {
+    ultimoDisparo = ahora;
+    estado = ESPERANDO_SUBIDA;
+    disparo.alto();
+    halEsperarUs(10);
+    disparo.bajo();
+}
+
+// Avanzar la máquina de estados
+bool MedidorDistancia::actualizar() {
+    if (trigPin < 0 || echoPin < 0) return false;
+
+    unsigned long ahora = halMicros();
+
+    switch (estado) {
+        case REPOSO:
+            if (ahora - ultimoDisparo >= intervaloDisparo) {
+                disparar(ahora);
+            }
+            return false;
+
+        case ESPERANDO_SUBIDA:
+        case ESPERANDO_BAJADA:
+            // Sin eco completo dentro del plazo: ciclo perdido
+            if (ahora - ultimoDisparo > timeoutEco + MARGEN_INICIO_ECO) {
+                estado = REPOSO;
+                ultimaValida = false;
+                timeouts++;
+                return true;
+            }
+            return false;
+
+        case COMPLETA: {
+            unsigned long duracion = finEco - inicioEco;
+            float distancia = duracion * 0.034 / 2.0;
+
+            // Filtrar lecturas inválidas (muy cerca o muy lejos)
+            ultimaValida = (distancia > 2 && distancia < 400);
+            if (ultimaValida) {
+                ultimaDistancia = distancia;
+                marcaMuestra = finEco;
+                muestrasValidas++;
+            }
+            estado = REPOSO;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ¿Fue válido el último ciclo terminado?
+bool MedidorDistancia::muestraValida() {
+    return ultimaValida;
+}
+
+// Última distancia válida en cm
+float MedidorDistancia::obtenerDistancia() {
+    return ultimaDistancia;
+}
+
+// Marca de tiempo (micros) de la última muestra válida
+unsigned long MedidorDistancia::obtenerMarcaMuestra() {
+    return marcaMuestra;
+}
+
+// Configurar periodo entre disparos (ms)
+void MedidorDistancia::setIntervaloDisparo(unsigned long ms) {
+    intervaloDisparo = ms * 1000UL;
+}
+
+// Configurar duración máxima del eco (us)
+void MedidorDistancia::setTimeoutEco(unsigned long us) {
+    timeoutEco = us;
+}
+
+// Obtener número de muestras válidas
+unsigned long MedidorDistancia::obtenerMuestrasValidas() {
+    return muestrasValidas;
+}
+
+// Obtener número de ciclos sin eco
+unsigned long MedidorDistancia::obtenerTimeouts() {
+    return timeouts;
+}
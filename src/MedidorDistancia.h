@@ -0,0 +1,69 @@
+#ifndef MEDIDOR_DISTANCIA_H
+#define MEDIDOR_DISTANCIA_H
+
+#include <Arduino.h>
+#include "Hal.h"
+
+// Medición no bloqueante del sensor HC-SR04.
+// El disparo se lanza desde actualizar() y los flancos del ECHO se capturan
+// por interrupción, de modo que loop() nunca se queda esperando al sensor.
+class MedidorDistancia {
+public:
+    // Estados de la máquina de medición
+    enum Estado : uint8_t {
+        REPOSO,            // Esperando al siguiente disparo
+        ESPERANDO_SUBIDA,  // Disparo enviado, esperando inicio del eco
+        ESPERANDO_BAJADA,  // Eco en curso, esperando su final
+        COMPLETA           // Eco completo, pendiente de procesar
+    };
+
+    MedidorDistancia(int trig, int echo);
+
+    // Configura pines e interrupción del ECHO
+    void inicializar();
+
+    // Avanza la máquina de estados (llamar desde loop, nunca bloquea).
+    // Devuelve true cuando termina un ciclo de medición (válido o no).
+    bool actualizar();
+
+    // Resultado del último ciclo terminado
+    bool muestraValida();
+    float obtenerDistancia();       // cm
+    unsigned long obtenerMarcaMuestra();  // micros() al final del eco
+
+    // Configuración
+    void setIntervaloDisparo(unsigned long ms);  // Periodo entre disparos
+    void setTimeoutEco(unsigned long us);        // Eco máximo esperado
+
+    // Estadísticas
+    unsigned long obtenerMuestrasValidas();
+    unsigned long obtenerTimeouts();
+
+    // Entrada de flanco del ECHO (desde la ISR o desde una simulación)
+    void registrarFlanco(bool nivel, unsigned long marca);
+
+private:
+    int trigPin;
+    int echoPin;
+    SalidaDigital disparo;  // TRIG por registro
+
+    volatile uint8_t estado;
+    volatile unsigned long inicioEco;  // micros() del flanco de subida
+    volatile unsigned long finEco;     // micros() del flanco de bajada
+    unsigned long ultimoDisparo;       // micros() del último disparo
+
+    unsigned long intervaloDisparo;    // us entre disparos
+    unsigned long timeoutEco;          // us máximos esperando el eco
+
+    float ultimaDistancia;
+    bool ultimaValida;
+    unsigned long marcaMuestra;
+
+    unsigned long muestrasValidas;
+    unsigned long timeouts;
+
+    void disparar(unsigned long ahora);
+    static void IRAM_ATTR isrEco(void* arg);
+};
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef PANEL_WEB_H
+#define PANEL_WEB_H
+
+#include <Arduino.h>
+
+// Generado por extras/panel/generar_panel.py a partir de extras/panel/panel.html.
+// No editar a mano: editar el HTML y volver a ejecutar el script.
+// Original: 7656 bytes, comprimido: 2355 bytes.
+
+#define PANEL_ETAG "\"693b5a31615e429b\""
+
+static const size_t PANEL_GZ_LONGITUD = 2355;
+
+static const uint8_t PANEL_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0xff, 0xad, 0x59, 0x5b, 0x6f, 0x22, 0xc9,
+    0x15, 0x7e, 0xe7, 0x57, 0xd4, 0x4e, 0x14, 0x35, 0x68, 0x0d, 0x06, 0x63, 0x6c, 0xcc, 0x6d, 0x45,
+    0x80, 0xc9, 0x3a, 0xb2, 0xcd, 0xc8, 0xc6, 0x91, 0x92, 0xb7, 0xa2, 0xbb, 0x80, 0x9a, 0x69, 0xba,
+    0x50, 0x77, 0x03, 0xf6, 0x8c, 0x2c, 0x25, 0x2f, 0xc9, 0xcb, 0x28, 0xa3, 0x49, 0xa2, 0xdc, 0xa4,
+    0x68, 0x34, 0x52, 0xa4, 0xbc, 0x44, 0x51, 0x9e, 0xa2, 0x7d, 0x4e, 0xfe, 0xc9, 0xfc, 0x81, 0xcc,
+    0x4f, 0xc8, 0x39, 0x55, 0xd5, 0x4d, 0xdf, 0x30, 0x78, 0x77, 0x85, 0x34, 0xe3, 0xae, 0x3a, 0x97,
+    0xef, 0x5c, 0xea, 0x9c, 0xd3, 0xd5, 0xad, 0x2f, 0xfa, 0xc3, 0xde, 0xe8, 0x67, 0x2f, 0x06, 0x64,
+    0xe6, 0xcf, 0xed, 0x4e, 0x4b, 0xff, 0xcb, 0xa8, 0xd5, 0xc9, 0xb5, 0xe6, 0xcc, 0xa7, 0xc4, 0x9c,
+    0x51, 0xd7, 0x63, 0x7e, 0xdb, 0xb8, 0x1d, 0x3d, 0x2f, 0xd6, 0x8d, 0x60, 0xd9, 0xa1, 0x73, 0xd6,
+    0x36, 0x56, 0x9c, 0xad, 0x17, 0xc2, 0xf5, 0x0d, 0x62, 0x0a, 0xc7, 0x67, 0x0e, 0x90, 0xad, 0xb9,
+    0xe5, 0xcf, 0xda, 0x16, 0x5b, 0x71, 0x93, 0x15, 0xe5, 0xc3, 0x01, 0xe1, 0x0e, 0xf7, 0x39, 0xb5,
+    0x8b, 0x9e, 0x49, 0x6d, 0xd6, 0xae, 0x94, 0xca, 0x28, 0xc6, 0xe7, 0xbe, 0xcd, 0x3a, 0x3d, 0xe0,
+    0x73, 0x85, 0x4d, 0x7a, 0xc2, 0x9c, 0x31, 0x72, 0x2d, 0xc6, 0xc2, 0x6f, 0x1d, 0xaa, 0xad, 0x5c,
+    0xcb, 0xf3, 0xef, 0xf1, 0xff, 0xb1, 0xb0, 0xee, 0xc9, 0x1b, 0x32, 0x01, 0xd2, 0xe2, 0x84, 0xce,
+    0xb9, 0x7d, 0xdf, 0x20, 0x5d, 0x17, 0x04, 0x1e, 0x10, 0x8f, 0x3a, 0x5e, 0xd1, 0x63, 0x2e, 0x9f,
+    0x34, 0xc9, 0x9c, 0xde, 0x29, 0x85, 0x0d, 0x72, 0x52, 0x2e, 0x2f, 0xee, 0x70, 0xc5, 0x9d, 0x72,
+    0xa7, 0x41, 0x8e, 0xe0, 0x89, 0xd0, 0xa5, 0x2f, 0x9a, 0x64, 0x41, 0x2d, 0x8b, 0x3b, 0x53, 0xb5,
+    0xd6, 0x24, 0x63, 0x6a, 0xbe, 0x9a, 0xba, 0x62, 0xe9, 0x58, 0x0d, 0xf2, 0x83, 0x49, 0x19, 0x7f,
+    0x4d, 0xf2, 0x90, 0x2b, 0x99, 0xd4, 0xb5, 0x40, 0x65, 0x74, 0x7b, 0x3d, 0xe3, 0x3e, 0x03, 0x0e,
+    0xe1, 0x5a, 0xcc, 0x2d, 0xba, 0xd4, 0xe2, 0x4b, 0xaf, 0x41, 0x2a, 0x52, 0x4c, 0x42, 0x6a, 0xa0,
+    0xb7, 0x52, 0x03, 0xbd, 0x65, 0xe4, 0xb9, 0x2b, 0x7a, 0x33, 0x6a, 0x89, 0x75, 0x83, 0x94, 0xc9,
+    0x11, 0x2c, 0xe2, 0x86, 0x3b, 0x1d, 0xd3, 0x7c, 0xf9, 0x40, 0xfe, 0x4a, 0x95, 0x02, 0xea, 0x9d,
+    0x55, 0x40, 0xa9, 0x29, 0x6c, 0xe1, 0x02, 0x9c, 0x6a, 0xb5, 0xda, 0x24, 0x3e, 0xbb, 0xf3, 0x8b,
+    0xd4, 0xe6, 0x53, 0x10, 0x67, 0x82, 0x83, 0x99, 0x1b, 0x88, 0x2f, 0x82, 0xab, 0x7c, 0x31, 0x6f,
+    0xa0, 0x2c, 0x89, 0xd9, 0x63, 0x8e, 0x27, 0x5c, 0x10, 0x60, 0x71, 0x6f, 0x61, 0x53, 0x70, 0xd2,
+    0xc4, 0x66, 0xb0, 0xf5, 0x72, 0xe9, 0xf9, 0x7c, 0x72, 0x5f, 0xd4, 0x21, 0x6a, 0x10, 0x6f, 0x41,
+    0x21, 0x36, 0x63, 0xe6, 0xaf, 0x19, 0x73, 0x9a, 0x44, 0x4a, 0x2f, 0x82, 0x71, 0x73, 0x2f, 0xa9,
+    0x43, 0xd9, 0x87, 0x26, 0x84, 0x16, 0x56, 0x6a, 0x69, 0xbf, 0x9d, 0xe1, 0x2f, 0xe5, 0x9a, 0x38,
+    0xae, 0xa2, 0x4d, 0xc7, 0xcc, 0x0e, 0xc2, 0xb8, 0x66, 0x7c, 0x3a, 0x03, 0x28, 0x63, 0x61, 0x5b,
+    0xcd, 0xd0, 0xe2, 0x5a, 0xad, 0x16, 0xe5, 0x58, 0x51, 0x7b, 0xc9, 0x02, 0x0e, 0x8f, 0xbf, 0x66,
+    0xe0, 0xdf, 0x63, 0x14, 0x1a, 0xd0, 0x97, 0xcb, 0xa7, 0xe3, 0xc9, 0x44, 0xb2, 0x2c, 0x21, 0xc5,
+    0xe2, 0xa4, 0x95, 0x93, 0x28, 0xe9, 0xc9, 0xc9, 0x49, 0xe8, 0x38, 0x9b, 0x4d, 0xfc, 0x0d, 0x3c,
+    0xe6, 0xf9, 0x10, 0x19, 0xe0, 0xcd, 0x72, 0x75, 0x32, 0x5d, 0xb2, 0x82, 0x1f, 0x85, 0x57, 0x0f,
+    0x17, 0xe2, 0x16, 0x26, 0x33, 0xc2, 0x77, 0x21, 0x71, 0xe1, 0x50, 0x08, 0x58, 0xa3, 0xb6, 0x4d,
+    0xca, 0xa5, 0xaa, 0x27, 0xd1, 0x2c, 0xa8, 0xab, 0xd0, 0xc4, 0x3d, 0x3c, 0x31, 0x2b, 0xe5, 0xd3,
+    0xa8, 0xe1, 0x2a, 0x4d, 0xe9, 0x8a, 0x3a, 0xaf, 0xa9, 0x93, 0x66, 0x38, 0xaa, 0xd3, 0xd3, 0xe3,
+    0x5a, 0xc8, 0xa0, 0x73, 0x17, 0x38, 0x5c, 0x06, 0xc7, 0xcd, 0x64, 0x16, 0x67, 0x19, 0x5c, 0x96,
+    0x59, 0xad, 0x65, 0x72, 0xcd, 0xc5, 0x6e, 0x0f, 0xe9, 0xc4, 0xd8, 0xe5, 0xa1, 0xf2, 0x2e, 0x0f,
+    0xe9, 0x84, 0x43, 0xad, 0x14, 0x62, 0xe3, 0xa6, 0x50, 0x06, 0x51, 0x4f, 0xa1, 0x64, 0x9e, 0x69,
+    0xd3, 0x55, 0x8a, 0xfe, 0xc4, 0x3c, 0xad, 0x9d, 0x5a, 0x19, 0xf4, 0xf6, 0xd2, 0x64, 0xde, 0xf7,
+    0x63, 0x56, 0xa5, 0xbe, 0xa7, 0x59, 0x5b, 0x03, 0x2f, 0xc1, 0x14, 0x85, 0x93, 0x0e, 0xbd, 0x75,
+    0x8a, 0xd1, 0x4e, 0x86, 0x5e, 0xd3, 0x4f, 0x26, 0x49, 0x06, 0x59, 0x36, 0x02, 0xea, 0xb3, 0xb3,
+    0x33, 0x49, 0x3d, 0xf6, 0x9d, 0x68, 0x61, 0x18, 0xdb, 0xc2, 0x7c, 0xd5, 0x24, 0xba, 0x5a, 0x56,
+    0xca, 0xe5, 0x1f, 0xa6, 0x2c, 0x4e, 0x02, 0xdf, 0xc7, 0x58, 0xe5, 0xa5, 0x06, 0x71, 0x84, 0xc3,
+    0xb2, 0xcb, 0x81, 0xb9, 0x74, 0x3d, 0x04, 0xb6, 0x10, 0x5c, 0xf9, 0x79, 0xab, 0x3f, 0x00, 0x71,
+    0xf1, 0xa9, 0x09, 0x10, 0xe1, 0x69, 0xcc, 0xc4, 0x8a, 0xb9, 0x69, 0xce, 0xda, 0xc9, 0xb8, 0x1a,
+    0xd2, 0x3e, 0x35, 0x61, 0x22, 0x3c, 0xd9, 0xf2, 0xe1, 0xf4, 0x8c, 0x4f, 0x8e, 0x42, 0x5a, 0x6c,
+    0x39, 0x7b, 0x9f, 0xcc, 0x80, 0x21, 0x5b, 0xf2, 0x51, 0xa5, 0x5e, 0xaf, 0xd6, 0x23, 0x56, 0x3a,
+    0x4b, 0x6a, 0xef, 0x28, 0x13, 0x63, 0x9b, 0x62, 0x94, 0x63, 0x2c, 0xd9, 0xd2, 0x59, 0x99, 0xd6,
+    0x75, 0x5e, 0x21, 0x69, 0x70, 0x30, 0x1e, 0x4b, 0xc4, 0xb8, 0x70, 0xc9, 0x91, 0x2d, 0x7b, 0x32,
+    0x61, 0xd6, 0xf1, 0xa6, 0x8c, 0xc8, 0x36, 0x84, 0x1d, 0x3f, 0xd5, 0xa7, 0xa6, 0x74, 0x11, 0x9c,
+    0xac, 0x24, 0xad, 0xce, 0x5f, 0xa4, 0x03, 0x92, 0x48, 0x8f, 0x80, 0x23, 0x40, 0x4d, 0x9f, 0xaf,
+    0x84, 0x97, 0x28, 0xfe, 0xc7, 0x5b, 0x8a, 0xbf, 0xcc, 0x43, 0x5d, 0x5f, 0x74, 0x9b, 0x51, 0x02,
+    0xa2, 0x78, 0xb8, 0x63, 0x73, 0x07, 0x3a, 0xa4, 0x3a, 0x25, 0x51, 0xc6, 0x7a, 0xac, 0xdb, 0xe3,
+    0x4a, 0x25, 0x3d, 0x47, 0x64, 0x87, 0x38, 0x59, 0x42, 0x6a, 0xc9, 0x12, 0x72, 0x14, 0xef, 0x97,
+    0xdc, 0xf9, 0xde, 0x81, 0x99, 0xa6, 0x99, 0x70, 0xca, 0xde, 0xa0, 0x64, 0x97, 0xe4, 0x30, 0x48,
+    0x98, 0x74, 0x2f, 0x40, 0x11, 0x30, 0x75, 0x04, 0x73, 0x94, 0x02, 0x93, 0x7d, 0x8a, 0xb3, 0x8a,
+    0x46, 0x2a, 0xae, 0x19, 0xa5, 0xe7, 0x21, 0xd7, 0x3a, 0xd4, 0xe3, 0x62, 0xcb, 0x33, 0x5d, 0xbe,
+    0xf0, 0x3b, 0xb9, 0x15, 0x75, 0x89, 0x45, 0x7d, 0xc8, 0x8d, 0x36, 0x79, 0xf3, 0xd0, 0xcc, 0x4d,
+    0x96, 0x8e, 0x89, 0x95, 0x86, 0xcc, 0x05, 0x94, 0x08, 0xea, 0xf6, 0x71, 0x2f, 0x0f, 0x14, 0xb4,
+    0x40, 0xde, 0xe4, 0x08, 0xb1, 0x84, 0xb9, 0x9c, 0x43, 0xfd, 0x2f, 0x4d, 0x99, 0x3f, 0xb0, 0x19,
+    0xfe, 0xf9, 0xa3, 0xfb, 0x73, 0x2b, 0x6f, 0xa0, 0xe1, 0xd4, 0x31, 0x39, 0x35, 0x0a, 0x25, 0xee,
+    0x38, 0xcc, 0xfd, 0x7a, 0x74, 0x79, 0x01, 0x42, 0x91, 0xb5, 0x14, 0x6e, 0x96, 0x7c, 0xf1, 0x9c,
+    0xdf, 0x31, 0x2b, 0x5f, 0x29, 0x90, 0x2f, 0x89, 0x41, 0x5a, 0x30, 0x67, 0x39, 0x04, 0xaa, 0x85,
+    0xe7, 0xb5, 0x9f, 0xe1, 0x7c, 0xf2, 0xac, 0x63, 0xce, 0x01, 0x25, 0xac, 0x76, 0x8c, 0x26, 0xe8,
+    0x43, 0x7c, 0xc2, 0xe5, 0x53, 0xe6, 0x8c, 0xa0, 0x03, 0x09, 0x10, 0x68, 0xc8, 0x75, 0x3e, 0x21,
+    0x12, 0x55, 0x49, 0x6d, 0xf6, 0x95, 0x09, 0x6d, 0xd8, 0xbe, 0x18, 0xf6, 0xba, 0x17, 0x06, 0xa0,
+    0x4d, 0xf2, 0x91, 0xcf, 0x1f, 0x7e, 0xf7, 0xd1, 0x40, 0x37, 0x10, 0xc2, 0x6c, 0x8f, 0x3d, 0x22,
+    0xe3, 0x7a, 0x70, 0x39, 0x1c, 0x0d, 0xb7, 0x09, 0xf9, 0x77, 0x54, 0x48, 0x9a, 0xe2, 0xd3, 0x5f,
+    0xdf, 0x6a, 0x82, 0xad, 0xce, 0x82, 0x39, 0x72, 0xc1, 0x5c, 0xea, 0x2f, 0xdd, 0x4c, 0x77, 0x45,
+    0xb6, 0xf7, 0x70, 0xd8, 0x7f, 0xfe, 0xd5, 0x0b, 0x3c, 0x06, 0x24, 0x11, 0x34, 0xcd, 0xc7, 0x20,
+    0xd8, 0xcb, 0xd7, 0x09, 0xd5, 0xca, 0x17, 0xb0, 0x4e, 0xbe, 0x22, 0xc6, 0xa7, 0x3f, 0xfd, 0xe2,
+    0x7f, 0xdf, 0xbc, 0x23, 0x7d, 0xe6, 0x33, 0x13, 0xb2, 0x9a, 0x1a, 0xa4, 0x41, 0x8c, 0xcf, 0x1f,
+    0xde, 0xfe, 0x99, 0x0c, 0x3d, 0x68, 0x50, 0xc2, 0x28, 0xa4, 0x75, 0x61, 0xac, 0xd4, 0xa4, 0xd8,
+    0xe7, 0x2b, 0xb4, 0x65, 0x9b, 0x6e, 0x45, 0x64, 0x14, 0x90, 0x29, 0x64, 0x28, 0x49, 0xa3, 0xae,
+    0xe0, 0x9d, 0x09, 0xbd, 0x28, 0x5f, 0x2e, 0xf4, 0xd8, 0x89, 0x66, 0x49, 0x6c, 0xea, 0x19, 0x5c,
+    0x72, 0x21, 0xd6, 0xcc, 0xed, 0x51, 0x8f, 0xe5, 0x0b, 0x81, 0x62, 0x0e, 0x75, 0x50, 0x04, 0x0e,
+    0xd4, 0x8c, 0x32, 0x96, 0xdd, 0x9f, 0x76, 0xaf, 0x7e, 0xde, 0xbd, 0xea, 0x0f, 0x0d, 0x69, 0xd7,
+    0x3f, 0x7e, 0x05, 0x76, 0xa1, 0x35, 0xf9, 0x14, 0xe5, 0xf5, 0x60, 0x74, 0x3d, 0xec, 0x0d, 0xfa,
+    0xe7, 0x83, 0x0d, 0xf5, 0xaf, 0x35, 0xb5, 0xf1, 0xe9, 0xdd, 0x37, 0xf8, 0x67, 0x02, 0x73, 0xd4,
+    0x7f, 0x0a, 0x01, 0x06, 0x29, 0x01, 0x38, 0x80, 0x88, 0xe5, 0x7a, 0x87, 0x67, 0x90, 0x44, 0xe9,
+    0xd0, 0xc4, 0x19, 0x5e, 0x91, 0x83, 0x26, 0xaa, 0x50, 0x16, 0xc8, 0x47, 0x89, 0xff, 0xb2, 0x3b,
+    0xb8, 0x01, 0x0b, 0x24, 0x72, 0xdd, 0xe2, 0x25, 0x74, 0xdd, 0x8e, 0xe3, 0x72, 0xd3, 0x91, 0xcf,
+    0x16, 0xf4, 0xf9, 0xc3, 0xfb, 0xf7, 0x44, 0x47, 0xff, 0x6f, 0x7f, 0x20, 0x32, 0xee, 0x21, 0x79,
+    0x60, 0x19, 0xf6, 0xe4, 0x3d, 0x2c, 0xeb, 0x02, 0x99, 0x42, 0xa1, 0x19, 0x32, 0x50, 0xe0, 0xce,
+    0x9c, 0x42, 0x0d, 0x15, 0x4a, 0x3b, 0xe8, 0xec, 0xde, 0x8e, 0x86, 0x97, 0xff, 0xfd, 0xe5, 0xe8,
+    0xbc, 0x37, 0xd4, 0x40, 0x7e, 0xf3, 0x4f, 0x72, 0xd9, 0xbd, 0xba, 0xc5, 0x73, 0x1e, 0x2b, 0x06,
+    0xb2, 0xc5, 0xf6, 0xa1, 0xf0, 0x0a, 0x87, 0x8f, 0x6d, 0xe6, 0xa9, 0x9a, 0xf5, 0xc8, 0x29, 0xf0,
+    0x98, 0x69, 0x42, 0xb5, 0xbb, 0x40, 0x3e, 0x38, 0x0e, 0xb2, 0x3a, 0x96, 0x74, 0xe5, 0x46, 0x87,
+    0xcb, 0xa2, 0x2d, 0x0b, 0x8e, 0x32, 0x54, 0x2b, 0xd8, 0x23, 0xbb, 0xb5, 0x48, 0xc5, 0x1a, 0xb0,
+    0x65, 0x44, 0x53, 0xcd, 0x11, 0x9b, 0x70, 0xca, 0xe7, 0x81, 0x03, 0x33, 0xb6, 0xc5, 0x2d, 0xea,
+    0xa1, 0x13, 0x82, 0xb1, 0x57, 0x1a, 0x1f, 0xce, 0xb4, 0x29, 0xd9, 0x59, 0x67, 0x39, 0x25, 0xeb,
+    0xf3, 0x87, 0xdf, 0x7e, 0x24, 0x17, 0xb7, 0xbd, 0xc1, 0x0d, 0x19, 0x5c, 0xf5, 0x20, 0xd1, 0xcf,
+    0xfb, 0xdd, 0x9b, 0xe0, 0x70, 0xbf, 0xd7, 0x3b, 0xdd, 0x17, 0xdd, 0x1f, 0x77, 0x71, 0x5d, 0xab,
+    0xd8, 0x6a, 0x2a, 0x8c, 0x1c, 0xd2, 0x4e, 0x15, 0xd8, 0x6d, 0x08, 0xba, 0x41, 0x48, 0x03, 0x08,
+    0x10, 0x53, 0xad, 0x08, 0x22, 0xbb, 0x09, 0xa9, 0x5a, 0x8b, 0x06, 0xf6, 0x41, 0xd7, 0xd8, 0xef,
+    0x16, 0x44, 0x1c, 0xb5, 0x65, 0x0c, 0x1f, 0x74, 0xba, 0x06, 0x73, 0x91, 0x86, 0xaa, 0x3a, 0x4a,
+    0x6c, 0xf1, 0x4b, 0x5d, 0x48, 0xd4, 0xe2, 0xad, 0x0d, 0xad, 0xd0, 0x83, 0x9c, 0x52, 0x49, 0x19,
+    0xab, 0xc1, 0xb1, 0x01, 0xe9, 0x59, 0x07, 0xda, 0xc3, 0x3b, 0xf2, 0x75, 0xaf, 0x78, 0x73, 0x5d,
+    0x3e, 0x0e, 0xab, 0x72, 0x23, 0x9b, 0x27, 0x98, 0x5e, 0xb2, 0xb9, 0x76, 0x60, 0x1a, 0x6d, 0x7a,
+    0xc4, 0x6e, 0x4c, 0x6f, 0x3f, 0x62, 0x31, 0xbf, 0xb8, 0xac, 0xd6, 0x9e, 0x82, 0x29, 0xcd, 0xb5,
+    0x03, 0xd3, 0xc5, 0x72, 0xce, 0x1d, 0xe1, 0x41, 0xae, 0x59, 0xbb, 0x31, 0x61, 0x1e, 0x5e, 0x56,
+    0xcf, 0xaa, 0x4f, 0x41, 0x94, 0xe4, 0xd9, 0x89, 0x07, 0xcf, 0xd6, 0x5e, 0x48, 0x06, 0xfd, 0xa7,
+    0xe2, 0xd8, 0x70, 0x3c, 0xda, 0x67, 0x03, 0x78, 0x5d, 0x35, 0x82, 0x27, 0x4e, 0x49, 0x14, 0x7c,
+    0x33, 0xf7, 0xb0, 0x19, 0xbf, 0x40, 0x17, 0xbc, 0x89, 0xf0, 0xd7, 0xc1, 0x04, 0xa6, 0x2a, 0xd9,
+    0x84, 0xf9, 0xe6, 0x2c, 0x6f, 0x1c, 0xca, 0x89, 0x0d, 0x44, 0xf9, 0x33, 0xe6, 0xe4, 0x5d, 0xd2,
+    0xee, 0x10, 0xb7, 0xf4, 0x12, 0x12, 0x34, 0x5f, 0xd0, 0x6b, 0xe8, 0x04, 0x5c, 0x7e, 0x13, 0x0e,
+    0x77, 0xb8, 0xd2, 0x4c, 0x4d, 0x75, 0xc2, 0xc3, 0x3b, 0xb5, 0x42, 0x4c, 0x35, 0xb4, 0x31, 0xec,
+    0xf9, 0xee, 0x60, 0x05, 0x46, 0x84, 0xaa, 0xb1, 0xc6, 0x7e, 0xb1, 0xe6, 0x8e, 0x25, 0xd6, 0x25,
+    0xb9, 0x73, 0x23, 0x96, 0xae, 0xc9, 0x70, 0x44, 0xf2, 0x98, 0x7f, 0x8e, 0x6f, 0xaa, 0x2b, 0x6a,
+    0xe7, 0x13, 0xb8, 0x0f, 0x48, 0xad, 0x5c, 0x06, 0x15, 0x2e, 0x83, 0x44, 0x75, 0x9a, 0xe1, 0x09,
+    0x9c, 0x2c, 0xf1, 0x0e, 0x01, 0x60, 0x39, 0x6c, 0x4d, 0x22, 0xe2, 0xc0, 0x36, 0xa6, 0xd4, 0xaa,
+    0x02, 0xa0, 0xe8, 0x4a, 0xc2, 0x99, 0x33, 0xcf, 0xa3, 0x53, 0xe4, 0x08, 0x70, 0xe6, 0xa5, 0xee,
+    0xe1, 0xf8, 0x25, 0x80, 0x2d, 0x41, 0xa0, 0xf8, 0xd4, 0x51, 0x16, 0x1d, 0x90, 0x9f, 0xdc, 0x0c,
+    0xaf, 0xf0, 0x96, 0x08, 0xe6, 0x03, 0x28, 0x04, 0x38, 0xbb, 0x16, 0xb6, 0x99, 0x1e, 0x53, 0xc2,
+    0x5c, 0x57, 0xb8, 0x51, 0x15, 0x41, 0xff, 0x40, 0xe3, 0x35, 0x95, 0xcb, 0xa8, 0x75, 0x7f, 0xe3,
+    0x53, 0x44, 0x0f, 0xbd, 0x32, 0x82, 0xbd, 0xd4, 0xbb, 0x18, 0xde, 0x0c, 0xfa, 0x85, 0x3d, 0xfc,
+    0x81, 0xb5, 0x28, 0xee, 0x73, 0x3a, 0x1f, 0x73, 0xea, 0x5e, 0x42, 0x93, 0xcc, 0xeb, 0xd6, 0x1d,
+    0x8f, 0x38, 0xb6, 0xcf, 0xaf, 0xf4, 0x4e, 0x5b, 0x76, 0x8b, 0xe0, 0xc5, 0x1f, 0xd2, 0xbb, 0x22,
+    0x93, 0xb6, 0x6c, 0x04, 0xd1, 0x07, 0xdc, 0x10, 0x7b, 0x80, 0x31, 0xe2, 0x73, 0x26, 0x96, 0x7e,
+    0x36, 0x8a, 0x78, 0xd4, 0x7d, 0x31, 0x9d, 0xda, 0x2c, 0x2c, 0xd5, 0x22, 0x91, 0x71, 0x9b, 0xb6,
+    0x6c, 0x7c, 0x67, 0x25, 0xf2, 0x58, 0x26, 0xe4, 0xcb, 0x46, 0x71, 0xa8, 0xf6, 0xf7, 0xd7, 0x70,
+    0xf4, 0x98, 0x06, 0xb4, 0x25, 0x53, 0x0b, 0x55, 0xdd, 0xea, 0xa9, 0x3a, 0x74, 0xf2, 0x0b, 0xc7,
+    0x16, 0x50, 0xdf, 0xe2, 0x59, 0x92, 0x3e, 0xaf, 0xcd, 0xf4, 0x39, 0x92, 0xe9, 0x06, 0x45, 0x43,
+    0xbf, 0x7a, 0xb5, 0x0e, 0xe5, 0x37, 0x84, 0x16, 0x5e, 0xdd, 0xc3, 0xd3, 0xac, 0x02, 0x85, 0xe5,
+    0x2f, 0x7f, 0x24, 0x99, 0xb7, 0xfd, 0xb0, 0x99, 0x6b, 0x59, 0x30, 0x77, 0xa8, 0x9a, 0x14, 0x19,
+    0x04, 0xc3, 0x41, 0x8f, 0x5b, 0x6d, 0x35, 0x3e, 0x76, 0xe4, 0xc8, 0xa6, 0x67, 0xb8, 0xd6, 0x21,
+    0x70, 0xa5, 0x79, 0x8d, 0xf8, 0x52, 0xf4, 0x22, 0x01, 0xb7, 0xc6, 0x4b, 0xdf, 0x17, 0x41, 0x01,
+    0xc4, 0x2e, 0x4f, 0x22, 0xd7, 0x46, 0x06, 0x11, 0x8e, 0x69, 0x73, 0xf3, 0x15, 0x8a, 0xda, 0xa4,
+    0xad, 0xef, 0x2e, 0x59, 0x21, 0x50, 0xae, 0x28, 0x5b, 0x87, 0x4a, 0xd0, 0x56, 0x89, 0xc1, 0x64,
+    0x9a, 0x2d, 0x71, 0x42, 0xa1, 0xf9, 0x4b, 0x91, 0x30, 0x30, 0x0c, 0x14, 0x69, 0x44, 0xa4, 0xb6,
+    0x2c, 0x5b, 0xb2, 0x8c, 0x71, 0xe8, 0x13, 0x39, 0x9f, 0x6c, 0x94, 0xa4, 0x73, 0x5d, 0x2b, 0x89,
+    0x4c, 0x9a, 0x69, 0x45, 0xe8, 0x2f, 0x14, 0x18, 0x1b, 0x37, 0x88, 0x9c, 0x36, 0xda, 0x46, 0xf0,
+    0xb6, 0x2f, 0xaf, 0xf5, 0x8c, 0x8c, 0x60, 0xa9, 0x39, 0x6f, 0x33, 0xbd, 0x49, 0x51, 0xd1, 0x51,
+    0xb1, 0x93, 0x31, 0x80, 0x3d, 0x12, 0xbd, 0x6c, 0xb3, 0x6d, 0x05, 0x2a, 0x61, 0xa9, 0x3e, 0x70,
+    0x86, 0xea, 0x5c, 0xc3, 0xab, 0xc3, 0xe1, 0xf3, 0xe7, 0x44, 0x2e, 0xee, 0x8c, 0xd0, 0xc6, 0x8f,
+    0xb1, 0x59, 0x2f, 0x53, 0x83, 0x3a, 0x70, 0xda, 0x95, 0x9b, 0x01, 0x2f, 0xed, 0xc9, 0x6c, 0xab,
+    0x82, 0xd7, 0x3d, 0x75, 0xbd, 0x1f, 0x75, 0x90, 0xd1, 0x51, 0x6f, 0x5f, 0xe4, 0x45, 0xf7, 0xba,
+    0xdb, 0xdf, 0x33, 0xa7, 0x55, 0x6b, 0x35, 0x3a, 0xd1, 0x5e, 0x6e, 0x44, 0xbf, 0xb3, 0x18, 0x6a,
+    0xec, 0xea, 0x07, 0x77, 0x13, 0x0d, 0xdd, 0xcf, 0xb3, 0x18, 0xe4, 0x67, 0x16, 0x05, 0x69, 0x73,
+    0xd1, 0xd1, 0x29, 0x16, 0x49, 0x78, 0x5b, 0x91, 0x01, 0x6a, 0x2f, 0x04, 0x6a, 0xc8, 0x8a, 0x4c,
+    0x73, 0x7b, 0xc2, 0x88, 0x5e, 0x21, 0x20, 0x90, 0xcd, 0x2d, 0xc0, 0xb7, 0x45, 0x82, 0x43, 0xcd,
+    0x66, 0x80, 0xdb, 0x13, 0x06, 0x5e, 0x23, 0x80, 0xfa, 0x84, 0xea, 0xed, 0x01, 0x9a, 0x55, 0x83,
+    0x13, 0xa3, 0x3f, 0x34, 0xf9, 0x62, 0xd1, 0x08, 0x6f, 0x4c, 0xe5, 0xc5, 0x3c, 0x62, 0xf9, 0xfd,
+    0xdf, 0xc9, 0x8d, 0x1e, 0x8d, 0x88, 0x9e, 0x9c, 0xa0, 0x08, 0x56, 0xb3, 0xac, 0xda, 0x5c, 0x6f,
+    0x1a, 0xfa, 0x78, 0xc6, 0x07, 0xae, 0x4e, 0x0f, 0x14, 0xe1, 0xf7, 0x9f, 0x52, 0xa9, 0x94, 0xc0,
+    0x77, 0x28, 0x4b, 0x2f, 0x08, 0xc6, 0x2f, 0xba, 0xb9, 0xff, 0x03, 0xee, 0x99, 0xf5, 0x6d, 0xe8,
+    0x1d, 0x00, 0x00,
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef PERFILES_COCHE_H
+#define PERFILES_COCHE_H
+
+#include "CocheT.h"
+
+// Perfiles de hardware: pines, rol y funciones de cada coche fijados al
+// compilar. Un sensor con pin -1 no está montado y su lectura no se compila
+// (sin LM393 no hay sensores; sin LM35 solo se comparte la luz). Para otro
+// montaje basta con copiar un perfil y cambiar lo que haga falta:
+//
+//   struct MiPerfil : PerfilMaestroLolin { static constexpr int LUCES = -1; };
+//   CochePerfil<MiPerfil> miCoche;
+//
+// Pines en GPIO (los Dx del LOLIN D1 ESP-WROOM-02 entre paréntesis).
+
+// Maestro del proyecto: HC-SR04 y LM393, LEDs y panel web
+struct PerfilMaestroLolin {
+    typedef RolMaestro Rol;
+    typedef ConWeb Web;
+    static constexpr int MOTOR1_A = 5;      // (D1) Motor izquierdo
+    static constexpr int MOTOR1_B = 4;      // (D2)
+    static constexpr int MOTOR2_A = 0;      // (D3) Motor derecho
+    static constexpr int MOTOR2_B = 2;      // (D4)
+    static constexpr int TRIG = 14;         // (D5) HC-SR04
+    static constexpr int ECHO = 12;         // (D6) Con divisor de tensión
+    static constexpr int TEMPERATURA = -1;  // LM35 no montado (sería A0 = 17)
+    static constexpr int LUZ = 13;          // (D7) LM393
+    static constexpr int LUCES = 15;        // (D8) LEDs
+};
+
+// Esclavo del proyecto: solo motores, HC-SR04 de seguridad y LEDs; usa la
+// luz que le manda el maestro
+struct PerfilEsclavoLolin {
+    typedef RolEsclavo Rol;
+    typedef ConWeb Web;
+    static constexpr int MOTOR1_A = 5;      // (D1)
+    static constexpr int MOTOR1_B = 4;      // (D2)
+    static constexpr int MOTOR2_A = 0;      // (D3)
+    static constexpr int MOTOR2_B = 2;      // (D4)
+    static constexpr int TRIG = 14;         // (D5)
+    static constexpr int ECHO = 12;         // (D6)
+    static constexpr int TEMPERATURA = -1;
+    static constexpr int LUZ = -1;
+    static constexpr int LUCES = 15;        // (D8)
+};
+
+// Coche que puede cambiar de rol desde la web, con todos los sensores
+struct PerfilDualLolin : PerfilMaestroLolin {
+    typedef RolDinamico Rol;
+    static constexpr int TEMPERATURA = 17;  // (A0) LM35
+};
+
+// Política de sensores según los pines montados
+template <bool LUZ, bool TEMPERATURA> struct SensoresMontados { typedef SinSensores Tipo; };
+template <> struct SensoresMontados<true, true> { typedef ConSensores Tipo; };
+template <> struct SensoresMontados<true, false> { typedef SoloLuz Tipo; };
+
+// CocheT que corresponde a un perfil
+template <class Perfil>
+struct CocheDePerfil {
+    typedef CocheT<typename Perfil::Rol,
+                   typename SensoresMontados<(Perfil::LUZ >= 0), (Perfil::TEMPERATURA >= 0)>::Tipo,
+                   typename Perfil::Web> Tipo;
+};
+
+// Coche construido con los pines y políticas de un perfil
+template <class Perfil>
+class CochePerfil : public CocheDePerfil<Perfil>::Tipo {
+public:
+    CochePerfil()
+        : CocheDePerfil<Perfil>::Tipo(Perfil::MOTOR1_A, Perfil::MOTOR1_B, Perfil::MOTOR2_A, Perfil::MOTOR2_B,
+                                      Perfil::TRIG, Perfil::ECHO, Perfil::TEMPERATURA, Perfil::LUZ,
+                                      Perfil::LUCES) {}
+};
+
+#endif
@@ -0,0 +1,178 @@
+#include "Planificador.h"
+#include "Hal.h"
+
+// Constructor
+Planificador::Planificador() {
+    numTareas = 0;
+}
+
+// Registrar una tarea periódica
+int Planificador::agregar(const char* nombre, FuncionTarea funcion, void* contexto,
+                          unsigned long periodoUs, unsigned long plazoUs, uint8_t prioridad) {
+    if (numTareas >= MAX_TAREAS || funcion == nullptr || periodoUs == 0) return -1;
+
+    Tarea& tarea = tareas[numTareas];
+    tarea.nombre = nombre;
+    tarea.funcion = funcion;
+    tarea.contexto = contexto;
+    tarea.periodoUs = periodoUs;
+    tarea.plazoUs = plazoUs > 0 ? plazoUs : periodoUs;
+    tarea.prioridad = prioridad;
+    tarea.activa = true;
+    tarea.activacion = halMicros();
+    tarea.ejecuciones = 0;
+    tarea.vencidas = 0;
+    tarea.saltadas = 0;
+    tarea.ejecucionMaxima = 0;
+    tarea.retrasoMaximo = 0;
+    tarea.ejecucionTotal = 0;
+    return numTareas++;
+}
+
+bool Planificador::valido(int id) {
+    return id >= 0 && id < numTareas;
+}
+
+// Cambiar el periodo de una tarea (el plazo lo sigue si era el periodo)
+void Planificador::setPeriodo(int id, unsigned long periodoUs) {
+    if (!valido(id) || periodoUs == 0) return;
+    Tarea& tarea = tareas[id];
+    if (tarea.plazoUs == tarea.periodoUs) tarea.plazoUs = periodoUs;
+    tarea.periodoUs = periodoUs;
+}
+
+// Activar o pausar una tarea
+void Planificador::setActiva(int id, bool activa) {
+    if (!valido(id)) return;
+    if (activa && !tareas[id].activa) {
+        tareas[id].activacion = halMicros();  // Volver sin deuda de periodos
+    }
+    tareas[id].activa = activa;
+}
+
+// Tarea activada con el plazo absoluto más cercano (y más prioridad a igualdad)
+// que aún no haya corrido en esta pasada, o -1
+int Planificador::elegir(unsigned long ahoraUs, uint8_t* hechas) {
+    int elegida = -1;
+    long mejorHolgura = 0;
+    for (uint8_t i = 0; i < numTareas; i++) {
+        Tarea& tarea = tareas[i];
+        if (!tarea.activa || hechas[i]) continue;
+        if ((long)(ahoraUs - tarea.activacion) < 0) continue;  // Aún no toca
+
+        // Tiempo que queda hasta el plazo (negativo si ya venció)
+        long holgura = (long)(tarea.activacion + tarea.plazoUs - ahoraUs);
+        if (elegida < 0 || holgura < mejorHolgura ||
+            (holgura == mejorHolgura && tarea.prioridad > tareas[elegida].prioridad)) {
+            elegida = i;
+            mejorHolgura = holgura;
+        }
+    }
+    return elegida;
+}
+
+// Ejecutar las tareas activadas, cada una como mucho una vez por llamada
+uint8_t Planificador::atender() {
+    uint8_t hechas[MAX_TAREAS] = {0};
+    uint8_t ejecutadas = 0;
+
+    while (true) {
+        unsigned long inicio = halMicros();
+        int indice = elegir(inicio, hechas);
+        if (indice < 0) return ejecutadas;
+        hechas[indice] = 1;
+        ejecutadas++;
+
+        Tarea& tarea = tareas[indice];
+        unsigned long retraso = inicio - tarea.activacion;
+        tarea.funcion(tarea.contexto);
+        unsigned long fin = halMicros();
+        unsigned long duracion = fin - inicio;
+
+        // Estadísticas
+        tarea.ejecuciones++;
+        tarea.ejecucionTotal += duracion;
+        if (duracion > tarea.ejecucionMaxima) tarea.ejecucionMaxima = duracion;
+        if (retraso > tarea.retrasoMaximo) tarea.retrasoMaximo = retraso;
+        if (fin - tarea.activacion > tarea.plazoUs) tarea.vencidas++;
+
+        // Siguiente activación a ritmo fijo; los periodos ya perdidos se saltan
+        tarea.activacion += tarea.periodoUs;
+        while ((long)(fin - tarea.activacion) >= (long)tarea.periodoUs) {
+            tarea.activacion += tarea.periodoUs;
+            tarea.saltadas++;
+        }
+    }
+}
+
+// Número de tareas registradas
+uint8_t Planificador::cantidad() {
+    return numTareas;
+}
+
+// Poner a cero las estadísticas de todas las tareas
+void Planificador::reiniciarEstadisticas() {
+    for (uint8_t i = 0; i < numTareas; i++) {
+        Tarea& tarea = tareas[i];
+        tarea.ejecuciones = 0;
+        tarea.vencidas = 0;
+        tarea.saltadas = 0;
+        tarea.ejecucionMaxima = 0;
+        tarea.retrasoMaximo = 0;
+        tarea.ejecucionTotal = 0;
+    }
+}
+
+// Resumen en JSON: una entrada por tarea con periodo, ejecución y retrasos (us)
+size_t Planificador::escribirJSON(char* destino, size_t tam) {
+    if (tam < 3) {  // "[]" y el terminador
+        if (tam > 0) destino[0] = '\0';
+        return 0;
+    }
+    size_t usado = 1;
+    destino[0] = '[';
+
+    // Cada tarea entera o nada, dejando sitio para el "]" y el terminador
+    for (uint8_t i = 0; i < numTareas; i++) {
+        Tarea& tarea = tareas[i];
+        size_t libre = tam - usado - 1;
+        int n = snprintf(destino + usado, libre,
+                         "%s{\"nombre\":\"%s\",\"periodo\":%lu,\"plazo\":%lu,\"prioridad\":%u,"
+                         "\"ejecuciones\":%lu,\"vencidas\":%lu,\"saltadas\":%lu,"
+                         "\"ejecucionMedia\":%lu,\"ejecucionMax\":%lu,\"retrasoMax\":%lu}",
+                         i > 0 ? "," : "", tarea.nombre, tarea.periodoUs, tarea.plazoUs, tarea.prioridad,
+                         tarea.ejecuciones, tarea.vencidas, tarea.saltadas,
+                         obtenerEjecucionMedia(i), tarea.ejecucionMaxima, tarea.retrasoMaximo);
+        if (n < 0 || (size_t)n >= libre) break;
+        usado += n;
+    }
+
+    destino[usado++] = ']';
+    destino[usado] = '\0';
+    return usado;
+}
+
+unsigned long Planificador::obtenerEjecuciones(int id) {
+    return valido(id) ? tareas[id].ejecuciones : 0;
+}
+
+unsigned long Planificador::obtenerVencidas(int id) {
+    return valido(id) ? tareas[id].vencidas : 0;
+}
+
+unsigned long Planificador::obtenerSaltadas(int id) {
+    return valido(id) ? tareas[id].saltadas : 0;
+}
+
+unsigned long Planificador::obtenerEjecucionMedia(int id) {
+    if (!valido(id) || tareas[id].ejecuciones == 0) return 0;
+    return (unsigned long)(tareas[id].ejecucionTotal / tareas[id].ejecuciones);
+}
+
+unsigned long Planificador::obtenerEjecucionMaxima(int id) {
+    return valido(id) ? tareas[id].ejecucionMaxima : 0;
+}
+
+unsigned long Planificador::obtenerRetrasoMaximo(int id) {
+    return valido(id) ? tareas[id].retrasoMaximo : 0;
+}
@@ -0,0 +1,75 @@
+#ifndef PLANIFICADOR_H
+#define PLANIFICADOR_H
+
+#include <Arduino.h>
+
+#define MAX_TAREAS 10
+
+// Planificador cooperativo de tareas periódicas.
+// Cada tarea tiene periodo, plazo relativo y prioridad. En cada llamada a
+// atender() se ejecutan las tareas ya activadas por orden de plazo absoluto
+// (EDF) y, a igual plazo, por prioridad. Las activaciones avanzan a ritmo
+// fijo (activación += periodo), así que el ritmo no deriva con la carga.
+// Las tareas no se interrumpen: una que se pasa de su plazo se cuenta como
+// vencida y, si llega a perder periodos enteros, como saltada.
+class Planificador {
+public:
+    typedef void (*FuncionTarea)(void* contexto);
+
+    Planificador();
+
+    // Registrar una tarea. plazoUs = 0 usa el periodo como plazo.
+    // Devuelve su identificador o -1 si no caben más.
+    int agregar(const char* nombre, FuncionTarea funcion, void* contexto,
+                unsigned long periodoUs, unsigned long plazoUs = 0, uint8_t prioridad = 0);
+
+    void setPeriodo(int id, unsigned long periodoUs);
+    void setActiva(int id, bool activa);
+
+    // Ejecutar lo que toque (llamar desde loop() tan a menudo como se pueda).
+    // Devuelve cuántas tareas se ejecutaron (0 = tiempo libre).
+    uint8_t atender();
+
+    // Estadísticas
+    uint8_t cantidad();
+    void reiniciarEstadisticas();
+    // Lista JSON de las tareas. Solo escribe las que caben enteras y siempre
+    // cierra la lista, así que un buffer corto da un JSON válido más corto.
+    // Devuelve la longitud escrita, o 0 si no cabe ni "[]".
+    size_t escribirJSON(char* destino, size_t tam);
+
+    // Estadísticas por tarea (id de agregar())
+    unsigned long obtenerEjecuciones(int id);
+    unsigned long obtenerVencidas(int id);       // Terminó después de su plazo
+    unsigned long obtenerSaltadas(int id);       // Periodos perdidos enteros
+    unsigned long obtenerEjecucionMedia(int id); // us
+    unsigned long obtenerEjecucionMaxima(int id);
+    unsigned long obtenerRetrasoMaximo(int id);  // Activación → inicio (jitter), us
+
+private:
+    struct Tarea {
+        const char* nombre;
+        FuncionTarea funcion;
+        void* contexto;
+        unsigned long periodoUs;
+        unsigned long plazoUs;
+        uint8_t prioridad;
+        bool activa;
+        unsigned long activacion;  // micros() de la próxima activación
+
+        unsigned long ejecuciones;
+        unsigned long vencidas;
+        unsigned long saltadas;
+        unsigned long ejecucionMaxima;
+        unsigned long retrasoMaximo;
+        uint64_t ejecucionTotal;
+    };
+
+    Tarea tareas[MAX_TAREAS];
+    uint8_t numTareas;
+
+    int elegir(unsigned long ahoraUs, uint8_t* hechas);
+    bool valido(int id);
+};
+
+#endif
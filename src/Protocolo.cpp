@@ -0,0 +1,40 @@
+#include "Protocolo.h"
+
+// Tabla de 16 entradas (un nibble por paso): 32 bytes en lugar de 512
+static const uint16_t TABLA_CRC16[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+// CRC-16/CCITT-FALSE
+uint16_t calcularCRC16(const uint8_t* datos, size_t longitud) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < longitud; i++) {
+        crc = (crc << 4) ^ TABLA_CRC16[((crc >> 12) ^ (datos[i] >> 4)) & 0x0F];
+        crc = (crc << 4) ^ TABLA_CRC16[((crc >> 12) ^ (datos[i] & 0x0F)) & 0x0F];
+    }
+    return crc;
+}
+
+// Identificar el tipo de trama por su cabecera
+uint8_t tipoTrama(const uint8_t* datos, size_t longitud) {
+    if (longitud < sizeof(CabeceraTrama)) return TRAMA_INVALIDA;
+    if (datos[1] != PROTOCOLO_VERSION) return TRAMA_INVALIDA;
+    return datos[0];
+}
+
+// Texto del estado → código
+uint8_t codigoMovimiento(const char* estado) {
+    if (strcmp(estado, "AVANZANDO") == 0) return MOV_AVANZANDO;
+    if (strcmp(estado, "RETROCEDIENDO") == 0) return MOV_RETROCEDIENDO;
+    return MOV_PARADO;
+}
+
+// Código → texto del estado
+const char* textoMovimiento(uint8_t codigo) {
+    switch (codigo) {
+        case MOV_AVANZANDO: return "AVANZANDO";
+        case MOV_RETROCEDIENDO: return "RETROCEDIENDO";
+        default: return "PARADO";
+    }
+}
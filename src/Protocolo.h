@@ -0,0 +1,150 @@
+#ifndef PROTOCOLO_H
+#define PROTOCOLO_H
+
+#include <Arduino.h>
+
+// Protocolo binario de las tramas ESP-NOW entre coches.
+// Todas las tramas empiezan por la misma cabecera empaquetada y terminan en
+// un CRC-16/CCITT, de modo que el tipo se identifica por etiqueta y no por
+// tamaño. Los valores reales viajan en punto fijo y los estados como códigos.
+
+#define PROTOCOLO_VERSION 4
+
+// Tipos de trama (primer byte de la cabecera)
+enum TipoTrama : uint8_t {
+    TRAMA_INVALIDA = 0,
+    TRAMA_COMANDO = 1,    // Maestro → esclavo: velocidades y sensores
+    TRAMA_CONTROL = 2,    // Cualquiera: órdenes de control (cambio de modo)
+    TRAMA_RESPUESTA = 3,  // Esclavo → maestro: sensores del esclavo
+    TRAMA_SINCRONIA = 4   // Esclavo ↔ maestro: intercambio de marcas para el reloj común
+};
+
+// Estado de movimiento codificado
+enum CodigoMovimiento : uint8_t {
+    MOV_PARADO = 0,
+    MOV_AVANZANDO = 1,
+    MOV_RETROCEDIENDO = 2
+};
+
+// Órdenes de control
+enum CodigoControl : uint8_t {
+    CTRL_CAMBIAR_MODO = 1  // argumento: RolCoche destino
+};
+
+// Rol del coche dentro del par
+enum RolCoche : uint8_t {
+    ROL_MAESTRO = 0,
+    ROL_ESCLAVO = 1
+};
+
+// Banderas de sensores
+#define BANDERA_SENSORES 0x01  // El emisor tiene sensores físicos
+#define BANDERA_LUZ      0x02  // Lectura del LM393 (1 = claro)
+#define BANDERA_SIN_TEMPERATURA 0x04  // Sin LM35: la temperatura no es válida
+#define BANDERA_SINCRONIA 0x08  // Respuesta que pide sincronía al maestro
+
+// Número de secuencia: cada emisor numera aparte sus tramas de difusión y
+// las que manda a cada par, y marca las de difusión con el bit alto. Así el
+// receptor solo ve huecos en lo que iba dirigido a él.
+#define SECUENCIA_DIFUSION 0x8000
+#define SECUENCIA_NUMERO   0x7FFF
+
+// Cabecera común (8 bytes)
+struct __attribute__((packed)) CabeceraTrama {
+    uint8_t tipo;          // TipoTrama
+    uint8_t version;       // PROTOCOLO_VERSION
+    uint16_t secuencia;    // Número de secuencia del emisor (SECUENCIA_*)
+    uint32_t marcaTiempo;  // micros() del emisor al sellar la trama
+};
+
+// Comando de movimiento (22 bytes, antes 40)
+struct __attribute__((packed)) TramaComando {
+    static const uint8_t TIPO = TRAMA_COMANDO;
+    CabeceraTrama cabecera;
+    int16_t velocidadIzq;  // -255 a 255
+    int16_t velocidadDer;  // -255 a 255
+    uint8_t movimiento;    // CodigoMovimiento
+    uint8_t banderas;      // BANDERA_*
+    int16_t temperatura;   // Centésimas de grado Celsius
+    uint32_t aplicarEn;    // micros() del maestro en que aplica esta orden (0 = al llegar)
+    uint16_t crc;
+};
+
+// Orden de control (12 bytes, antes 40)
+struct __attribute__((packed)) TramaControl {
+    static const uint8_t TIPO = TRAMA_CONTROL;
+    CabeceraTrama cabecera;
+    uint8_t codigo;        // CodigoControl
+    uint8_t argumento;     // Depende del código
+    uint16_t crc;
+};
+
+// Respuesta con sensores y eco de latencia (22 bytes, antes 32)
+struct __attribute__((packed)) TramaRespuesta {
+    static const uint8_t TIPO = TRAMA_RESPUESTA;
+    CabeceraTrama cabecera;
+    uint8_t origen;        // RolCoche del emisor
+    uint8_t banderas;      // BANDERA_*
+    int16_t temperatura;   // Centésimas de grado Celsius
+    uint32_t marcaEco;     // marcaTiempo del último comando recibido (0 = ninguno)
+    uint32_t retenidoUs;   // Tiempo entre recibir ese comando y enviar esta respuesta
+    uint16_t crc;
+};
+
+// Sincronía del maestro a una respuesta con BANDERA_SINCRONIA (18 bytes).
+// La petición sale en t1 (su marcaTiempo, reloj del esclavo) y llega en t2;
+// esta trama sale en t3 (su marcaTiempo, reloj del maestro) y llega en t4.
+struct __attribute__((packed)) TramaSincronia {
+    static const uint8_t TIPO = TRAMA_SINCRONIA;
+    CabeceraTrama cabecera;
+    uint32_t marcaEco;     // t1
+    uint32_t recepcionEco; // t2
+    uint16_t crc;
+};
+
+// CRC-16/CCITT-FALSE (polinomio 0x1021, valor inicial 0xFFFF)
+uint16_t calcularCRC16(const uint8_t* datos, size_t longitud);
+
+// Tipo de una trama recibida, o TRAMA_INVALIDA si no es de este protocolo
+uint8_t tipoTrama(const uint8_t* datos, size_t longitud);
+
+// Rellenar cabecera y CRC de una trama lista para enviar
+template <typename T>
+void sellarTrama(T& trama, uint16_t secuencia, uint32_t marcaTiempo) {
+    trama.cabecera.tipo = T::TIPO;
+    trama.cabecera.version = PROTOCOLO_VERSION;
+    trama.cabecera.secuencia = secuencia;
+    trama.cabecera.marcaTiempo = marcaTiempo;
+    trama.crc = calcularCRC16((const uint8_t*)&trama, sizeof(T) - sizeof(trama.crc));
+}
+
+// Vista sin copia sobre el buffer recibido; nullptr si tamaño, tipo,
+// versión o CRC no cuadran. Las estructuras están empaquetadas (alineación 1).
+template <typename T>
+const T* verTrama(const uint8_t* datos, size_t longitud) {
+    if (longitud != sizeof(T)) return nullptr;
+    const T* trama = reinterpret_cast<const T*>(datos);
+    if (trama->cabecera.tipo != T::TIPO || trama->cabecera.version != PROTOCOLO_VERSION) {
+        return nullptr;
+    }
+    if (calcularCRC16(datos, sizeof(T) - sizeof(trama->crc)) != trama->crc) return nullptr;
+    return trama;
+}
+
+// Conversión de punto fijo (centésimas)
+inline int16_t aCentesimas(float valor) {
+    float escalado = valor * 100.0f;
+    if (escalado > 32767.0f) return 32767;
+    if (escalado < -32768.0f) return -32768;
+    return (int16_t)(escalado < 0 ? escalado - 0.5f : escalado + 0.5f);
+}
+
+inline float deCentesimas(int16_t valor) {
+    return valor / 100.0f;
+}
+
+// Conversión entre código de movimiento y texto del estado
+uint8_t codigoMovimiento(const char* estado);
+const char* textoMovimiento(uint8_t codigo);
+
+#endif
@@ -0,0 +1,183 @@
+#include "RampaMotor.h"
+
+// Paso máximo de tiempo por llamada: tras una pausa larga no dar un salto
+#define RAMPA_DT_MAX_US 50000UL
+
+// Constructor
+RampaMotor::RampaMotor() {
+    configurar(210, 100000, 2000, 20000);  // Impulso como el antiguo delay(100)
+    objetivo = 0;
+    salidaQ8 = 0;
+    tasaQ8 = 0;
+    frenando = false;
+    impulso = false;
+    inicioImpulso = 0;
+    ultimaMarca = 0;
+    hayMarca = false;
+    impulsos = 0;
+}
+
+// Configurar impulso de arranque, pendiente y tirón
+void RampaMotor::configurar(int16_t nuevoImpulso, unsigned long nuevaDuracionUs,
+                            uint16_t pendienteMax, uint32_t tironMax) {
+    pwmImpulso = constrain(nuevoImpulso, 0, 255);
+    duracionImpulsoUs = nuevaDuracionUs;
+    pendienteMaxQ8 = (int32_t)pendienteMax * 256;
+    tironMaxQ8 = tironMax > 8000000UL ? INT32_MAX : (int32_t)(tironMax * 256);
+}
+
+void RampaMotor::setObjetivo(int16_t pwm) {
+    pwm = constrain(pwm, -255, 255);
+    if (pwm != objetivo) frenando = false;  // La frenada era hacia el objetivo anterior
+    objetivo = pwm;
+}
+
+// Parada inmediata (seguridad): sin rampa ni impulso
+void RampaMotor::detener() {
+    objetivo = 0;
+    salidaQ8 = 0;
+    tasaQ8 = 0;
+    frenando = false;
+    impulso = false;
+}
+
+// Avanzar el perfil el tiempo transcurrido desde la última llamada
+int16_t RampaMotor::avanzar(unsigned long ahoraUs) {
+    unsigned long dt = hayMarca ? ahoraUs - ultimaMarca : 0;
+    if (dt > RAMPA_DT_MAX_US) dt = RAMPA_DT_MAX_US;
+    ultimaMarca = ahoraUs;
+    hayMarca = true;
+
+    int32_t objetivoQ8 = (int32_t)objetivo * 256;
+
+    // Impulso en curso: se mantiene salvo que el objetivo pase a cero o cambie
+    // de sentido. Al acabar, la rampa sigue desde el valor del impulso (también
+    // hacia cero: cortarlo de golpe sería un salto como el que evita la rampa)
+    if (impulso) {
+        bool mismoSentido = (objetivo > 0 && salidaQ8 > 0) || (objetivo < 0 && salidaQ8 < 0);
+        if (mismoSentido && ahoraUs - inicioImpulso < duracionImpulsoUs) {
+            return obtenerSalida();
+        }
+        impulso = false;
+    }
+
+    // Arranque desde parado: impulso
+    if (salidaQ8 == 0 && objetivo != 0 && pwmImpulso > 0 && duracionImpulsoUs > 0) {
+        impulso = true;
+        inicioImpulso = ahoraUs;
+        salidaQ8 = (objetivo > 0 ? pwmImpulso : -pwmImpulso) * 256;
+        tasaQ8 = 0;
+        impulsos++;
+        return obtenerSalida();
+    }
+
+    int32_t error = objetivoQ8 - salidaQ8;
+    // En el objetivo; si se pasa por él con pendiente (no daba tiempo a
+    // frenar), el tirón limitado la lleva a cero
+    if (error == 0 && (tasaQ8 == 0 || tironMaxQ8 == 0)) {
+        tasaQ8 = 0;
+        return obtenerSalida();
+    }
+
+    // Sin límite de pendiente: aplicar el objetivo directamente
+    if (pendienteMaxQ8 == 0) {
+        salidaQ8 = objetivoQ8;
+        tasaQ8 = 0;
+        return obtenerSalida();
+    }
+
+    // Pendiente deseada; con tirón limitado la pendiente cambia poco a poco,
+    // también al frenar, así que la frenada empieza antes de llegar
+    int32_t tasaDeseada = error > 0 ? pendienteMaxQ8 : (error < 0 ? -pendienteMaxQ8 : 0);
+    bool sePasa = false;  // El objetivo está más cerca de lo que se tarda en frenar
+    if (tironMaxQ8 > 0) {
+        int64_t cambioMax = ((int64_t)tironMaxQ8 * (int64_t)dt) / 1000000;
+        if (cambioMax < 1) cambioMax = 1;
+        bool acercandose = (tasaQ8 > 0 && error > 0) || (tasaQ8 < 0 && error < 0);
+        if (!acercandose) frenando = false;
+        if (acercandose) {
+            // Hasta el objetivo, o hasta cero si hay que cambiar de sentido
+            bool cruzaCero = (salidaQ8 > 0 && objetivoQ8 < 0) || (salidaQ8 < 0 && objetivoQ8 > 0);
+            int64_t distancia = cruzaCero ? salidaQ8 : error;
+            if (distancia < 0) distancia = -distancia;
+            int64_t tasa = tasaQ8 > 0 ? tasaQ8 : -tasaQ8;
+            // Frenar cuando lo que falta es lo que se recorre frenando con el
+            // tirón máximo, tasa²/(2·tirón), más el tramo de este paso; con la
+            // tasa que habría tras acelerar en él, para no empezar tarde
+            if (!frenando) {
+                int64_t siguiente = tasa + cambioMax;
+                if (siguiente > pendienteMaxQ8) siguiente = pendienteMaxQ8;
+                frenando = distancia <= siguiente * siguiente / (2 * (int64_t)tironMaxQ8) +
+                                        siguiente * (int64_t)dt / 1000000;
+            }
+            // Ya frenando, la deceleración justa para pararse en el objetivo
+            // (tasa²/(2·distancia), nunca más que el tirón): sin alternar
+            // acelerar y frenar. Sin bajar de la pendiente de un paso de tirón,
+            // para no quedarse a las puertas, y el último tramo a la medida
+            if (frenando) {
+                int64_t deceleracion = tasa * tasa / (2 * distancia);
+                if (deceleracion > 2 * (int64_t)tironMaxQ8) sePasa = true;
+                if (deceleracion > tironMaxQ8) deceleracion = tironMaxQ8;
+                int64_t minima = cambioMax;
+                int64_t nueva = tasa - deceleracion * (int64_t)dt / 1000000;
+                if (nueva < minima) nueva = minima;
+                if (distancia * 1000000 <= minima * (int64_t)dt) {
+                    nueva = (distancia * 1000000 + (int64_t)dt - 1) / (int64_t)dt;
+                }
+                tasaDeseada = (int32_t)(tasaQ8 > 0 ? nueva : -nueva);
+            }
+        }
+        int64_t diferencia = (int64_t)tasaDeseada - tasaQ8;
+        if (diferencia > cambioMax) diferencia = cambioMax;
+        if (diferencia < -cambioMax) diferencia = -cambioMax;
+        tasaQ8 += (int32_t)diferencia;
+    } else {
+        tasaQ8 = tasaDeseada;
+    }
+
+    int64_t paso = ((int64_t)tasaQ8 * (int64_t)dt) / 1000000;
+    bool llega = (error > 0 && paso >= error) || (error < 0 && paso <= error);
+    if (llega && !sePasa) {
+        // Llegada: sin pasarse. La pendiente queda en la de este último
+        // tramo y pasa a cero en el siguiente. Si no da tiempo a frenar
+        // (objetivo cambiado muy cerca) se pasa y vuelve con el tirón limitado
+        salidaQ8 = objetivoQ8;
+        tasaQ8 = (int32_t)(((int64_t)error * 1000000) / (int64_t)dt);
+    } else {
+        int32_t nueva = salidaQ8 + (int32_t)paso;
+        // Al cruzar cero, pararse en cero para rearrancar con impulso
+        if ((salidaQ8 > 0 && nueva < 0) || (salidaQ8 < 0 && nueva > 0)) {
+            nueva = 0;
+            tasaQ8 = (int32_t)(((int64_t)-salidaQ8 * 1000000) / (int64_t)dt);
+        }
+        // Al pasarse no salir del rango del PWM
+        if (nueva > 255 * 256 || nueva < -255 * 256) {
+            nueva = nueva > 0 ? 255 * 256 : -255 * 256;
+            tasaQ8 = 0;
+        }
+        if (nueva == 0) frenando = false;  // La frenada era hasta cero; ahora hacia el objetivo
+        salidaQ8 = nueva;
+    }
+    return obtenerSalida();
+}
+
+// Salida actual redondeada a PWM entero
+int16_t RampaMotor::obtenerSalida() {
+    return (int16_t)((salidaQ8 + (salidaQ8 >= 0 ? 128 : -128)) / 256);
+}
+
+int16_t RampaMotor::obtenerObjetivo() {
+    return objetivo;
+}
+
+int32_t RampaMotor::obtenerPendiente() {
+    return tasaQ8 / 256;
+}
+
+bool RampaMotor::enImpulso() {
+    return impulso;
+}
+
+unsigned long RampaMotor::obtenerImpulsos() {
+    return impulsos;
+}
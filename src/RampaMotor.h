@@ -0,0 +1,53 @@
+#ifndef RAMPA_MOTOR_H
+#define RAMPA_MOTOR_H
+
+#include <Arduino.h>
+
+// Perfil de salida de una rueda, sin esperas.
+// Al arrancar desde parado se da un impulso de PWM durante un tiempo fijo para
+// vencer la fricción estática; después la salida va hacia el objetivo con la
+// pendiente (PWM/s) y el tirón (PWM/s²) limitados. La frenada también respeta
+// el tirón: empieza cuando lo que falta es tasa²/(2·tirón), así que la salida
+// llega al objetivo con la pendiente ya casi a cero. avanzar() se llama a
+// menudo (cada pocos ms) y cada llamada hace solo el tramo correspondiente al
+// tiempo transcurrido. Los cambios de sentido pasan por cero y vuelven a
+// arrancar con impulso.
+class RampaMotor {
+public:
+    RampaMotor();
+
+    // pwmImpulso = 0 o duracionImpulsoUs = 0 desactivan el impulso;
+    // pendienteMax = 0 aplica el objetivo de golpe; tironMax = 0 sin límite de tirón
+    void configurar(int16_t pwmImpulso, unsigned long duracionImpulsoUs,
+                    uint16_t pendienteMax, uint32_t tironMax);
+
+    void setObjetivo(int16_t pwm);  // -255 a 255
+    void detener();                 // Salida a cero inmediatamente
+
+    // Avanzar el perfil hasta ahoraUs y devolver la salida
+    int16_t avanzar(unsigned long ahoraUs);
+
+    int16_t obtenerSalida();
+    int16_t obtenerObjetivo();
+    int32_t obtenerPendiente();       // PWM/s de la rampa en este momento
+    bool enImpulso();
+    unsigned long obtenerImpulsos();  // Arranques con impulso
+
+private:
+    int16_t pwmImpulso;
+    unsigned long duracionImpulsoUs;
+    int32_t pendienteMaxQ8;  // PWM·256 por segundo
+    int32_t tironMaxQ8;      // PWM·256 por segundo²
+
+    int16_t objetivo;
+    int32_t salidaQ8;        // PWM·256
+    int32_t tasaQ8;          // Pendiente actual, PWM·256 por segundo
+    bool frenando;           // Frenada hacia el objetivo en curso
+    bool impulso;
+    unsigned long inicioImpulso;
+    unsigned long ultimaMarca;
+    bool hayMarca;
+    unsigned long impulsos;
+};
+
+#endif
@@ -0,0 +1,134 @@
+#include "RegistroTraza.h"
+#include <new>
+
+static const uint8_t CABECERA_FICHERO[TRAZA_TAM_CABECERA_FICHERO] = {'C', 'T', 'R', 'Z', TRAZA_VERSION, 0, 0, 0};
+
+// Constructor
+RegistroTraza::RegistroTraza() {
+    memoria = nullptr;
+    tam = 0;
+    inicio = 0;
+    usados = 0;
+    registrando = false;
+    cabeceraEscrita = false;
+    eventos = 0;
+    perdidos = 0;
+}
+
+RegistroTraza::~RegistroTraza() {
+    delete[] memoria;
+}
+
+// El anillo se reserva solo la primera vez; llamadas posteriores lo vacían
+bool RegistroTraza::iniciar(size_t bytes) {
+    if (memoria == nullptr) {
+        memoria = new (std::nothrow) uint8_t[bytes];
+        if (memoria == nullptr) return false;
+        tam = bytes;
+    }
+    inicio = 0;
+    usados = 0;
+    eventos = 0;
+    perdidos = 0;
+    cabeceraEscrita = false;
+    registrando = true;
+    return true;
+}
+
+void RegistroTraza::detener() {
+    registrando = false;
+}
+
+void RegistroTraza::registrar(uint8_t tipo, unsigned long marca, const void* datos, uint8_t longitud) {
+    registrar(tipo, marca, datos, longitud, nullptr, 0);
+}
+
+// El evento entra entero o no entra: el lector nunca ve uno a medias
+void RegistroTraza::registrar(uint8_t tipo, unsigned long marca, const void* parte1, uint8_t longitud1,
+                              const void* parte2, uint8_t longitud2) {
+    if (!activa()) return;
+
+    size_t longitud = longitud1 + longitud2;
+    if (longitud > 255 || sizeof(CabeceraEventoTraza) + longitud > tam - usados) {
+        perdidos++;
+        return;
+    }
+
+    CabeceraEventoTraza cabecera;
+    cabecera.tipo = tipo;
+    cabecera.longitud = longitud;
+    cabecera.marca = marca;
+    copiar(&cabecera, sizeof(cabecera));
+    if (longitud1 > 0) copiar(parte1, longitud1);
+    if (longitud2 > 0) copiar(parte2, longitud2);
+    eventos++;
+}
+
+// Copiar al final del anillo, partiendo en dos si da la vuelta
+void RegistroTraza::copiar(const void* origen, size_t longitud) {
+    size_t fin = (inicio + usados) % tam;
+    size_t primero = tam - fin;
+    if (primero > longitud) primero = longitud;
+    memcpy(memoria + fin, origen, primero);
+    memcpy(memoria, (const uint8_t*)origen + primero, longitud - primero);
+    usados += longitud;
+}
+
+size_t RegistroTraza::volcar(Print& destino) {
+    if (memoria == nullptr) return 0;
+
+    size_t escritos = 0;
+    if (!cabeceraEscrita) {
+        escritos += destino.write(CABECERA_FICHERO, sizeof(CABECERA_FICHERO));
+        cabeceraEscrita = true;
+    }
+
+    // Lo pendiente ocupa uno o dos tramos contiguos
+    while (usados > 0) {
+        size_t tramo = tam - inicio;
+        if (tramo > usados) tramo = usados;
+        size_t n = destino.write(memoria + inicio, tramo);
+        inicio = (inicio + n) % tam;
+        usados -= n;
+        escritos += n;
+        if (n < tramo) break;  // Salida llena: lo que queda, en el siguiente volcado
+    }
+    return escritos;
+}
+
+size_t RegistroTraza::pendientes() {
+    return usados;
+}
+
+size_t RegistroTraza::capacidad() {
+    return tam;
+}
+
+unsigned long RegistroTraza::obtenerEventos() {
+    return eventos;
+}
+
+unsigned long RegistroTraza::obtenerPerdidos() {
+    return perdidos;
+}
+
+bool RegistroTraza::leerEvento(const uint8_t* datos, size_t tam, size_t& pos, EventoTraza& evento) {
+    if (pos + sizeof(CabeceraEventoTraza) > tam) return false;
+
+    CabeceraEventoTraza cabecera;
+    memcpy(&cabecera, datos + pos, sizeof(cabecera));
+    if (pos + sizeof(cabecera) + cabecera.longitud > tam) return false;
+
+    evento.tipo = cabecera.tipo;
+    evento.longitud = cabecera.longitud;
+    evento.marca = cabecera.marca;
+    evento.datos = datos + pos + sizeof(cabecera);
+    pos += sizeof(cabecera) + cabecera.longitud;
+    return true;
+}
+
+size_t RegistroTraza::leerCabecera(const uint8_t* datos, size_t tam) {
+    if (tam < sizeof(CABECERA_FICHERO)) return 0;
+    if (memcmp(datos, CABECERA_FICHERO, 5) != 0) return 0;
+    return sizeof(CABECERA_FICHERO);
+}
@@ -0,0 +1,150 @@
+#ifndef REGISTRO_TRAZA_H
+#define REGISTRO_TRAZA_H
+
+#include <Arduino.h>
+
+// Traza binaria de lo que entra y sale del coche, para reproducirla después.
+// Cada evento es una cabecera fija (tipo, longitud, micros()) seguida de su
+// carga; se copian a un anillo en RAM desde loop() y se vuelcan por tramos a
+// cualquier salida (LittleFS en el coche, un fichero en Linux). Si el anillo
+// se llena, los eventos nuevos se descartan y se cuentan: la traza nunca
+// bloquea el control. El formato del fichero es una cabecera de 8 bytes
+// ("CTRZ", versión y 3 bytes a cero) y los eventos uno detrás de otro.
+
+#define TRAZA_VERSION 4
+#define TRAZA_TAM_CABECERA_FICHERO 8
+
+// Tipos de evento
+enum TipoEventoTraza : uint8_t {
+    TRAZA_INICIO = 1,       // EventoTrazaInicio: configuración al empezar
+    TRAZA_MODO = 2,         // EventoTrazaModo: cambio local de rol o de automático
+    TRAZA_DISTANCIA = 3,    // EventoTrazaDistancia: ciclo del HC-SR04 terminado
+    TRAZA_LUZ = 4,          // int8_t: lectura del LM393
+    TRAZA_TEMPERATURA = 5,  // int16_t: lectura del ADC del LM35
+    TRAZA_RX = 6,           // EventoTrazaRX + trama: procesada en loop()
+    TRAZA_TX = 7,           // mac[6] + trama: encolada para enviar
+    TRAZA_ACK = 8,          // EventoTrazaACK: resultado de envío procesado
+    TRAZA_CONTROL = 9,      // Sin carga: paso del PID
+    TRAZA_MOTOR = 10,       // EventoTrazaMotor: orden a los motores
+    TRAZA_MANDO = 11,       // Sin carga: orden del esclavo sin comandos del maestro
+    TRAZA_SEGUIMIENTO = 12, // Sin carga: paso del control del esclavo sobre el hueco fusionado
+    TRAZA_PROGRAMADA = 13   // Sin carga: órdenes programadas que llegaron a su instante
+};
+
+// Cabecera de cada evento (6 bytes)
+struct __attribute__((packed)) CabeceraEventoTraza {
+    uint8_t tipo;        // TipoEventoTraza
+    uint8_t longitud;    // Bytes de carga tras la cabecera
+    uint32_t marca;      // micros() al registrarlo
+};
+
+struct __attribute__((packed)) EventoTrazaInicio {
+    uint8_t maestro;
+    uint8_t automatico;
+    uint8_t sensoresLocales;
+    uint8_t planificador;     // 1 si las tareas corren con el planificador
+    float distanciaMin;
+    float distanciaMax;
+    float kp, ki, kd, kff;
+    int16_t pwmMinimo;
+    uint8_t modoFiltro;       // FiltroDistancia::Modo
+    uint8_t ventanaFiltro;
+    uint32_t horizonteMando;  // us, ExtrapoladorMando
+    uint32_t presupuestoMando;
+    uint32_t decaimientoMando;
+    uint8_t fusion;           // Control propio del esclavo (FusionHueco)
+    float gananciaFusion;     // cm/s por PWM
+    int16_t bandaFusion;
+    uint32_t constanteFusion; // us
+    uint32_t periodoSincronia;  // us entre intercambios de sincronía
+    uint32_t retardoAplicacion; // us, órdenes programadas del maestro
+};
+
+// Qué llamada cambió el modo
+enum OrigenModoTraza : uint8_t {
+    TRAZA_MODO_ROL = 0,         // cambiarModo()
+    TRAZA_MODO_AUTOMATICO = 1   // setModoAutomatico()
+};
+
+struct __attribute__((packed)) EventoTrazaModo {
+    uint8_t origen;           // OrigenModoTraza
+    uint8_t maestro;
+    uint8_t automatico;
+};
+
+struct __attribute__((packed)) EventoTrazaDistancia {
+    uint8_t valida;
+    float distancia;          // cm, tal como la dio el medidor
+    uint32_t marcaMuestra;    // micros() al final del eco
+};
+
+struct __attribute__((packed)) EventoTrazaRX {
+    uint32_t marcaRecepcion;  // micros() en el callback
+    uint8_t mac[6];
+};
+
+struct __attribute__((packed)) EventoTrazaACK {
+    uint8_t exitoso;
+    uint32_t marcaResultado;  // micros() en el callback
+};
+
+struct __attribute__((packed)) EventoTrazaMotor {
+    int16_t izquierdo;
+    int16_t derecho;
+    uint8_t parada;           // 1 = detener inmediato (sin rampa)
+};
+
+// Evento leído de una traza: la carga apunta dentro del buffer leído
+struct EventoTraza {
+    uint8_t tipo;
+    uint8_t longitud;
+    uint32_t marca;
+    const uint8_t* datos;
+};
+
+class RegistroTraza {
+public:
+    RegistroTraza();
+    ~RegistroTraza();
+
+    // Reservar el anillo (una vez) y empezar a registrar; false si no hay memoria
+    bool iniciar(size_t tam);
+    void detener();  // Deja de registrar; lo pendiente se puede volcar aún
+    bool activa() { return memoria != nullptr && registrando; }
+
+    // Registrar un evento con su carga en una o dos partes (p. ej. cabecera
+    // de recepción + trama). Descarta el evento si no cabe.
+    void registrar(uint8_t tipo, unsigned long marca, const void* datos, uint8_t longitud);
+    void registrar(uint8_t tipo, unsigned long marca, const void* parte1, uint8_t longitud1,
+                   const void* parte2, uint8_t longitud2);
+
+    // Escribir lo pendiente (precedido de la cabecera de fichero la primera
+    // vez tras iniciar()) y liberarlo. Devuelve los bytes escritos.
+    size_t volcar(Print& destino);
+
+    size_t pendientes();
+    size_t capacidad();
+    unsigned long obtenerEventos();    // Registrados desde iniciar()
+    unsigned long obtenerPerdidos();   // Descartados por anillo lleno
+
+    // Leer el evento en pos de una traza ya cargada en memoria (sin la
+    // cabecera de fichero) y avanzar pos. false al final o si está truncada.
+    static bool leerEvento(const uint8_t* datos, size_t tam, size_t& pos, EventoTraza& evento);
+
+    // Comprobar la cabecera de fichero; devuelve su tamaño o 0 si no es una traza
+    static size_t leerCabecera(const uint8_t* datos, size_t tam);
+
+private:
+    uint8_t* memoria;
+    size_t tam;
+    size_t inicio;   // Primer byte pendiente
+    size_t usados;   // Bytes pendientes
+    bool registrando;
+    bool cabeceraEscrita;
+    unsigned long eventos;
+    unsigned long perdidos;
+
+    void copiar(const void* origen, size_t longitud);
+};
+
+#endif
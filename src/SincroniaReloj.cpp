@@ -0,0 +1,198 @@
+#include "SincroniaReloj.h"
+
+// Varianza de medida con el RTT mínimo (us², jitter de la radio y del
+// callback) y de proceso: ruido de fase (us²/s) y paseo de la deriva del
+// cristal (ppm²/s, temperatura)
+static const float RUIDO_MEDIDA = 2500.0;
+static const float RUIDO_FASE = 10.0;
+static const float RUIDO_DERIVA = 0.01;
+
+// Incertidumbre inicial de la deriva: un cristal corriente está a ±100 ppm
+static const float VARIANZA_DERIVA_INICIAL = 10000.0;
+
+// RTT por encima del cual el intercambio no sirve (colas, reintentos)
+static const unsigned long RTT_MAXIMO_US = 50000;
+
+// Intercambios aceptados antes de dar el reloj por bueno, y tiempo sin
+// ninguno tras el que deja de serlo
+static const uint8_t INTERCAMBIOS_MINIMOS = 4;
+static const unsigned long CADUCIDAD_US = 10000000;
+
+// Rechazos consecutivos tras los que se asume un salto real del reloj
+static const uint8_t RECHAZOS_PARA_REINICIAR = 3;
+
+// Residuo a partir del cual se pasa a la base
+static const float RESIDUO_MAXIMO = 1000.0;
+
+// Constructor
+SincroniaReloj::SincroniaReloj() {
+    intercambios = 0;
+    rechazos = 0;
+    reiniciar();
+}
+
+// Sin estimación ni historial de RTT
+void SincroniaReloj::reiniciar() {
+    base = 0;
+    residuo = 0;
+    deriva = 0;
+    p00 = p01 = p11 = 0;
+    marca = 0;
+    marcaIntercambio = 0;
+    hayEstimacion = false;
+    aceptados = 0;
+    rechazosSeguidos = 0;
+    cabezaRTT = 0;
+    cantidadRTT = 0;
+}
+
+unsigned long SincroniaReloj::rttMinimo() {
+    unsigned long minimo = RTT_MAXIMO_US;
+    for (uint8_t i = 0; i < cantidadRTT; i++) {
+        if (rtts[i] < minimo) minimo = rtts[i];
+    }
+    return minimo;
+}
+
+// Llevar desfase y deriva hasta hastaUs
+void SincroniaReloj::predecir(unsigned long hastaUs) {
+    if ((long)(hastaUs - marca) <= 0) return;
+    float dt = (hastaUs - marca) / 1000000.0;
+    marca = hastaUs;
+
+    residuo += deriva * dt;
+    p00 += 2 * dt * p01 + dt * dt * p11 + RUIDO_FASE * dt;
+    p01 += dt * p11;
+    p11 += RUIDO_DERIVA * dt;
+}
+
+// Arrancar en una medida, sin saber nada de la deriva
+void SincroniaReloj::iniciar(uint32_t desfase, unsigned long marcaUs, float ruido) {
+    base = desfase;
+    residuo = 0;
+    deriva = 0;
+    p00 = ruido;
+    p01 = 0;
+    p11 = VARIANZA_DERIVA_INICIAL;
+    marca = marcaUs;
+    marcaIntercambio = marcaUs;
+    hayEstimacion = true;
+    aceptados = 1;
+    rechazosSeguidos = 0;
+}
+
+// Corregir la estimación con un intercambio
+bool SincroniaReloj::agregarIntercambio(uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4) {
+    long rtt = (long)(int32_t)((t4 - t1) - (t3 - t2));
+    if (rtt < 0 || (unsigned long)rtt > RTT_MAXIMO_US) {
+        rechazos++;
+        return false;
+    }
+    rtts[cabezaRTT] = rtt;
+    cabezaRTT = (cabezaRTT + 1) % HISTORIAL_RTT;
+    if (cantidadRTT < HISTORIAL_RTT) cantidadRTT++;
+
+    // Desfase en aritmética módulo 2^32 (los dos relojes dan la vuelta) y
+    // referido a la mitad del intercambio en el reloj propio
+    uint32_t ida = t2 - t1;
+    uint32_t vuelta = t3 - t4;
+    uint32_t desfase = vuelta + (uint32_t)((int32_t)(ida - vuelta) / 2);
+    unsigned long mitad = t1 + (uint32_t)(t4 - t1) / 2;
+    float asimetria = (rtt - (long)rttMinimo()) / 2.0;
+    float ruido = RUIDO_MEDIDA + asimetria * asimetria;
+
+    if (!hayEstimacion) {
+        iniciar(desfase, mitad, ruido);
+        intercambios++;
+        return true;
+    }
+    predecir(mitad);
+
+    // Innovación y puerta de validación
+    float innovacion = (float)(int32_t)(desfase - base) - residuo;
+    float s = p00 + ruido;
+    if (innovacion * innovacion > 9.0 * s) {
+        rechazos++;
+        rechazosSeguidos++;
+        if (rechazosSeguidos >= RECHAZOS_PARA_REINICIAR) {
+            iniciar(desfase, mitad, ruido);
+            intercambios++;
+            return true;
+        }
+        return false;
+    }
+    rechazosSeguidos = 0;
+
+    // Corrección
+    float k0 = p00 / s;
+    float k1 = p01 / s;
+    residuo += k0 * innovacion;
+    deriva += k1 * innovacion;
+    p11 -= k1 * p01;
+    p01 -= k0 * p01;
+    p00 -= k0 * p00;
+
+    // La parte entera del residuo pasa a la base
+    if (residuo > RESIDUO_MAXIMO || residuo < -RESIDUO_MAXIMO) {
+        int32_t entero = (int32_t)residuo;
+        base += entero;
+        residuo -= entero;
+    }
+
+    marcaIntercambio = mitad;
+    if (aceptados < INTERCAMBIOS_MINIMOS) aceptados++;
+    intercambios++;
+    return true;
+}
+
+bool SincroniaReloj::sincronizado(unsigned long ahoraUs) {
+    return hayEstimacion && aceptados >= INTERCAMBIOS_MINIMOS && ahoraUs - marcaIntercambio < CADUCIDAD_US;
+}
+
+// Residuo del desfase en un instante propio, con la deriva estimada
+float SincroniaReloj::desfaseEn(unsigned long localUs) {
+    return residuo + deriva * ((long)(localUs - marca) / 1000000.0);
+}
+
+static int32_t redondear(float valor) {
+    return (int32_t)(valor < 0 ? valor - 0.5f : valor + 0.5f);
+}
+
+uint32_t SincroniaReloj::aReferencia(unsigned long localUs) {
+    return (uint32_t)localUs + base + redondear(desfaseEn(localUs));
+}
+
+// El desfase se evalúa en el instante propio aproximado (la deriva cambia
+// menos de 1 us por cada 10 ms de error a 100 ppm)
+unsigned long SincroniaReloj::aLocal(uint32_t referenciaUs) {
+    uint32_t aproximado = referenciaUs - base - redondear(residuo);
+    return (uint32_t)(referenciaUs - base - redondear(desfaseEn(aproximado)));
+}
+
+long SincroniaReloj::obtenerDesfase(unsigned long ahoraUs) {
+    if (!hayEstimacion) return 0;
+    return (int32_t)(aReferencia(ahoraUs) - (uint32_t)ahoraUs);
+}
+
+float SincroniaReloj::obtenerDeriva() {
+    return deriva;
+}
+
+float SincroniaReloj::obtenerError(unsigned long ahoraUs) {
+    if (!hayEstimacion) return 0;
+    float dt = (long)(ahoraUs - marca) / 1000000.0;
+    if (dt < 0) dt = 0;
+    return sqrtf(p00 + 2 * dt * p01 + dt * dt * p11 + RUIDO_FASE * dt);
+}
+
+unsigned long SincroniaReloj::obtenerRTT() {
+    return cantidadRTT > 0 ? rttMinimo() : 0;
+}
+
+unsigned long SincroniaReloj::obtenerIntercambios() {
+    return intercambios;
+}
+
+unsigned long SincroniaReloj::obtenerRechazos() {
+    return rechazos;
+}
@@ -0,0 +1,66 @@
+#ifndef SINCRONIA_RELOJ_H
+#define SINCRONIA_RELOJ_H
+
+#include <Arduino.h>
+
+// Reloj del maestro visto desde el esclavo (base de tiempo común de la flota).
+// Cada intercambio de sincronía da cuatro marcas, como en NTP: t1 sale la
+// petición y t4 llega la respuesta (reloj propio), t2 llega la petición y t3
+// sale la respuesta (reloj del maestro). El desfase medido es
+// ((t2 - t1) + (t3 - t4)) / 2 y su error, como mucho, la mitad de lo que el
+// RTT supera al mínimo reciente (la asimetría que pudo haber).
+// Un Kalman de desfase y deriva (ppm) filtra las medidas, pesando cada una
+// por ese RTT, y sigue prediciendo entre intercambios con la deriva estimada.
+class SincroniaReloj {
+public:
+    static const uint8_t HISTORIAL_RTT = 8;  // Intercambios para el RTT mínimo
+
+    SincroniaReloj();
+
+    // Olvidar la estimación (cambio de maestro)
+    void reiniciar();
+
+    // Intercambio completo. Devuelve false si se descarta (RTT imposible o
+    // desfase fuera de la puerta de validación)
+    bool agregarIntercambio(uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4);
+
+    // Hay estimación con suficientes intercambios y no caducada
+    bool sincronizado(unsigned long ahoraUs);
+
+    // Conversión entre el reloj propio y el del maestro
+    uint32_t aReferencia(unsigned long localUs);
+    unsigned long aLocal(uint32_t referenciaUs);
+
+    long obtenerDesfase(unsigned long ahoraUs);  // us, maestro - propio
+    float obtenerDeriva();                       // ppm, positiva si el maestro adelanta
+    float obtenerError(unsigned long ahoraUs);   // us, desviación típica del desfase
+    unsigned long obtenerRTT();                  // us, mínimo reciente
+    unsigned long obtenerIntercambios();         // Aceptados
+    unsigned long obtenerRechazos();
+
+private:
+    // Desfase = base + residuo: la parte entera absorbe los saltos grandes y
+    // el float solo guarda lo que queda (precisión de us)
+    uint32_t base;
+    float residuo;        // us
+    float deriva;         // ppm (us por segundo)
+    float p00, p01, p11;
+    unsigned long marca;              // micros() propios de la estimación
+    unsigned long marcaIntercambio;   // micros() del último intercambio aceptado
+    bool hayEstimacion;
+    uint8_t aceptados;
+    uint8_t rechazosSeguidos;
+    unsigned long intercambios;
+    unsigned long rechazos;
+
+    unsigned long rtts[HISTORIAL_RTT];
+    uint8_t cabezaRTT;
+    uint8_t cantidadRTT;
+
+    float desfaseEn(unsigned long localUs);
+    unsigned long rttMinimo();
+    void predecir(unsigned long hastaUs);
+    void iniciar(uint32_t desfase, unsigned long marcaUs, float ruido);
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "TablaPares.h"
+#include "Hal.h"
+#include "Protocolo.h"
+
+const uint8_t MAC_DIFUSION[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+// Constructor
+TablaPares::TablaPares() {
+    numPares = 0;
+    secuenciaDifusion = 0;
+    secuenciaSinPar = 0;
+}
+
+// Buscar un par por MAC
+int TablaPares::buscar(const uint8_t* mac) {
+    for (uint8_t i = 0; i < numPares; i++) {
+        if (memcmp(pares[i].mac, mac, 6) == 0) return i;
+    }
+    return -1;
+}
+
+// Añadir un par nuevo (o devolver el existente)
+int TablaPares::agregar(const uint8_t* mac) {
+    int indice = buscar(mac);
+    if (indice >= 0) return indice;
+    if (numPares >= MAX_PARES) return -1;
+    if (memcmp(mac, MAC_DIFUSION, 6) == 0) return -1;  // No es un coche
+
+    InfoPar& par = pares[numPares];
+    memset(&par, 0, sizeof(par));
+    memcpy(par.mac, mac, 6);
+    par.rol = ROL_ESCLAVO;  // Hasta que anuncie otra cosa
+
+    // Necesario para poder responderle por unicast
+    halAgregarParESPNow(mac);
+    return numPares++;
+}
+
+// Contabilizar una trama recibida
+InfoPar* TablaPares::registrarRecepcion(const uint8_t* mac, uint16_t secuencia, unsigned long ahora) {
+    int indice = agregar(mac);
+    if (indice < 0) return nullptr;
+
+    InfoPar& par = pares[indice];
+    FlujoSecuencia& flujo = (secuencia & SECUENCIA_DIFUSION) ? par.difusion : par.directo;
+    secuencia &= SECUENCIA_NUMERO;
+    if (flujo.hay) {
+        uint16_t salto = (secuencia - flujo.ultima) & SECUENCIA_NUMERO;
+        if (salto == 0) {
+            // Reintento de una trama que ya llegó (se perdió solo su ACK)
+            par.duplicados++;
+            return nullptr;
+        }
+        if (salto <= SECUENCIA_NUMERO / 2) {
+            par.perdidos += salto - 1;
+        } else if (((flujo.ultima - secuencia) & SECUENCIA_NUMERO) <= VENTANA_REORDEN) {
+            // Más antigua que la última: ya se contó en su hueco y su
+            // contenido está superado. La secuencia no retrocede.
+            par.reordenados++;
+            par.recibidos++;
+            par.ultimoVisto = ahora;
+            return nullptr;
+        }
+    }
+    flujo.ultima = secuencia;
+    flujo.hay = true;
+    par.recibidos++;
+    par.ultimoVisto = ahora;
+    return &par;
+}
+
+// Secuencia de la próxima trama: un contador para la difusión y uno por par
+uint16_t TablaPares::siguienteSecuencia(const uint8_t* destino) {
+    if (memcmp(destino, MAC_DIFUSION, 6) == 0) {
+        return (secuenciaDifusion++ & SECUENCIA_NUMERO) | SECUENCIA_DIFUSION;
+    }
+    int indice = agregar(destino);
+    if (indice < 0) return secuenciaSinPar++ & SECUENCIA_NUMERO;
+    return pares[indice].secuenciaTx++ & SECUENCIA_NUMERO;
+}
+
+// Guardar datos de sensores de un par
+void TablaPares::actualizarSensores(InfoPar* par, float temperatura, int luminosidad, unsigned long ahora) {
+    par->temperatura = temperatura;
+    par->luminosidad = luminosidad;
+    par->datosValidos = true;
+    par->ultimosDatos = ahora;
+}
+
+// Par con los datos de sensores más frescos
+InfoPar* TablaPares::masRecienteConSensores(unsigned long ahora, unsigned long caducidad) {
+    InfoPar* mejor = nullptr;
+    for (uint8_t i = 0; i < numPares; i++) {
+        InfoPar& par = pares[i];
+        if (!par.datosValidos || ahora - par.ultimosDatos >= caducidad) continue;
+        if (mejor == nullptr || (long)(par.ultimosDatos - mejor->ultimosDatos) > 0) {
+            mejor = &par;
+        }
+    }
+    return mejor;
+}
+
+// Número de pares conocidos
+uint8_t TablaPares::cantidad() {
+    return numPares;
+}
+
+// Acceso a un par por índice
+InfoPar* TablaPares::obtener(uint8_t indice) {
+    if (indice >= numPares) return nullptr;
+    return &pares[indice];
+}
+
+// MAC en texto
+void formatearMAC(const uint8_t* mac, char* destino) {
+    snprintf(destino, 18, "%02X:%02X:%02X:%02X:%02X:%02X",
+             mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+}
@@ -0,0 +1,82 @@
+#ifndef TABLA_PARES_H
+#define TABLA_PARES_H
+
+#include <Arduino.h>
+
+// Límite de 20 pares sin cifrar de ESP-NOW en el ESP8266, menos el de difusión
+#define MAX_PARES 19
+
+// Una trama hasta este número de secuencias por detrás de la última llegó
+// desordenada; más atrás, el emisor se reinició y se sigue desde ella
+#define VENTANA_REORDEN 32
+
+// Dirección de difusión: los comandos salen en una sola trama para toda la flota
+extern const uint8_t MAC_DIFUSION[6];
+
+// Última secuencia recibida de un flujo (difusión o dirigido a este coche)
+struct FlujoSecuencia {
+    uint16_t ultima;                // Sin el bit de difusión
+    bool hay;
+};
+
+// Estado de cada coche conocido
+struct InfoPar {
+    uint8_t mac[6];
+    uint8_t rol;                    // RolCoche anunciado en sus tramas
+    unsigned long ultimoVisto;      // millis() de la última trama válida
+
+    // Estadísticas de enlace
+    unsigned long recibidos;        // Tramas válidas recibidas
+    unsigned long perdidos;         // Huecos en su número de secuencia
+    unsigned long duplicados;       // Retransmisiones ya procesadas
+    unsigned long reordenados;      // Llegadas después de una más nueva
+    FlujoSecuencia difusion;        // Sus tramas a toda la flota
+    FlujoSecuencia directo;         // Sus tramas dirigidas a este coche
+    uint16_t secuenciaTx;           // Próxima trama que le mandamos por unicast
+
+    // Últimos datos de sensores recibidos
+    bool datosValidos;
+    float temperatura;
+    int luminosidad;
+    unsigned long ultimosDatos;     // millis() de los últimos datos de sensores
+};
+
+// Tabla de pares ESP-NOW de la flota
+class TablaPares {
+public:
+    TablaPares();
+
+    // Añadir un par (también lo registra en ESP-NOW). Devuelve su índice o -1.
+    int agregar(const uint8_t* mac);
+    int buscar(const uint8_t* mac);
+
+    // Contabilizar una trama de mac con su número de secuencia (con el bit
+    // SECUENCIA_DIFUSION, cada flujo por separado).
+    // Devuelve el par (se añade si era desconocido) o nullptr si es un
+    // duplicado, llegó desordenada (ya hay una más nueva) o la tabla está llena.
+    InfoPar* registrarRecepcion(const uint8_t* mac, uint16_t secuencia, unsigned long ahora);
+
+    // Número de secuencia de la próxima trama hacia destino (MAC_DIFUSION
+    // o un par; uno desconocido se añade)
+    uint16_t siguienteSecuencia(const uint8_t* destino);
+
+    // Guardar datos de sensores recibidos de un par
+    void actualizarSensores(InfoPar* par, float temperatura, int luminosidad, unsigned long ahora);
+
+    // Par con datos de sensores más recientes y no caducados, o nullptr
+    InfoPar* masRecienteConSensores(unsigned long ahora, unsigned long caducidad);
+
+    uint8_t cantidad();
+    InfoPar* obtener(uint8_t indice);
+
+private:
+    InfoPar pares[MAX_PARES];
+    uint8_t numPares;
+    uint16_t secuenciaDifusion;
+    uint16_t secuenciaSinPar;       // Unicast a un destino que no cabe en la tabla
+};
+
+// Formatear una MAC como "AA:BB:CC:DD:EE:FF" (buffer de al menos 18 bytes)
+void formatearMAC(const uint8_t* mac, char* destino);
+
+#endif
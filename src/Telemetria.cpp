@@ -0,0 +1,237 @@
+#include "Telemetria.h"
+#include "Protocolo.h"
+#include <limits.h>
+
+// Escritor secuencial sobre un buffer fijo: si algo no cabe, marca el
+// desbordamiento y deja de escribir
+class EscritorJSON {
+public:
+    EscritorJSON(char* destino, size_t tam) : inicio(destino), actual(destino), fin(destino + tam), desbordado(tam == 0), hayCampos(false) {}
+
+    void caracter(char c) {
+        if (actual + 1 >= fin) {  // Reservar hueco para el terminador
+            desbordado = true;
+            return;
+        }
+        *actual++ = c;
+    }
+
+    void literal(const char* texto) {
+        while (*texto) caracter(*texto++);
+    }
+
+    // Los contadores son de 32 bits en el ESP8266; en el host se recortan
+    // igual para que el ancho máximo (10 cifras) sea el mismo
+    void natural(uint32_t valor) {
+        char cifras[10];
+        uint8_t n = 0;
+        do {
+            cifras[n++] = '0' + valor % 10;
+            valor /= 10;
+        } while (valor > 0);
+        while (n > 0) caracter(cifras[--n]);
+    }
+
+    void entero(int32_t valor) {
+        if (valor < 0) {
+            caracter('-');
+            natural(0U - (uint32_t)valor);
+        } else {
+            natural(valor);
+        }
+    }
+
+    // Número con parte decimal fija, redondeado y recortado a ±TELEMETRIA_DECIMAL_MAX
+    void decimal(float valor, uint8_t decimales) {
+        if (valor != valor) {  // NaN no existe en JSON
+            literal("null");
+            return;
+        }
+        if (valor > TELEMETRIA_DECIMAL_MAX) valor = TELEMETRIA_DECIMAL_MAX;
+        if (valor < -TELEMETRIA_DECIMAL_MAX) valor = -TELEMETRIA_DECIMAL_MAX;
+
+        unsigned long escala = 1;
+        for (uint8_t i = 0; i < decimales; i++) escala *= 10;
+
+        bool negativo = valor < 0;
+        float absoluto = negativo ? -valor : valor;
+        unsigned long parteEntera = (unsigned long)absoluto;
+        unsigned long parteDecimal = (unsigned long)((absoluto - parteEntera) * escala + 0.5f);
+        if (parteDecimal >= escala) {  // El redondeo se llevó una unidad
+            parteEntera++;
+            parteDecimal -= escala;
+        }
+
+        if (negativo && (parteEntera > 0 || parteDecimal > 0)) caracter('-');
+        natural(parteEntera);
+        if (decimales == 0) return;
+        caracter('.');
+        for (unsigned long divisor = escala / 10; divisor > 0; divisor /= 10) {
+            caracter('0' + (parteDecimal / divisor) % 10);
+        }
+    }
+
+    // Nombre de campo, con coma si no es el primero del objeto
+    void clave(const char* nombre) {
+        if (hayCampos) caracter(',');
+        hayCampos = true;
+        caracter('"');
+        literal(nombre);
+        literal("\":");
+    }
+
+    void booleano(bool valor) {
+        literal(valor ? "true" : "false");
+    }
+
+    void texto(const char* valor) {
+        caracter('"');
+        literal(valor);
+        caracter('"');
+    }
+
+    // Cierra la cadena; 0 si hubo desbordamiento
+    size_t terminar() {
+        if (desbordado) {
+            if (fin > inicio) *inicio = '\0';
+            return 0;
+        }
+        *actual = '\0';
+        return actual - inicio;
+    }
+
+private:
+    char* inicio;
+    char* actual;
+    char* fin;
+    bool desbordado;
+    bool hayCampos;
+};
+
+static const char* textoOrigen(uint8_t origen) {
+    switch (origen) {
+        case ORIGEN_LOCAL: return "LOCAL";
+        case ORIGEN_REMOTO: return "REMOTO";
+        default: return "SIN_DATOS";
+    }
+}
+
+// Valor de un decimal tal como se publica, para comparar sin ruido
+static long cuantizar(float valor, uint8_t decimales) {
+    if (valor != valor) return LONG_MIN;
+    if (valor > TELEMETRIA_DECIMAL_MAX) valor = TELEMETRIA_DECIMAL_MAX;
+    if (valor < -TELEMETRIA_DECIMAL_MAX) valor = -TELEMETRIA_DECIMAL_MAX;
+    float escala = decimales == 2 ? 100.0f : (decimales == 1 ? 10.0f : 1.0f);
+    float escalado = valor * escala;
+    return (long)(escalado < 0 ? escalado - 0.5f : escalado + 0.5f);
+}
+
+// ¿Cambió algo publicable de la flota? vistoHace cuenta por segundos
+static bool cambiaronPares(const InstantaneaTelemetria& t, const InstantaneaTelemetria& anterior) {
+    if (t.numPares != anterior.numPares) return true;
+    for (uint8_t i = 0; i < t.numPares && i < MAX_PARES; i++) {
+        const InstantaneaPar& a = t.pares[i];
+        const InstantaneaPar& b = anterior.pares[i];
+        if (memcmp(a.mac, b.mac, 6) != 0 || a.rol != b.rol || a.datosValidos != b.datosValidos ||
+            a.luz != b.luz || cuantizar(a.temperatura, 2) != cuantizar(b.temperatura, 2) ||
+            a.vistoHace / 1000 != b.vistoHace / 1000 || a.recibidos != b.recibidos ||
+            a.perdidos != b.perdidos || a.duplicados != b.duplicados ||
+            a.reordenados != b.reordenados) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Escribir los campos de la instantánea. Sin anterior se escriben todos;
+// con anterior, solo los que cambiaron a la precisión publicada.
+static size_t escribirCampos(const InstantaneaTelemetria& t, const InstantaneaTelemetria* anterior,
+                             char* destino, size_t tam) {
+    EscritorJSON json(destino, tam);
+    const InstantaneaTelemetria* a = anterior;
+
+#define CAMBIA(campo) (a == nullptr || a->campo != t.campo)
+#define CAMBIA_DECIMAL(campo, decimales) (a == nullptr || cuantizar(a->campo, decimales) != cuantizar(t.campo, decimales))
+
+    json.caracter('{');
+    if (CAMBIA_DECIMAL(distancia, 2))          { json.clave("distancia");            json.decimal(t.distancia, 2); }
+    if (CAMBIA_DECIMAL(varianzaDistancia, 2))  { json.clave("varianzaDistancia");    json.decimal(t.varianzaDistancia, 2); }
+    if (CAMBIA_DECIMAL(velocidadDistancia, 1)) { json.clave("velocidadDistancia");   json.decimal(t.velocidadDistancia, 1); }
+    if (CAMBIA_DECIMAL(temperatura, 2))        { json.clave("temperatura");          json.decimal(t.temperatura, 2); }
+    if (CAMBIA(luz))                           { json.clave("luz");                  json.entero(t.luz); }
+    if (CAMBIA(movimiento))                    { json.clave("estado");               json.texto(textoMovimiento(t.movimiento)); }
+    if (CAMBIA(esMaestro))                     { json.clave("modo");                 json.texto(t.esMaestro ? "MAESTRO" : "ESCLAVO"); }
+    if (CAMBIA(automatico))                    { json.clave("automatico");           json.booleano(t.automatico); }
+    if (CAMBIA(lucesDisponibles))              { json.clave("lucesDisponibles");     json.booleano(t.lucesDisponibles); }
+    if (CAMBIA(lucesEncendidas))               { json.clave("lucesEncendidas");      json.booleano(t.lucesEncendidas); }
+    if (CAMBIA(lucesAutomaticas))              { json.clave("lucesAutomaticas");     json.booleano(t.lucesAutomaticas); }
+    if (CAMBIA(tieneSensores))                 { json.clave("tieneSensores");        json.booleano(t.tieneSensores); }
+    if (CAMBIA(origenDatos))                   { json.clave("origenDatos");          json.texto(textoOrigen(t.origenDatos)); }
+
+    // Información de sensores activos
+    if (CAMBIA(sensorUltrasonico))             { json.clave("sensorUltrasonico");    json.booleano(t.sensorUltrasonico); }
+    if (CAMBIA(sensorTemperatura))             { json.clave("sensorTemperatura");    json.booleano(t.sensorTemperatura); }
+    if (CAMBIA(sensorLuminosidad))             { json.clave("sensorLuminosidad");    json.booleano(t.sensorLuminosidad); }
+    if (CAMBIA(sensorLuces))                   { json.clave("sensorLuces");          json.booleano(t.sensorLuces); }
+
+    // Estadísticas ESP-NOW
+    if (CAMBIA(mensajesEnviados))              { json.clave("mensajesEnviados");     json.natural(t.mensajesEnviados); }
+    if (CAMBIA(mensajesRecibidos))             { json.clave("mensajesRecibidos");    json.natural(t.mensajesRecibidos); }
+    if (CAMBIA(mensajesFallidos))              { json.clave("mensajesFallidos");     json.natural(t.mensajesFallidos); }
+    if (CAMBIA(reintentos))                    { json.clave("reintentos");           json.natural(t.reintentos); }
+    if (CAMBIA(timeoutsACK))                   { json.clave("timeoutsACK");          json.natural(t.timeoutsACK); }
+    if (CAMBIA(comandosSobrescritos))          { json.clave("comandosSobrescritos"); json.natural(t.comandosSobrescritos); }
+    if (CAMBIA(desbordesBuzon))                { json.clave("desbordesBuzon");       json.natural(t.desbordesBuzon); }
+    if (CAMBIA_DECIMAL(tasaExito, 1))          { json.clave("tasaExito");            json.decimal(t.tasaExito, 1); }
+    if (CAMBIA(silenciosMando))                { json.clave("silenciosMando");       json.natural(t.silenciosMando); }
+    if (CAMBIA(paradasPorSilencio))            { json.clave("paradasPorSilencio");   json.natural(t.paradasPorSilencio); }
+    if (CAMBIA_DECIMAL(errorExtrapolacion, 1)) { json.clave("errorExtrapolacion");   json.decimal(t.errorExtrapolacion, 1); }
+    if (CAMBIA(controlPropio))                 { json.clave("controlPropio");        json.booleano(t.controlPropio); }
+    if (CAMBIA_DECIMAL(huecoFusion, 2))        { json.clave("huecoFusion");          json.decimal(t.huecoFusion, 2); }
+    if (CAMBIA(relojSincronizado))             { json.clave("relojSincronizado");    json.booleano(t.relojSincronizado); }
+    if (CAMBIA(desfaseReloj))                  { json.clave("desfaseReloj");         json.entero(t.desfaseReloj); }
+    if (CAMBIA_DECIMAL(derivaReloj, 2))        { json.clave("derivaReloj");          json.decimal(t.derivaReloj, 2); }
+    if (CAMBIA_DECIMAL(errorReloj, 1))         { json.clave("errorReloj");           json.decimal(t.errorReloj, 1); }
+    if (CAMBIA(comandosTarde))                 { json.clave("comandosTarde");        json.natural(t.comandosTarde); }
+
+#undef CAMBIA
+#undef CAMBIA_DECIMAL
+
+    // Datos por par de la flota (la lista entera si cambió cualquiera)
+    if (a == nullptr || cambiaronPares(t, *a)) {
+        json.clave("pares");
+        json.caracter('[');
+        uint8_t numPares = t.numPares < MAX_PARES ? t.numPares : MAX_PARES;
+        for (uint8_t i = 0; i < numPares; i++) {
+            const InstantaneaPar& par = t.pares[i];
+            char mac[18];
+            formatearMAC(par.mac, mac);
+            if (i > 0) json.caracter(',');
+            json.literal("{\"mac\":");           json.texto(mac);
+            json.literal(",\"rol\":");           json.texto(par.rol == ROL_MAESTRO ? "MAESTRO" : "ESCLAVO");
+            json.literal(",\"vistoHace\":");     json.natural(par.vistoHace);
+            json.literal(",\"recibidos\":");     json.natural(par.recibidos);
+            json.literal(",\"perdidos\":");      json.natural(par.perdidos);
+            json.literal(",\"duplicados\":");    json.natural(par.duplicados);
+            json.literal(",\"reordenados\":");   json.natural(par.reordenados);
+            json.literal(",\"temperatura\":");   json.decimal(par.datosValidos ? par.temperatura : -999, 2);
+            json.literal(",\"luz\":");           json.entero(par.datosValidos ? par.luz : -1);
+            json.caracter('}');
+        }
+        json.caracter(']');
+    }
+    json.caracter('}');
+
+    return json.terminar();
+}
+
+// Escribir la instantánea completa como JSON
+size_t escribirTelemetriaJSON(const InstantaneaTelemetria& t, char* destino, size_t tam) {
+    return escribirCampos(t, nullptr, destino, tam);
+}
+
+// Escribir solo lo que cambió respecto a la última instantánea publicada
+size_t escribirTelemetriaDeltaJSON(const InstantaneaTelemetria& t, const InstantaneaTelemetria& anterior,
+                                   char* destino, size_t tam) {
+    return escribirCampos(t, &anterior, destino, tam);
+}
@@ -0,0 +1,112 @@
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include <Arduino.h>
+#include "TablaPares.h"
+
+// Serialización de la telemetría a JSON sin memoria dinámica.
+// El estado se copia primero en una instantánea (solo valores ya leídos, sin
+// tocar sensores) y luego se escribe en un buffer del llamante. Cada campo
+// tiene un ancho máximo acotado, así que el tamaño del peor caso es fijo.
+
+// Origen de los datos de sensores
+enum OrigenDatos : uint8_t {
+    ORIGEN_LOCAL = 0,
+    ORIGEN_REMOTO = 1,
+    ORIGEN_SIN_DATOS = 2
+};
+
+// Los decimales se recortan a ±TELEMETRIA_DECIMAL_MAX para acotar su ancho
+#define TELEMETRIA_DECIMAL_MAX 9999999.0f
+
+// Peor caso del JSON: parte fija + cada par de la flota con su coma (el
+// primero no la lleva y ese byte queda para el terminador). Todos los
+// números al máximo ancho y los textos más largos.
+// Al añadir un campo hay que subirlos: prueba_telemetria escribe el peor
+// caso y comprueba que ocupa exactamente TELEMETRIA_TAM_MAX.
+#define TELEMETRIA_TAM_FIJO 913
+#define TELEMETRIA_TAM_POR_PAR 198
+#define TELEMETRIA_TAM_MAX (TELEMETRIA_TAM_FIJO + MAX_PARES * TELEMETRIA_TAM_POR_PAR)
+
+// Datos de un par de la flota
+struct InstantaneaPar {
+    uint8_t mac[6];
+    uint8_t rol;                  // RolCoche
+    bool datosValidos;
+    int8_t luz;                   // -1 si no hay datos
+    float temperatura;            // -999 si no hay datos
+    unsigned long vistoHace;      // ms
+    unsigned long recibidos;
+    unsigned long perdidos;
+    unsigned long duplicados;
+    unsigned long reordenados;
+};
+
+// Estado completo publicado en /datos
+struct InstantaneaTelemetria {
+    // Sensores
+    float distancia;
+    float varianzaDistancia;
+    float velocidadDistancia;
+    float temperatura;            // -999 si no hay datos
+    int8_t luz;                   // -1 si no hay datos
+    uint8_t origenDatos;          // OrigenDatos
+
+    // Estado
+    uint8_t movimiento;           // CodigoMovimiento
+    bool esMaestro;
+    bool automatico;
+    bool lucesDisponibles;
+    bool lucesEncendidas;
+    bool lucesAutomaticas;
+    bool tieneSensores;
+
+    // Sensores conectados
+    bool sensorUltrasonico;
+    bool sensorTemperatura;
+    bool sensorLuminosidad;
+    bool sensorLuces;
+
+    // Estadísticas ESP-NOW
+    unsigned long mensajesEnviados;
+    unsigned long mensajesRecibidos;
+    unsigned long mensajesFallidos;
+    unsigned long reintentos;
+    unsigned long timeoutsACK;
+    unsigned long comandosSobrescritos;
+    unsigned long desbordesBuzon;
+    float tasaExito;
+
+    // Esclavo sin comandos del maestro (ExtrapoladorMando)
+    unsigned long silenciosMando;
+    unsigned long paradasPorSilencio;
+    float errorExtrapolacion;     // PWM
+
+    // Esclavo con control propio sobre el hueco fusionado (FusionHueco)
+    bool controlPropio;
+    float huecoFusion;            // cm
+
+    // Reloj común con el maestro (SincroniaReloj) y órdenes programadas
+    bool relojSincronizado;
+    long desfaseReloj;            // us, maestro - propio
+    float derivaReloj;            // ppm
+    float errorReloj;             // us (desviación típica)
+    unsigned long comandosTarde;  // Llegaron pasado su instante
+
+    // Flota
+    uint8_t numPares;
+    InstantaneaPar pares[MAX_PARES];
+};
+
+// Escribir la instantánea como JSON terminado en '\0'. Devuelve la longitud
+// escrita (sin el terminador), o 0 si no cabe en el buffer.
+size_t escribirTelemetriaJSON(const InstantaneaTelemetria& t, char* destino, size_t tam);
+
+// Igual, pero solo con los campos que cambiaron respecto a "anterior" a la
+// precisión publicada (la lista de pares va entera si cambió alguno). Si no
+// cambió nada escribe "{}" (longitud TELEMETRIA_DELTA_VACIO).
+size_t escribirTelemetriaDeltaJSON(const InstantaneaTelemetria& t, const InstantaneaTelemetria& anterior,
+                                   char* destino, size_t tam);
+#define TELEMETRIA_DELTA_VACIO 2
+
+#endif